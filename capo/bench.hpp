@@ -0,0 +1,427 @@
+/*
+    The Capo Library
+    Code covered by the MIT License
+
+    Author: mutouyun (http://orzz.org)
+*/
+
+#pragma once
+
+#include "capo/stopwatch.hpp"
+#include "capo/printf.hpp"
+#include "capo/json.hpp"
+#include "capo/noncopyable.hpp"
+
+#include <string>       // std::string, std::getline, std::stod
+#include <vector>       // std::vector
+#include <initializer_list> // std::initializer_list
+#include <map>          // std::map
+#include <thread>       // std::thread
+#include <atomic>       // std::atomic
+#include <chrono>       // std::chrono
+#include <sstream>      // std::ostringstream
+#include <istream>      // std::istream
+#include <iostream>     // std::cout
+#include <algorithm>    // std::sort, std::find, std::any_of
+#include <utility>      // std::forward
+#include <cmath>        // std::sqrt, std::ceil
+#include <cstddef>      // size_t
+
+#if defined(_MSC_VER)
+#include <intrin.h>     // _ReadWriteBarrier
+#endif/*_MSC_VER*/
+
+namespace capo {
+
+////////////////////////////////////////////////////////////////
+/// Optimization barriers
+////////////////////////////////////////////////////////////////
+
+/*
+    do_not_optimize(v): forces v to be computed (and stored), as if it were read.
+    clobber_memory()  : forces all pending writes to memory, as if all memory were read.
+*/
+
+#if defined(__GNUC__)
+template <typename T>
+inline void do_not_optimize(const T& v)
+{
+    __asm__ __volatile__("" : : "r,m"(v) : "memory");
+}
+
+template <typename T>
+inline void do_not_optimize(T& v)
+{
+    __asm__ __volatile__("" : "+r,m"(v) : : "memory");
+}
+
+inline void clobber_memory(void)
+{
+    __asm__ __volatile__("" : : : "memory");
+}
+#else /*!__GNUC__*/
+namespace detail_bench {
+
+inline void use_pointer(const volatile char*) {}
+
+} // namespace detail_bench
+
+template <typename T>
+inline void do_not_optimize(const T& v)
+{
+    detail_bench::use_pointer(&reinterpret_cast<const volatile char&>(v));
+    _ReadWriteBarrier();
+}
+
+inline void clobber_memory(void)
+{
+    _ReadWriteBarrier();
+}
+#endif/*!__GNUC__*/
+
+////////////////////////////////////////////////////////////////
+/// Benchmark results
+////////////////////////////////////////////////////////////////
+
+/*
+    The statistics of the samples, in nanoseconds per iteration.
+*/
+
+struct bench_stats
+{
+    size_t              iterations_ = 0;    // per sample
+    std::vector<double> samples_;           // sorted
+    double mean_   = 0;
+    double median_ = 0;
+    double stddev_ = 0;
+    double min_    = 0;
+    double max_    = 0;
+
+    bench_stats(void) = default;
+
+    bench_stats(size_t iterations, std::vector<double> samples)
+        : iterations_(iterations), samples_(std::move(samples))
+    {
+        if (samples_.empty()) return;
+        std::sort(samples_.begin(), samples_.end());
+        double sum = 0, sum2 = 0;
+        for (double s : samples_) sum += s;
+        mean_ = sum / samples_.size();
+        for (double s : samples_) sum2 += (s - mean_) * (s - mean_);
+        stddev_ = (samples_.size() > 1) ? std::sqrt(sum2 / (samples_.size() - 1)) : 0;
+        min_    = samples_.front();
+        max_    = samples_.back();
+        median_ = percentile(50);
+    }
+
+    /*
+        Linear interpolation between the closest ranks, p is in [0, 100].
+    */
+    double percentile(double p) const
+    {
+        if (samples_.empty()) return 0;
+        double pos = (samples_.size() - 1) * (p < 0 ? 0 : p > 100 ? 100 : p) / 100;
+        size_t lo  = static_cast<size_t>(pos);
+        if (lo + 1 >= samples_.size()) return samples_.back();
+        return samples_[lo] + (samples_[lo + 1] - samples_[lo]) * (pos - lo);
+    }
+};
+
+struct bench_result
+{
+    std::string name_;
+    bench_stats stats_;
+    double      baseline_ = 0;  // the median of the baseline, 0 if there is none
+
+    /*
+        The relative change of the median against the baseline (0.1 means 10% slower).
+    */
+    double change(void) const
+    {
+        return (baseline_ > 0) ? (stats_.median_ / baseline_ - 1) : 0;
+    }
+};
+
+namespace detail_bench {
+
+template <typename T>
+std::string param_name(const std::string& name, const T& param)
+{
+    std::ostringstream ss;
+    ss << name << "/" << param;
+    return ss.str();
+}
+
+inline std::vector<std::string> split_csv(const std::string& line)
+{
+    std::vector<std::string> cols(1);
+    for (char c : line)
+    {
+        if (c == ',') cols.emplace_back();
+        else if (c != '\r') cols.back().push_back(c);
+    }
+    return cols;
+}
+
+} // namespace detail_bench
+
+////////////////////////////////////////////////////////////////
+/// Microbenchmark harness
+////////////////////////////////////////////////////////////////
+
+/*
+    Each case is run for the warmup time, then the iterations per sample are calibrated
+    so that a sample takes at least min_time, then the samples are taken.
+    A case is a callable, invoked once per iteration.
+
+    <code>
+        capo::bench b;
+        b.run("vector::push_back", [&] { v.push_back(1); capo::do_not_optimize(v); });
+        b.run("memcpy", { 16, 256, 4096 }, [&](size_t n) { std::memcpy(dst, src, n); capo::clobber_memory(); });
+        b.write_csv(std::cout);
+    <code/>
+*/
+
+template <typename ClockT = std::chrono::steady_clock>
+class basic_bench : capo::noncopyable
+{
+    std::chrono::nanoseconds    min_time_   = std::chrono::milliseconds(10);
+    std::chrono::nanoseconds    warmup_     = std::chrono::milliseconds(5);
+    size_t                      samples_    = 10;
+    size_t                      iterations_ = 0;    // 0: calibrate
+    bool                        verbose_    = true;
+
+    std::vector<bench_result>     results_;
+    std::map<std::string, double> baseline_;
+
+    template <typename F>
+    static double time(F& f, size_t n)
+    {
+        capo::stopwatch<1, ClockT> sw(true);
+        for (size_t i = 0; i < n; ++i) f();
+        return static_cast<double>(sw.template elapsed<std::chrono::nanoseconds>());
+    }
+
+    /*
+        Runs f(n) (a batch of n iterations, returns the elapsed nanoseconds)
+        for calibrating, warming up and sampling.
+    */
+    template <typename BatchF>
+    const bench_result& measure(const std::string& name, BatchF&& batch)
+    {
+        const double min_ns = static_cast<double>(min_time_.count());
+        const size_t max_n  = size_t(1) << 40; // in case the case was optimized away
+        size_t n = (iterations_ == 0) ? 1 : iterations_;
+        auto grow = [&](double t)
+        {
+            double k = (t > 0) ? (min_ns * 1.2 / t) : 10;
+            n = static_cast<size_t>(n * (k > 10 ? 10 : k < 2 ? 2 : k));
+        };
+        // a clock too coarse for the batch could report 0 forever, so the rounds are bounded too
+        const size_t max_rounds = 1000;
+        size_t round = 0;
+        for (double spent = 0; (spent < warmup_.count()) && (round < max_rounds); ++round)
+        {
+            double t = batch(n);
+            spent += t;
+            if ((iterations_ == 0) && (t < min_ns) && (n < max_n)) grow(t);
+        }
+        if (iterations_ == 0)
+        {
+            for (double t; ((t = batch(n)) < min_ns) && (n < max_n); ) grow(t);
+        }
+        std::vector<double> samples;
+        for (size_t i = 0; i < samples_; ++i) samples.push_back(batch(n) / n);
+
+        bench_result r;
+        r.name_  = name;
+        r.stats_ = bench_stats { n, std::move(samples) };
+        auto it = baseline_.find(name);
+        if (it != baseline_.end()) r.baseline_ = it->second;
+        results_.push_back(std::move(r));
+        if (verbose_)
+        {
+            if (results_.size() == 1) print_head(std::cout, false);
+            print(std::cout, results_.back());
+        }
+        return results_.back();
+    }
+
+    template <typename F>
+    static void print_head(F&& out, bool has_baseline)
+    {
+        capo::printf(out, "%-40s %12s %12s %10s %12s%s\n", "benchmark", "median(ns)", "mean(ns)", "stddev", "p99(ns)",
+                     has_baseline ? "   change" : "");
+    }
+
+    template <typename F>
+    static void print(F&& out, const bench_result& r)
+    {
+        auto& s = r.stats_;
+        if (r.baseline_ > 0)
+            capo::printf(out, "%-40s %12.2f %12.2f %10.2f %12.2f %+8.1f%%\n",
+                         r.name_.c_str(), s.median_, s.mean_, s.stddev_, s.percentile(99), r.change() * 100);
+        else
+            capo::printf(out, "%-40s %12.2f %12.2f %10.2f %12.2f\n",
+                         r.name_.c_str(), s.median_, s.mean_, s.stddev_, s.percentile(99));
+    }
+
+public:
+    basic_bench& min_time  (std::chrono::nanoseconds t) { min_time_   = t; return *this; }
+    basic_bench& warmup    (std::chrono::nanoseconds t) { warmup_     = t; return *this; }
+    basic_bench& samples   (size_t n) { samples_    = (n == 0) ? 1 : n; return *this; }
+    basic_bench& iterations(size_t n) { iterations_ = n; return *this; } // 0: calibrate
+    basic_bench& verbose   (bool v)   { verbose_    = v; return *this; }
+
+    const std::vector<bench_result>& results(void) const { return results_; }
+
+    /*
+        Runs f() repeatedly.
+    */
+    template <typename F>
+    const bench_result& run(const std::string& name, F&& f)
+    {
+        return measure(name, [&f](size_t n) { return time(f, n); });
+    }
+
+    /*
+        Runs f(param) for each parameter, the cases are named "name/param".
+    */
+    template <typename P, typename F>
+    void run(const std::string& name, const std::vector<P>& params, F&& f)
+    {
+        for (auto& p : params)
+        {
+            auto g = [&f, &p] { f(p); };
+            measure(detail_bench::param_name(name, p), [&g](size_t n) { return time(g, n); });
+        }
+    }
+
+    template <typename P, typename F>
+    void run(const std::string& name, std::initializer_list<P> params, F&& f)
+    {
+        run(name, std::vector<P>(params), std::forward<F>(f));
+    }
+
+    /*
+        Runs f(thread_index) concurrently in each number of threads, the cases are named
+        "name/threads:N", and the times are the wall time divided by the iterations per thread.
+    */
+    template <typename F>
+    void run_threads(const std::string& name, const std::vector<size_t>& thread_counts, F&& f)
+    {
+        for (size_t tn : thread_counts)
+        {
+            measure(detail_bench::param_name(name, "threads:" + std::to_string(tn)), [&f, tn](size_t n)
+            {
+                std::atomic<size_t> ready { 0 };
+                std::atomic<bool>   go    { false };
+                std::vector<std::thread> ths;
+                for (size_t t = 0; t < tn; ++t)
+                {
+                    ths.emplace_back([&, t]
+                    {
+                        ready.fetch_add(1, std::memory_order_release);
+                        while (!go.load(std::memory_order_acquire)) std::this_thread::yield();
+                        for (size_t i = 0; i < n; ++i) f(t);
+                    });
+                }
+                while (ready.load(std::memory_order_acquire) != tn) std::this_thread::yield();
+                capo::stopwatch<1, ClockT> sw(true);
+                go.store(true, std::memory_order_release);
+                for (auto& th : ths) th.join();
+                return static_cast<double>(sw.template elapsed<std::chrono::nanoseconds>());
+            });
+        }
+    }
+
+    /*
+        Loads the medians of a baseline written by write_csv,
+        the following results are compared against it.
+    */
+    bool load_baseline(std::istream& in)
+    {
+        std::string line;
+        if (!std::getline(in, line)) return false;
+        auto head = detail_bench::split_csv(line);
+        auto pos  = static_cast<size_t>(std::find(head.begin(), head.end(), "median_ns") - head.begin());
+        if ((head[0] != "name") || (pos == head.size())) return false;
+        while (std::getline(in, line))
+        {
+            auto cols = detail_bench::split_csv(line);
+            if (cols.size() <= pos) continue;
+            try { baseline_[cols[0]] = std::stod(cols[pos]); }
+            catch (...) { return false; }
+        }
+        return true;
+    }
+
+    /*
+        The results whose medians are slower than the baseline by more than tolerance (0.1 means 10%).
+    */
+    std::vector<bench_result> regressions(double tolerance) const
+    {
+        std::vector<bench_result> rs;
+        for (auto& r : results_)
+            if ((r.baseline_ > 0) && (r.change() > tolerance)) rs.push_back(r);
+        return rs;
+    }
+
+    /*
+        Prints the results (ns per iteration) as a table, the output is the same as capo::printf's.
+    */
+    template <typename F>
+    void report(F&& out) const
+    {
+        print_head(out, std::any_of(results_.begin(), results_.end(), [](const bench_result& r)
+        {
+            return r.baseline_ > 0;
+        }));
+        for (auto& r : results_) print(out, r);
+    }
+
+    template <typename F>
+    void write_csv(F&& out) const
+    {
+        capo::printf(out, "name,iterations,samples,mean_ns,median_ns,stddev_ns,min_ns,max_ns,p90_ns,p99_ns\n");
+        for (auto& r : results_)
+        {
+            auto& s = r.stats_;
+            capo::printf(out, "%s,%zu,%zu,%r,%r,%r,%r,%r,%r,%r\n", r.name_.c_str(), s.iterations_, s.samples_.size(),
+                         s.mean_, s.median_, s.stddev_, s.min_, s.max_, s.percentile(90), s.percentile(99));
+        }
+    }
+
+    /*
+        The output can be anything json_writer accepts.
+    */
+    template <typename F>
+    void write_json(F&& out) const
+    {
+        capo::json_writer<F&&> w { std::forward<F>(out) };
+        w.begin_object().key("benchmarks").begin_array();
+        for (auto& r : results_)
+        {
+            auto& s = r.stats_;
+            w.begin_object()
+             .member("name"      , r.name_)
+             .member("iterations", s.iterations_)
+             .member("samples"   , s.samples_.size())
+             .member("mean_ns"   , s.mean_)
+             .member("median_ns" , s.median_)
+             .member("stddev_ns" , s.stddev_)
+             .member("min_ns"    , s.min_)
+             .member("max_ns"    , s.max_)
+             .member("p90_ns"    , s.percentile(90))
+             .member("p99_ns"    , s.percentile(99));
+            if (r.baseline_ > 0)
+                w.member("baseline_ns", r.baseline_).member("change", r.change());
+            w.end_object();
+        }
+        w.end_array().end_object();
+    }
+};
+
+using bench = basic_bench<>;
+
+} // namespace capo
@@ -0,0 +1,743 @@
+/*
+    The Capo Library
+    Code covered by the MIT License
+
+    Author: mutouyun (http://orzz.org)
+*/
+
+#pragma once
+
+#include "capo/noncopyable.hpp"
+#include "capo/spin_lock.hpp"
+#include "capo/concept.hpp"
+#include "capo/logger.hpp"
+#include "capo/output.hpp"
+#include "capo/printf.hpp"
+#include "capo/format.hpp"
+
+#include <string>       // std::string
+#include <vector>       // std::vector
+#include <atomic>       // std::atomic
+#include <mutex>        // std::mutex, std::lock_guard
+#include <chrono>       // std::chrono
+#include <utility>      // std::forward
+#include <type_traits>  // std::decay, std::is_integral, ...
+#include <limits>       // std::numeric_limits
+#include <cstdint>      // uint64_t, uint32_t, uint8_t
+#include <cstddef>      // size_t
+#include <cstring>      // std::memcpy, std::strlen
+#include <cstdio>       // std::FILE, std::fopen, ...
+
+namespace capo {
+
+////////////////////////////////////////////////////////////////
+/// Deferred-formatting binary log
+////////////////////////////////////////////////////////////////
+
+/*
+    A call records only the id of its format site, a timestamp and the raw arguments.
+    The format strings are written once per file, and binlog_reader formats the records offline.
+
+    File layout (native byte order):
+
+        "CAPOBLG1"
+        block*       : { block_head, payload }
+        index entry* : { offset, min_ts, max_ts, kind }   (written by close)
+        trailer      : { index offset, index count, "CAPOBIDX" }
+
+    There are two kinds of blocks:
+    1. site blocks, the payload is a list of { id, level, line, tags, fmt, file }.
+    2. data blocks, the payload is a list of { id, time delta, arguments... }.
+    If the trailer is missing (the writer was not closed), the reader scans the blocks instead.
+*/
+
+namespace detail_binlog {
+
+enum : uint8_t
+{
+    t_none = 0, t_sint, t_uint, t_char, t_wchar, t_double, t_ldouble, t_str, t_ptr
+};
+
+enum : uint8_t
+{
+    block_data = 0, block_site = 1
+};
+
+struct block_head
+{
+    char     magic_[4]; // "CBLK"
+    uint32_t kind_;
+    uint32_t size_;     // payload bytes
+    uint32_t count_;    // records
+    uint64_t min_ts_;
+    uint64_t max_ts_;
+};
+
+struct index_entry
+{
+    uint64_t offset_;
+    uint64_t min_ts_;
+    uint64_t max_ts_;
+    uint64_t kind_;
+};
+
+struct trailer
+{
+    uint64_t offset_;
+    uint64_t count_;
+    char     magic_[8]; // "CAPOBIDX"
+};
+
+constexpr const char file_magic[] = "CAPOBLG1";
+constexpr const char tail_magic[] = "CAPOBIDX";
+
+/*
+    Classifies an argument type through the pf mapping of capo::output.
+*/
+
+constexpr bool same_str(const char* a, const char* b)
+{
+    return (*a == *b) && ((*a == '\0') || same_str(a + 1, b + 1));
+}
+
+template <typename T>
+using rep_t = typename std::decay<T>::type;
+
+CAPO_CONCEPT_TYPING_(can_cast_str, static_cast<const char*>(std::declval<T&>()));
+
+constexpr uint8_t classify_pf(const char* v)
+{
+    return same_str(v, "c"  ) ? t_char    :
+           same_str(v, "lc" ) ? t_wchar   :
+           same_str(v, "d"  ) || same_str(v, "ld") || same_str(v, "lld") ? t_sint :
+           same_str(v, "u"  ) || same_str(v, "lu") || same_str(v, "llu") ? t_uint :
+           same_str(v, "f"  ) ? t_double  :
+           same_str(v, "Lf" ) ? t_ldouble :
+           same_str(v, "s"  ) ? t_str     :
+           same_str(v, "p"  ) ? t_ptr     : t_none; // "ls" is not supported
+}
+
+template <typename T, typename U = rep_t<T>>
+struct tag_of : std::integral_constant<uint8_t,
+    std::is_same<U, bool>::value         ? t_uint :
+    detail_output::pf<U>::value          ? classify_pf(detail_output::pf<U>::val()) :
+    std::is_same<U, std::string>::value  ? t_str  :
+    std::is_enum<U>::value               ? t_sint :
+    std::is_integral<U>::value           ? (std::is_signed<U>::value ? t_sint : t_uint) :
+    can_cast_str<U>::value               ? t_str  : t_none>
+{};
+
+/*
+    Variable-length encoding
+*/
+
+inline void put_varint(std::vector<char>& buf, uint64_t v)
+{
+    while (v >= 0x80)
+    {
+        buf.push_back(static_cast<char>(v | 0x80));
+        v >>= 7;
+    }
+    buf.push_back(static_cast<char>(v));
+}
+
+inline uint64_t zigzag  (int64_t  v) { return (static_cast<uint64_t>(v) << 1) ^ static_cast<uint64_t>(v >> 63); }
+inline int64_t  unzigzag(uint64_t v) { return static_cast<int64_t>(v >> 1) ^ -static_cast<int64_t>(v & 1); }
+
+inline void put_bytes(std::vector<char>& buf, const void* p, size_t n)
+{
+    auto c = static_cast<const char*>(p);
+    buf.insert(buf.end(), c, c + n);
+}
+
+inline void put_str(std::vector<char>& buf, const char* s, size_t n)
+{
+    put_varint(buf, n);
+    put_bytes(buf, s, n);
+}
+
+inline const char* str_of(const char* s)        { return (s == nullptr) ? "(null)" : s; }
+inline const char* str_of(const std::string& s) { return s.c_str(); }
+template <typename T, CAPO_REQUIRE_(!std::is_convertible<T, const char*>::value && can_cast_str<T>::value)>
+inline const char* str_of(const T& s) { return str_of(static_cast<const char*>(s)); }
+
+template <uint8_t Tag> struct encoder;
+
+template <> struct encoder<t_sint>
+{
+    template <typename T> static void put(std::vector<char>& buf, const T& a)
+    { put_varint(buf, zigzag(static_cast<int64_t>(a))); }
+};
+
+template <> struct encoder<t_uint>
+{
+    template <typename T> static void put(std::vector<char>& buf, const T& a)
+    { put_varint(buf, static_cast<uint64_t>(a)); }
+};
+
+template <> struct encoder<t_char>
+{
+    template <typename T> static void put(std::vector<char>& buf, const T& a)
+    { buf.push_back(static_cast<char>(a)); }
+};
+
+template <> struct encoder<t_wchar>
+{
+    template <typename T> static void put(std::vector<char>& buf, const T& a)
+    { put_varint(buf, static_cast<uint64_t>(a)); }
+};
+
+template <> struct encoder<t_double>
+{
+    template <typename T> static void put(std::vector<char>& buf, const T& a)
+    { double v = static_cast<double>(a); put_bytes(buf, &v, sizeof(v)); }
+};
+
+/*
+    long double is stored as double, since its representation is not portable.
+*/
+template <> struct encoder<t_ldouble> : encoder<t_double> {};
+
+template <> struct encoder<t_str>
+{
+    template <typename T> static void put(std::vector<char>& buf, const T& a)
+    { const char* s = str_of(a); put_str(buf, s, std::strlen(s)); }
+    static void put(std::vector<char>& buf, const std::string& a)
+    { put_str(buf, a.data(), a.size()); }
+};
+
+template <> struct encoder<t_ptr>
+{
+    template <typename T> static void put(std::vector<char>& buf, const T& a)
+    { put_varint(buf, static_cast<uint64_t>(reinterpret_cast<uintptr_t>(a))); }
+};
+
+template <typename T>
+inline void encode(std::vector<char>& buf, const T& a)
+{
+    static_assert(tag_of<T>::value != t_none, "The type of argument is not supported by binlog.");
+    encoder<tag_of<T>::value>::put(buf, a);
+}
+
+/*
+    Strings are checked as const char*, since they are decoded into it.
+*/
+
+template <typename T, CAPO_REQUIRE_(tag_of<T>::value != t_str)>
+inline const T& checked(const T& a) { return a; }
+
+template <typename T, CAPO_REQUIRE_(tag_of<T>::value == t_str)>
+inline const char* checked(const T& a) { return str_of(a); }
+
+template <typename... A>
+struct signature
+{
+    static const uint8_t* tags(void)
+    {
+        static const uint8_t t[] = { tag_of<A>::value..., t_none };
+        return t;
+    }
+};
+
+} // namespace detail_binlog
+
+/*
+    A static format site, see CAPO_BINLOG_.
+*/
+
+struct binlog_site
+{
+    log_level             level_;
+    const char*           file_;
+    unsigned              line_;
+    const char*           fmt_   = nullptr;
+    const uint8_t*        tags_  = nullptr;
+    size_t                count_ = 0;
+    std::atomic<uint32_t> id_ { 0 };
+
+    binlog_site(log_level level, const char* file, unsigned line)
+        : level_(level), file_(file), line_(line)
+    {}
+};
+
+namespace detail_binlog {
+
+struct registry
+{
+    capo::spin_lock           lc_;
+    std::vector<binlog_site*> sites_;
+
+    static registry& instance(void)
+    {
+        static registry reg;
+        return reg;
+    }
+
+    /*
+        Registers a site at its first call, and checks its format only once.
+    */
+    template <typename... A>
+    static uint32_t enroll(binlog_site& site, const char* fmt, const A&... args)
+    {
+        uint32_t id = site.id_.load(std::memory_order_acquire);
+        if (id != 0) return id;
+        detail_printf_::check(fmt, checked(args)...);
+        registry& reg = instance();
+        std::lock_guard<capo::spin_lock> guard { reg.lc_ };
+        id = site.id_.load(std::memory_order_relaxed);
+        if (id != 0) return id;
+        site.fmt_   = fmt;
+        site.tags_  = signature<A...>::tags();
+        site.count_ = sizeof...(A);
+        reg.sites_.push_back(&site);
+        id = static_cast<uint32_t>(reg.sites_.size());
+        site.id_.store(id, std::memory_order_release);
+        return id;
+    }
+};
+
+} // namespace detail_binlog
+
+////////////////////////////////////////////////////////////////
+/// Binary log writer
+////////////////////////////////////////////////////////////////
+
+/*
+    The records are buffered in blocks, and a full block is written to the file.
+    flush() writes the pending blocks, close() (or the destructor) also writes the index.
+*/
+
+class binlog_writer : capo::noncopyable
+{
+    std::FILE*        fp_ = nullptr;
+    size_t            block_size_;
+    mutable std::mutex lc_;         // not a spin lock, since a full block is written to the file under it
+
+    std::vector<char> data_, sites_;
+    uint32_t          data_count_ = 0, sites_count_ = 0;
+    uint64_t          base_ts_ = 0, min_ts_ = 0, max_ts_ = 0;
+    std::vector<char> defined_;
+    std::vector<detail_binlog::index_entry> index_;
+    uint64_t          offset_ = 0;
+
+    static uint64_t now(void)
+    {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   std::chrono::system_clock::now().time_since_epoch()).count());
+    }
+
+    bool write_bytes(const void* p, size_t n)
+    {
+        if (std::fwrite(p, 1, n, fp_) != n) return false;
+        offset_ += n;
+        return true;
+    }
+
+    /*
+        A block is indexed only after it has been written entirely.
+        A failed write leaves the file broken (a partial block), so the file is closed,
+        and the writer becomes invalid.
+    */
+    bool write_block(uint32_t kind, std::vector<char>& payload, uint32_t& count, uint64_t min_ts, uint64_t max_ts)
+    {
+        if (count == 0) return true;
+        detail_binlog::block_head head { { 'C', 'B', 'L', 'K' }, kind,
+                                         static_cast<uint32_t>(payload.size()), count, min_ts, max_ts };
+        uint64_t offset = offset_;
+        if (!write_bytes(&head, sizeof(head)) ||
+            !write_bytes(payload.data(), payload.size()))
+        {
+            fail();
+            return false;
+        }
+        index_.push_back({ offset, min_ts, max_ts, kind });
+        payload.clear();
+        count = 0;
+        return true;
+    }
+
+    void fail(void)
+    {
+        std::fclose(fp_);
+        fp_ = nullptr;
+    }
+
+    void define(const binlog_site& site, uint32_t id)
+    {
+        if (defined_.size() <= id) defined_.resize(id + 1, 0);
+        if (defined_[id]) return;
+        defined_[id] = 1;
+        using namespace detail_binlog;
+        put_varint(sites_, id);
+        put_varint(sites_, static_cast<uint8_t>(site.level_));
+        put_varint(sites_, site.line_);
+        put_str   (sites_, reinterpret_cast<const char*>(site.tags_), site.count_);
+        put_str   (sites_, site.fmt_ , std::strlen(site.fmt_));
+        put_str   (sites_, site.file_, std::strlen(site.file_));
+        ++sites_count_;
+    }
+
+    bool flush_blocks(void)
+    {
+        // the site block goes first, so the sites are always defined before they are used
+        return write_block(detail_binlog::block_site, sites_, sites_count_, 0, 0) &&
+               write_block(detail_binlog::block_data, data_ , data_count_ , min_ts_, max_ts_);
+    }
+
+public:
+    explicit binlog_writer(const std::string& path, size_t block_size = 64 * 1024)
+        : block_size_(block_size)
+    {
+        fp_ = std::fopen(path.c_str(), "wb");
+        if (fp_ == nullptr) return;
+        if (!write_bytes(detail_binlog::file_magic, 8))
+        {
+            fail();
+            return;
+        }
+        data_.reserve(block_size_ + 256);
+    }
+
+    ~binlog_writer(void) { close(); }
+
+    bool valid(void) const
+    {
+        std::lock_guard<std::mutex> guard { lc_ };
+        return fp_ != nullptr;
+    }
+
+    template <typename... A>
+    void write(binlog_site& site, const char* fmt, const A&... args)
+    {
+        if (fmt == nullptr) return;
+        uint32_t id = detail_binlog::registry::enroll(site, fmt, args...);
+        uint64_t ts = now();
+        std::lock_guard<std::mutex> guard { lc_ };
+        // fp_ is checked under the lock, since a failed flush or close() may clear it
+        if (fp_ == nullptr) return;
+        define(site, id);
+        // the first record of a block has the full timestamp, the others have a delta
+        if (data_count_ == 0)
+        {
+            base_ts_ = min_ts_ = max_ts_ = ts;
+            detail_binlog::put_varint(data_, id);
+            detail_binlog::put_varint(data_, ts);
+        }
+        else
+        {
+            if (ts < min_ts_) min_ts_ = ts;
+            if (ts > max_ts_) max_ts_ = ts;
+            detail_binlog::put_varint(data_, id);
+            detail_binlog::put_varint(data_, detail_binlog::zigzag(static_cast<int64_t>(ts - base_ts_)));
+        }
+        int unused[] = { 0, (detail_binlog::encode(data_, args), 0)... };
+        static_cast<void>(unused);
+        ++data_count_;
+        if (data_.size() >= block_size_) flush_blocks();
+    }
+
+    /*
+        Returns false if the writer is (or becomes) invalid, the records could not be written.
+    */
+    bool flush(void)
+    {
+        std::lock_guard<std::mutex> guard { lc_ };
+        if (fp_ == nullptr) return false;
+        if (!flush_blocks()) return false;
+        if (std::fflush(fp_) == 0) return true;
+        fail();
+        return false;
+    }
+
+    bool close(void)
+    {
+        std::lock_guard<std::mutex> guard { lc_ };
+        if (fp_ == nullptr) return false;
+        if (!flush_blocks()) return false;
+        detail_binlog::trailer tail { offset_, index_.size(), {} };
+        std::memcpy(tail.magic_, detail_binlog::tail_magic, 8);
+        bool ok = (index_.empty() || write_bytes(index_.data(), index_.size() * sizeof(index_[0]))) &&
+                  write_bytes(&tail, sizeof(tail));
+        ok = (std::fclose(fp_) == 0) && ok;
+        fp_ = nullptr;
+        return ok;
+    }
+};
+
+/*
+    Records a binary log through a static site.
+    The arguments are not evaluated if the level is compiled out (see CAPO_LOG_LEVEL_).
+
+    <code>
+        CAPO_BINLOG_(writer, info, "%s: %d", name, value);
+    <code/>
+*/
+
+#define CAPO_BINLOG_(WRITER, LEVEL, ...)                                                              \
+    do                                                                                                \
+    {                                                                                                 \
+        if (static_cast<int>(capo::log_level::LEVEL) >= CAPO_LOG_LEVEL_)                              \
+        {                                                                                             \
+            static capo::binlog_site capo_binlog_site__ { capo::log_level::LEVEL, __FILE__, __LINE__ }; \
+            (WRITER).write(capo_binlog_site__, __VA_ARGS__);                                          \
+        }                                                                                             \
+    } while(false)
+
+////////////////////////////////////////////////////////////////
+/// Binary log reader (the offline decoder)
+////////////////////////////////////////////////////////////////
+
+struct binlog_entry
+{
+    uint64_t    time_;  // nanoseconds since epoch
+    log_level   level_;
+    const char* file_;
+    unsigned    line_;
+    std::string text_;
+};
+
+class binlog_reader : capo::noncopyable
+{
+    struct site_info
+    {
+        log_level   level_ = log_level::info;
+        unsigned    line_  = 0;
+        std::string tags_, fmt_, file_;
+        bool        valid_ = false;
+    };
+
+    struct cursor
+    {
+        const char* cur_;
+        const char* end_;
+        bool        bad_ = false;
+
+        uint64_t varint(void)
+        {
+            uint64_t v = 0;
+            for (unsigned s = 0; s < 64; s += 7)
+            {
+                if (cur_ >= end_) break;
+                uint8_t b = static_cast<uint8_t>(*cur_++);
+                v |= static_cast<uint64_t>(b & 0x7f) << s;
+                if ((b & 0x80) == 0) return v;
+            }
+            bad_ = true;
+            return 0;
+        }
+
+        const char* bytes(size_t n)
+        {
+            if (static_cast<size_t>(end_ - cur_) < n) { bad_ = true; cur_ = end_; return nullptr; }
+            const char* p = cur_;
+            cur_ += n;
+            return p;
+        }
+
+        std::string str(void)
+        {
+            size_t n = static_cast<size_t>(varint());
+            const char* p = bytes(n);
+            return (p == nullptr) ? std::string{} : std::string(p, n);
+        }
+    };
+
+    std::FILE*                              fp_ = nullptr;
+    bool                                    indexed_ = false;
+    std::vector<detail_binlog::index_entry> index_;
+    std::vector<site_info>                  sites_;
+    std::vector<char>                       payload_;
+    std::string                             tmp_;
+
+    bool read_at(uint64_t off, void* p, size_t n)
+    {
+        if (std::fseek(fp_, static_cast<long>(off), SEEK_SET) != 0) return false;
+        return std::fread(p, 1, n, fp_) == n;
+    }
+
+    bool read_trailer(void)
+    {
+        if (std::fseek(fp_, 0, SEEK_END) != 0) return false;
+        long size = std::ftell(fp_);
+        if (size < static_cast<long>(8 + sizeof(detail_binlog::trailer))) return false;
+        detail_binlog::trailer tail;
+        if (!read_at(static_cast<uint64_t>(size) - sizeof(tail), &tail, sizeof(tail))) return false;
+        if (std::memcmp(tail.magic_, detail_binlog::tail_magic, 8) != 0) return false;
+        if (tail.offset_ + tail.count_ * sizeof(detail_binlog::index_entry) + sizeof(tail) != static_cast<uint64_t>(size))
+            return false;
+        index_.resize(static_cast<size_t>(tail.count_));
+        return index_.empty() || read_at(tail.offset_, index_.data(), index_.size() * sizeof(index_[0]));
+    }
+
+    /*
+        Rebuilds the index from the block heads.
+    */
+    void scan_blocks(void)
+    {
+        index_.clear();
+        uint64_t off = 8;
+        detail_binlog::block_head head;
+        while (read_at(off, &head, sizeof(head)) && std::memcmp(head.magic_, "CBLK", 4) == 0)
+        {
+            index_.push_back({ off, head.min_ts_, head.max_ts_, head.kind_ });
+            off += sizeof(head) + head.size_;
+        }
+    }
+
+    bool load_block(const detail_binlog::index_entry& ie, detail_binlog::block_head& head)
+    {
+        if (!read_at(ie.offset_, &head, sizeof(head))) return false;
+        if (std::memcmp(head.magic_, "CBLK", 4) != 0) return false;
+        payload_.resize(head.size_);
+        return payload_.empty() || (std::fread(payload_.data(), 1, payload_.size(), fp_) == payload_.size());
+    }
+
+    void load_sites(void)
+    {
+        detail_binlog::block_head head;
+        for (auto& ie : index_)
+        {
+            if (ie.kind_ != detail_binlog::block_site || !load_block(ie, head)) continue;
+            cursor cs { payload_.data(), payload_.data() + payload_.size() };
+            for (uint32_t i = 0; i < head.count_ && !cs.bad_; ++i)
+            {
+                size_t id = static_cast<size_t>(cs.varint());
+                if (sites_.size() <= id) sites_.resize(id + 1);
+                site_info& si = sites_[id];
+                si.level_ = static_cast<log_level>(cs.varint());
+                si.line_  = static_cast<unsigned>(cs.varint());
+                si.tags_  = cs.str();
+                si.fmt_   = cs.str();
+                si.file_  = cs.str();
+                si.valid_ = !cs.bad_;
+            }
+        }
+    }
+
+    /*
+        Formats the arguments with the format of the site, and moves the cursor to the next record.
+    */
+    bool decode(cursor& cs, const site_info& si, std::string& out)
+    {
+        using namespace detail_binlog;
+        out.clear();
+        const char* fmt = si.fmt_.c_str();
+        for (char c : si.tags_)
+        {
+            const char* s = detail_format::write_text(out, fmt);
+            detail_format::spec sp;
+            bool ok = (s != nullptr) && detail_format::parse(s, sp);
+            switch (static_cast<uint8_t>(c))
+            {
+            case t_sint:
+                { long long v = unzigzag(cs.varint()); if (ok) detail_format::write_arg(out, sp, v); }
+                break;
+            case t_uint:
+                { unsigned long long v = cs.varint(); if (ok) detail_format::write_arg(out, sp, v); }
+                break;
+            case t_char:
+                { const char* p = cs.bytes(1); char v = p ? *p : '\0'; if (ok) detail_format::write_arg(out, sp, v); }
+                break;
+            case t_wchar:
+                { wchar_t v = static_cast<wchar_t>(cs.varint()); if (ok) detail_format::write_arg(out, sp, v); }
+                break;
+            case t_double:
+            case t_ldouble:
+                {
+                    double v = 0;
+                    const char* p = cs.bytes(sizeof(v));
+                    if (p != nullptr) std::memcpy(&v, p, sizeof(v));
+                    if (!ok) break;
+                    if (static_cast<uint8_t>(c) == t_double)
+                         detail_format::write_arg(out, sp, v);
+                    else detail_format::write_arg(out, sp, static_cast<long double>(v));
+                }
+                break;
+            case t_str:
+                { tmp_ = cs.str(); if (ok) detail_format::write_arg(out, sp, tmp_.c_str()); }
+                break;
+            case t_ptr:
+                {
+                    auto v = reinterpret_cast<const void*>(static_cast<uintptr_t>(cs.varint()));
+                    if (ok) detail_format::write_arg(out, sp, v);
+                }
+                break;
+            default:
+                cs.bad_ = true;
+            }
+            if (cs.bad_) return false;
+            if (!ok) return false;
+            fmt = sp.end_;
+        }
+        detail_format::write_text(out, fmt);
+        return true;
+    }
+
+public:
+    explicit binlog_reader(const std::string& path)
+    {
+        fp_ = std::fopen(path.c_str(), "rb");
+        if (fp_ == nullptr) return;
+        char magic[8];
+        if (!read_at(0, magic, 8) || std::memcmp(magic, detail_binlog::file_magic, 8) != 0)
+        {
+            std::fclose(fp_);
+            fp_ = nullptr;
+            return;
+        }
+        indexed_ = read_trailer();
+        if (!indexed_) scan_blocks();
+        load_sites();
+    }
+
+    ~binlog_reader(void)
+    {
+        if (fp_ != nullptr) std::fclose(fp_);
+    }
+
+    bool   valid  (void) const { return fp_ != nullptr; }
+    bool   indexed(void) const { return indexed_; } // false if the writer was not closed
+    size_t blocks (void) const { return index_.size(); }
+
+    /*
+        Calls f(const binlog_entry&) for each record in [from, to].
+        Only the blocks overlapping the range are read.
+        Returns the number of records passed to f.
+    */
+    template <typename F>
+    size_t read(F&& f, uint64_t from = 0, uint64_t to = (std::numeric_limits<uint64_t>::max)())
+    {
+        if (fp_ == nullptr) return 0;
+        size_t n = 0;
+        binlog_entry ent;
+        detail_binlog::block_head head;
+        for (auto& ie : index_)
+        {
+            if (ie.kind_ != detail_binlog::block_data) continue;
+            if (ie.max_ts_ < from || ie.min_ts_ > to) continue;
+            if (!load_block(ie, head)) continue;
+            cursor cs { payload_.data(), payload_.data() + payload_.size() };
+            uint64_t base = 0;
+            for (uint32_t i = 0; i < head.count_ && !cs.bad_; ++i)
+            {
+                size_t   id = static_cast<size_t>(cs.varint());
+                uint64_t ts = cs.varint();
+                if (i == 0) base = ts;
+                else ts = base + static_cast<uint64_t>(detail_binlog::unzigzag(ts));
+                if (id >= sites_.size() || !sites_[id].valid_) break;
+                const site_info& si = sites_[id];
+                if (!decode(cs, si, ent.text_)) break;
+                if (ts < from || ts > to) continue;
+                ent.time_  = ts;
+                ent.level_ = si.level_;
+                ent.file_  = si.file_.c_str();
+                ent.line_  = si.line_;
+                f(static_cast<const binlog_entry&>(ent));
+                ++n;
+            }
+        }
+        return n;
+    }
+};
+
+} // namespace capo
@@ -0,0 +1,246 @@
+/*
+    The Capo Library
+    Code covered by the MIT License
+
+    Author: mutouyun (http://orzz.org)
+*/
+
+#pragma once
+
+#include "capo/detect_plat.hpp"
+
+#include <chrono>       // std::chrono
+#include <thread>       // std::this_thread
+#include <ratio>        // std::nano
+#include <cstdint>      // uint64_t, int64_t
+
+#if defined(CAPO_OS_WIN_)
+#include <windows.h>    // GetTickCount64, GetThreadTimes, GetProcessTimes
+#else /*!CAPO_OS_WIN_*/
+#include <time.h>       // clock_gettime
+#endif/*!CAPO_OS_WIN_*/
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#   include <intrin.h>      // __rdtsc, __rdtscp, __cpuid, _mm_lfence
+#   define CAPO_CLOCK_TSC_
+#elif defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#   include <x86intrin.h>   // __rdtsc, __rdtscp, _mm_lfence
+#   include <cpuid.h>       // __get_cpuid
+#   define CAPO_CLOCK_TSC_
+#endif
+
+/*
+    How long the tsc_clock calibration (against std::chrono::steady_clock) takes.
+*/
+
+#ifndef CAPO_CLOCK_TSC_CALIBRATION_MS_
+#define CAPO_CLOCK_TSC_CALIBRATION_MS_ 10
+#endif/*CAPO_CLOCK_TSC_CALIBRATION_MS_*/
+
+namespace capo {
+
+////////////////////////////////////////////////////////////////
+/// Clock policies for stopwatch, all of them meet the requirements of Clock
+////////////////////////////////////////////////////////////////
+
+namespace use {
+
+/*
+    The ways of reading the time-stamp counter:
+    tsc_relaxed - rdtsc, may be reordered with the surrounding instructions
+    tsc_lfence  - lfence + rdtsc, waits for all earlier instructions to complete
+    tsc_rdtscp  - rdtscp, waits for all earlier instructions to complete
+*/
+
+struct tsc_relaxed {};
+struct tsc_lfence  {};
+struct tsc_rdtscp  {};
+
+} // namespace use
+
+namespace detail_clock {
+
+#if defined(CAPO_CLOCK_TSC_)
+inline uint64_t read_tsc(use::tsc_relaxed) { return __rdtsc(); }
+inline uint64_t read_tsc(use::tsc_lfence)  { _mm_lfence(); return __rdtsc(); }
+inline uint64_t read_tsc(use::tsc_rdtscp)  { unsigned aux; return __rdtscp(&aux); }
+
+inline bool tsc_invariant(void)
+{
+    unsigned r[4] = {};
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0x80000000);
+    if (static_cast<unsigned>(info[0]) < 0x80000007) return false;
+    __cpuid(info, 0x80000007);
+    r[3] = static_cast<unsigned>(info[3]);
+#else /*!_MSC_VER*/
+    if (!__get_cpuid(0x80000007, &r[0], &r[1], &r[2], &r[3])) return false;
+#endif/*!_MSC_VER*/
+    return (r[3] & (1u << 8)) != 0; // CPUID.80000007H:EDX[8], Invariant TSC
+}
+#else /*!CAPO_CLOCK_TSC_*/
+/*
+    There is no time-stamp counter, so the ticks are steady_clock nanoseconds.
+*/
+template <typename OrderT>
+inline uint64_t read_tsc(OrderT)
+{
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                 std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+inline bool tsc_invariant(void) { return false; }
+#endif/*!CAPO_CLOCK_TSC_*/
+
+/*
+    Measures the ticks per nanosecond once, at the first use of tsc_clock.
+*/
+struct tsc_calibration
+{
+    uint64_t base_;
+    double   ns_per_tick_;
+
+    tsc_calibration(void)
+    {
+        using namespace std::chrono;
+        auto     t0 = steady_clock::now();
+        uint64_t c0 = read_tsc(use::tsc_rdtscp{});
+        std::this_thread::sleep_for(milliseconds(CAPO_CLOCK_TSC_CALIBRATION_MS_));
+        auto     t1 = steady_clock::now();
+        uint64_t c1 = read_tsc(use::tsc_rdtscp{});
+        auto ns = duration_cast<nanoseconds>(t1 - t0).count();
+        base_        = c0;
+        ns_per_tick_ = (c1 > c0) ? (static_cast<double>(ns) / static_cast<double>(c1 - c0)) : 1.0;
+    }
+
+    static const tsc_calibration& instance(void)
+    {
+        static tsc_calibration cal;
+        return cal;
+    }
+};
+
+#if defined(CAPO_OS_WIN_)
+inline int64_t filetime_ns(const FILETIME& ft)
+{
+    return static_cast<int64_t>((static_cast<uint64_t>(ft.dwHighDateTime) << 32) | ft.dwLowDateTime) * 100;
+}
+#else /*!CAPO_OS_WIN_*/
+inline int64_t clock_ns(clockid_t id)
+{
+    timespec ts;
+    ::clock_gettime(id, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+#endif/*!CAPO_OS_WIN_*/
+
+template <typename ClockT>
+struct nano_clock
+{
+    using rep        = int64_t;
+    using period     = std::nano;
+    using duration   = std::chrono::duration<rep, period>;
+    using time_point = std::chrono::time_point<ClockT, duration>;
+
+    static constexpr bool is_steady = true;
+};
+
+template <typename ClockT>
+constexpr bool nano_clock<ClockT>::is_steady;
+
+} // namespace detail_clock
+
+/*
+    Invariant time-stamp counter, converted to nanoseconds with a startup calibration.
+    The epoch is the moment of the calibration.
+*/
+
+template <typename OrderT = use::tsc_relaxed>
+struct tsc_clock : detail_clock::nano_clock<tsc_clock<OrderT>>
+{
+    using typename detail_clock::nano_clock<tsc_clock>::rep;
+    using typename detail_clock::nano_clock<tsc_clock>::duration;
+    using typename detail_clock::nano_clock<tsc_clock>::time_point;
+
+    static uint64_t ticks(void)
+    {
+        return detail_clock::read_tsc(OrderT{});
+    }
+
+    /* Whether the counter runs at a constant rate across P-/C-states */
+    static bool invariant(void)
+    {
+        static const bool inv = detail_clock::tsc_invariant();
+        return inv;
+    }
+
+    /* Ticks per second */
+    static double frequency(void)
+    {
+        return 1e9 / detail_clock::tsc_calibration::instance().ns_per_tick_;
+    }
+
+    static time_point now(void)
+    {
+        auto& cal = detail_clock::tsc_calibration::instance();
+        auto  t   = static_cast<int64_t>(ticks() - cal.base_);
+        return time_point(duration(static_cast<rep>(static_cast<double>(t) * cal.ns_per_tick_)));
+    }
+};
+
+/*
+    Cheap monotonic timestamps, the resolution is only a few milliseconds.
+*/
+
+struct coarse_clock : detail_clock::nano_clock<coarse_clock>
+{
+    static time_point now(void)
+    {
+#if defined(CAPO_OS_WIN_)
+        return time_point(duration(static_cast<rep>(::GetTickCount64()) * 1000000));
+#elif defined(CLOCK_MONOTONIC_COARSE)
+        return time_point(duration(detail_clock::clock_ns(CLOCK_MONOTONIC_COARSE)));
+#else
+        return time_point(duration(detail_clock::clock_ns(CLOCK_MONOTONIC)));
+#endif
+    }
+};
+
+/*
+    The CPU time consumed by the calling thread.
+*/
+
+struct thread_cpu_clock : detail_clock::nano_clock<thread_cpu_clock>
+{
+    static time_point now(void)
+    {
+#if defined(CAPO_OS_WIN_)
+        FILETIME c, e, k, u;
+        ::GetThreadTimes(::GetCurrentThread(), &c, &e, &k, &u);
+        return time_point(duration(detail_clock::filetime_ns(k) + detail_clock::filetime_ns(u)));
+#else /*!CAPO_OS_WIN_*/
+        return time_point(duration(detail_clock::clock_ns(CLOCK_THREAD_CPUTIME_ID)));
+#endif/*!CAPO_OS_WIN_*/
+    }
+};
+
+/*
+    The CPU time consumed by all threads of the process.
+*/
+
+struct process_cpu_clock : detail_clock::nano_clock<process_cpu_clock>
+{
+    static time_point now(void)
+    {
+#if defined(CAPO_OS_WIN_)
+        FILETIME c, e, k, u;
+        ::GetProcessTimes(::GetCurrentProcess(), &c, &e, &k, &u);
+        return time_point(duration(detail_clock::filetime_ns(k) + detail_clock::filetime_ns(u)));
+#else /*!CAPO_OS_WIN_*/
+        return time_point(duration(detail_clock::clock_ns(CLOCK_PROCESS_CPUTIME_ID)));
+#endif/*!CAPO_OS_WIN_*/
+    }
+};
+
+} // namespace capo
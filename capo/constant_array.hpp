@@ -9,7 +9,12 @@
 
 #include "capo/type_list.hpp"
 
-#include <type_traits> // std::integral_constant
+#include <type_traits> // std::integral_constant, std::decay_t
+#include <array>       // std::array
+#include <utility>     // std::index_sequence, std::make_index_sequence
+#include <functional>  // std::less, std::greater
+#include <stdexcept>   // std::invalid_argument
+#include <cstddef>     // size_t
 
 namespace capo {
 
@@ -27,6 +32,17 @@ class constant_array
     struct type_list_<std::integral_constant<T, N>...>
     {
         static const T value[sizeof...(N)];
+
+        static constexpr std::array<T, sizeof...(N)> array(void) { return {{ N... }}; }
+    };
+
+    template <typename S, size_t N, const std::array<T, N>& A>
+    struct from_array_;
+
+    template <size_t... I, size_t N, const std::array<T, N>& A>
+    struct from_array_<std::index_sequence<I...>, N, A>
+    {
+        using type = type_list_<std::integral_constant<T, A[I]>...>;
     };
 
     template <template <T> class Do_>
@@ -55,6 +71,19 @@ public:
     template <T... N>
     using type = type_list_<std::integral_constant<T, N>...>;
 
+    /*
+        Converts between the constant arrays & the constexpr std::array,
+        A should have a static storage duration, e.g.
+        static constexpr std::array<int, 3> arr {{ 3, 1, 2 }};
+        using sorted = constant_array<int>::from_array<3, arr>;
+    */
+
+    template <size_t N, const std::array<T, N>& A>
+    using from_array = typename from_array_<std::make_index_sequence<N>, N, A>::type;
+
+    template <typename Arr>
+    static constexpr auto to_array(void) { return Arr::array(); }
+
     template <typename Arr>
     using size = types_size<Arr>;
 
@@ -118,6 +147,241 @@ template <typename T>
 template <T... N>
 const T constant_array<T>::type_list_<std::integral_constant<T, N>...>::value[sizeof...(N)] = { N... };
 
+////////////////////////////////////////////////////////////////
+/// Constexpr algorithms of std::array
+////////////////////////////////////////////////////////////////
+
+/*
+    The constexpr versions of the constant_array algorithms, on the values instead of the types.
+    They are much cheaper to compile, and the results could be used as the tables in .rodata:
+
+    constexpr int square(size_t i) { return static_cast<int>(i * i); }
+    static constexpr auto squares = capo::make_array<16>(square);
+
+    The functors should be callable in the constant expressions,
+    e.g. the constexpr functions (the lambdas are not constexpr before C++17).
+*/
+
+namespace detail_constant_array {
+
+/* The operator[] of std::array is not constexpr for modifying before C++17 */
+
+template <typename T, size_t N>
+struct buffer
+{
+    T data_[(N > 0) ? N : 1] {};
+
+    constexpr T&       operator[](size_t i)       { return data_[i]; }
+    constexpr const T& operator[](size_t i) const { return data_[i]; }
+};
+
+template <typename T, size_t N, size_t... I>
+constexpr std::array<T, N> to_array(const buffer<T, N>& buf, std::index_sequence<I...>)
+{
+    return {{ buf[I]... }};
+}
+
+template <typename T, size_t N>
+constexpr std::array<T, N> to_array(const buffer<T, N>& buf)
+{
+    return to_array(buf, std::make_index_sequence<N> {});
+}
+
+template <typename F, size_t... I>
+constexpr auto make_array(F f, std::index_sequence<I...>)
+{
+    return std::array<std::decay_t<decltype(f(size_t {}))>, sizeof...(I)> {{ f(I)... }};
+}
+
+} // namespace detail_constant_array
+
+/* { f(0), f(1), ..., f(N - 1) } */
+
+template <size_t N, typename F>
+constexpr auto make_array(F f)
+{
+    return detail_constant_array::make_array(f, std::make_index_sequence<N> {});
+}
+
+template <size_t N, typename T>
+constexpr std::array<T, N> array_assign(const T& v)
+{
+    detail_constant_array::buffer<T, N> r {};
+    for (size_t i = 0; i < N; ++i) r[i] = v;
+    return detail_constant_array::to_array(r);
+}
+
+template <typename T, size_t N1, size_t N2>
+constexpr std::array<T, N1 + N2> array_link(const std::array<T, N1>& a1, const std::array<T, N2>& a2)
+{
+    detail_constant_array::buffer<T, N1 + N2> r {};
+    for (size_t i = 0; i < N1; ++i) r[i]      = a1[i];
+    for (size_t i = 0; i < N2; ++i) r[N1 + i] = a2[i];
+    return detail_constant_array::to_array(r);
+}
+
+template <size_t IndexN, typename T, size_t N>
+constexpr std::array<T, N + 1> array_insert(const std::array<T, N>& a, const T& v)
+{
+    static_assert(IndexN <= N, "Index is out of range!");
+    detail_constant_array::buffer<T, N + 1> r {};
+    for (size_t i = 0; i < IndexN; ++i) r[i]     = a[i];
+    r[IndexN] = v;
+    for (size_t i = IndexN; i < N; ++i) r[i + 1] = a[i];
+    return detail_constant_array::to_array(r);
+}
+
+template <size_t IndexN, size_t CountN = 1, typename T, size_t N>
+constexpr std::array<T, N - CountN> array_erase(const std::array<T, N>& a)
+{
+    static_assert((IndexN < N) && (CountN <= N - IndexN), "Index is out of range!");
+    detail_constant_array::buffer<T, N - CountN> r {};
+    for (size_t i = 0; i < IndexN; ++i)               r[i]          = a[i];
+    for (size_t i = IndexN + CountN; i < N; ++i)      r[i - CountN] = a[i];
+    return detail_constant_array::to_array(r);
+}
+
+/* The index of the first v, or -1 */
+
+template <typename T, size_t N>
+constexpr int array_find(const std::array<T, N>& a, const T& v)
+{
+    for (size_t i = 0; i < N; ++i)
+        if (a[i] == v) return static_cast<int>(i);
+    return -1;
+}
+
+template <typename T, size_t N>
+constexpr bool array_exist(const std::array<T, N>& a, const T& v)
+{
+    return array_find(a, v) != -1;
+}
+
+template <typename T, size_t N>
+constexpr size_t array_count(const std::array<T, N>& a, const T& v)
+{
+    size_t n = 0;
+    for (size_t i = 0; i < N; ++i)
+        if (a[i] == v) ++n;
+    return n;
+}
+
+/* The count of the distinct values */
+
+template <typename T, size_t N>
+constexpr size_t array_distinct(const std::array<T, N>& a)
+{
+    size_t n = 0;
+    for (size_t i = 0; i < N; ++i)
+    {
+        size_t j = 0;
+        while ((j < i) && !(a[j] == a[i])) ++j;
+        if (j == i) ++n;
+    }
+    return n;
+}
+
+template <typename T, size_t N, typename F>
+constexpr auto array_foreach(const std::array<T, N>& a, F f)
+{
+    detail_constant_array::buffer<std::decay_t<decltype(f(a[0]))>, N> r {};
+    for (size_t i = 0; i < N; ++i) r[i] = f(a[i]);
+    return detail_constant_array::to_array(r);
+}
+
+template <typename T, size_t N>
+constexpr std::array<T, N> array_replace(const std::array<T, N>& a, const T& v1, const T& v2)
+{
+    detail_constant_array::buffer<T, N> r {};
+    for (size_t i = 0; i < N; ++i) r[i] = (a[i] == v1) ? v2 : a[i];
+    return detail_constant_array::to_array(r);
+}
+
+/*
+    The size of the result depends on the values, so it should be given,
+    e.g. array_remove<N - array_count(a, v)>(a, v)
+*/
+
+template <size_t M, typename T, size_t N>
+constexpr std::array<T, M> array_remove(const std::array<T, N>& a, const T& v)
+{
+    detail_constant_array::buffer<T, M> r {};
+    size_t n = 0;
+    for (size_t i = 0; i < N; ++i)
+    {
+        if (a[i] == v) continue;
+        if (n == M) throw std::invalid_argument("array_remove: the result is larger than M");
+        r[n++] = a[i];
+    }
+    return (n == M) ? detail_constant_array::to_array(r)
+                    : throw std::invalid_argument("array_remove: the result is smaller than M");
+}
+
+/* Keeps the first one of the same values, e.g. array_compact<array_distinct(a)>(a) */
+
+template <size_t M, typename T, size_t N>
+constexpr std::array<T, M> array_compact(const std::array<T, N>& a)
+{
+    detail_constant_array::buffer<T, M> r {};
+    size_t n = 0;
+    for (size_t i = 0; i < N; ++i)
+    {
+        size_t j = 0;
+        while ((j < n) && !(r[j] == a[i])) ++j;
+        if (j < n) continue;
+        if (n == M) throw std::invalid_argument("array_compact: the result is larger than M");
+        r[n++] = a[i];
+    }
+    return (n == M) ? detail_constant_array::to_array(r)
+                    : throw std::invalid_argument("array_compact: the result is smaller than M");
+}
+
+template <typename T, size_t N>
+constexpr std::array<T, N> array_reverse(const std::array<T, N>& a)
+{
+    detail_constant_array::buffer<T, N> r {};
+    for (size_t i = 0; i < N; ++i) r[i] = a[N - 1 - i];
+    return detail_constant_array::to_array(r);
+}
+
+/* A stable bottom-up merge sort, If_(x, y) is true if x should be placed before y */
+
+template <typename T, size_t N, typename F>
+constexpr std::array<T, N> array_sort_if(const std::array<T, N>& a, F if_)
+{
+    detail_constant_array::buffer<T, N> x {}, y {};
+    for (size_t i = 0; i < N; ++i) x[i] = a[i];
+    auto* src = &x;
+    auto* dst = &y;
+    for (size_t w = 1; w < N; w *= 2)
+    {
+        for (size_t lo = 0; lo < N; lo += w * 2)
+        {
+            size_t mid = (lo + w     < N) ? lo + w     : N;
+            size_t hi  = (lo + w * 2 < N) ? lo + w * 2 : N;
+            size_t i = lo, j = mid, k = lo;
+            while ((i < mid) && (j < hi))
+                (*dst)[k++] = if_((*src)[j], (*src)[i]) ? (*src)[j++] : (*src)[i++];
+            while (i < mid) (*dst)[k++] = (*src)[i++];
+            while (j < hi ) (*dst)[k++] = (*src)[j++];
+        }
+        auto* t = src; src = dst; dst = t;
+    }
+    return detail_constant_array::to_array(*src);
+}
+
+template <typename T, size_t N>
+constexpr std::array<T, N> array_sort_less(const std::array<T, N>& a)
+{
+    return array_sort_if(a, std::less<T> {});
+}
+
+template <typename T, size_t N>
+constexpr std::array<T, N> array_sort_greater(const std::array<T, N>& a)
+{
+    return array_sort_if(a, std::greater<T> {});
+}
+
 ////////////////////////////////////////////////////////////////
 
 } // namespace capo
@@ -0,0 +1,115 @@
+/*
+    The Capo Library
+    Code covered by the MIT License
+
+    Author: mutouyun (http://orzz.org)
+*/
+
+#pragma once
+
+#include "capo/type_list.hpp"
+#include "capo/types_to_seq.hpp"
+#include "capo/type_traits.hpp"
+
+#include <utility>      // std::forward, std::declval
+#include <cstddef>      // size_t
+
+namespace capo {
+
+////////////////////////////////////////////////////////////////
+/// Dispatch a runtime index to a type of the type-list
+////////////////////////////////////////////////////////////////
+
+/*
+    capo::dispatch<capo::types<int, double, std::string>>(index, [](auto tag, auto&&... args)
+    {
+        using T = typename decltype(tag)::type;
+        ...
+    }, args...);
+
+    The visitor is called through a constexpr table of function pointers,
+    which is one indirect call without any bounds checking,
+    so the index must be less than the size of the type-list.
+    All the calls should return the same type (or the types convertible to the first one).
+*/
+
+namespace detail_dispatch {
+
+template <typename R, typename F, typename... A>
+using entry_t = R(*)(F&&, A&&...);
+
+template <typename T, typename R, typename F, typename... A>
+R call1(F&& f, A&&... args)
+{
+    return std::forward<F>(f)(type_tag<T>{}, std::forward<A>(args)...);
+}
+
+template <typename T1, typename T2, typename R, typename F, typename... A>
+R call2(F&& f, A&&... args)
+{
+    return std::forward<F>(f)(type_tag<T1>{}, type_tag<T2>{}, std::forward<A>(args)...);
+}
+
+template <typename TypesT, typename R, typename F, typename... A>
+struct table;
+
+template <typename... T, template <typename...> class TypesT, typename R, typename F, typename... A>
+struct table<TypesT<T...>, R, F, A...>
+{
+    static constexpr entry_t<R, F, A...> value[] = { &call1<T, R, F, A...>... };
+};
+
+template <typename... T, template <typename...> class TypesT, typename R, typename F, typename... A>
+constexpr entry_t<R, F, A...> table<TypesT<T...>, R, F, A...>::value[];
+
+/* The entries are in row-major order, (i, j) is at i * types_size<T2> + j */
+
+template <typename TypesT1, typename TypesT2, typename SeqT, typename R, typename F, typename... A>
+struct table2;
+
+template <typename TypesT1, typename TypesT2, int... K, typename R, typename F, typename... A>
+struct table2<TypesT1, TypesT2, constant_seq<K...>, R, F, A...>
+{
+    enum : int { cols = types_size<TypesT2>::value };
+
+    static constexpr entry_t<R, F, A...> value[] =
+    {
+        &call2<types_at_t<TypesT1, K / cols>, types_at_t<TypesT2, K % cols>, R, F, A...>...
+    };
+};
+
+template <typename TypesT1, typename TypesT2, int... K, typename R, typename F, typename... A>
+constexpr entry_t<R, F, A...> table2<TypesT1, TypesT2, constant_seq<K...>, R, F, A...>::value[];
+
+} // namespace detail_dispatch
+
+template <typename TypesT, typename F, typename... A>
+decltype(auto) dispatch(size_t index, F&& visitor, A&&... args)
+{
+    static_assert(types_size<TypesT>::value > 0, "The type-list of dispatch should not be empty.");
+    using r_t = decltype(std::declval<F>()(type_tag<types_front_t<TypesT>>{}, std::declval<A>()...));
+    return detail_dispatch::table<TypesT, r_t, F, A...>::value[index]
+                                 (std::forward<F>(visitor), std::forward<A>(args)...);
+}
+
+/*
+    The multi-dispatch of two type-lists, with a table of all the combinations:
+
+    capo::multi_dispatch<shapes, shapes>(i, j, [](auto tag1, auto tag2) { ... });
+*/
+
+template <typename TypesT1, typename TypesT2, typename F, typename... A>
+decltype(auto) multi_dispatch(size_t index1, size_t index2, F&& visitor, A&&... args)
+{
+    static_assert((types_size<TypesT1>::value > 0) && (types_size<TypesT2>::value > 0),
+                  "The type-lists of multi_dispatch should not be empty.");
+    using r_t = decltype(std::declval<F>()(type_tag<types_front_t<TypesT1>>{},
+                                           type_tag<types_front_t<TypesT2>>{}, std::declval<A>()...));
+    using seq_t = size_to_seq<types_size<TypesT1>::value * types_size<TypesT2>::value>;
+    return detail_dispatch::table2<TypesT1, TypesT2, seq_t, r_t, F, A...>::value[index1 * types_size<TypesT2>::value + index2]
+                                  (std::forward<F>(visitor), std::forward<A>(args)...);
+}
+
+////////////////////////////////////////////////////////////////
+
+} // namespace capo
@@ -65,7 +65,12 @@ struct file : capo::noncopyable
     virtual bool close(void) = 0;
     virtual bool clear(void) = 0;
     virtual file::size_type read(buf_type* buff) = 0;
-    virtual file::size_type write(const buf_type& buff) = 0;
+    virtual file::size_type write(const void* data, file::size_type size) = 0;
+
+    virtual file::size_type write(const buf_type& buff)
+    {
+        return write(buff.data(), static_cast<file::size_type>(buff.size()));
+    }
 
     virtual bool seek(file::off_type off, std::ios_base::seekdir way = std::ios_base::cur) = 0;
     virtual file::off_type  tell(void) = 0;
@@ -84,7 +89,7 @@ struct file : capo::noncopyable
         if (!seek(0, std::ios_base::beg)) return;
         buf_type buff(2 << 10); // 1024 bytes
         while (read(&buff) != 0)
-            if (rhs.write(buff) != buff.size())
+            if (rhs.write(buff) != static_cast<file::size_type>(buff.size()))
                 break;
     }
 };
@@ -171,10 +176,14 @@ public:
         return std::fread(buff->data(), sizeof(buf_type::value_type), buff->size(), file_);
     }
     file::size_type write(const buf_type& buff)
+    {
+        return write(buff.data(), buff.size());
+    }
+    file::size_type write(const void* data, file::size_type n)
     {
         if (file_ == nullptr) return 0;
-        if (buff.empty()) return 0;
-        return std::fwrite(buff.data(), sizeof(buf_type::value_type), buff.size(), file_);
+        if (data == nullptr || n <= 0) return 0;
+        return std::fwrite(data, sizeof(buf_type::value_type), (std::size_t)n, file_);
     }
 
     bool seek(file::off_type off, std::ios_base::seekdir way = std::ios_base::cur)
@@ -284,17 +293,21 @@ public:
         return s;
     }
     file::size_type write(const buf_type& buff)
+    {
+        return write(buff.data(), buff.size());
+    }
+    file::size_type write(const void* data, file::size_type n)
     {
         if (error()) return 0;
-        if (buff.empty()) return 0;
+        if (data == nullptr || n <= 0) return 0;
         file::off_type t = tell();
         if (t == file::OutOfRange) return 0;
-        std::size_t s = (std::size_t)size(), sr = (std::size_t)(t + buff.size());
+        std::size_t s = (std::size_t)size(), sr = (std::size_t)(t + n);
         if (s < sr) buff_.resize(sr);
         position_ = std::next(buff_.begin(), (long)t); // relocate
-        std::memcpy(&(*position_), buff.data(), buff.size());
-        std::advance(position_, buff.size());
-        return buff.size();
+        std::memcpy(&(*position_), data, (std::size_t)n);
+        std::advance(position_, n);
+        return n;
     }
 
     bool seek(file::off_type off, std::ios_base::seekdir way = std::ios_base::cur)
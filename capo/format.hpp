@@ -0,0 +1,1178 @@
+/*
+    The Capo Library
+    Code covered by the MIT License
+
+    Author: mutouyun (http://orzz.org)
+*/
+
+#pragma once
+
+#include "capo/force_inline.hpp"
+#include "capo/concept.hpp"
+#include "capo/lookup_table.hpp"
+
+#include <string>       // std::string
+#include <type_traits>  // std::is_convertible, std::make_unsigned, std::enable_if, ...
+#include <utility>      // std::forward
+#include <cstdint>      // uint64_t, uint32_t, intmax_t, uintmax_t
+#include <cstddef>      // size_t, ptrdiff_t
+#include <cstring>      // std::memcpy, std::strlen
+#include <cstdlib>      // std::strtold
+#include <cstdio>       // snprintf
+#include <cwchar>       // wint_t
+#include <algorithm>    // std::min, std::copy, std::fill_n
+
+namespace capo {
+
+////////////////////////////////////////////////////////////////
+/// Native formatting engine for printf & output
+////////////////////////////////////////////////////////////////
+
+/*
+    <Remarks>
+
+    The buffer type B used by the writers below only needs what std::string provides:
+    <code>
+        b.push_back(char);
+        b.append(const char*, size_t);
+        b.append(size_t, char);
+        b.size();
+    <code/>
+*/
+
+namespace detail_format {
+
+/*
+    Conversion specification: %[flags][width][.precision][length]specifier
+*/
+
+struct spec
+{
+    enum length_t : char
+    {
+        none, h, hh, l, ll, j, z, t, L
+    };
+
+    const char* beg_  = nullptr; // points to '%'
+    const char* end_  = nullptr; // past the specifier
+    int      width_   = 0;
+    int      prec_    = -1;
+    length_t len_     = none;
+    char     type_    = 0;
+    bool     left_    = false;
+    bool     plus_    = false;
+    bool     space_   = false;
+    bool     alt_     = false;
+    bool     zero_    = false;
+};
+
+inline bool is_spec_type(char c)
+{
+    switch (c)
+    {
+    case 'd': case 'i': case 'u': case 'o': case 'x': case 'X':
+    case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A':
+    case 'c': case 's': case 'p': case 'n': case 'r':
+        return true;
+    default:
+        return false;
+    }
+}
+
+/*
+    Parse a specification, fmt points to the '%'.
+    Unknown characters are skipped just like detail_printf_::enforce_argument does.
+*/
+
+inline bool parse(const char* fmt, spec& sp)
+{
+    sp = spec{};
+    sp.beg_ = fmt++;
+    for (;; ++fmt)
+    {
+        switch (*fmt)
+        {
+        case '-': sp.left_  = true; continue;
+        case '+': sp.plus_  = true; continue;
+        case ' ': sp.space_ = true; continue;
+        case '#': sp.alt_   = true; continue;
+        case '0': sp.zero_  = true; continue;
+        }
+        break;
+    }
+    for (; *fmt >= '0' && *fmt <= '9'; ++fmt)
+        sp.width_ = sp.width_ * 10 + (*fmt - '0');
+    if (*fmt == '.')
+    {
+        sp.prec_ = 0;
+        for (++fmt; *fmt >= '0' && *fmt <= '9'; ++fmt)
+            sp.prec_ = sp.prec_ * 10 + (*fmt - '0');
+    }
+    for (; *fmt; ++fmt)
+    {
+        switch (*fmt)
+        {
+        case 'h': sp.len_ = (sp.len_ == spec::h) ? spec::hh : spec::h; continue;
+        case 'l': sp.len_ = (sp.len_ == spec::l) ? spec::ll : spec::l; continue;
+        case 'j': sp.len_ = spec::j; continue;
+        case 'z': sp.len_ = spec::z; continue;
+        case 't': sp.len_ = spec::t; continue;
+        case 'L': sp.len_ = spec::L; continue;
+        }
+        if (is_spec_type(*fmt))
+        {
+            sp.type_ = *fmt;
+            sp.end_  = fmt + 1;
+            return true;
+        }
+    }
+    return false;
+}
+
+////////////////////////////////////////////////////////////////
+/// Integers
+////////////////////////////////////////////////////////////////
+
+/*
+    Two digits at a time, see: "Three Optimization Tips for C++", Andrei Alexandrescu
+*/
+
+inline const char* digits2(size_t n)
+{
+    return lookup_table::digits::digits2.data() + n * 2;
+}
+
+template <typename U>
+CAPO_FORCE_INLINE_ char* write_dec(char* end, U v)
+{
+    while (v >= 100)
+    {
+        end -= 2;
+        std::memcpy(end, digits2(static_cast<size_t>(v % 100)), 2);
+        v /= 100;
+    }
+    if (v < 10)
+    {
+        *--end = static_cast<char>('0' + v);
+        return end;
+    }
+    end -= 2;
+    std::memcpy(end, digits2(static_cast<size_t>(v)), 2);
+    return end;
+}
+
+template <typename U>
+CAPO_FORCE_INLINE_ char* write_hex(char* end, U v, bool upper)
+{
+    const char* xdigits = upper ? lookup_table::digits::upper.data() : lookup_table::digits::lower.data();
+    do { *--end = xdigits[v & 0xf]; } while ((v >>= 4) != 0);
+    return end;
+}
+
+template <typename U>
+CAPO_FORCE_INLINE_ char* write_oct(char* end, U v)
+{
+    do { *--end = static_cast<char>('0' + (v & 7)); } while ((v >>= 3) != 0);
+    return end;
+}
+
+/*
+    Writes [prefix][zeros][body] with the width of spec.
+*/
+
+template <typename B>
+void write_padded(B& out, const spec& sp, const char* prefix, size_t pn,
+                  size_t zeros, const char* body, size_t bn, bool zero_pad)
+{
+    size_t total = pn + zeros + bn;
+    size_t fill  = (static_cast<size_t>(sp.width_) > total) ? (sp.width_ - total) : 0;
+    if (fill && !sp.left_)
+    {
+        if (zero_pad && sp.zero_) zeros += fill;
+        else out.append(fill, ' ');
+    }
+    if (pn)    out.append(prefix, pn);
+    if (zeros) out.append(zeros, '0');
+    if (bn)    out.append(body, bn);
+    if (fill && sp.left_) out.append(fill, ' ');
+}
+
+template <typename B, typename U>
+void write_integer(B& out, const spec& sp, U val, bool neg)
+{
+    char tmp[sizeof(U) * 3 + 1];
+    char* end = tmp + sizeof(tmp);
+    char* beg;
+    char prefix[3] = {};
+    size_t pn = 0;
+    switch (sp.type_)
+    {
+    case 'o': beg = write_oct(end, val);       break;
+    case 'x': beg = write_hex(end, val, false); break;
+    case 'X': beg = write_hex(end, val, true);  break;
+    default : beg = write_dec(end, val);       break;
+    }
+    size_t n = static_cast<size_t>(end - beg);
+    if (sp.prec_ == 0 && val == 0) n = 0;
+    size_t zeros = (sp.prec_ > 0 && static_cast<size_t>(sp.prec_) > n) ? (sp.prec_ - n) : 0;
+    switch (sp.type_)
+    {
+    case 'd': case 'i':
+        if (neg)            prefix[pn++] = '-';
+        else if (sp.plus_)  prefix[pn++] = '+';
+        else if (sp.space_) prefix[pn++] = ' ';
+        break;
+    case 'o':
+        if (sp.alt_ && zeros == 0 && (n == 0 || *beg != '0')) zeros = 1;
+        break;
+    case 'x': case 'X':
+        if (sp.alt_ && val != 0)
+        {
+            prefix[pn++] = '0';
+            prefix[pn++] = sp.type_;
+        }
+        break;
+    }
+    write_padded(out, sp, prefix, pn, zeros, end - n, n, (sp.prec_ < 0));
+}
+
+template <typename T>
+using promoted_unsigned = typename std::conditional<(sizeof(T) < sizeof(unsigned)), unsigned,
+                                                    typename std::make_unsigned<T>::type>::type;
+
+template <typename B, typename T>
+void write_signed(B& out, const spec& sp, T v)
+{
+    using u_t = promoted_unsigned<T>;
+    bool neg = (v < 0);
+    u_t  mag = neg ? static_cast<u_t>(0u - static_cast<u_t>(v)) : static_cast<u_t>(v);
+    write_integer(out, sp, mag, neg);
+}
+
+template <typename B, typename T>
+void write_unsigned(B& out, const spec& sp, T v)
+{
+    write_integer(out, sp, static_cast<promoted_unsigned<T>>(v), false);
+}
+
+////////////////////////////////////////////////////////////////
+/// Characters & strings
+////////////////////////////////////////////////////////////////
+
+template <typename B>
+void write_chars(B& out, const spec& sp, const char* s, size_t n)
+{
+    write_padded(out, sp, nullptr, 0, 0, s, n, false);
+}
+
+template <typename B>
+void write_string(B& out, const spec& sp, const char* s)
+{
+    if (s == nullptr)
+    {
+        // The same as glibc.
+        if (sp.prec_ < 0 || sp.prec_ >= 6) write_chars(out, sp, "(null)", 6);
+        else write_chars(out, sp, "", 0);
+        return;
+    }
+    size_t n;
+    if (sp.prec_ < 0) n = std::strlen(s);
+    else
+    {
+        const void* f = std::memchr(s, 0, static_cast<size_t>(sp.prec_));
+        n = f ? static_cast<size_t>(static_cast<const char*>(f) - s) : static_cast<size_t>(sp.prec_);
+    }
+    write_chars(out, sp, s, n);
+}
+
+template <typename B>
+void write_pointer(B& out, const spec& sp, const void* p)
+{
+    if (p == nullptr)
+    {
+        write_chars(out, sp, "(nil)", 5);
+        return;
+    }
+    char tmp[sizeof(uintptr_t) * 2];
+    char* end = tmp + sizeof(tmp);
+    char* beg = write_hex(end, reinterpret_cast<uintptr_t>(p), false);
+    char prefix[4] = {};
+    size_t pn = 0;
+    if (sp.plus_)       prefix[pn++] = '+';
+    else if (sp.space_) prefix[pn++] = ' ';
+    prefix[pn++] = '0';
+    prefix[pn++] = 'x';
+    size_t n = static_cast<size_t>(end - beg);
+    size_t zeros = (sp.prec_ > 0 && static_cast<size_t>(sp.prec_) > n) ? (sp.prec_ - n) : 0;
+    write_padded(out, sp, prefix, pn, zeros, beg, n, (sp.prec_ < 0));
+}
+
+////////////////////////////////////////////////////////////////
+/// Shortest round-trip floating-point digits (Grisu2)
+////////////////////////////////////////////////////////////////
+
+/*
+    See: Florian Loitsch, "Printing Floating-Point Numbers Quickly and Accurately with Integers"
+         http://florian.loitsch.com/publications/dtoa-pldi2010.pdf
+
+    The generated digits always round-trip, in very rare cases (about 0.1%)
+    they might be one digit longer than the shortest ones.
+*/
+
+struct diy_fp
+{
+    uint64_t f_;
+    int      e_;
+
+    diy_fp(void) = default;
+    diy_fp(uint64_t f, int e) : f_(f), e_(e) {}
+
+    diy_fp operator-(const diy_fp& rhs) const
+    {
+        return { f_ - rhs.f_, e_ };
+    }
+
+    diy_fp operator*(const diy_fp& rhs) const
+    {
+#   if defined(__SIZEOF_INT128__)
+        unsigned __int128 p = static_cast<unsigned __int128>(f_) * rhs.f_;
+        uint64_t h = static_cast<uint64_t>(p >> 64);
+        uint64_t l = static_cast<uint64_t>(p);
+        if (l & (uint64_t(1) << 63)) ++h; // rounding
+        return { h, e_ + rhs.e_ + 64 };
+#   else
+        const uint64_t M32 = 0xFFFFFFFFu;
+        uint64_t a = f_ >> 32, b = f_ & M32, c = rhs.f_ >> 32, d = rhs.f_ & M32;
+        uint64_t ac = a * c, bc = b * c, ad = a * d, bd = b * d;
+        uint64_t tmp = (bd >> 32) + (ad & M32) + (bc & M32);
+        tmp += 1U << 31; // rounding
+        return { ac + (ad >> 32) + (bc >> 32) + (tmp >> 32), e_ + rhs.e_ + 64 };
+#   endif
+    }
+
+    diy_fp normalize(void) const
+    {
+        diy_fp r = *this;
+        while (!(r.f_ & (uint64_t(1) << 63)))
+        {
+            r.f_ <<= 1;
+            --r.e_;
+        }
+        return r;
+    }
+};
+
+template <typename T> struct float_traits;
+
+template <> struct float_traits<double>
+{
+    using bits_t = uint64_t;
+    enum : int { SignificandSize = 52, ExponentBias = 0x3FF + 52 };
+};
+
+template <> struct float_traits<float>
+{
+    using bits_t = uint32_t;
+    enum : int { SignificandSize = 23, ExponentBias = 0x7F + 23 };
+};
+
+template <typename T>
+struct float_bits
+{
+    using traits_t = float_traits<T>;
+    using bits_t   = typename traits_t::bits_t;
+
+    enum : int
+    {
+        SigBits  = traits_t::SignificandSize,
+        ExpBits  = static_cast<int>(sizeof(T) * 8) - SigBits - 1,
+        ExpMask  = (1 << ExpBits) - 1,
+        Bias     = traits_t::ExponentBias
+    };
+
+    bits_t bits_;
+
+    explicit float_bits(T v) { std::memcpy(&bits_, &v, sizeof(T)); }
+
+    bool     sign       (void) const { return (bits_ >> (sizeof(T) * 8 - 1)) != 0; }
+    int      biased_exp (void) const { return static_cast<int>((bits_ >> SigBits) & ExpMask); }
+    uint64_t significand(void) const { return bits_ & ((bits_t(1) << SigBits) - 1); }
+    bool     is_special (void) const { return biased_exp() == ExpMask; }
+    bool     is_zero    (void) const { return (bits_ & ~(bits_t(1) << (sizeof(T) * 8 - 1))) == 0; }
+
+    // The binary exponent of the last significand bit.
+    int ulp_exp(void) const
+    {
+        int be = biased_exp();
+        return (be ? be : 1) - Bias;
+    }
+
+    diy_fp to_diy_fp(void) const
+    {
+        int be = biased_exp();
+        return be ? diy_fp{ significand() | (uint64_t(1) << SigBits), be - Bias }
+                  : diy_fp{ significand(), 1 - Bias };
+    }
+
+    void boundaries(const diy_fp& v, diy_fp& mi, diy_fp& pl) const
+    {
+        const uint64_t hidden = uint64_t(1) << SigBits;
+        pl = diy_fp{ (v.f_ << 1) + 1, v.e_ - 1 };
+        while (!(pl.f_ & (hidden << 1)))
+        {
+            pl.f_ <<= 1;
+            --pl.e_;
+        }
+        pl.f_ <<= (64 - SigBits - 2);
+        pl.e_  -= (64 - SigBits - 2);
+        mi = (v.f_ == hidden) ? diy_fp{ (v.f_ << 2) - 1, v.e_ - 2 }
+                              : diy_fp{ (v.f_ << 1) - 1, v.e_ - 1 };
+        mi.f_ <<= (mi.e_ - pl.e_);
+        mi.e_   = pl.e_;
+    }
+};
+
+inline diy_fp cached_power(int e, int& K)
+{
+    // 10^-348, 10^-340, ..., 10^340
+    static const uint64_t pow_f[] =
+    {
+        0xfa8fd5a0081c0288, 0xbaaee17fa23ebf76, 0x8b16fb203055ac76, 0xcf42894a5dce35ea,
+        0x9a6bb0aa55653b2d, 0xe61acf033d1a45df, 0xab70fe17c79ac6ca, 0xff77b1fcbebcdc4f,
+        0xbe5691ef416bd60c, 0x8dd01fad907ffc3c, 0xd3515c2831559a83, 0x9d71ac8fada6c9b5,
+        0xea9c227723ee8bcb, 0xaecc49914078536d, 0x823c12795db6ce57, 0xc21094364dfb5637,
+        0x9096ea6f3848984f, 0xd77485cb25823ac7, 0xa086cfcd97bf97f4, 0xef340a98172aace5,
+        0xb23867fb2a35b28e, 0x84c8d4dfd2c63f3b, 0xc5dd44271ad3cdba, 0x936b9fcebb25c996,
+        0xdbac6c247d62a584, 0xa3ab66580d5fdaf6, 0xf3e2f893dec3f126, 0xb5b5ada8aaff80b8,
+        0x87625f056c7c4a8b, 0xc9bcff6034c13053, 0x964e858c91ba2655, 0xdff9772470297ebd,
+        0xa6dfbd9fb8e5b88f, 0xf8a95fcf88747d94, 0xb94470938fa89bcf, 0x8a08f0f8bf0f156b,
+        0xcdb02555653131b6, 0x993fe2c6d07b7fac, 0xe45c10c42a2b3b06, 0xaa242499697392d3,
+        0xfd87b5f28300ca0e, 0xbce5086492111aeb, 0x8cbccc096f5088cc, 0xd1b71758e219652c,
+        0x9c40000000000000, 0xe8d4a51000000000, 0xad78ebc5ac620000, 0x813f3978f8940984,
+        0xc097ce7bc90715b3, 0x8f7e32ce7bea5c70, 0xd5d238a4abe98068, 0x9f4f2726179a2245,
+        0xed63a231d4c4fb27, 0xb0de65388cc8ada8, 0x83c7088e1aab65db, 0xc45d1df942711d9a,
+        0x924d692ca61be758, 0xda01ee641a708dea, 0xa26da3999aef774a, 0xf209787bb47d6b85,
+        0xb454e4a179dd1877, 0x865b86925b9bc5c2, 0xc83553c5c8965d3d, 0x952ab45cfa97a0b3,
+        0xde469fbd99a05fe3, 0xa59bc234db398c25, 0xf6c69a72a3989f5c, 0xb7dcbf5354e9bece,
+        0x88fcf317f22241e2, 0xcc20ce9bd35c78a5, 0x98165af37b2153df, 0xe2a0b5dc971f303a,
+        0xa8d9d1535ce3b396, 0xfb9b7cd9a4a7443c, 0xbb764c4ca7a44410, 0x8bab8eefb6409c1a,
+        0xd01fef10a657842c, 0x9b10a4e5e9913129, 0xe7109bfba19c0c9d, 0xac2820d9623bf429,
+        0x80444b5e7aa7cf85, 0xbf21e44003acdd2d, 0x8e679c2f5e44ff8f, 0xd433179d9c8cb841,
+        0x9e19db92b4e31ba9, 0xeb96bf6ebadf77d9, 0xaf87023b9bf0ee6b
+    };
+    static const short pow_e[] =
+    {
+        -1220, -1193, -1166, -1140, -1113, -1087, -1060, -1034, -1007,  -980,
+         -954,  -927,  -901,  -874,  -847,  -821,  -794,  -768,  -741,  -715,
+         -688,  -661,  -635,  -608,  -582,  -555,  -529,  -502,  -475,  -449,
+         -422,  -396,  -369,  -343,  -316,  -289,  -263,  -236,  -210,  -183,
+         -157,  -130,  -103,   -77,   -50,   -24,     3,    30,    56,    83,
+          109,   136,   162,   189,   216,   242,   269,   295,   322,   348,
+          375,   402,   428,   455,   481,   508,   534,   561,   588,   614,
+          641,   667,   694,   720,   747,   774,   800,   827,   853,   880,
+          907,   933,   960,   986,  1013,  1039,  1066
+    };
+    double dk = (-61 - e) * 0.30102999566398114 + 347; // dk must be positive
+    int k = static_cast<int>(dk);
+    if (dk - k > 0.0) ++k;
+    unsigned index = static_cast<unsigned>((k >> 3) + 1);
+    K = -(-348 + static_cast<int>(index << 3));
+    return { pow_f[index], pow_e[index] };
+}
+
+inline void grisu_round(char* buf, int len, uint64_t delta, uint64_t rest, uint64_t ten_kappa, uint64_t wp_w)
+{
+    while (rest < wp_w && delta - rest >= ten_kappa &&
+          (rest + ten_kappa < wp_w || wp_w - rest > rest + ten_kappa - wp_w))
+    {
+        --buf[len - 1];
+        rest += ten_kappa;
+    }
+}
+
+inline void digit_gen(const diy_fp& W, const diy_fp& Mp, uint64_t delta, char* buf, int& len, int& K)
+{
+    static const uint32_t pow10[] =
+    {
+        1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000
+    };
+    const diy_fp one(uint64_t(1) << -Mp.e_, Mp.e_);
+    const diy_fp wp_w = Mp - W;
+    uint32_t p1 = static_cast<uint32_t>(Mp.f_ >> -one.e_);
+    uint64_t p2 = Mp.f_ & (one.f_ - 1);
+    int kappa = 1;
+    while (kappa < 10 && p1 >= pow10[kappa]) ++kappa;
+    len = 0;
+    while (kappa > 0)
+    {
+        uint32_t d = p1 / pow10[kappa - 1];
+        p1 %= pow10[kappa - 1];
+        if (d || len) buf[len++] = static_cast<char>('0' + d);
+        --kappa;
+        uint64_t tmp = (static_cast<uint64_t>(p1) << -one.e_) + p2;
+        if (tmp <= delta)
+        {
+            K += kappa;
+            grisu_round(buf, len, delta, tmp, static_cast<uint64_t>(pow10[kappa]) << -one.e_, wp_w.f_);
+            return;
+        }
+    }
+    for (;;)
+    {
+        p2    *= 10;
+        delta *= 10;
+        char d = static_cast<char>(p2 >> -one.e_);
+        if (d || len) buf[len++] = static_cast<char>('0' + d);
+        p2 &= one.f_ - 1;
+        --kappa;
+        if (p2 < delta)
+        {
+            K += kappa;
+            int index = -kappa;
+            grisu_round(buf, len, delta, p2, one.f_, wp_w.f_ * (index < 10 ? pow10[index] : 0));
+            return;
+        }
+    }
+}
+
+/*
+    The decimal digits of a finite floating-point value.
+    value = 0.[digits_] * 10^point_
+*/
+
+struct decimal
+{
+    char digits_[24];
+    int  size_;
+    int  point_;
+    bool neg_;
+};
+
+template <typename T>
+void grisu2(T value, decimal& dec)
+{
+    float_bits<T> fb(value);
+    dec.neg_ = fb.sign();
+    if (fb.is_zero())
+    {
+        dec.digits_[0] = '0';
+        dec.size_  = 1;
+        dec.point_ = 1;
+        return;
+    }
+    diy_fp v = fb.to_diy_fp(), w_m, w_p;
+    fb.boundaries(v, w_m, w_p);
+    int K = 0;
+    const diy_fp c_mk = cached_power(w_p.e_, K);
+    const diy_fp W  = v.normalize() * c_mk;
+    diy_fp       Wp = w_p * c_mk;
+    diy_fp       Wm = w_m * c_mk;
+    ++Wm.f_;
+    --Wp.f_;
+    digit_gen(W, Wp, Wp.f_ - Wm.f_, dec.digits_, dec.size_, K);
+    dec.point_ = dec.size_ + K;
+}
+
+////////////////////////////////////////////////////////////////
+/// Floating-point
+////////////////////////////////////////////////////////////////
+
+/*
+    Writes the exponent part, like: e+05, e-123
+*/
+
+inline size_t exp_chars(char* p, int e, char ec)
+{
+    char* s = p;
+    *p++ = ec;
+    if (e < 0) { *p++ = '-'; e = -e; }
+    else         *p++ = '+';
+    if (e < 10) *p++ = '0';
+    char tmp[4];
+    char* end = tmp + sizeof(tmp);
+    char* beg = write_dec(end, static_cast<unsigned>(e));
+    std::memcpy(p, beg, end - beg);
+    return static_cast<size_t>((p + (end - beg)) - s);
+}
+
+inline size_t sign_char(char* p, const spec& sp, bool neg)
+{
+    if (neg)            { *p = '-'; return 1; }
+    else if (sp.plus_)  { *p = '+'; return 1; }
+    else if (sp.space_) { *p = ' '; return 1; }
+    return 0;
+}
+
+/*
+    Writes the digits in fixed notation, with frac_n fractional digits.
+    The digits beyond dec.size_ are all zeros.
+*/
+
+template <typename B>
+void write_fixed(B& out, const spec& sp, const decimal& dec, int frac_n, bool force_point)
+{
+    char sign[1];
+    size_t sn = sign_char(sign, sp, dec.neg_);
+    size_t int_n = (dec.point_ > 0) ? static_cast<size_t>(dec.point_) : 1;
+    bool   point = (frac_n > 0) || force_point;
+    size_t total = sn + int_n + (point ? 1 : 0) + static_cast<size_t>(frac_n);
+    size_t fill  = (static_cast<size_t>(sp.width_) > total) ? (sp.width_ - total) : 0;
+    if (fill && !sp.left_ && !sp.zero_) out.append(fill, ' ');
+    if (sn) out.append(sign, sn);
+    if (fill && !sp.left_ &&  sp.zero_) out.append(fill, '0');
+    // integral part
+    if (dec.point_ > 0)
+    {
+        size_t n = (dec.size_ < dec.point_) ? static_cast<size_t>(dec.size_) : int_n;
+        out.append(dec.digits_, n);
+        if (n < int_n) out.append(int_n - n, '0');
+    }
+    else out.push_back('0');
+    // fractional part
+    if (point) out.push_back('.');
+    if (frac_n > 0)
+    {
+        int lead = (dec.point_ < 0) ? -dec.point_ : 0;
+        if (lead > frac_n) lead = frac_n;
+        if (lead) out.append(static_cast<size_t>(lead), '0');
+        int first = (dec.point_ > 0) ? dec.point_ : 0;
+        int n = dec.size_ - first;
+        if (n > frac_n - lead) n = frac_n - lead;
+        if (n > 0) out.append(dec.digits_ + first, static_cast<size_t>(n));
+        else n = 0;
+        int rest = frac_n - lead - n;
+        if (rest > 0) out.append(static_cast<size_t>(rest), '0');
+    }
+    if (fill && sp.left_) out.append(fill, ' ');
+}
+
+/*
+    Writes the digits in exponential notation, with frac_n fractional digits.
+*/
+
+template <typename B>
+void write_exp(B& out, const spec& sp, const decimal& dec, int frac_n, bool force_point, char ec)
+{
+    char sign[1], ex[8];
+    size_t sn = sign_char(sign, sp, dec.neg_);
+    int    e  = (dec.digits_[0] == '0') ? 0 : dec.point_ - 1;
+    size_t en = exp_chars(ex, e, ec);
+    bool   point = (frac_n > 0) || force_point;
+    size_t total = sn + 1 + (point ? 1 : 0) + static_cast<size_t>(frac_n) + en;
+    size_t fill  = (static_cast<size_t>(sp.width_) > total) ? (sp.width_ - total) : 0;
+    if (fill && !sp.left_ && !sp.zero_) out.append(fill, ' ');
+    if (sn) out.append(sign, sn);
+    if (fill && !sp.left_ &&  sp.zero_) out.append(fill, '0');
+    out.push_back(dec.digits_[0]);
+    if (point) out.push_back('.');
+    if (frac_n > 0)
+    {
+        int n = dec.size_ - 1;
+        if (n > frac_n) n = frac_n;
+        if (n > 0) out.append(dec.digits_ + 1, static_cast<size_t>(n));
+        else n = 0;
+        if (frac_n > n) out.append(static_cast<size_t>(frac_n - n), '0');
+    }
+    out.append(ex, en);
+    if (fill && sp.left_) out.append(fill, ' ');
+}
+
+/*
+    Falls back to snprintf, for the conversions the engine does not produce natively.
+*/
+
+#if defined(__GNUC__)
+#   pragma GCC diagnostic push
+#   pragma GCC diagnostic ignored "-Wformat-nonliteral"
+#   pragma GCC diagnostic ignored "-Wformat-security"
+#endif/*__GNUC__*/
+template <typename B, typename T>
+bool write_printf(B& out, const spec& sp, T val)
+{
+    char fmt[32];
+    std::string big;
+    const char* f = fmt;
+    size_t fn = static_cast<size_t>(sp.end_ - sp.beg_);
+    if (fn < sizeof(fmt))
+    {
+        std::memcpy(fmt, sp.beg_, fn);
+        fmt[fn] = '\0';
+    }
+    else f = (big.assign(sp.beg_, fn), big.c_str());
+    char buf[512]; // enough for "%f" of DBL_MAX
+    int n = ::snprintf(buf, sizeof(buf), f, val);
+    if (n < 0) return false;
+    if (n < static_cast<int>(sizeof(buf)))
+    {
+        out.append(buf, static_cast<size_t>(n));
+        return true;
+    }
+    std::string tmp(static_cast<size_t>(n), '\0');
+    n = ::snprintf(&tmp[0], tmp.size() + 1, f, val);
+    if (n < 0) return false;
+    out.append(tmp.data(), static_cast<size_t>(n));
+    return true;
+}
+#if defined(__GNUC__)
+#   pragma GCC diagnostic pop
+#endif/*__GNUC__*/
+
+/*
+    Checks whether the shortest digits are exactly what printf would produce
+    when the last printed digit is at 10^pos.
+    If the value's ulp is less than 10^(pos - 1), the correctly rounded result
+    is the shortest digits padded with zeros.
+*/
+
+template <typename T>
+bool is_exact_enough(const float_bits<T>& fb, const decimal& dec, int pos)
+{
+    if (dec.point_ - dec.size_ < pos) return false;
+    if (fb.is_zero()) return true;
+    // log10(2) = 0.30102999566398119521373889472449
+    return (fb.ulp_exp() * 0.30102999566398120) < (pos - 1);
+}
+
+template <typename B>
+bool write_double(B& out, const spec& sp, double val)
+{
+    float_bits<double> fb(val);
+    if (fb.is_special()) return write_printf(out, sp, val);
+    int prec = (sp.prec_ < 0) ? 6 : sp.prec_;
+    decimal dec;
+    switch (sp.type_)
+    {
+    case 'f': case 'F':
+        grisu2(val, dec);
+        if (!is_exact_enough(fb, dec, -prec)) break;
+        write_fixed(out, sp, dec, prec, sp.alt_);
+        return true;
+    case 'e': case 'E':
+        grisu2(val, dec);
+        if (!is_exact_enough(fb, dec, (fb.is_zero() ? 0 : dec.point_ - 1) - prec)) break;
+        write_exp(out, sp, dec, prec, sp.alt_, (sp.type_ == 'e') ? 'e' : 'E');
+        return true;
+    }
+    return write_printf(out, sp, val);
+}
+
+/*
+    Shortest round-trip notation, chooses fixed or exponential like javascript does.
+*/
+
+template <typename B>
+void write_shortest(B& out, const spec& sp, const decimal& dec)
+{
+    if (dec.point_ > -6 && dec.point_ <= 21)
+    {
+        int frac_n = dec.size_ - dec.point_;
+        write_fixed(out, sp, dec, (frac_n > 0) ? frac_n : 0, sp.alt_);
+    }
+    else write_exp(out, sp, dec, dec.size_ - 1, sp.alt_, 'e');
+}
+
+template <typename B, typename T>
+bool write_shortest(B& out, const spec& sp, T val)
+{
+    float_bits<T> fb(val);
+    if (fb.is_special())
+    {
+        const char* s = (fb.significand() != 0) ? (fb.sign() ? "-nan" : "nan")
+                                                : (fb.sign() ? "-inf" : "inf");
+        write_chars(out, sp, s, std::strlen(s));
+        return true;
+    }
+    decimal dec;
+    grisu2(val, dec);
+    write_shortest(out, sp, dec);
+    return true;
+}
+
+template <typename B>
+bool write_shortest(B& out, const spec& sp, long double val)
+{
+    // There is no native algorithm for long double, find the shortest one by snprintf.
+    char buf[64];
+    for (int prec = 17; prec < 40; ++prec)
+    {
+        int n = ::snprintf(buf, sizeof(buf), "%.*Lg", prec, val);
+        if (n < 0) return false;
+        if (std::strtold(buf, nullptr) == val || val != val)
+        {
+            write_chars(out, sp, buf, static_cast<size_t>(n));
+            return true;
+        }
+    }
+    return false;
+}
+
+////////////////////////////////////////////////////////////////
+/// Argument dispatching
+////////////////////////////////////////////////////////////////
+
+/*
+    All the conversions are compiled for every argument type,
+    but the ones not convertible are never called (detail_printf_::check rejects them).
+*/
+
+template <typename T, typename A>
+auto cast_(A&& a) -> typename std::enable_if<std::is_convertible<A, T>::value, T>::type
+{
+    return static_cast<T>(std::forward<A>(a));
+}
+
+template <typename T, typename A>
+auto cast_(A&&) -> typename std::enable_if<!std::is_convertible<A, T>::value, T>::type
+{
+    return T{};
+}
+
+template <typename B, typename T>
+void store_count(B& out, T* p)
+{
+    if (p != nullptr) *p = static_cast<T>(out.size());
+}
+
+template <typename B, typename A>
+bool write_arg(B& out, const spec& sp, A&& a)
+{
+    switch (sp.type_)
+    {
+    case 'd': case 'i':
+        switch (sp.len_)
+        {
+        default:
+        case spec::none: write_signed(out, sp, cast_<int>        (std::forward<A>(a))); break;
+        case spec::h:    write_signed(out, sp, cast_<short>      (std::forward<A>(a))); break;
+        case spec::hh:   write_signed(out, sp, cast_<signed char>(std::forward<A>(a))); break;
+        case spec::l:    write_signed(out, sp, cast_<long>       (std::forward<A>(a))); break;
+        case spec::ll:   write_signed(out, sp, cast_<long long>  (std::forward<A>(a))); break;
+        case spec::j:    write_signed(out, sp, cast_<intmax_t>   (std::forward<A>(a))); break;
+        case spec::z:    write_signed(out, sp, cast_<ptrdiff_t>  (std::forward<A>(a))); break;
+        case spec::t:    write_signed(out, sp, cast_<ptrdiff_t>  (std::forward<A>(a))); break;
+        }
+        return true;
+    case 'u': case 'o': case 'x': case 'X':
+        switch (sp.len_)
+        {
+        default:
+        case spec::none: write_unsigned(out, sp, cast_<unsigned int>      (std::forward<A>(a))); break;
+        case spec::h:    write_unsigned(out, sp, cast_<unsigned short>    (std::forward<A>(a))); break;
+        case spec::hh:   write_unsigned(out, sp, cast_<unsigned char>     (std::forward<A>(a))); break;
+        case spec::l:    write_unsigned(out, sp, cast_<unsigned long>     (std::forward<A>(a))); break;
+        case spec::ll:   write_unsigned(out, sp, cast_<unsigned long long>(std::forward<A>(a))); break;
+        case spec::j:    write_unsigned(out, sp, cast_<uintmax_t>         (std::forward<A>(a))); break;
+        case spec::z:    write_unsigned(out, sp, cast_<size_t>            (std::forward<A>(a))); break;
+        case spec::t:    write_unsigned(out, sp, cast_<size_t>            (std::forward<A>(a))); break;
+        }
+        return true;
+    case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A':
+        if (sp.len_ == spec::L)
+            return write_printf(out, sp, cast_<long double>(std::forward<A>(a)));
+        return write_double(out, sp, cast_<double>(std::forward<A>(a)));
+    case 'r':
+        if (sp.len_ == spec::L || std::is_same<typename std::decay<A>::type, long double>::value)
+            return write_shortest(out, sp, cast_<long double>(std::forward<A>(a)));
+        if (std::is_same<typename std::decay<A>::type, float>::value)
+            return write_shortest(out, sp, cast_<float>(std::forward<A>(a)));
+        return write_shortest(out, sp, cast_<double>(std::forward<A>(a)));
+    case 'c':
+        if (sp.len_ == spec::l)
+            return write_printf(out, sp, static_cast<wint_t>(cast_<wchar_t>(std::forward<A>(a))));
+        else
+        {
+            char c = static_cast<char>(static_cast<unsigned char>(cast_<int>(std::forward<A>(a))));
+            write_chars(out, sp, &c, 1);
+        }
+        return true;
+    case 's':
+        if (sp.len_ == spec::l)
+            return write_printf(out, sp, cast_<const wchar_t*>(std::forward<A>(a)));
+        write_string(out, sp, cast_<const char*>(std::forward<A>(a)));
+        return true;
+    case 'p':
+        write_pointer(out, sp, cast_<const void*>(std::forward<A>(a)));
+        return true;
+    case 'n':
+        switch (sp.len_)
+        {
+        default:
+        case spec::none: store_count(out, cast_<int*>      (std::forward<A>(a))); break;
+        case spec::h:    store_count(out, cast_<short*>    (std::forward<A>(a))); break;
+        case spec::hh:   store_count(out, cast_<char*>     (std::forward<A>(a))); break;
+        case spec::l:    store_count(out, cast_<long*>     (std::forward<A>(a))); break;
+        case spec::ll:   store_count(out, cast_<long long*>(std::forward<A>(a))); break;
+        case spec::j:    store_count(out, cast_<intmax_t*> (std::forward<A>(a))); break;
+        case spec::z:    store_count(out, cast_<size_t*>   (std::forward<A>(a))); break;
+        case spec::t:    store_count(out, cast_<ptrdiff_t*>(std::forward<A>(a))); break;
+        }
+        return true;
+    }
+    return false;
+}
+
+/*
+    Writes the characters between the specifications.
+    Returns the next '%' which is not an escape, or nullptr if reached the end.
+*/
+
+template <typename B>
+const char* write_text(B& out, const char* fmt)
+{
+    for (;;)
+    {
+        const char* p = fmt;
+        while (*p && *p != '%') ++p;
+        if (p != fmt) out.append(fmt, static_cast<size_t>(p - fmt));
+        if (*p == '\0') return nullptr;
+        if (p[1] != '%') return p;
+        out.push_back('%');
+        fmt = p + 2;
+    }
+}
+
+template <typename B>
+bool format(B& out, const char* fmt)
+{
+    return (write_text(out, fmt) == nullptr);
+}
+
+template <typename B, typename A1, typename... A>
+bool format(B& out, const char* fmt, A1&& a1, A&&... args)
+{
+    fmt = write_text(out, fmt);
+    if (fmt == nullptr) return false;
+    spec sp;
+    if (!parse(fmt, sp)) return false;
+    if (!write_arg(out, sp, std::forward<A1>(a1))) return false;
+    return format(out, sp.end_, std::forward<A>(args)...);
+}
+
+} // namespace detail_format
+
+////////////////////////////////////////////////////////////////
+/// Convert a number to characters
+////////////////////////////////////////////////////////////////
+
+/*
+    Returns a pointer past the last written character,
+    or nullptr if the space of [first, last) is not enough.
+    Floating-point numbers are written in the shortest round-trip notation.
+*/
+
+namespace detail_format {
+
+struct range_buffer
+{
+    char* cur_;
+    char* last_;
+    bool  full_ = false;
+
+    range_buffer(char* first, char* last) : cur_(first), last_(last) {}
+
+    void append(const char* s, size_t n)
+    {
+        if (full_ || static_cast<size_t>(last_ - cur_) < n) { full_ = true; return; }
+        std::memcpy(cur_, s, n);
+        cur_ += n;
+    }
+    void append(size_t n, char c)
+    {
+        if (full_ || static_cast<size_t>(last_ - cur_) < n) { full_ = true; return; }
+        std::memset(cur_, c, n);
+        cur_ += n;
+    }
+    void push_back(char c) { append(&c, 1); }
+};
+
+/*
+    Writes through an output iterator, stops writing after limit_ characters,
+    but keeps counting the size.
+*/
+
+template <typename OutputIt>
+struct iterator_buffer
+{
+    OutputIt it_;
+    size_t   limit_;
+    size_t   size_ = 0;
+
+    iterator_buffer(OutputIt it, size_t limit = static_cast<size_t>(-1))
+        : it_(it), limit_(limit)
+    {}
+
+    size_t size(void) const { return size_; }
+
+    void push_back(char c)
+    {
+        if (size_ < limit_) *it_++ = c;
+        ++size_;
+    }
+    void append(const char* s, size_t n)
+    {
+        size_t k = (size_ < limit_) ? (std::min)(n, limit_ - size_) : 0;
+        it_ = std::copy(s, s + k, it_);
+        size_ += n;
+    }
+    void append(size_t n, char c)
+    {
+        size_t k = (size_ < limit_) ? (std::min)(n, limit_ - size_) : 0;
+        it_ = std::fill_n(it_, k, c);
+        size_ += n;
+    }
+};
+
+/*
+    Writes to a file-like object (which has write(const void*, size)) through a stack buffer.
+*/
+
+template <typename FileT>
+class file_buffer
+{
+    FileT& file_;
+    char   data_[256];
+    size_t n_      = 0;
+    size_t size_   = 0;
+    bool   failed_ = false;
+
+public:
+    explicit file_buffer(FileT& f) : file_(f) {}
+
+    size_t size  (void) const { return size_;   }
+    bool   failed(void) const { return failed_; }
+
+    void flush(void)
+    {
+        if (n_ == 0) return;
+        if (static_cast<size_t>(file_.write(data_, n_)) != n_) failed_ = true;
+        n_ = 0;
+    }
+
+    void push_back(char c)
+    {
+        if (n_ == sizeof(data_)) flush();
+        data_[n_++] = c;
+        ++size_;
+    }
+    void append(const char* s, size_t n)
+    {
+        size_ += n;
+        while (n > 0)
+        {
+            if (n_ == sizeof(data_)) flush();
+            size_t k = (std::min)(n, sizeof(data_) - n_);
+            std::memcpy(data_ + n_, s, k);
+            n_ += k; s += k; n -= k;
+        }
+    }
+    void append(size_t n, char c)
+    {
+        size_ += n;
+        while (n > 0)
+        {
+            if (n_ == sizeof(data_)) flush();
+            size_t k = (std::min)(n, sizeof(data_) - n_);
+            std::memset(data_ + n_, c, k);
+            n_ += k; n -= k;
+        }
+    }
+};
+
+} // namespace detail_format
+
+////////////////////////////////////////////////////////////////
+/// Fixed-capacity character buffer on caller's memory
+////////////////////////////////////////////////////////////////
+
+/*
+    The content is always null-terminated, so the usable capacity is (capacity - 1).
+    Characters beyond the capacity are dropped and truncated() becomes true.
+*/
+
+class fixed_buffer
+{
+    char*  data_;
+    size_t capacity_;
+    size_t size_      = 0;
+    bool   truncated_ = false;
+
+public:
+    fixed_buffer(char* data, size_t capacity)
+        : data_(data), capacity_(capacity)
+    {
+        if (capacity_ > 0) data_[0] = '\0';
+    }
+
+    template <size_t N>
+    fixed_buffer(char (& data)[N])
+        : fixed_buffer(data, N)
+    {}
+
+    const char* data     (void) const { return data_;      }
+    const char* c_str    (void) const { return data_;      }
+    size_t      size     (void) const { return size_;      }
+    size_t      capacity (void) const { return capacity_;  }
+    bool        empty    (void) const { return size_ == 0; }
+    bool        truncated(void) const { return truncated_; }
+
+    void clear(void)
+    {
+        size_ = 0;
+        truncated_ = false;
+        if (capacity_ > 0) data_[0] = '\0';
+    }
+
+    void push_back(char c) { append(1, c); }
+
+    void append(const char* s, size_t n)
+    {
+        n = reserve(n);
+        if (n == 0) return;
+        std::memcpy(data_ + size_, s, n);
+        data_[size_ += n] = '\0';
+    }
+
+    void append(size_t n, char c)
+    {
+        n = reserve(n);
+        if (n == 0) return;
+        std::memset(data_ + size_, c, n);
+        data_[size_ += n] = '\0';
+    }
+
+private:
+    size_t reserve(size_t n)
+    {
+        size_t room = (capacity_ > size_ + 1) ? (capacity_ - size_ - 1) : 0;
+        if (n > room)
+        {
+            truncated_ = true;
+            n = room;
+        }
+        return n;
+    }
+};
+
+template <typename T, CAPO_REQUIRE_(std::is_integral<T>::value && !std::is_same<T, bool>::value)>
+char* to_chars(char* first, char* last, T value)
+{
+    detail_format::range_buffer out { first, last };
+    detail_format::spec sp;
+    sp.type_ = 'd';
+    if (std::is_signed<T>::value)
+         detail_format::write_signed  (out, sp, value);
+    else detail_format::write_unsigned(out, sp, value);
+    return out.full_ ? nullptr : out.cur_;
+}
+
+template <typename T, CAPO_REQUIRE_(std::is_floating_point<T>::value)>
+char* to_chars(char* first, char* last, T value)
+{
+    detail_format::range_buffer out { first, last };
+    detail_format::spec sp;
+    sp.type_ = 'r';
+    detail_format::write_shortest(out, sp, value);
+    return out.full_ ? nullptr : out.cur_;
+}
+
+} // namespace capo
@@ -0,0 +1,465 @@
+/*
+    The Capo Library
+    Code covered by the MIT License
+
+    Author: mutouyun (http://orzz.org)
+*/
+
+#pragma once
+
+#include "capo/noncopyable.hpp"
+#include "capo/scope_guard.hpp"
+#include "capo/stopwatch.hpp"
+#include "capo/spin_lock.hpp"
+#include "capo/thread_local_ptr.hpp"
+#include "capo/unused.hpp"
+
+#include <array>        // std::array
+#include <vector>       // std::vector
+#include <string>       // std::string
+#include <memory>       // std::shared_ptr, std::make_shared
+#include <atomic>       // std::atomic
+#include <mutex>        // std::lock_guard
+#include <chrono>       // std::chrono
+#include <limits>       // std::numeric_limits
+#include <cmath>        // std::sqrt, std::ceil
+#include <cstdint>      // uint64_t
+#include <cstddef>      // size_t
+
+namespace capo {
+namespace detail_histogram {
+
+inline unsigned msb(uint64_t v) // v != 0
+{
+#if defined(_MSC_VER) && defined(_M_X64)
+    unsigned long i;
+    _BitScanReverse64(&i, v);
+    return static_cast<unsigned>(i);
+#elif defined(__GNUC__)
+    return 63u - static_cast<unsigned>(__builtin_clzll(v));
+#else
+    unsigned i = 0;
+    while (v >>= 1) ++i;
+    return i;
+#endif
+}
+
+inline void put_varint(std::string& buf, uint64_t v)
+{
+    while (v >= 0x80)
+    {
+        buf.push_back(static_cast<char>((v & 0x7f) | 0x80));
+        v >>= 7;
+    }
+    buf.push_back(static_cast<char>(v));
+}
+
+inline bool get_varint(const unsigned char*& p, const unsigned char* e, uint64_t& v)
+{
+    v = 0;
+    for (unsigned s = 0; (p != e) && (s < 64); s += 7)
+    {
+        unsigned char c = *p++;
+        v |= static_cast<uint64_t>(c & 0x7f) << s;
+        if ((c & 0x80) == 0) return true;
+    }
+    return false;
+}
+
+/*
+    Log-linear bucketing:
+    values below 2^SubBits have their own buckets, above that every power of 2
+    is split into 2^(SubBits - 1) linear buckets, so the relative error is
+    at most 1 / 2^(SubBits - 1).
+*/
+
+template <unsigned SubBits>
+struct layout
+{
+    static_assert(SubBits >= 2 && SubBits <= 16, "SubBits must be in [2, 16]");
+
+    enum : size_t
+    {
+        half  = size_t(1) << (SubBits - 1),
+        count = (66 - SubBits) * half
+    };
+
+    static size_t index_of(uint64_t v)
+    {
+        if (v < (uint64_t(1) << SubBits)) return static_cast<size_t>(v);
+        unsigned e = msb(v) - SubBits + 1;
+        return e * half + static_cast<size_t>(v >> e);
+    }
+
+    static uint64_t lower_of(size_t i)
+    {
+        if (i < 2 * half) return i;
+        unsigned e = static_cast<unsigned>(i / half) - 1;
+        return static_cast<uint64_t>(i - e * half) << e;
+    }
+
+    static uint64_t upper_of(size_t i)
+    {
+        if (i < 2 * half) return i;
+        unsigned e = static_cast<unsigned>(i / half) - 1;
+        return lower_of(i) + ((uint64_t(1) << e) - 1);
+    }
+};
+
+template <typename Rep, typename Period>
+uint64_t to_ns(std::chrono::duration<Rep, Period> d)
+{
+    auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(d).count();
+    return (ns > 0) ? static_cast<uint64_t>(ns) : 0;
+}
+
+} // namespace detail_histogram
+
+////////////////////////////////////////////////////////////////
+/// Log-linear (HDR-style) histogram with fixed memory and O(1) recording
+////////////////////////////////////////////////////////////////
+
+/*
+    Records unsigned values (durations are recorded in nanoseconds).
+    The default SubBits (7) keeps the relative error of the percentiles below 1/64,
+    and takes (66 - 7) * 64 buckets.
+*/
+
+template <unsigned SubBits = 7>
+class histogram
+{
+    using layout_t = detail_histogram::layout<SubBits>;
+
+public:
+    enum : size_t { bucket_count = layout_t::count };
+
+private:
+    std::array<uint64_t, bucket_count> counts_ {};
+    uint64_t total_ = 0;
+    uint64_t min_   = (std::numeric_limits<uint64_t>::max)();
+    uint64_t max_   = 0;
+    double   sum_   = 0;
+    double   sum2_  = 0;
+
+    template <unsigned> friend class concurrent_histogram;
+
+public:
+    static size_t   index_of(uint64_t v) { return layout_t::index_of(v); }
+    static uint64_t lower_of(size_t i)   { return layout_t::lower_of(i); }
+    static uint64_t upper_of(size_t i)   { return layout_t::upper_of(i); }
+
+    void record(uint64_t v, uint64_t n = 1)
+    {
+        counts_[index_of(v)] += n;
+        total_ += n;
+        if (v < min_) min_ = v;
+        if (v > max_) max_ = v;
+        double d = static_cast<double>(v);
+        sum_  += d * n;
+        sum2_ += d * d * n;
+    }
+
+    template <typename Rep, typename Period>
+    void record(std::chrono::duration<Rep, Period> d, uint64_t n = 1)
+    {
+        record(detail_histogram::to_ns(d), n);
+    }
+
+    void merge(const histogram& rhs)
+    {
+        if (rhs.total_ == 0) return;
+        for (size_t i = 0; i < bucket_count; ++i) counts_[i] += rhs.counts_[i];
+        total_ += rhs.total_;
+        if (rhs.min_ < min_) min_ = rhs.min_;
+        if (rhs.max_ > max_) max_ = rhs.max_;
+        sum_  += rhs.sum_;
+        sum2_ += rhs.sum2_;
+    }
+
+    histogram& operator+=(const histogram& rhs)
+    {
+        merge(rhs);
+        return (*this);
+    }
+
+    void clear(void)
+    {
+        (*this) = histogram{};
+    }
+
+    uint64_t count(void) const { return total_; }
+    uint64_t min  (void) const { return (total_ == 0) ? 0 : min_; }
+    uint64_t max  (void) const { return max_; }
+
+    double mean(void) const
+    {
+        return (total_ == 0) ? 0 : (sum_ / total_);
+    }
+
+    double stddev(void) const
+    {
+        if (total_ == 0) return 0;
+        double m = mean(), v = sum2_ / total_ - m * m;
+        return (v > 0) ? std::sqrt(v) : 0;
+    }
+
+    /*
+        The value below which p percent (0 ~ 100) of the records fall,
+        reported as the highest value equivalent to the bucket.
+    */
+    uint64_t percentile(double p) const
+    {
+        if (total_ == 0) return 0;
+        if (p <= 0)   return min_;
+        if (p >= 100) return max_;
+        auto rank = static_cast<uint64_t>(std::ceil(p / 100 * total_));
+        if (rank == 0) rank = 1;
+        uint64_t acc = 0;
+        for (size_t i = 0; i < bucket_count; ++i)
+        {
+            if ((acc += counts_[i]) >= rank)
+            {
+                uint64_t v = upper_of(i);
+                return (v < min_) ? min_ : (v > max_) ? max_ : v;
+            }
+        }
+        return max_;
+    }
+
+    uint64_t median(void) const { return percentile(50); }
+
+    /*
+        Calls f(lower, upper, count) for each non-empty bucket.
+    */
+    template <typename F>
+    void for_each(F&& f) const
+    {
+        for (size_t i = 0; i < bucket_count; ++i)
+        {
+            if (counts_[i] != 0) f(lower_of(i), upper_of(i), counts_[i]);
+        }
+    }
+
+    /*
+        A compact, sparse encoding for passing the histogram across processes.
+    */
+    std::string encode(void) const
+    {
+        using namespace detail_histogram;
+        std::string buf { "CAPOHIST" };
+        put_varint(buf, SubBits);
+        put_varint(buf, min());
+        put_varint(buf, max_);
+        size_t last = 0;
+        for (size_t i = 0; i < bucket_count; ++i)
+        {
+            if (counts_[i] == 0) continue;
+            put_varint(buf, i - last);
+            put_varint(buf, counts_[i]);
+            last = i;
+        }
+        return buf;
+    }
+
+    /*
+        Merges an encoded histogram, returns false if the data is malformed.
+    */
+    bool decode(const void* data, size_t size)
+    {
+        using namespace detail_histogram;
+        auto p = static_cast<const unsigned char*>(data), e = p + size;
+        if (size < 8 || std::string(reinterpret_cast<const char*>(p), 8) != "CAPOHIST") return false;
+        p += 8;
+        uint64_t bits, lo, hi;
+        if (!get_varint(p, e, bits) || (bits != SubBits) ||
+            !get_varint(p, e, lo)   || !get_varint(p, e, hi)) return false;
+        histogram tmp;
+        uint64_t idx = 0, step, n;
+        while (p != e)
+        {
+            if (!get_varint(p, e, step) || !get_varint(p, e, n)) return false;
+            if ((idx += step) >= bucket_count) return false;
+            uint64_t v = (lower_of(idx) + upper_of(idx)) / 2;
+            tmp.record(v < lo ? lo : v > hi ? hi : v, n);
+        }
+        if (tmp.total_ != 0)
+        {
+            tmp.min_ = lo;
+            tmp.max_ = hi;
+        }
+        merge(tmp);
+        return true;
+    }
+
+    bool decode(const std::string& buf)
+    {
+        return decode(buf.data(), buf.size());
+    }
+};
+
+////////////////////////////////////////////////////////////////
+/// Lock-free histogram for recording from multiple threads
+////////////////////////////////////////////////////////////////
+
+/*
+    Every thread records into its own shard without any atomic RMW,
+    the shards are merged by snapshot().
+    Shards of exited threads are kept (with their records) and reused by new threads.
+    If the thread-local key could not be created, all threads record into one shard under the lock.
+*/
+
+template <unsigned SubBits = 7>
+class concurrent_histogram : capo::noncopyable
+{
+public:
+    using histogram_t = histogram<SubBits>;
+    enum : size_t { bucket_count = histogram_t::bucket_count };
+
+private:
+    struct shard
+    {
+        std::array<std::atomic<uint64_t>, bucket_count> counts_;
+        std::atomic<uint64_t> min_ { (std::numeric_limits<uint64_t>::max)() };
+        std::atomic<uint64_t> max_ { 0 };
+        std::atomic<double>   sum_ { 0 };
+        std::atomic<double>   sum2_{ 0 };
+        std::atomic<bool>     used_{ true };
+
+        shard(void)
+        {
+            for (auto& c : counts_) c.store(0, std::memory_order_relaxed);
+        }
+
+        template <typename T, typename U>
+        static void add(std::atomic<T>& a, U n)
+        {
+            a.store(a.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+        }
+    };
+
+    struct owner
+    {
+        std::shared_ptr<shard> shard_;
+
+        ~owner(void) { shard_->used_.store(false, std::memory_order_release); }
+    };
+
+    capo::thread_local_ptr<owner>       local_;
+    capo::spin_lock                     lc_;
+    std::vector<std::shared_ptr<shard>> shards_;
+    std::shared_ptr<shard>              shared_; // only used without a valid local_
+
+    shard* local_shard(void)
+    {
+        owner* o = local_;
+        if (o != nullptr) return o->shard_.get();
+        o = new owner;
+        {
+            std::lock_guard<capo::spin_lock> guard { lc_ };
+            for (auto& s : shards_)
+            {
+                bool expected = false;
+                if (s->used_.compare_exchange_strong(expected, true, std::memory_order_acquire))
+                {
+                    o->shard_ = s;
+                    break;
+                }
+            }
+            if (!o->shard_)
+            {
+                o->shard_ = std::make_shared<shard>();
+                shards_.push_back(o->shard_);
+            }
+        }
+        local_ = o;
+        return o->shard_.get();
+    }
+
+    static void record(shard* s, uint64_t v, uint64_t n)
+    {
+        shard::add(s->counts_[histogram_t::index_of(v)], n);
+        if (v < s->min_.load(std::memory_order_relaxed)) s->min_.store(v, std::memory_order_relaxed);
+        if (v > s->max_.load(std::memory_order_relaxed)) s->max_.store(v, std::memory_order_relaxed);
+        double d = static_cast<double>(v);
+        shard::add(s->sum_ , d * n);
+        shard::add(s->sum2_, d * d * n);
+    }
+
+public:
+    void record(uint64_t v, uint64_t n = 1)
+    {
+        if (local_.valid())
+        {
+            record(local_shard(), v, n);
+            return;
+        }
+        std::lock_guard<capo::spin_lock> guard { lc_ };
+        if (!shared_)
+        {
+            shared_ = std::make_shared<shard>();
+            shards_.push_back(shared_);
+        }
+        record(shared_.get(), v, n);
+    }
+
+    template <typename Rep, typename Period>
+    void record(std::chrono::duration<Rep, Period> d, uint64_t n = 1)
+    {
+        record(detail_histogram::to_ns(d), n);
+    }
+
+    /*
+        Merges all shards into a histogram.
+        Records made concurrently with the snapshot may or may not be included.
+    */
+    histogram_t snapshot(void)
+    {
+        histogram_t h;
+        std::lock_guard<capo::spin_lock> guard { lc_ };
+        for (auto& s : shards_)
+        {
+            histogram_t t;
+            for (size_t i = 0; i < bucket_count; ++i)
+                t.total_ += (t.counts_[i] = s->counts_[i].load(std::memory_order_relaxed));
+            if (t.total_ == 0) continue;
+            t.min_  = s->min_ .load(std::memory_order_relaxed);
+            t.max_  = s->max_ .load(std::memory_order_relaxed);
+            t.sum_  = s->sum_ .load(std::memory_order_relaxed);
+            t.sum2_ = s->sum2_.load(std::memory_order_relaxed);
+            h.merge(t);
+        }
+        return h;
+    }
+};
+
+////////////////////////////////////////////////////////////////
+/// Record the duration of a scope into a histogram
+////////////////////////////////////////////////////////////////
+
+/*
+    Do things like this:
+    -->
+    {
+        auto guard = capo::record_scope(hist);          // or record_scope<capo::tsc_clock<>>(hist)
+        ...
+    }
+    -->
+    {
+        CAPO_HISTOGRAM_SCOPE_(hist);
+        ...
+    }
+*/
+
+template <typename ClockT = std::chrono::steady_clock, typename HistT>
+auto record_scope(HistT& hist)
+{
+    return capo::make<scope_guard>([&hist, sw = capo::stopwatch<1, ClockT>(true)]() mutable
+    {
+        hist.record(sw.elapsed());
+    });
+}
+
+#define CAPO_HISTOGRAM_SCOPE_L_(L, ...) auto CAPO_SCOPE_GUARD_V_(L) = capo::record_scope(__VA_ARGS__)
+#define CAPO_HISTOGRAM_SCOPE_(...)      CAPO_HISTOGRAM_SCOPE_L_(__LINE__, __VA_ARGS__)
+
+} // namespace capo
@@ -14,7 +14,9 @@
 #include "capo/constant_array.hpp"
 #include "capo/concept.hpp"
 
+#include <iterator> // std::random_access_iterator_tag
 #include <utility>  // std::move, std::forward, std::swap
+#include <cstddef>  // size_t, ptrdiff_t
 
 namespace capo {
 
@@ -75,6 +77,14 @@ auto forward(typename std::enable_if<(ForwardN > sizeof...(A))>::type*, A&&... a
 /// Iterator pattern
 ////////////////////////////////////////////////////////////////
 
+/*
+    A random-access iterator over the states of policy A.
+    Stepping uses A::next/A::prev, jumping uses A::at on the origin state,
+    so += n, -, [] are as cheap as A::at (O(1) or O(log(n)) for the built-in policies).
+    The elements are computed from the state, so they are returned by value
+    (a reference into the iterator would dangle, e.g. with std::reverse_iterator).
+*/
+
 template <class A, typename T, int StateSize = A::StateSize>
 class iterator
 {
@@ -82,8 +92,15 @@ public:
     using tp_t = types_assign_t<StateSize, std::tuple<T>>;
     using size_type = size_t;
 
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type        = T;
+    using difference_type   = std::ptrdiff_t;
+    using pointer           = void;
+    using reference         = T;
+
 private:
     tp_t   x_;
+    tp_t   o_;      // the origin state, A::at(o_, n) gives the state at index n
     size_t i_ = 0;
 
     using seq = list_to_seq<tp_t>;
@@ -97,16 +114,27 @@ private:
         i_ = n;
     }
 
+    void seek(size_t n)
+    {
+        if (n == i_) return;
+        if (n == i_ + 1) { next(seq{}); return; }
+        if (n + 1 == i_) { prev(seq{}); return; }
+        x_ = o_;
+        if (n == 0) i_ = 0;
+        else at(n, seq{});
+    }
+
 public:
     iterator(void) {}
 
     template <typename... P, CAPO_REQUIRE_(detail_iterator_::Convertible<T, P...>::value)>
     iterator(P&&... args)
         : x_(detail_iterator_::forward<seq::value>(nullptr, std::forward<P>(args)...))
+        , o_(x_)
     {}
 
-    iterator(const tp_t& x)           : x_(x) {}
-    iterator(const tp_t& x, size_t n) : x_(x) { at(n, seq{}); }
+    iterator(const tp_t& x)           : x_(x), o_(x) {}
+    iterator(const tp_t& x, size_t n) : x_(x), o_(x) { at(n, seq{}); }
 
     iterator(const iterator&) = default;
     iterator(iterator&&)      = default;
@@ -114,21 +142,30 @@ public:
     iterator& operator=(iterator rhs)
     {
         x_.swap(rhs.x_);
+        o_.swap(rhs.o_);
         i_ = rhs.i_;
         return (*this);
     }
 
 public:
-    T&       operator*(void)       { return std::get<0>(x_); }
-    const T& operator*(void) const { return std::get<0>(x_); }
+    T operator*(void) const { return std::get<0>(x_); }
+    T operator->(void) const { return std::get<0>(x_); }
 
-    T&       operator->(void)       { return this->operator*(); }
-    const T& operator->(void) const { return this->operator*(); }
+    T operator[](difference_type n) const
+    {
+        return *((*this) + n);
+    }
 
     bool operator==(const iterator& rhs) const { return (this->i_ == rhs.i_); }
     bool operator!=(const iterator& rhs) const { return !operator==(rhs); }
+    bool operator< (const iterator& rhs) const { return (this->i_ <  rhs.i_); }
+    bool operator> (const iterator& rhs) const { return (this->i_ >  rhs.i_); }
+    bool operator<=(const iterator& rhs) const { return (this->i_ <= rhs.i_); }
+    bool operator>=(const iterator& rhs) const { return (this->i_ >= rhs.i_); }
 
-    tp_t& get_tuple(void) { return x_; }
+    tp_t&       get_tuple(void)       { return x_; }
+    const tp_t& get_tuple(void) const { return x_; }
+    size_t index(void) const { return i_; }
 
     iterator& operator++(void)
     {
@@ -155,6 +192,40 @@ public:
         --(*this);
         return old;
     }
+
+    iterator& operator+=(difference_type n)
+    {
+        seek(i_ + static_cast<size_t>(n));
+        return (*this);
+    }
+
+    iterator& operator-=(difference_type n)
+    {
+        seek(i_ - static_cast<size_t>(n));
+        return (*this);
+    }
+
+    iterator operator+(difference_type n) const
+    {
+        iterator r(*this);
+        return r += n;
+    }
+
+    iterator operator-(difference_type n) const
+    {
+        iterator r(*this);
+        return r -= n;
+    }
+
+    friend iterator operator+(difference_type n, const iterator& it)
+    {
+        return it + n;
+    }
+
+    difference_type operator-(const iterator& rhs) const
+    {
+        return static_cast<difference_type>(this->i_ - rhs.i_);
+    }
 };
 
 ////////////////////////////////////////////////////////////////
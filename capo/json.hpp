@@ -0,0 +1,480 @@
+/*
+    The Capo Library
+    Code covered by the MIT License
+
+    Author: mutouyun (http://orzz.org)
+*/
+
+#pragma once
+
+#include "capo/type_traits.hpp"
+#include "capo/concept.hpp"
+#include "capo/noncopyable.hpp"
+#include "capo/printf.hpp"
+#include "capo/format.hpp"
+
+#include <string>       // std::string
+#include <vector>       // std::vector
+#include <utility>      // std::forward, std::move
+#include <type_traits>  // std::is_integral, std::is_floating_point, ...
+#include <iterator>     // std::begin, std::end
+#include <stdexcept>    // std::invalid_argument
+#include <cstdint>      // uint8_t
+#include <cstddef>      // size_t
+#include <cstring>      // std::strlen
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#   include <emmintrin.h> // _mm_loadu_si128, ...
+#   define CAPO_JSON_SSE2_
+#endif
+
+namespace capo {
+
+////////////////////////////////////////////////////////////////
+/// Escape scanning
+////////////////////////////////////////////////////////////////
+
+namespace detail_json {
+
+inline bool need_escape(unsigned char c)
+{
+    return (c < 0x20) || (c == '"') || (c == '\\');
+}
+
+/*
+    Returns the position of the first character needing an escape in [first, last),
+    or last if there is none. Scans 16 bytes at a time with SSE2.
+*/
+
+inline const char* find_escape(const char* first, const char* last)
+{
+#if defined(CAPO_JSON_SSE2_)
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i slash = _mm_set1_epi8('\\');
+    const __m128i ctrl  = _mm_set1_epi8(0x1f);
+    for (; last - first >= 16; first += 16)
+    {
+        __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first));
+        __m128i m = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(x, quote), _mm_cmpeq_epi8(x, slash)),
+                                 _mm_cmpeq_epi8(_mm_max_epu8(x, ctrl), ctrl)); // x <= 0x1f
+        int mask = _mm_movemask_epi8(m);
+        if (mask != 0)
+        {
+#   if defined(_MSC_VER)
+            unsigned long i;
+            _BitScanForward(&i, static_cast<unsigned long>(mask));
+            return first + i;
+#   else
+            return first + __builtin_ctz(static_cast<unsigned>(mask));
+#   endif
+        }
+    }
+#endif/*CAPO_JSON_SSE2_*/
+    for (; first != last; ++first)
+        if (need_escape(static_cast<unsigned char>(*first))) return first;
+    return last;
+}
+
+template <typename B>
+void write_escaped(B& out, const char* s, size_t n)
+{
+    static const char hex[] = "0123456789abcdef";
+    const char* last = s + n;
+    out.push_back('"');
+    for (;;)
+    {
+        const char* p = find_escape(s, last);
+        if (p != s) out.append(s, static_cast<size_t>(p - s));
+        if (p == last) break;
+        char esc[6] = { '\\', 0 };
+        size_t len = 2;
+        switch (*p)
+        {
+        case '"' : esc[1] = '"' ; break;
+        case '\\': esc[1] = '\\'; break;
+        case '\b': esc[1] = 'b' ; break;
+        case '\f': esc[1] = 'f' ; break;
+        case '\n': esc[1] = 'n' ; break;
+        case '\r': esc[1] = 'r' ; break;
+        case '\t': esc[1] = 't' ; break;
+        default:
+            esc[1] = 'u'; esc[2] = '0'; esc[3] = '0';
+            esc[4] = hex[(static_cast<unsigned char>(*p) >> 4) & 0xf];
+            esc[5] = hex[ static_cast<unsigned char>(*p)       & 0xf];
+            len = 6;
+            break;
+        }
+        out.append(esc, len);
+        s = p + 1;
+    }
+    out.push_back('"');
+}
+
+/*
+    Output targets
+*/
+
+CAPO_CONCEPT_TYPING_(can_append , std::declval<T&>().append(static_cast<const char*>(nullptr), size_t{}));
+CAPO_CONCEPT_TYPING_(can_write  , std::declval<T&>().write(static_cast<const void*>(nullptr), 0));
+CAPO_CONCEPT_TYPING_(can_ostream, std::declval<T&>().write(static_cast<const char*>(nullptr), 0).flush());
+
+template <typename F, CAPO_REQUIRE_(can_append<underlying<F>>::value)>
+void emit(F&& out, std::string& buf)
+{
+    out.append(buf.data(), buf.size());
+    buf.clear();
+}
+
+template <typename F, CAPO_REQUIRE_(!can_append<underlying<F>>::value && can_write<underlying<F>>::value)>
+void emit(F&& out, std::string& buf)
+{
+    out.write(buf.data(), buf.size());
+    buf.clear();
+}
+
+template <typename F, CAPO_REQUIRE_(!can_append<underlying<F>>::value && !can_write<underlying<F>>::value &&
+                                     can_ostream<underlying<F>>::value)>
+void emit(F&& out, std::string& buf)
+{
+    out.write(buf.data(), static_cast<std::streamsize>(buf.size()));
+    buf.clear();
+}
+
+template <typename F, CAPO_REQUIRE_(!can_append<underlying<F>>::value && !can_write<underlying<F>>::value &&
+                                    !can_ostream<underlying<F>>::value && capo::is_closure<F>::value)>
+void emit(F&& out, std::string& buf)
+{
+    size_t cap = buf.capacity();
+    out(std::move(buf));
+    buf.clear();
+    buf.reserve(cap);
+}
+
+CAPO_CONCEPT_TYPING_(is_range, std::begin(std::declval<T&>()) != std::end(std::declval<T&>()));
+
+} // namespace detail_json
+
+////////////////////////////////////////////////////////////////
+/// Streaming JSON writer
+////////////////////////////////////////////////////////////////
+
+/*
+    Writes JSON into a reusable buffer, and hands it to the output
+    (a std::string, capo::fixed_buffer, capo::file, std::ostream or a closure taking std::string&&)
+    each time it grows over flush_size, so memory stays bounded for large documents.
+
+    The nesting is checked at runtime (throws std::invalid_argument);
+    use json() to get a scope which checks the nesting at compile time.
+
+    A user type can be written with value(), if it has:
+    <code>
+        void operator()(capo::json_writer<F>& w) const;
+    <code/>
+*/
+
+template <typename F>
+class json_writer : capo::noncopyable
+{
+    enum : uint8_t { in_root, in_object, in_array };
+
+    F                    out_;
+    std::string          buf_;
+    size_t               flush_size_;
+    std::vector<uint8_t> stack_ { in_root };
+    bool                 first_    = true;  // no element in the current level yet
+    bool                 has_key_  = false; // a key is waiting for its value
+
+    static void enforce(const char* what)
+    {
+        throw std::invalid_argument { std::string("Invalid JSON: ") + what + "." };
+    }
+
+    void check_flush(void)
+    {
+        if (buf_.size() >= flush_size_) flush();
+    }
+
+    /*
+        Writes the separator before a value.
+    */
+    void before_value(void)
+    {
+        switch (stack_.back())
+        {
+        case in_object:
+            if (!has_key_) enforce("a key is required before a value in an object");
+            has_key_ = false;
+            break;
+        case in_array:
+            if (!first_) buf_.push_back(',');
+            break;
+        default: // in_root: the documents are separated by new lines
+            if (!first_) buf_.push_back('\n');
+            break;
+        }
+        first_ = false;
+    }
+
+    template <typename T>
+    void write_number(T v)
+    {
+        char str[64];
+        char* end = capo::to_chars(str, str + sizeof(str), v);
+        if (end == nullptr) buf_.append("null", 4);
+        else                buf_.append(str, static_cast<size_t>(end - str));
+    }
+
+    void write_value(std::nullptr_t) { buf_.append("null", 4); }
+
+    void write_value(bool v)
+    {
+        if (v) buf_.append("true" , 4);
+        else   buf_.append("false", 5);
+    }
+
+    template <typename T, CAPO_REQUIRE_(std::is_integral<T>::value && !std::is_same<T, bool>::value)>
+    void write_value(T v) { write_number(v); }
+
+    template <typename T, CAPO_REQUIRE_(std::is_floating_point<T>::value)>
+    void write_value(T v)
+    {
+        // JSON has no NaN or infinity
+        if (v != v || v - v != v - v) buf_.append("null", 4);
+        else write_number(v);
+    }
+
+    void write_value(const char* s)
+    {
+        if (s == nullptr) buf_.append("null", 4);
+        else detail_json::write_escaped(buf_, s, std::strlen(s));
+    }
+
+    void write_value(const std::string& s) { detail_json::write_escaped(buf_, s.data(), s.size()); }
+
+    void open(uint8_t kind, char c)
+    {
+        before_value();
+        buf_.push_back(c);
+        stack_.push_back(kind);
+        first_ = true;
+    }
+
+    void close(uint8_t kind, char c)
+    {
+        if (stack_.back() != kind) enforce("mismatched end of object or array");
+        if (has_key_) enforce("a key has no value");
+        buf_.push_back(c);
+        stack_.pop_back();
+        first_ = false;
+        check_flush();
+    }
+
+public:
+    template <typename T>
+    explicit json_writer(T&& out, size_t flush_size = 4096)
+        : out_(std::forward<T>(out)), flush_size_(flush_size)
+    {
+        buf_.reserve(flush_size_ + 64);
+    }
+
+    ~json_writer(void) { flush(); }
+
+    size_t depth(void) const { return stack_.size() - 1; }
+
+    /*
+        Hands the buffered characters to the output.
+    */
+    void flush(void)
+    {
+        if (buf_.empty()) return;
+        typedef typename std::conditional<std::is_reference<F>::value, F, F&>::type out_t;
+        detail_json::emit(static_cast<out_t>(out_), buf_);
+    }
+
+    json_writer& begin_object(void) { open (in_object, '{'); return *this; }
+    json_writer& end_object  (void) { close(in_object, '}'); return *this; }
+    json_writer& begin_array (void) { open (in_array , '['); return *this; }
+    json_writer& end_array   (void) { close(in_array , ']'); return *this; }
+
+    json_writer& key(const char* k, size_t n)
+    {
+        if (stack_.back() != in_object) enforce("a key must be in an object");
+        if (has_key_) enforce("a key has no value");
+        if (!first_) buf_.push_back(',');
+        detail_json::write_escaped(buf_, k, n);
+        buf_.push_back(':');
+        has_key_ = true;
+        return *this;
+    }
+    json_writer& key(const char* k)        { return key(k, std::strlen(k)); }
+    json_writer& key(const std::string& k) { return key(k.data(), k.size()); }
+
+    /*
+        Writes a JSON text as it is.
+    */
+    json_writer& raw(const char* s, size_t n)
+    {
+        before_value();
+        buf_.append(s, n);
+        check_flush();
+        return *this;
+    }
+
+    template <typename T>
+    auto value(const T& v) -> decltype(std::declval<json_writer&>().write_value(v), std::declval<json_writer&>())
+    {
+        before_value();
+        write_value(v);
+        check_flush();
+        return *this;
+    }
+
+    template <typename T>
+    auto value(const T& v) -> decltype(v(std::declval<json_writer&>()), std::declval<json_writer&>())
+    {
+        v(*this);
+        return *this;
+    }
+
+    template <typename T, CAPO_REQUIRE_(!std::is_convertible<T, const char*>::value &&
+                                        !std::is_convertible<T, std::string>::value &&
+                                         detail_json::is_range<const T>::value)>
+    json_writer& value(const T& v)
+    {
+        begin_array();
+        for (const auto& e : v) value(e);
+        return end_array();
+    }
+
+    template <typename T>
+    json_writer& member(const char* k, const T& v)
+    {
+        key(k);
+        return value(v);
+    }
+};
+
+////////////////////////////////////////////////////////////////
+/// Compile-time checked nesting
+////////////////////////////////////////////////////////////////
+
+namespace detail_json {
+
+struct object_tag {}; // expecting a key
+struct key_tag    {}; // expecting the value of a key
+struct array_tag  {};
+
+template <typename... S>             struct front          { using type = void; };
+template <typename T, typename... S> struct front<T, S...> { using type = T; };
+
+/*
+    The nesting is kept in S... (innermost first), a misuse has no matching member function.
+    The value of a key replaces the key_tag with the object_tag it returns to.
+*/
+
+template <typename W, typename... S>
+class scope;
+
+template <typename W, typename... S>
+struct after_value                              { using type = scope<W, S...>; };
+template <typename W, typename... S>
+struct after_value<W, key_tag, S...>            { using type = scope<W, object_tag, S...>; };
+
+template <typename W, typename... S>
+struct popped {};
+template <typename W, typename T, typename... S>
+struct popped<W, T, S...> : after_value<W, S...> {};
+
+template <typename W, typename... S>
+class scope
+{
+    W* w_;
+
+    using top_t = typename front<S...>::type;
+
+    template <typename U>
+    using can_value = std::integral_constant<bool, std::is_same<U, void     >::value ||
+                                                   std::is_same<U, array_tag>::value ||
+                                                   std::is_same<U, key_tag  >::value>;
+
+public:
+    explicit scope(W* w) : w_(w) {}
+
+    W& writer(void) const { return *w_; }
+
+    template <typename T, typename U = top_t, CAPO_REQUIRE_(can_value<U>::value)>
+    typename after_value<W, S...>::type value(const T& v)
+    {
+        w_->value(v);
+        return typename after_value<W, S...>::type { w_ };
+    }
+
+    template <typename U = top_t, CAPO_REQUIRE_(can_value<U>::value)>
+    scope<W, object_tag, S...> object(void)
+    {
+        w_->begin_object();
+        return scope<W, object_tag, S...> { w_ };
+    }
+
+    template <typename U = top_t, CAPO_REQUIRE_(can_value<U>::value)>
+    scope<W, array_tag, S...> array(void)
+    {
+        w_->begin_array();
+        return scope<W, array_tag, S...> { w_ };
+    }
+
+    template <typename K, typename U = top_t, CAPO_REQUIRE_(std::is_same<U, object_tag>::value)>
+    scope<W, key_tag, S...> key(const K& k)
+    {
+        w_->key(k);
+        return scope<W, key_tag, S...> { w_ };
+    }
+
+    template <typename T, typename U = top_t, CAPO_REQUIRE_(std::is_same<U, object_tag>::value)>
+    scope member(const char* k, const T& v)
+    {
+        w_->key(k);
+        w_->value(v);
+        return *this;
+    }
+
+    /*
+        Ends the object or the array, and returns to the enclosing scope.
+    */
+    template <typename U = top_t, typename P = popped<W, S...>, CAPO_REQUIRE_(std::is_same<U, object_tag>::value)>
+    typename P::type end(void)
+    {
+        w_->end_object();
+        return typename P::type { w_ };
+    }
+
+    template <typename U = top_t, typename P = popped<W, S...>, CAPO_REQUIRE_(std::is_same<U, array_tag>::value)>
+    typename P::type end(void)
+    {
+        w_->end_array();
+        return typename P::type { w_ };
+    }
+};
+
+} // namespace detail_json
+
+template <typename W, typename... S>
+using json_scope = detail_json::scope<W, S...>;
+
+/*
+    <code>
+        capo::json_writer<std::string&> w { str };
+        capo::json(w).object()
+                         .member("id", 1)
+                         .key("tags").array().value("a").value("b").end()
+                     .end();
+    <code/>
+*/
+
+template <typename W>
+json_scope<W> json(W& w)
+{
+    return json_scope<W> { &w };
+}
+
+} // namespace capo
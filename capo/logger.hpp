@@ -0,0 +1,847 @@
+/*
+    The Capo Library
+    Code covered by the MIT License
+
+    Author: mutouyun (http://orzz.org)
+*/
+
+#pragma once
+
+#include "capo/detect_plat.hpp"
+#include "capo/noncopyable.hpp"
+#include "capo/spin_lock.hpp"
+#include "capo/thread_local_ptr.hpp"
+#include "capo/printf.hpp"
+#include "capo/format.hpp"
+
+#include <string>       // std::string
+#include <vector>       // std::vector
+#include <memory>       // std::shared_ptr, std::make_shared
+#include <tuple>        // std::tuple, std::get
+#include <utility>      // std::forward, std::index_sequence
+#include <type_traits>  // std::decay, std::is_trivially_copyable, ...
+#include <atomic>       // std::atomic
+#include <thread>       // std::thread
+#include <mutex>        // std::mutex, std::lock_guard
+#include <condition_variable> // std::condition_variable
+#include <chrono>       // std::chrono
+#include <stdexcept>    // std::exception
+#include <cstdint>      // uint64_t, uint32_t, uint8_t, uintptr_t
+#include <cstddef>      // size_t
+#include <cstring>      // std::memcpy, std::strlen
+#include <cwchar>       // std::wcslen
+#include <cstdio>       // std::fopen, std::rename, std::remove
+#include <ctime>        // std::time_t, std::tm
+#include <algorithm>    // std::min
+
+#if !defined(CAPO_OS_WIN_)
+#   include <fcntl.h>   // ::open
+#   include <unistd.h>  // ::close, ::write
+#   include <sys/uio.h> // ::writev, struct iovec
+#   include <climits>   // IOV_MAX
+#   include <cerrno>    // errno, EINTR
+#endif/*!CAPO_OS_WIN_*/
+
+namespace capo {
+
+////////////////////////////////////////////////////////////////
+/// Severity levels
+////////////////////////////////////////////////////////////////
+
+enum class log_level : uint8_t
+{
+    trace = 0, debug, info, warn, error, fatal, off
+};
+
+/*
+    The records under CAPO_LOG_LEVEL_ are compiled out.
+    Define it (as an integer of log_level) before including this file to override.
+*/
+
+#if !defined(CAPO_LOG_LEVEL_)
+#if defined(NDEBUG)
+#   define CAPO_LOG_LEVEL_ 2 /* log_level::info  */
+#else /*!NDEBUG*/
+#   define CAPO_LOG_LEVEL_ 0 /* log_level::trace */
+#endif/*!NDEBUG*/
+#endif/*!CAPO_LOG_LEVEL_*/
+
+inline const char* log_level_name(log_level lv)
+{
+    static const char* const names[] =
+    {
+        "TRACE", "DEBUG", "INFO ", "WARN ", "ERROR", "FATAL", "OFF  "
+    };
+    return names[static_cast<size_t>(lv) % (sizeof(names) / sizeof(names[0]))];
+}
+
+////////////////////////////////////////////////////////////////
+/// Log file with rotation
+////////////////////////////////////////////////////////////////
+
+/*
+    If rotate_size > 0, when the file would exceed rotate_size bytes,
+    "path" is renamed to "path.1" ("path.1" to "path.2", ...), at most rotate_count files are kept,
+    and a new "path" is created.
+*/
+
+class log_file : capo::noncopyable
+{
+public:
+    struct chunk
+    {
+        const char* data_;
+        size_t      size_;
+    };
+
+private:
+    std::string path_;
+    size_t      rotate_size_  = 0;
+    size_t      rotate_count_ = 0;
+    size_t      size_         = 0;
+    bool        owned_        = false;
+#if defined(CAPO_OS_WIN_)
+    std::FILE*  fd_ = nullptr;
+#else /*!CAPO_OS_WIN_*/
+    int         fd_ = -1;
+#endif/*!CAPO_OS_WIN_*/
+
+    bool open_file(void)
+    {
+#if defined(CAPO_OS_WIN_)
+        fd_ = std::fopen(path_.c_str(), "ab");
+        if (fd_ == nullptr) return false;
+        std::fseek(fd_, 0, SEEK_END);
+        size_ = static_cast<size_t>(std::ftell(fd_));
+#else /*!CAPO_OS_WIN_*/
+        fd_ = ::open(path_.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+        if (fd_ < 0) return false;
+        off_t s = ::lseek(fd_, 0, SEEK_END);
+        size_ = (s < 0) ? 0 : static_cast<size_t>(s);
+#endif/*!CAPO_OS_WIN_*/
+        owned_ = true;
+        return true;
+    }
+
+    void close_file(void)
+    {
+        if (!owned_) return;
+#if defined(CAPO_OS_WIN_)
+        if (fd_ != nullptr) std::fclose(fd_);
+        fd_ = nullptr;
+#else /*!CAPO_OS_WIN_*/
+        if (fd_ >= 0) ::close(fd_);
+        fd_ = -1;
+#endif/*!CAPO_OS_WIN_*/
+        owned_ = false;
+    }
+
+    void rotate(void)
+    {
+        close_file();
+        if (rotate_count_ == 0)
+            std::remove(path_.c_str());
+        else
+        {
+            std::remove((path_ + "." + std::to_string(rotate_count_)).c_str());
+            for (size_t i = rotate_count_ - 1; i > 0; --i)
+                std::rename((path_ + "." + std::to_string(i)).c_str(),
+                            (path_ + "." + std::to_string(i + 1)).c_str());
+            std::rename(path_.c_str(), (path_ + ".1").c_str());
+        }
+        open_file();
+        size_ = 0;
+    }
+
+    bool write_chunks(const chunk* cks, size_t n)
+    {
+#if defined(CAPO_OS_WIN_)
+        for (size_t i = 0; i < n; ++i)
+        {
+            if (std::fwrite(cks[i].data_, 1, cks[i].size_, fd_) != cks[i].size_) return false;
+            size_ += cks[i].size_;
+        }
+        return std::fflush(fd_) == 0;
+#else /*!CAPO_OS_WIN_*/
+        static const size_t iov_max =
+#   if defined(IOV_MAX)
+            IOV_MAX;
+#   else
+            16;
+#   endif
+        ::iovec iov[64];
+        while (n > 0)
+        {
+            size_t k = (std::min)(n, (std::min)(iov_max, sizeof(iov) / sizeof(iov[0])));
+            size_t total = 0;
+            for (size_t i = 0; i < k; ++i)
+            {
+                iov[i].iov_base = const_cast<char*>(cks[i].data_);
+                iov[i].iov_len  = cks[i].size_;
+                total += cks[i].size_;
+            }
+            ::iovec* p = iov;
+            size_t   c = k;
+            while (total > 0)
+            {
+                ssize_t r = ::writev(fd_, p, static_cast<int>(c));
+                if (r < 0)
+                {
+                    if (errno == EINTR) continue; // interrupted before anything was written
+                    return false;
+                }
+                if (r == 0) return false;
+                size_ += static_cast<size_t>(r);
+                total -= static_cast<size_t>(r);
+                // partial write: skip the written parts
+                while (c > 0 && static_cast<size_t>(r) >= p->iov_len)
+                {
+                    r -= static_cast<ssize_t>(p->iov_len);
+                    ++p; --c;
+                }
+                if (c > 0)
+                {
+                    p->iov_base = static_cast<char*>(p->iov_base) + r;
+                    p->iov_len -= static_cast<size_t>(r);
+                }
+            }
+            cks += k;
+            n   -= k;
+        }
+        return true;
+#endif/*!CAPO_OS_WIN_*/
+    }
+
+public:
+    /*
+        Writes to the standard output.
+    */
+    log_file(void)
+#if defined(CAPO_OS_WIN_)
+        : fd_(stdout)
+#else /*!CAPO_OS_WIN_*/
+        : fd_(STDOUT_FILENO)
+#endif/*!CAPO_OS_WIN_*/
+    {}
+
+    explicit log_file(std::string path, size_t rotate_size = 0, size_t rotate_count = 0)
+        : path_(std::move(path)), rotate_size_(rotate_size), rotate_count_(rotate_count)
+    {
+        open_file();
+    }
+
+    ~log_file(void) { close_file(); }
+
+    bool   valid(void) const { return owned_ || path_.empty(); }
+    size_t size (void) const { return size_; }
+
+    /*
+        Writes the chunks in batches (a chunk will never be split by a rotation).
+    */
+    bool write(const chunk* cks, size_t n)
+    {
+        if (!valid()) return false;
+        if (rotate_size_ == 0 || path_.empty())
+            return write_chunks(cks, n);
+        while (n > 0)
+        {
+            if (size_ > 0 && size_ + cks[0].size_ > rotate_size_)
+            {
+                rotate();
+                if (!valid()) return false;
+            }
+            size_t k = 0, s = size_;
+            while (k < n && (k == 0 || s + cks[k].size_ <= rotate_size_))
+                s += cks[k++].size_;
+            if (!write_chunks(cks, k)) return false;
+            cks += k;
+            n   -= k;
+        }
+        return true;
+    }
+};
+
+////////////////////////////////////////////////////////////////
+/// Records & per-thread rings
+////////////////////////////////////////////////////////////////
+
+namespace detail_log {
+
+/*
+    Arguments are copied into the ring in binary, so they must be trivially copyable.
+    Strings are copied with their contents, and are read back as const char* (const wchar_t*).
+    A wide string is aligned for wchar_t, the padding is reserved as a part of its fixed size.
+*/
+
+template <typename T, typename U = typename std::decay<T>::type>
+struct is_string : std::integral_constant<bool,
+                   std::is_same<U, char*>::value || std::is_same<U, const char*>::value ||
+                   std::is_same<U, std::string>::value>
+{};
+
+template <typename T, typename U = typename std::decay<T>::type>
+struct is_wstring : std::integral_constant<bool,
+                    std::is_same<U, wchar_t*>::value || std::is_same<U, const wchar_t*>::value ||
+                    std::is_same<U, std::wstring>::value>
+{};
+
+template <typename T>
+struct is_text : std::integral_constant<bool, is_string<T>::value || is_wstring<T>::value> {};
+
+template <typename T>
+using packed_t = typename std::conditional<is_string<T>::value, const char*,
+                 typename std::conditional<is_wstring<T>::value, const wchar_t*,
+                 typename std::decay<T>::type>::type>::type;
+
+template <typename T>
+struct fixed_size : std::integral_constant<size_t, is_text<T>::value ? 0 : sizeof(packed_t<T>)> {};
+
+/* The bytes of a string besides its contents: the terminator, and the padding of a wide string */
+template <typename T>
+struct str_extra : std::integral_constant<size_t, is_string <T>::value ? 1 :
+                                                  is_wstring<T>::value ? sizeof(wchar_t) + alignof(wchar_t) - 1 : 0>
+{};
+
+template <typename... T> struct str_count;
+template <>              struct str_count<> : std::integral_constant<size_t, 0> {};
+template <typename T1, typename... T>
+struct str_count<T1, T...> : std::integral_constant<size_t, str_extra<T1>::value + str_count<T...>::value> {};
+
+template <typename... T> struct sum_size;
+template <>              struct sum_size<> : std::integral_constant<size_t, 0> {};
+template <typename T1, typename... T>
+struct sum_size<T1, T...> : std::integral_constant<size_t, fixed_size<T1>::value + sum_size<T...>::value> {};
+
+inline size_t str_len(const char* s)            { return (s == nullptr) ? 0 : std::strlen(s); }
+inline size_t str_len(const std::string& s)     { return s.size(); }
+inline size_t str_len(const wchar_t* s)         { return (s == nullptr) ? 0 : std::wcslen(s); }
+inline size_t str_len(const std::wstring& s)    { return s.size(); }
+inline const char*    str_ptr(const char* s)            { return (s == nullptr) ? "" : s; }
+inline const char*    str_ptr(const std::string& s)     { return s.c_str(); }
+inline const wchar_t* str_ptr(const wchar_t* s)         { return (s == nullptr) ? L"" : s; }
+inline const wchar_t* str_ptr(const std::wstring& s)    { return s.c_str(); }
+
+template <typename C>
+inline C* align_for_wchar(C* p)
+{
+    auto a = reinterpret_cast<uintptr_t>(p);
+    return p + ((alignof(wchar_t) - a % alignof(wchar_t)) % alignof(wchar_t));
+}
+
+template <typename T, CAPO_REQUIRE_(is_string<T>::value)>
+inline size_t want(T&& a) { return str_len(a) + 1; }
+
+template <typename T, CAPO_REQUIRE_(is_wstring<T>::value)>
+inline size_t want(T&& a) { return str_len(a) * sizeof(wchar_t) + str_extra<T>::value; }
+
+template <typename T, CAPO_REQUIRE_(!is_text<T>::value)>
+inline size_t want(T&&) { return sizeof(packed_t<T>); }
+
+struct writer
+{
+    char*  cur_;
+    size_t str_room_; // bytes left for the string contents
+
+    template <typename T, CAPO_REQUIRE_(is_string<T>::value)>
+    void put(T&& a)
+    {
+        size_t n = (std::min)(str_len(a), str_room_);
+        std::memcpy(cur_, str_ptr(a), n);
+        cur_[n] = '\0';
+        cur_      += n + 1;
+        str_room_ -= n;
+    }
+
+    template <typename T, CAPO_REQUIRE_(is_wstring<T>::value)>
+    void put(T&& a)
+    {
+        size_t n = (std::min)(str_len(a), str_room_ / sizeof(wchar_t));
+        const wchar_t zero = 0;
+        cur_ = align_for_wchar(cur_);
+        std::memcpy(cur_, str_ptr(a), n * sizeof(wchar_t));
+        std::memcpy(cur_ + n * sizeof(wchar_t), &zero, sizeof(wchar_t));
+        cur_      += (n + 1) * sizeof(wchar_t);
+        str_room_ -= n * sizeof(wchar_t);
+    }
+
+    template <typename T, CAPO_REQUIRE_(!is_text<T>::value)>
+    void put(T&& a)
+    {
+        static_assert(std::is_trivially_copyable<packed_t<T>>::value,
+                      "The arguments of log should be trivially copyable, or strings.");
+        packed_t<T> v(a);
+        std::memcpy(cur_, &v, sizeof(v));
+        cur_ += sizeof(v);
+    }
+};
+
+struct reader
+{
+    const char* cur_;
+
+    template <typename T>
+    typename std::enable_if<std::is_same<T, const char*>::value, T>::type get(void)
+    {
+        const char* s = cur_;
+        cur_ += std::strlen(s) + 1;
+        return s;
+    }
+
+    template <typename T>
+    typename std::enable_if<std::is_same<T, const wchar_t*>::value, T>::type get(void)
+    {
+        cur_ = align_for_wchar(cur_);
+        auto s = reinterpret_cast<const wchar_t*>(cur_);
+        cur_ += (std::wcslen(s) + 1) * sizeof(wchar_t);
+        return s;
+    }
+
+    template <typename T>
+    typename std::enable_if<!std::is_same<T, const char*>::value &&
+                            !std::is_same<T, const wchar_t*>::value, T>::type get(void)
+    {
+        T v;
+        std::memcpy(&v, cur_, sizeof(v));
+        cur_ += sizeof(v);
+        return v;
+    }
+};
+
+/*
+    A padding record may be only 16 bytes, so size_ and format_ must be in the first 16 bytes.
+*/
+
+struct record
+{
+    typedef bool (*format_t)(std::string&, const char*, const char*);
+
+    uint32_t    size_;   // total bytes of this record, aligned
+    log_level   level_;
+    format_t    format_; // nullptr means a wrap-around padding
+    const char* fmt_;
+    uint64_t    time_;   // nanoseconds since epoch
+};
+
+template <typename Tp, std::size_t... I>
+inline bool format_tuple(std::string& out, const char* fmt, Tp& args, std::index_sequence<I...>)
+{
+    detail_printf_::verify(fmt, std::get<I>(args)...);
+    return detail_format::format(out, fmt, std::get<I>(args)...);
+}
+
+template <typename... P>
+bool format_record(std::string& out, const char* fmt, const char* data)
+{
+    reader rd { data };
+    std::tuple<P...> args { rd.get<P>()... }; // braced-init-list keeps the order
+    static_cast<void>(rd);
+    try
+    {
+        return format_tuple(out, fmt, args, std::index_sequence_for<P...>{});
+    }
+    catch (const std::exception& e)
+    {
+        out.append("<bad format: ");
+        out.append(e.what());
+        out.push_back('>');
+        return false;
+    }
+}
+
+constexpr size_t align16(size_t n) { return (n + 15) & ~size_t(15); }
+
+/*
+    A single-producer/single-consumer byte ring.
+    Records are stored contiguously, a padding record fills the tail when wrapping around.
+*/
+
+class ring : capo::noncopyable
+{
+    alignas(64) std::atomic<size_t> tail_ { 0 }; // written by the producer
+    size_t head_cache_ = 0;
+
+    alignas(64) std::atomic<size_t> head_ { 0 }; // written by the consumer
+
+    alignas(64) std::vector<char> buff_;
+    size_t              mask_;
+
+public:
+    std::atomic<bool>   closed_ { false };
+    uint32_t            id_;
+
+    ring(size_t size, uint32_t id)
+        : id_(id)
+    {
+        size_t s = 4096;
+        while (s < size) s <<= 1;
+        buff_.resize(s);
+        mask_ = s - 1;
+    }
+
+    size_t capacity   (void) const { return buff_.size(); }
+    size_t max_record (void) const { return buff_.size() / 4; }
+
+    bool empty(void) const
+    {
+        return head_.load(std::memory_order_acquire) == tail_.load(std::memory_order_acquire);
+    }
+
+    /*
+        Producer side: returns the storage for a record of n bytes, or nullptr if full.
+    */
+    char* prepare(size_t n)
+    {
+        size_t t   = tail_.load(std::memory_order_relaxed);
+        size_t pos = t & mask_;
+        size_t pad = (buff_.size() - pos < n) ? (buff_.size() - pos) : 0;
+        if (t + pad + n - head_cache_ > buff_.size())
+        {
+            head_cache_ = head_.load(std::memory_order_acquire);
+            if (t + pad + n - head_cache_ > buff_.size()) return nullptr;
+        }
+        if (pad > 0)
+        {
+            auto r = reinterpret_cast<record*>(&buff_[pos]);
+            r->format_ = nullptr;
+            r->size_   = static_cast<uint32_t>(pad);
+            tail_.store(t + pad, std::memory_order_release);
+            pos = 0;
+        }
+        return &buff_[pos];
+    }
+
+    void commit(size_t n)
+    {
+        tail_.store(tail_.load(std::memory_order_relaxed) + n, std::memory_order_release);
+    }
+
+    /*
+        Consumer side: calls f(const record&) for each available record.
+    */
+    template <typename F>
+    size_t consume(F&& f)
+    {
+        size_t h = head_.load(std::memory_order_relaxed);
+        size_t t = tail_.load(std::memory_order_acquire);
+        size_t n = 0;
+        while (h != t)
+        {
+            auto r = reinterpret_cast<const record*>(&buff_[h & mask_]);
+            if (r->format_ != nullptr)
+            {
+                f(*r);
+                ++n;
+            }
+            h += r->size_;
+        }
+        head_.store(h, std::memory_order_release);
+        return n;
+    }
+};
+
+/*
+    Owned by thread_local_ptr, marks the ring as closed when the thread exits.
+*/
+
+struct producer
+{
+    std::shared_ptr<ring> ring_;
+
+    ~producer(void) { ring_->closed_.store(true, std::memory_order_release); }
+};
+
+} // namespace detail_log
+
+namespace use
+{
+    /*
+        The policies when a ring is full.
+    */
+    struct log_drop  { enum : bool { blocking = false }; };
+    struct log_block { enum : bool { blocking = true  }; };
+}
+
+////////////////////////////////////////////////////////////////
+/// Asynchronous logger
+////////////////////////////////////////////////////////////////
+
+/*
+    Producers copy the format pointer and the arguments into their per-thread ring,
+    a background thread formats the records and writes them in batches.
+
+    <Remarks>
+    1. The format string must have static storage duration (a string literal).
+    2. Strings (const char*, std::string) are copied; too long strings are truncated
+       to fit ring_size / 4.
+    3. Records of the same thread keep their order.
+*/
+
+template <typename PolicyT = use::log_drop>
+class logger : capo::noncopyable
+{
+    log_file                    file_;
+    size_t                      ring_size_;
+    std::atomic<uint8_t>        level_ { static_cast<uint8_t>(CAPO_LOG_LEVEL_) };
+
+    capo::thread_local_ptr<detail_log::producer> local_;
+    capo::spin_lock                              rings_lc_;
+    std::vector<std::shared_ptr<detail_log::ring>> rings_;
+    uint32_t                                     next_id_ = 0;
+    capo::spin_lock                              shared_lc_;
+    std::shared_ptr<detail_log::ring>            shared_;  // if local_ is invalid, see shared_ring()
+
+    std::mutex                  drain_lc_;
+    std::vector<std::shared_ptr<detail_log::ring>> snapshot_;
+    std::string                 text_;
+    std::vector<size_t>         ends_;
+    std::vector<log_file::chunk> chunks_;
+    std::time_t                 stamp_sec_ = -1;
+    char                        stamp_[32] = {};
+    std::atomic<size_t>         written_ { 0 };
+    std::atomic<size_t>         dropped_ { 0 };
+
+    std::mutex                  wait_lc_;
+    std::condition_variable     wait_cv_;
+    std::atomic<bool>           quit_ { false };
+    std::thread                 worker_;
+
+    detail_log::ring* local_ring(void)
+    {
+        detail_log::producer* p = local_;
+        if (p != nullptr) return p->ring_.get();
+        p = new detail_log::producer;
+        {
+            std::lock_guard<capo::spin_lock> guard { rings_lc_ };
+            p->ring_ = std::make_shared<detail_log::ring>(ring_size_, next_id_++);
+            rings_.push_back(p->ring_);
+        }
+        local_ = p;
+        return p->ring_.get();
+    }
+
+    /*
+        If the thread-local key could not be created,
+        all threads write into one ring, under shared_lc_.
+    */
+    detail_log::ring* shared_ring(void)
+    {
+        std::lock_guard<capo::spin_lock> guard { rings_lc_ };
+        if (!shared_)
+        {
+            shared_ = std::make_shared<detail_log::ring>(ring_size_, next_id_++);
+            rings_.push_back(shared_);
+        }
+        return shared_.get();
+    }
+
+    template <typename... A>
+    bool push(log_level lv, const char* fmt, A&&... args)
+    {
+        if (fmt == nullptr) return true;
+        if (local_.valid()) return push(local_ring(), lv, fmt, std::forward<A>(args)...);
+        std::lock_guard<capo::spin_lock> guard { shared_lc_ };
+        return push(shared_ring(), lv, fmt, std::forward<A>(args)...);
+    }
+
+    template <typename... A>
+    bool push(detail_log::ring* rg, log_level lv, const char* fmt, A&&... args)
+    {
+        using namespace detail_log;
+        size_t wants[] = { 0, want(args)... };
+        size_t need = 0;
+        for (size_t w : wants) need += w;
+        size_t fixed = sum_size<A...>::value + str_count<A...>::value;
+        size_t limit = rg->max_record() - sizeof(record);
+        if (fixed > limit)
+        {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        if (need > limit) need = limit;
+        size_t n = align16(sizeof(record) + need);
+
+        char* mem = rg->prepare(n);
+        if (mem == nullptr)
+        {
+            if (!PolicyT::blocking)
+            {
+                dropped_.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+            wait_cv_.notify_one();
+            for (unsigned k = 0; (mem = rg->prepare(n)) == nullptr; ++k)
+                detail_spin_lock::yield(k);
+        }
+        auto rc = reinterpret_cast<record*>(mem);
+        rc->format_ = &format_record<packed_t<A>...>;
+        rc->fmt_    = fmt;
+        rc->time_   = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                          std::chrono::system_clock::now().time_since_epoch()).count());
+        rc->size_   = static_cast<uint32_t>(n);
+        rc->level_  = lv;
+        writer wt { mem + sizeof(record), need - fixed };
+        int unused[] = { 0, (wt.put(std::forward<A>(args)), 0)... };
+        static_cast<void>(unused);
+        static_cast<void>(wt);
+        rg->commit(n);
+        return true;
+    }
+
+    template <typename... A>
+    bool log_(std::false_type, log_level, const char*, A&&...) { return true; }
+
+    template <typename... A>
+    bool log_(std::true_type, log_level lv, const char* fmt, A&&... args)
+    {
+        if (static_cast<uint8_t>(lv) < level_.load(std::memory_order_relaxed)) return true;
+        return push(lv, fmt, std::forward<A>(args)...);
+    }
+
+    void append_head(const detail_log::record& rc, uint32_t id)
+    {
+        std::time_t sec = static_cast<std::time_t>(rc.time_ / 1000000000);
+        if (sec != stamp_sec_)
+        {
+            std::tm tm {};
+#if defined(CAPO_OS_WIN_)
+            ::localtime_s(&tm, &sec);
+#else /*!CAPO_OS_WIN_*/
+            ::localtime_r(&sec, &tm);
+#endif/*!CAPO_OS_WIN_*/
+            std::strftime(stamp_, sizeof(stamp_), "%Y-%m-%d %H:%M:%S", &tm);
+            stamp_sec_ = sec;
+        }
+        detail_format::format(text_, "%s.%06u %s [%u] ", stamp_,
+                              static_cast<unsigned>((rc.time_ / 1000) % 1000000),
+                              log_level_name(rc.level_), static_cast<unsigned>(id));
+    }
+
+    /*
+        Formats all pending records, and writes them out.
+    */
+    size_t drain(void)
+    {
+        std::lock_guard<std::mutex> guard { drain_lc_ };
+        {
+            std::lock_guard<capo::spin_lock> guard { rings_lc_ };
+            snapshot_.assign(rings_.begin(), rings_.end());
+            // a closed ring can be removed after it has been drained
+            for (size_t i = 0; i < rings_.size();)
+            {
+                if (rings_[i]->closed_.load(std::memory_order_acquire) && rings_[i]->empty())
+                {
+                    rings_[i] = std::move(rings_.back());
+                    rings_.pop_back();
+                }
+                else ++i;
+            }
+        }
+        text_.clear();
+        ends_.clear();
+        size_t count = 0;
+        for (auto& rg : snapshot_)
+        {
+            uint32_t id = rg->id_;
+            count += rg->consume([&](const detail_log::record& rc)
+            {
+                append_head(rc, id);
+                rc.format_(text_, rc.fmt_, reinterpret_cast<const char*>(&rc + 1));
+                text_.push_back('\n');
+                ends_.push_back(text_.size());
+            });
+        }
+        snapshot_.clear();
+        if (count == 0) return 0;
+        // the chunks must be built after formatting, since text_ may be reallocated
+        chunks_.clear();
+        size_t beg = 0;
+        for (size_t end : ends_)
+        {
+            chunks_.push_back({ text_.data() + beg, end - beg });
+            beg = end;
+        }
+        file_.write(chunks_.data(), chunks_.size());
+        written_.fetch_add(count, std::memory_order_release);
+        return count;
+    }
+
+    void run(void)
+    {
+        while (!quit_.load(std::memory_order_acquire))
+        {
+            if (drain() > 0) continue;
+            std::unique_lock<std::mutex> guard { wait_lc_ };
+            wait_cv_.wait_for(guard, std::chrono::milliseconds(1));
+        }
+        drain();
+    }
+
+public:
+    /*
+        Writes to the standard output.
+    */
+    explicit logger(size_t ring_size = 64 * 1024)
+        : ring_size_(ring_size)
+        , worker_([this] { run(); })
+    {}
+
+    /*
+        Writes to a file, see log_file for the rotation parameters.
+    */
+    explicit logger(std::string path, size_t rotate_size = 0, size_t rotate_count = 0,
+                    size_t ring_size = 64 * 1024)
+        : file_(std::move(path), rotate_size, rotate_count)
+        , ring_size_(ring_size)
+        , worker_([this] { run(); })
+    {}
+
+    ~logger(void)
+    {
+        quit_.store(true, std::memory_order_release);
+        wait_cv_.notify_one();
+        if (worker_.joinable()) worker_.join();
+    }
+
+    bool valid(void) const { return file_.valid(); }
+
+    void set_level(log_level lv) { level_.store(static_cast<uint8_t>(lv), std::memory_order_relaxed); }
+    log_level level(void) const  { return static_cast<log_level>(level_.load(std::memory_order_relaxed)); }
+
+    /*
+        The number of records written out, and the number of records dropped by use::log_drop.
+    */
+    size_t written(void) const { return written_.load(std::memory_order_acquire); }
+    size_t dropped(void) const { return dropped_.load(std::memory_order_relaxed); }
+
+    /*
+        Writes out all the records pushed before this call.
+    */
+    void flush(void) { drain(); }
+
+    template <log_level L, typename... A>
+    bool log(const char* fmt, A&&... args)
+    {
+        return log_(std::integral_constant<bool, (static_cast<int>(L) >= CAPO_LOG_LEVEL_)>{},
+                    L, fmt, std::forward<A>(args)...);
+    }
+
+    template <typename... A> bool trace(const char* fmt, A&&... args) { return log<log_level::trace>(fmt, std::forward<A>(args)...); }
+    template <typename... A> bool debug(const char* fmt, A&&... args) { return log<log_level::debug>(fmt, std::forward<A>(args)...); }
+    template <typename... A> bool info (const char* fmt, A&&... args) { return log<log_level::info >(fmt, std::forward<A>(args)...); }
+    template <typename... A> bool warn (const char* fmt, A&&... args) { return log<log_level::warn >(fmt, std::forward<A>(args)...); }
+    template <typename... A> bool error(const char* fmt, A&&... args) { return log<log_level::error>(fmt, std::forward<A>(args)...); }
+    template <typename... A> bool fatal(const char* fmt, A&&... args) { return log<log_level::fatal>(fmt, std::forward<A>(args)...); }
+};
+
+/*
+    Like logger::log, but the arguments are not evaluated if the level is compiled out.
+*/
+
+#define CAPO_LOG_(LOGGER, LEVEL, ...)                                                \
+    do                                                                               \
+    {                                                                                \
+        if (static_cast<int>(capo::log_level::LEVEL) >= CAPO_LOG_LEVEL_)             \
+            (LOGGER).template log<capo::log_level::LEVEL>(__VA_ARGS__);              \
+    } while(false)
+
+} // namespace capo
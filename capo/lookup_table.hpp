@@ -0,0 +1,196 @@
+/*
+    The Capo Library
+    Code covered by the MIT License
+
+    Author: mutouyun (http://orzz.org)
+*/
+
+#pragma once
+
+#include "capo/constant_array.hpp"
+
+#include <array>    // std::array
+#include <cstddef>  // size_t
+#include <cstdint>  // uint8_t, uint32_t, int8_t
+
+namespace capo {
+
+/*
+    The lookup tables generated at compile-time (by capo::make_array), in capo::lookup_table.
+    Each table is a static constexpr std::array member in .rodata, e.g. crc32<>::value,
+    digits::digits2 / lower / upper / value, base64<>::encode / decode.
+*/
+
+////////////////////////////////////////////////////////////////
+/// CRC-32
+////////////////////////////////////////////////////////////////
+
+namespace detail_lookup_table {
+
+template <uint32_t PolyN>
+struct crc32_entry
+{
+    constexpr uint32_t operator()(size_t i) const
+    {
+        uint32_t c = static_cast<uint32_t>(i);
+        for (int k = 0; k < 8; ++k)
+            c = (c & 1) ? (PolyN ^ (c >> 1)) : (c >> 1);
+        return c;
+    }
+};
+
+} // namespace detail_lookup_table
+
+namespace lookup_table {
+
+/* The reflected polynomial, 0xedb88320 is the one of zlib, png, ethernet... */
+
+template <uint32_t PolyN = 0xedb88320>
+struct crc32
+{
+    static constexpr std::array<uint32_t, 256> value = make_array<256>(detail_lookup_table::crc32_entry<PolyN> {});
+
+    static uint32_t update(uint32_t crc, const void* data, size_t size)
+    {
+        auto p = static_cast<const uint8_t*>(data);
+        crc = ~crc;
+        for (size_t i = 0; i < size; ++i)
+            crc = value[(crc ^ p[i]) & 0xff] ^ (crc >> 8);
+        return ~crc;
+    }
+};
+
+template <uint32_t PolyN>
+constexpr std::array<uint32_t, 256> crc32<PolyN>::value;
+
+} // namespace lookup_table
+
+////////////////////////////////////////////////////////////////
+/// Popcount of bytes
+////////////////////////////////////////////////////////////////
+
+namespace detail_lookup_table {
+
+constexpr uint8_t popcount_entry(size_t i)
+{
+    return static_cast<uint8_t>((i == 0) ? 0 : (i & 1) + popcount_entry(i >> 1));
+}
+
+} // namespace detail_lookup_table
+
+namespace lookup_table {
+
+template <typename = void>
+struct popcount8_
+{
+    static constexpr std::array<uint8_t, 256> value = make_array<256>(detail_lookup_table::popcount_entry);
+};
+
+template <typename T>
+constexpr std::array<uint8_t, 256> popcount8_<T>::value;
+
+using popcount8 = popcount8_<>;
+
+} // namespace lookup_table
+
+////////////////////////////////////////////////////////////////
+/// Digits
+////////////////////////////////////////////////////////////////
+
+namespace detail_lookup_table {
+
+/* "00010203...9899", two digits at a time */
+constexpr char digits2_entry(size_t i)
+{
+    return static_cast<char>('0' + (((i & 1) == 0) ? (i / 20) : (i / 2 % 10)));
+}
+
+template <bool UpperN>
+struct xdigit_entry
+{
+    constexpr char operator()(size_t i) const
+    {
+        return static_cast<char>((i < 10) ? ('0' + i) : ((UpperN ? 'A' : 'a') + i - 10));
+    }
+};
+
+/* The value of a hex digit, or -1 */
+constexpr int8_t xvalue_entry(size_t c)
+{
+    return static_cast<int8_t>(((c >= '0') && (c <= '9')) ? (c - '0')      :
+                               ((c >= 'a') && (c <= 'f')) ? (c - 'a' + 10) :
+                               ((c >= 'A') && (c <= 'F')) ? (c - 'A' + 10) : -1);
+}
+
+} // namespace detail_lookup_table
+
+namespace lookup_table {
+
+template <typename = void>
+struct digits_
+{
+    static constexpr std::array<char, 200> digits2 = make_array<200>(detail_lookup_table::digits2_entry);
+    static constexpr std::array<char, 16>  lower   = make_array<16> (detail_lookup_table::xdigit_entry<false> {});
+    static constexpr std::array<char, 16>  upper   = make_array<16> (detail_lookup_table::xdigit_entry<true > {});
+    static constexpr std::array<int8_t, 256> value = make_array<256>(detail_lookup_table::xvalue_entry);
+};
+
+template <typename T> constexpr std::array<char, 200>  digits_<T>::digits2;
+template <typename T> constexpr std::array<char, 16>   digits_<T>::lower;
+template <typename T> constexpr std::array<char, 16>   digits_<T>::upper;
+template <typename T> constexpr std::array<int8_t, 256> digits_<T>::value;
+
+using digits = digits_<>;
+
+} // namespace lookup_table
+
+////////////////////////////////////////////////////////////////
+/// Base64
+////////////////////////////////////////////////////////////////
+
+namespace detail_lookup_table {
+
+template <bool UrlN>
+struct base64_entry
+{
+    constexpr char operator()(size_t i) const
+    {
+        return static_cast<char>((i < 26) ? ('A' + i)      :
+                                 (i < 52) ? ('a' + i - 26) :
+                                 (i < 62) ? ('0' + i - 52) :
+                                 (i == 62) ? (UrlN ? '-' : '+') : (UrlN ? '_' : '/'));
+    }
+};
+
+/* The 6-bit value of a base64 character, or -1 */
+template <bool UrlN>
+struct base64_value_entry
+{
+    constexpr int8_t operator()(size_t c) const
+    {
+        return static_cast<int8_t>(((c >= 'A') && (c <= 'Z')) ? (c - 'A')      :
+                                   ((c >= 'a') && (c <= 'z')) ? (c - 'a' + 26) :
+                                   ((c >= '0') && (c <= '9')) ? (c - '0' + 52) :
+                                   (c == (UrlN ? '-' : '+'))  ? 62             :
+                                   (c == (UrlN ? '_' : '/'))  ? 63             : -1);
+    }
+};
+
+} // namespace detail_lookup_table
+
+namespace lookup_table {
+
+/* UrlN: the URL and filename safe alphabet of RFC 4648 */
+
+template <bool UrlN = false>
+struct base64
+{
+    static constexpr std::array<char, 64>    encode = make_array<64> (detail_lookup_table::base64_entry<UrlN> {});
+    static constexpr std::array<int8_t, 256> decode = make_array<256>(detail_lookup_table::base64_value_entry<UrlN> {});
+};
+
+template <bool UrlN> constexpr std::array<char, 64>    base64<UrlN>::encode;
+template <bool UrlN> constexpr std::array<int8_t, 256> base64<UrlN>::decode;
+
+} // namespace lookup_table
+} // namespace capo
@@ -0,0 +1,584 @@
+/*
+    The Capo Library
+    Code covered by the MIT License
+
+    Author: mutouyun (http://orzz.org)
+*/
+
+#pragma once
+
+#include "capo/noncopyable.hpp"
+#include "capo/spin_lock.hpp"
+#include "capo/thread_local_ptr.hpp"
+#include "capo/format.hpp"
+
+#include <string>               // std::string
+#include <vector>               // std::vector
+#include <deque>                // std::deque
+#include <memory>               // std::shared_ptr, std::unique_ptr
+#include <atomic>               // std::atomic
+#include <mutex>                // std::mutex, std::lock_guard, std::unique_lock
+#include <condition_variable>   // std::condition_variable
+#include <thread>               // std::thread
+#include <chrono>               // std::chrono
+#include <utility>              // std::pair, std::move
+#include <algorithm>            // std::lower_bound, std::is_sorted
+#include <stdexcept>            // std::invalid_argument
+#include <limits>               // std::numeric_limits
+#include <cstring>              // std::memcpy
+#include <cstdio>               // std::fopen, std::rename
+#include <cstdint>              // uint64_t
+#include <cstddef>              // size_t
+
+/*
+    The number of the per-thread slots a registry has by default.
+    A counter takes 1 slot, a histogram takes (buckets + 2) slots.
+*/
+
+#ifndef CAPO_METRICS_SLOTS_
+#define CAPO_METRICS_SLOTS_ 1024
+#endif/*CAPO_METRICS_SLOTS_*/
+
+namespace capo {
+
+using metric_labels = std::vector<std::pair<std::string, std::string>>;
+
+namespace detail_metrics {
+
+inline uint64_t to_bits(double v)
+{
+    uint64_t b;
+    std::memcpy(&b, &v, sizeof(b));
+    return b;
+}
+
+inline double from_bits(uint64_t b)
+{
+    double v;
+    std::memcpy(&v, &b, sizeof(v));
+    return v;
+}
+
+/*
+    The slots of a thread, only written by the owner thread.
+*/
+
+struct shard
+{
+    std::unique_ptr<std::atomic<uint64_t>[]> slots_;
+    std::atomic<bool>                        used_ { true };
+
+    explicit shard(size_t n)
+        : slots_(new std::atomic<uint64_t>[n])
+    {
+        for (size_t i = 0; i < n; ++i) slots_[i].store(0, std::memory_order_relaxed);
+    }
+
+    void add(size_t i, uint64_t n)
+    {
+        slots_[i].store(slots_[i].load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    }
+
+    void add(size_t i, double v)
+    {
+        slots_[i].store(to_bits(from_bits(slots_[i].load(std::memory_order_relaxed)) + v), std::memory_order_relaxed);
+    }
+};
+
+struct owner
+{
+    std::shared_ptr<shard> shard_;
+
+    ~owner(void) { shard_->used_.store(false, std::memory_order_release); }
+};
+
+enum class kind : uint8_t { counter, gauge, histogram };
+
+struct series
+{
+    std::string         labels_;    // {k="v",...} or empty
+    size_t              slot_;      // the first per-thread slot, or the gauge index
+    std::vector<double> bounds_;    // histogram buckets
+};
+
+struct family
+{
+    std::string         name_;
+    std::string         help_;
+    kind                kind_;
+    std::deque<series>  series_;
+};
+
+inline void append_escaped(std::string& out, const std::string& s, bool quote)
+{
+    for (char c : s)
+    {
+        if (c == '\\')               out += "\\\\";
+        else if (c == '\n')          out += "\\n";
+        else if (quote && c == '"')  out += "\\\"";
+        else                         out += c;
+    }
+}
+
+inline std::string format_labels(const metric_labels& labels)
+{
+    if (labels.empty()) return {};
+    std::string s = "{";
+    for (auto& kv : labels)
+    {
+        if (s.size() > 1) s += ',';
+        s += kv.first;
+        s += "=\"";
+        append_escaped(s, kv.second, true);
+        s += '"';
+    }
+    return s += '}';
+}
+
+inline void append_number(std::string& out, double v)
+{
+    if (v != v) { out += "NaN"; return; }
+    if (v ==  std::numeric_limits<double>::infinity()) { out += "+Inf"; return; }
+    if (v == -std::numeric_limits<double>::infinity()) { out += "-Inf"; return; }
+    char buf[32];
+    out.append(buf, capo::to_chars(buf, buf + sizeof(buf), v));
+}
+
+inline void append_number(std::string& out, uint64_t v)
+{
+    char buf[32];
+    out.append(buf, capo::to_chars(buf, buf + sizeof(buf), v));
+}
+
+/*
+    Appends `name{labels,extra} `, extra is something like le="0.5".
+*/
+inline void append_head(std::string& out, const std::string& name, const char* suffix,
+                        const std::string& labels, const std::string& extra)
+{
+    out += name;
+    out += suffix;
+    if (!labels.empty() || !extra.empty())
+    {
+        if (labels.empty()) out += '{';
+        else                out.append(labels, 0, labels.size() - 1);
+        if (!labels.empty() && !extra.empty()) out += ',';
+        out += extra;
+        out += '}';
+    }
+    out += ' ';
+}
+
+} // namespace detail_metrics
+
+class metrics_registry;
+
+////////////////////////////////////////////////////////////////
+/// Metric handles, resolved once by the registry
+////////////////////////////////////////////////////////////////
+
+class metric_counter
+{
+    friend class metrics_registry;
+
+    metrics_registry* reg_  = nullptr;
+    size_t            slot_ = 0;
+
+    metric_counter(metrics_registry* reg, size_t slot) : reg_(reg), slot_(slot) {}
+
+public:
+    metric_counter(void) = default;
+
+    void inc(void) { add(1); }
+    void add(uint64_t n);
+};
+
+class metric_gauge
+{
+    friend class metrics_registry;
+
+    std::atomic<uint64_t>* val_ = nullptr;
+
+    explicit metric_gauge(std::atomic<uint64_t>* val) : val_(val) {}
+
+public:
+    metric_gauge(void) = default;
+
+    void set(double v)
+    {
+        val_->store(detail_metrics::to_bits(v), std::memory_order_relaxed);
+    }
+
+    void add(double d)
+    {
+        uint64_t old = val_->load(std::memory_order_relaxed);
+        while (!val_->compare_exchange_weak(old, detail_metrics::to_bits(detail_metrics::from_bits(old) + d),
+                                            std::memory_order_relaxed)) ;
+    }
+
+    void inc(void) { add( 1); }
+    void dec(void) { add(-1); }
+
+    double value(void) const
+    {
+        return detail_metrics::from_bits(val_->load(std::memory_order_relaxed));
+    }
+};
+
+class metric_histogram
+{
+    friend class metrics_registry;
+
+    metrics_registry* reg_    = nullptr;
+    size_t            slot_   = 0;
+    const double*     bounds_ = nullptr;
+    size_t            count_  = 0;
+
+    metric_histogram(metrics_registry* reg, size_t slot, const std::vector<double>& bounds)
+        : reg_(reg), slot_(slot), bounds_(bounds.data()), count_(bounds.size())
+    {}
+
+public:
+    metric_histogram(void) = default;
+
+    void observe(double v);
+
+    template <typename Rep, typename Period>
+    void observe(std::chrono::duration<Rep, Period> d) // in seconds
+    {
+        observe(std::chrono::duration_cast<std::chrono::duration<double>>(d).count());
+    }
+};
+
+////////////////////////////////////////////////////////////////
+/// Metrics registry
+////////////////////////////////////////////////////////////////
+
+/*
+    Metrics are resolved by (name, labels) into handles once, then updated without locks:
+    counters and histograms go to per-thread slots (a relaxed load and store),
+    gauges are shared atomics.
+    snapshot() sums the slots of all threads and writes the Prometheus text format.
+
+    <Remarks>
+    1. Handles are valid as long as the registry.
+    2. Slots of exited threads are kept (with their values) and reused by new threads.
+*/
+
+class metrics_registry : capo::noncopyable
+{
+    friend class metric_counter;
+    friend class metric_histogram;
+
+    const size_t slot_count_;
+    size_t       slot_used_ = 0;
+
+    capo::thread_local_ptr<detail_metrics::owner>       local_;
+    capo::spin_lock                                     shards_lc_;
+    std::vector<std::shared_ptr<detail_metrics::shard>> shards_;
+    capo::spin_lock                                     shared_lc_;
+    std::shared_ptr<detail_metrics::shard>              shared_;    // if local_ is invalid
+
+    std::mutex                                         lc_;    // for registering
+    std::vector<std::unique_ptr<detail_metrics::family>> families_;
+    std::vector<std::unique_ptr<std::atomic<uint64_t>>>  gauges_;
+
+    detail_metrics::shard* local(void)
+    {
+        detail_metrics::owner* o = local_;
+        if (o != nullptr) return o->shard_.get();
+        o = new detail_metrics::owner;
+        {
+            std::lock_guard<capo::spin_lock> guard { shards_lc_ };
+            for (auto& s : shards_)
+            {
+                bool expected = false;
+                if (s->used_.compare_exchange_strong(expected, true, std::memory_order_acquire))
+                {
+                    o->shard_ = s;
+                    break;
+                }
+            }
+            if (!o->shard_)
+            {
+                o->shard_ = std::make_shared<detail_metrics::shard>(slot_count_);
+                shards_.push_back(o->shard_);
+            }
+        }
+        local_ = o;
+        return o->shard_.get();
+    }
+
+    /*
+        Calls f(shard*) with the shard of the calling thread,
+        or with a shared one (under shared_lc_) if the thread-local key could not be created.
+    */
+    template <typename F>
+    void update(F&& f)
+    {
+        if (local_.valid()) return f(local());
+        std::lock_guard<capo::spin_lock> guard { shared_lc_ };
+        if (!shared_)
+        {
+            std::lock_guard<capo::spin_lock> guard_shards { shards_lc_ };
+            shared_ = std::make_shared<detail_metrics::shard>(slot_count_);
+            shards_.push_back(shared_);
+        }
+        f(shared_.get());
+    }
+
+    static void enforce(const std::string& what)
+    {
+        throw std::invalid_argument { "Invalid metric: " + what + "." };
+    }
+
+    /*
+        Finds or adds the series, returns it and whether it was added.
+        A new series takes n per-thread slots, which are taken before anything is added,
+        so a failed one leaves no series behind.
+    */
+    std::pair<detail_metrics::series*, bool>
+    resolve(const std::string& name, const std::string& help, detail_metrics::kind k, const metric_labels& labels, size_t n)
+    {
+        if (name.empty()) enforce("empty name");
+        std::string lbs = detail_metrics::format_labels(labels);
+        detail_metrics::family* fm = nullptr;
+        for (auto& f : families_)
+        {
+            if (f->name_ != name) continue;
+            if (f->kind_ != k) enforce(name + " has another type");
+            fm = f.get();
+            break;
+        }
+        if (fm != nullptr)
+        {
+            for (auto& s : fm->series_)
+            {
+                if (s.labels_ == lbs) return { &s, false };
+            }
+        }
+        size_t slot = (n == 0) ? 0 : take_slots(n, name);
+        if (fm == nullptr)
+        {
+            families_.emplace_back(new detail_metrics::family { name, help, k, {} });
+            fm = families_.back().get();
+        }
+        fm->series_.push_back({ std::move(lbs), slot, {} });
+        return { &fm->series_.back(), true };
+    }
+
+    size_t take_slots(size_t n, const std::string& name)
+    {
+        if (slot_used_ + n > slot_count_) enforce(name + " is out of slots");
+        size_t s = slot_used_;
+        slot_used_ += n;
+        return s;
+    }
+
+    using shards_t = std::vector<std::shared_ptr<detail_metrics::shard>>;
+
+    /*
+        The sum of a slot of all threads.
+    */
+    static uint64_t sum(const shards_t& shards, size_t i)
+    {
+        uint64_t n = 0;
+        for (auto& s : shards) n += s->slots_[i].load(std::memory_order_relaxed);
+        return n;
+    }
+
+    static double sum_double(const shards_t& shards, size_t i)
+    {
+        double v = 0;
+        for (auto& s : shards) v += detail_metrics::from_bits(s->slots_[i].load(std::memory_order_relaxed));
+        return v;
+    }
+
+public:
+    explicit metrics_registry(size_t slot_count = CAPO_METRICS_SLOTS_)
+        : slot_count_(slot_count)
+    {}
+
+    /*
+        Returns the handle of the metric, the same (name, labels) gets the same metric.
+    */
+    metric_counter counter(const std::string& name, const std::string& help = {}, const metric_labels& labels = {})
+    {
+        std::lock_guard<std::mutex> guard { lc_ };
+        auto r = resolve(name, help, detail_metrics::kind::counter, labels, 1);
+        return { this, r.first->slot_ };
+    }
+
+    metric_gauge gauge(const std::string& name, const std::string& help = {}, const metric_labels& labels = {})
+    {
+        std::lock_guard<std::mutex> guard { lc_ };
+        auto r = resolve(name, help, detail_metrics::kind::gauge, labels, 0);
+        if (r.second)
+        {
+            r.first->slot_ = gauges_.size();
+            gauges_.emplace_back(new std::atomic<uint64_t> { detail_metrics::to_bits(0.0) });
+        }
+        return metric_gauge { gauges_[r.first->slot_].get() };
+    }
+
+    /*
+        bounds are the upper bounds of the buckets (ascending), +Inf is implicit.
+        The default buckets are for latencies in seconds.
+    */
+    metric_histogram histogram(const std::string& name, const std::string& help = {}, const metric_labels& labels = {},
+                               std::vector<double> bounds = { .0001, .0005, .001, .005, .01, .05, .1, .5, 1, 5, 10 })
+    {
+        std::lock_guard<std::mutex> guard { lc_ };
+        if (!std::is_sorted(bounds.begin(), bounds.end())) enforce(name + " has unsorted buckets");
+        auto r = resolve(name, help, detail_metrics::kind::histogram, labels, bounds.size() + 2); // buckets, +Inf, sum
+        if (r.second) r.first->bounds_ = std::move(bounds);
+        return { this, r.first->slot_, r.first->bounds_ };
+    }
+
+    /*
+        Sums the values of all threads, and writes them in the Prometheus text format.
+    */
+    std::string snapshot(void)
+    {
+        using namespace detail_metrics;
+        std::lock_guard<std::mutex> guard { lc_ };
+        shards_t shards;
+        {
+            std::lock_guard<capo::spin_lock> guard_shards { shards_lc_ };
+            shards = shards_;
+        }
+        static const char* types[] = { "counter", "gauge", "histogram" };
+        std::string out;
+        for (auto& f : families_)
+        {
+            if (!f->help_.empty())
+            {
+                out += "# HELP " + f->name_ + ' ';
+                append_escaped(out, f->help_, false);
+                out += '\n';
+            }
+            out += "# TYPE " + f->name_ + ' ' + types[static_cast<int>(f->kind_)] + '\n';
+            for (auto& s : f->series_)
+            {
+                switch (f->kind_)
+                {
+                case kind::counter:
+                    append_head(out, f->name_, "", s.labels_, {});
+                    append_number(out, sum(shards, s.slot_));
+                    break;
+                case kind::gauge:
+                    append_head(out, f->name_, "", s.labels_, {});
+                    append_number(out, from_bits(gauges_[s.slot_]->load(std::memory_order_relaxed)));
+                    break;
+                case kind::histogram:
+                {
+                    uint64_t acc = 0;
+                    for (size_t i = 0; i <= s.bounds_.size(); ++i)
+                    {
+                        std::string le = "le=\"";
+                        if (i < s.bounds_.size()) append_number(le, s.bounds_[i]);
+                        else                      le += "+Inf";
+                        append_head(out, f->name_, "_bucket", s.labels_, le += '"');
+                        append_number(out, acc += sum(shards, s.slot_ + i));
+                        out += '\n';
+                    }
+                    append_head(out, f->name_, "_sum", s.labels_, {});
+                    append_number(out, sum_double(shards, s.slot_ + s.bounds_.size() + 1));
+                    out += '\n';
+                    append_head(out, f->name_, "_count", s.labels_, {});
+                    append_number(out, acc);
+                }
+                    break;
+                }
+                out += '\n';
+            }
+        }
+        return out;
+    }
+
+    /*
+        Writes a snapshot into a file, through a temporary file and a rename,
+        so the readers never see a partial file.
+    */
+    bool write_file(const std::string& path)
+    {
+        std::string text = snapshot();
+        std::string tmp  = path + ".tmp";
+        std::FILE* fp = std::fopen(tmp.c_str(), "wb");
+        if (fp == nullptr) return false;
+        bool ok = (std::fwrite(text.data(), 1, text.size(), fp) == text.size());
+        ok = (std::fclose(fp) == 0) && ok;
+        if (ok)
+        {
+            std::remove(path.c_str()); // rename does not replace an existing file on Windows
+            ok = (std::rename(tmp.c_str(), path.c_str()) == 0);
+        }
+        if (!ok) std::remove(tmp.c_str());
+        return ok;
+    }
+};
+
+inline void metric_counter::add(uint64_t n)
+{
+    reg_->update([&](detail_metrics::shard* sh) { sh->add(slot_, n); });
+}
+
+inline void metric_histogram::observe(double v)
+{
+    size_t i = slot_ + static_cast<size_t>(std::lower_bound(bounds_, bounds_ + count_, v) - bounds_);
+    reg_->update([&](detail_metrics::shard* sh)
+    {
+        sh->add(i, uint64_t(1));
+        sh->add(slot_ + count_ + 1, v);
+    });
+}
+
+////////////////////////////////////////////////////////////////
+/// Collector thread, writes the snapshots into a file periodically
+////////////////////////////////////////////////////////////////
+
+class metrics_collector : capo::noncopyable
+{
+    metrics_registry&       reg_;
+    std::string             path_;
+    std::chrono::milliseconds interval_;
+
+    std::mutex              lc_;
+    std::condition_variable cv_;
+    bool                    quit_ = false;
+    std::thread             worker_;
+
+public:
+    metrics_collector(metrics_registry& reg, std::string path,
+                      std::chrono::milliseconds interval = std::chrono::seconds(10))
+        : reg_(reg), path_(std::move(path)), interval_(interval)
+    {
+        worker_ = std::thread { [this]
+        {
+            std::unique_lock<std::mutex> guard { lc_ };
+            while (!quit_)
+            {
+                guard.unlock();
+                reg_.write_file(path_);
+                guard.lock();
+                cv_.wait_for(guard, interval_, [this] { return quit_; });
+            }
+        } };
+    }
+
+    /*
+        Writes the last snapshot before quitting.
+    */
+    ~metrics_collector(void)
+    {
+        {
+            std::lock_guard<std::mutex> guard { lc_ };
+            quit_ = true;
+        }
+        cv_.notify_one();
+        worker_.join();
+        reg_.write_file(path_);
+    }
+};
+
+} // namespace capo
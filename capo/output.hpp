@@ -8,6 +8,7 @@
 #pragma once
 
 #include "capo/printf.hpp"
+#include "capo/format.hpp"
 
 #include <string>   // std::string
 #include <utility>  // std::forward
@@ -159,44 +160,52 @@ using rep_t = typename std::decay<A>::type;
 
 CAPO_CONCEPT_TYPING_(can_cast_str, static_cast<const char*>(std::declval<T&&>()));
 
+template <typename A>
+void format_buffer(std::string& buf, const std::string& fmt, A&& a)
+{
+    detail_printf_::check(fmt.c_str(), a);
+    buf.clear();
+    if (!detail_format::format(buf, fmt.c_str(), std::forward<A>(a))) buf.clear();
+}
+
 inline void printf_buffer(std::string& buf, std::string&& /*cfg*/, bool a)
 {
-    capo::printf(use::strout(buf), "%s", (a ? "true" : "false"));
+    buf = (a ? "true" : "false");
 }
 
 template <typename A, CAPO_REQUIRE_(pf<rep_t<A>>::value)>
 void printf_buffer(std::string& buf, std::string&& cfg, A&& a)
 {
-    buf = "%";
+    std::string fmt = "%";
     if (cfg.empty())
     {
-        buf += pf<rep_t<A>>::val();
+        fmt += pf<rep_t<A>>::val();
     }
     else if (detail_printf_::is_specifier(cfg.back()))
     {
-        buf += std::move(cfg);
+        fmt += std::move(cfg);
     }
     else
     {
-        buf += std::move(cfg) + pf<rep_t<A>>::val();
+        fmt += std::move(cfg) + pf<rep_t<A>>::val();
     }
-    capo::printf(use::strout(buf), buf.c_str(), std::forward<A>(a));
+    format_buffer(buf, fmt, std::forward<A>(a));
 }
 
 template <typename A, CAPO_REQUIRE_(!pf<rep_t<A>>::value &&
                                      std::is_same<underlying<A>, std::string>::value)>
 void printf_buffer(std::string& buf, std::string&& cfg, A&& a)
 {
-    buf = "%";
+    std::string fmt = "%";
     if (!cfg.empty() && detail_printf_::is_specifier(cfg.back()))
     {
-        buf += std::move(cfg);
+        fmt += std::move(cfg);
     }
     else
     {
-        buf += "s";
+        fmt += "s";
     }
-    capo::printf(use::strout(buf), buf.c_str(), std::forward<A>(a).c_str());
+    format_buffer(buf, fmt, std::forward<A>(a).c_str());
 }
 
 template <typename A, CAPO_REQUIRE_(!pf<rep_t<A>>::value &&
@@ -204,16 +213,16 @@ template <typename A, CAPO_REQUIRE_(!pf<rep_t<A>>::value &&
                                      can_cast_str<A>::value)>
 void printf_buffer(std::string& buf, std::string&& cfg, A&& a)
 {
-    buf = "%";
+    std::string fmt = "%";
     if (!cfg.empty() && detail_printf_::is_specifier(cfg.back()))
     {
-        buf += std::move(cfg);
+        fmt += std::move(cfg);
     }
     else
     {
-        buf += "s";
+        fmt += "s";
     }
-    capo::printf(use::strout(buf), buf.c_str(), static_cast<const char*>(std::forward<A>(a)));
+    format_buffer(buf, fmt, static_cast<const char*>(std::forward<A>(a)));
 }
 
 template <typename A, CAPO_REQUIRE_(!pf<rep_t<A>>::value &&
@@ -0,0 +1,342 @@
+/*
+    The Capo Library
+    Code covered by the MIT License
+
+    Author: mutouyun (http://orzz.org)
+*/
+
+#pragma once
+
+#include <utility>      // std::pair
+#include <string>       // std::string
+#include <stdexcept>    // std::invalid_argument, std::out_of_range
+#include <type_traits>  // std::is_integral, std::is_enum
+#include <cstddef>      // size_t
+#include <cstring>      // std::memcmp
+#include <cstdint>      // uint64_t
+
+namespace capo {
+
+/*
+    A minimal perfect hash table, built at compile-time from a fixed set of keys.
+
+    The keys are hashed once (8 bytes a step for strings, a multiplication for integers & enums),
+    and split into N / 2 + 1 buckets by the high bits of the hash.
+    The constexpr constructor looks for a pilot of each bucket (the largest one first),
+    which displaces all the keys of the bucket into free slots ("hash & displace").
+    So a lookup is:
+
+        slot = fastrange(((hash ^ pilots[bucket(hash)]) * C) >> 32, N);
+        return (keys[slot] == key) ? &values[slot] : nullptr;
+
+    The duplicated keys, two keys with the same hash, or a set could not be placed,
+    will break the compilation (when the table is declared as constexpr).
+*/
+
+namespace detail_perfect_hash {
+
+////////////////////////////////////////////////////////////////
+/// Hash functions
+////////////////////////////////////////////////////////////////
+
+enum : uint64_t
+{
+    golden     = 0x9e3779b97f4a7c15ull,
+    multiplier = 0xff51afd7ed558ccdull
+};
+
+constexpr size_t length(const char* s)
+{
+    size_t n = 0;
+    while (s[n] != '\0') ++n;
+    return n;
+}
+
+/*
+    Reads the bytes as a little-endian word,
+    the shifts are merged into one load by the compiler at run-time.
+*/
+constexpr uint64_t byte_at(const char* s, size_t i)
+{
+    return static_cast<uint64_t>(static_cast<unsigned char>(s[i])) << (i * 8);
+}
+
+constexpr uint64_t read16(const char* s) { return byte_at(s, 0) | byte_at(s, 1); }
+constexpr uint64_t read32(const char* s) { return read16(s) | byte_at(s, 2) | byte_at(s, 3); }
+constexpr uint64_t read64(const char* s)
+{
+    return read32(s) | byte_at(s, 4) | byte_at(s, 5) | byte_at(s, 6) | byte_at(s, 7);
+}
+
+/* The tail (< 8 bytes) of a string */
+constexpr uint64_t read_tail(const char* s, size_t n)
+{
+    uint64_t w = 0;
+    size_t   k = 0;
+    if (n & 4) { w  = read32(s); k = 4; }
+    if (n & 2) { w |= read16(s + k) << (k * 8); k += 2; }
+    if (n & 1) { w |= byte_at(s + k, 0) << (k * 8); }
+    return w;
+}
+
+constexpr uint64_t hash_bytes(const char* s, size_t n)
+{
+    uint64_t h = golden ^ (n * multiplier);
+    for (; n >= 8; s += 8, n -= 8)
+    {
+        h = (h ^ read64(s)) * multiplier;
+        h ^= h >> 32;
+    }
+    h = (h ^ read_tail(s, n)) * golden;
+    return h ^ (h >> 29);
+}
+
+constexpr uint64_t splitmix(uint64_t x)
+{
+    x += golden;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+    return x ^ (x >> 31);
+}
+
+/* Maps a 32-bit value into [0, n) without a division */
+constexpr size_t fastrange(uint64_t x32, size_t n)
+{
+    return static_cast<size_t>((x32 * n) >> 32);
+}
+
+////////////////////////////////////////////////////////////////
+/// Key traits
+////////////////////////////////////////////////////////////////
+
+/* Integers & enums */
+
+template <typename K>
+struct traits
+{
+    static_assert(std::is_integral<K>::value || std::is_enum<K>::value,
+                  "The keys of perfect_map should be integers, enums or C-strings.");
+
+    using key_type = K;
+
+    static constexpr key_type store(K k) { return k; }
+    static constexpr uint64_t hash (K k) { return static_cast<uint64_t>(k) * golden; }
+    static constexpr bool     equal(K a, K b) { return a == b; }
+};
+
+/* C-strings, the stored strings are not copied */
+
+struct string_ref
+{
+    const char* data_;
+    size_t      size_;
+
+    constexpr const char* data(void) const { return data_; }
+    constexpr size_t      size(void) const { return size_; }
+};
+
+template <>
+struct traits<const char*>
+{
+    using key_type = string_ref;
+
+    static constexpr key_type store(const char* s) { return { s, length(s) }; }
+
+    static constexpr uint64_t hash(const key_type& s)        { return hash_bytes(s.data_, s.size_); }
+    static constexpr uint64_t hash(const char* s)            { return hash_bytes(s, length(s)); }
+    static constexpr uint64_t hash(const char* s, size_t n)  { return hash_bytes(s, n); }
+    static           uint64_t hash(const std::string& s)     { return hash_bytes(s.data(), s.size()); }
+
+    static constexpr bool equal(const key_type& a, const char* s, size_t n)
+    {
+        if (a.size_ != n) return false;
+        for (size_t i = 0; i < n; ++i)
+            if (a.data_[i] != s[i]) return false;
+        return true;
+    }
+    static constexpr bool equal(const key_type& a, const char* s)        { return equal(a, s, length(s)); }
+    static bool equal(const key_type& a, const std::string& s)
+    {
+        return (a.size_ == s.size()) && (std::memcmp(a.data_, s.data(), a.size_) == 0);
+    }
+};
+
+} // namespace detail_perfect_hash
+
+////////////////////////////////////////////////////////////////
+/// Perfect map
+////////////////////////////////////////////////////////////////
+
+template <typename K, typename V, size_t N>
+class perfect_map
+{
+    static_assert(N > 0, "The perfect_map needs at least one key.");
+
+public:
+    using traits     = detail_perfect_hash::traits<K>;
+    using key_type   = typename traits::key_type;
+    using value_type = V;
+
+    enum : size_t
+    {
+        bucket_count = N / 2 + 1,
+        max_tries    = 1 << 20
+    };
+
+private:
+    uint64_t pilots_[bucket_count] {};
+    key_type keys_  [N] {};
+    V        values_[N] {};
+
+    static constexpr size_t bucket(uint64_t h)
+    {
+        return detail_perfect_hash::fastrange(h >> 32, bucket_count);
+    }
+
+    static constexpr size_t slot(uint64_t h, uint64_t pilot)
+    {
+        return detail_perfect_hash::fastrange(((h ^ pilot) * detail_perfect_hash::multiplier) >> 32, N);
+    }
+
+public:
+    constexpr perfect_map(const std::pair<K, V> (& kv)[N])
+    {
+        uint64_t hash [N] {};
+        size_t   which[N] {};                   // the bucket of each key
+        size_t   first[bucket_count + 1] {};    // the keys of bucket b are in [first[b], first[b + 1])
+        size_t   order[N] {};                   // the keys, grouped by their buckets
+        size_t   fill [bucket_count] {};
+        size_t   slots[N] {};                   // the slots tried for a bucket
+        bool     used [N] {};
+        size_t   largest = 0;
+        for (size_t i = 0; i < N; ++i)
+        {
+            hash [i] = traits::hash(traits::store(kv[i].first));
+            which[i] = bucket(hash[i]);
+            ++first[which[i] + 1];
+        }
+        for (size_t b = 0; b < bucket_count; ++b)
+        {
+            if (first[b + 1] > largest) largest = first[b + 1];
+            first[b + 1] += first[b];
+        }
+        for (size_t i = 0; i < N; ++i) order[first[which[i]] + fill[which[i]]++] = i;
+        // Places the largest buckets first, while most of the slots are free
+        for (size_t n = largest; n > 0; --n)
+        for (size_t b = 0; b < bucket_count; ++b)
+        {
+            if (first[b + 1] - first[b] != n) continue;
+            const size_t* members = order + first[b];
+            for (size_t i = 1; i < n; ++i)
+            for (size_t j = 0; j < i; ++j)
+                if (hash[members[j]] == hash[members[i]])
+                    throw traits::equal(traits::store(kv[members[j]].first), kv[members[i]].first)
+                        ? std::invalid_argument("perfect_map: duplicate keys")
+                        : std::invalid_argument("perfect_map: hash collision");
+            size_t tries = 0;
+            for (; tries < max_tries; ++tries)
+            {
+                uint64_t pilot = detail_perfect_hash::splitmix(tries);
+                size_t j = 0;
+                for (; j < n; ++j)
+                {
+                    size_t s = slot(hash[members[j]], pilot);
+                    if (used[s]) break;
+                    size_t k = 0;
+                    while ((k < j) && (slots[k] != s)) ++k;
+                    if (k < j) break;
+                    slots[j] = s;
+                }
+                if (j < n) continue;
+                for (j = 0; j < n; ++j)
+                {
+                    used   [slots[j]] = true;
+                    keys_  [slots[j]] = traits::store(kv[members[j]].first);
+                    values_[slots[j]] = kv[members[j]].second;
+                }
+                pilots_[b] = pilot;
+                break;
+            }
+            if (tries == max_tries) throw std::invalid_argument("perfect_map: no pilot found");
+        }
+    }
+
+    static constexpr size_t size(void) { return N; }
+
+    /* The slot the key would be, which is in [0, N) */
+    template <typename... A>
+    constexpr size_t index(const A&... key) const
+    {
+        uint64_t h = traits::hash(key...);
+        return slot(h, pilots_[bucket(h)]);
+    }
+
+    template <typename... A>
+    constexpr const V* find(const A&... key) const
+    {
+        size_t s = index(key...);
+        return traits::equal(keys_[s], key...) ? &(values_[s]) : nullptr;
+    }
+
+    template <typename... A>
+    constexpr bool contains(const A&... key) const
+    {
+        return traits::equal(keys_[index(key...)], key...);
+    }
+
+    template <typename... A>
+    constexpr const V& at(const A&... key) const
+    {
+        const V* v = find(key...);
+        return (v == nullptr) ? throw std::out_of_range("perfect_map: key not found") : *v;
+    }
+
+    /* Get the stored key/value of a slot */
+    constexpr const key_type& key  (size_t s) const { return keys_  [s]; }
+    constexpr const V&        value(size_t s) const { return values_[s]; }
+};
+
+////////////////////////////////////////////////////////////////
+/// Make a perfect_map
+////////////////////////////////////////////////////////////////
+
+/*
+    constexpr auto methods = capo::make_perfect_map<const char*, int>({ { "GET", 1 }, { "POST", 2 } });
+    methods.find("POST");  // a pointer to 2
+    methods.find("PUT");   // nullptr
+*/
+
+template <typename K, typename V, size_t N>
+constexpr perfect_map<K, V, N> make_perfect_map(const std::pair<K, V> (& kv)[N])
+{
+    return { kv };
+}
+
+/*
+    Maps the keys to their indices in the given list,
+    e.g. the enumerator names to the enumerator values:
+
+    enum class color { red, green, blue };
+    constexpr const char* color_names[] = { "red", "green", "blue" };
+    constexpr auto colors = capo::make_perfect_index(color_names);
+    static_cast<color>(*colors.find("green"));  // color::green
+    color_names[static_cast<size_t>(color::blue)]; // "blue"
+*/
+
+namespace detail_perfect_hash {
+
+template <typename K, size_t N, size_t... I>
+constexpr perfect_map<K, size_t, N> make_index(const K (& keys)[N], std::index_sequence<I...>)
+{
+    return { { std::pair<K, size_t> { keys[I], I }... } };
+}
+
+} // namespace detail_perfect_hash
+
+template <typename K, size_t N>
+constexpr perfect_map<K, size_t, N> make_perfect_index(const K (& keys)[N])
+{
+    return detail_perfect_hash::make_index(keys, std::make_index_sequence<N> {});
+}
+
+} // namespace capo
@@ -10,15 +10,15 @@
 #include "capo/type_name.hpp"
 #include "capo/type_traits.hpp"
 #include "capo/concept.hpp"
+#include "capo/format.hpp"
 
 #include <string>       // std::string
 #include <stdexcept>    // std::invalid_argument
 #include <iostream>     // std::cout
 #include <utility>      // std::forward, std::move
-#include <cstdint>      // intmax_t, uintmax_t
+#include <cstdint>      // intmax_t, uintmax_t, uint64_t, uintptr_t
 #include <cstddef>      // size_t, ptrdiff_t
-#include <cstdio>       // snprintf
-#include <cstdarg>      // va_list, va_start, va_end
+#include <atomic>       // std::atomic
 
 namespace capo {
 
@@ -59,12 +59,8 @@ inline void enforce_argument(const char* fmt)
         switch(*fmt)
         {
         // check specifiers's length
-        case 'h':
-                if (state == length_t::h) state = length_t::hh;
-                else state = length_t::h; break;
-        case 'l':
-                if (state == length_t::l) state = length_t::ll;
-                else state = length_t::l; break;
+        case 'h': state = (state == length_t::h) ? length_t::hh : length_t::h; break;
+        case 'l': state = (state == length_t::l) ? length_t::ll : length_t::l; break;
         case 'j': state = length_t::j; break;
         case 'z': state = length_t::z; break;
         case 't': state = length_t::t; break;
@@ -100,6 +96,7 @@ inline void enforce_argument(const char* fmt)
             }
             return;
         case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A':
+        case 'r': // shortest round-trip, see capo/format.hpp
             switch(state)
             {
             default:
@@ -166,6 +163,172 @@ inline void check(const char* fmt, T1&& /*a1*/, T&&... args)
     enforce("Too few format specifiers");
 }
 
+/*
+    Caches the validated formats per format-pointer and type-signature,
+    so a format with the same argument types is checked only at its first call.
+
+    <Remarks>
+    The format must not change its contents at the same address with the same argument types,
+    which is always true for string literals.
+    CAPO_PRINTF_CHECK_CACHE_ is on in release builds; debug builds check every call.
+*/
+
+#if !defined(CAPO_PRINTF_CHECK_CACHE_)
+#if defined(NDEBUG)
+#   define CAPO_PRINTF_CHECK_CACHE_ 1
+#else /*!NDEBUG*/
+#   define CAPO_PRINTF_CHECK_CACHE_ 0
+#endif/*!NDEBUG*/
+#endif/*!CAPO_PRINTF_CHECK_CACHE_*/
+
+template <typename... T>
+struct check_cache
+{
+    /*
+        An open-addressing table per type-signature, hashed by the format pointer,
+        so the call sites sharing a common signature (e.g. a single %d) do not evict each other.
+    */
+    enum : unsigned
+    {
+        Bits   = 8,
+        Size   = 1u << Bits,
+        Probes = 8
+    };
+
+    static std::atomic<const char*> fmts_[Size];
+
+    static unsigned slot(const char* fmt, unsigned i)
+    {
+        auto h = static_cast<uint64_t>(reinterpret_cast<uintptr_t>(fmt)) * 0x9e3779b97f4a7c15ull;
+        return (static_cast<unsigned>(h >> (64 - Bits)) + i) & (Size - 1);
+    }
+
+    static bool find(const char* fmt)
+    {
+        for (unsigned i = 0; i < Probes; ++i)
+        {
+            const char* f = fmts_[slot(fmt, i)].load(std::memory_order_acquire);
+            if (f == fmt) return true;
+            if (f == nullptr) return false;
+        }
+        return false;
+    }
+
+    static void insert(const char* fmt)
+    {
+        for (unsigned i = 0; i < Probes; ++i)
+        {
+            const char* f = nullptr;
+            if (fmts_[slot(fmt, i)].compare_exchange_strong(f, fmt, std::memory_order_acq_rel) || (f == fmt)) return;
+        }
+        // the probed slots are all taken, replaces the first one
+        fmts_[slot(fmt, 0)].store(fmt, std::memory_order_release);
+    }
+};
+
+template <typename... T> std::atomic<const char*> check_cache<T...>::fmts_[check_cache<T...>::Size];
+
+template <typename... A>
+inline void verify(const char* fmt, A&&... args)
+{
+#if CAPO_PRINTF_CHECK_CACHE_
+    using cache_t = check_cache<typename std::decay<A>::type...>;
+    if (cache_t::find(fmt)) return;
+    check(fmt, args...);
+    cache_t::insert(fmt);
+#else /*!CAPO_PRINTF_CHECK_CACHE_*/
+    check(fmt, args...);
+#endif/*!CAPO_PRINTF_CHECK_CACHE_*/
+}
+
+/*
+    The constexpr version of check, for validating the literal formats at compile time.
+*/
+
+template <typename T, typename U>
+constexpr bool accept(void)
+{
+    return std::is_convertible<typename std::decay<T>::type, U>::value;
+}
+
+template <typename T>
+constexpr bool accept_argument(const char* fmt)
+{
+    int len = 0; // 0: none, 1: h, 2: hh, 3: l, 4: ll, 5: j, 6: z, 7: t, 8: L
+    for (; *fmt; ++fmt)
+    {
+        switch (*fmt)
+        {
+        case 'h': len = (len == 1) ? 2 : 1; break;
+        case 'l': len = (len == 3) ? 4 : 3; break;
+        case 'j': len = 5; break;
+        case 'z': len = 6; break;
+        case 't': len = 7; break;
+        case 'L': len = 8; break;
+        case 'd': case 'i':
+            return (len == 1) ? accept<T, short    >() : (len == 2) ? accept<T, char       >() :
+                   (len == 3) ? accept<T, long     >() : (len == 4) ? accept<T, long long  >() :
+                   (len == 5) ? accept<T, intmax_t >() : (len == 6) ? accept<T, size_t     >() :
+                   (len == 7) ? accept<T, ptrdiff_t>() :              accept<T, int        >();
+        case 'u': case 'o': case 'x': case 'X':
+            return (len == 1) ? accept<T, unsigned short>() : (len == 2) ? accept<T, unsigned char     >() :
+                   (len == 3) ? accept<T, unsigned long >() : (len == 4) ? accept<T, unsigned long long>() :
+                   (len == 5) ? accept<T, uintmax_t     >() : (len == 6) ? accept<T, size_t            >() :
+                   (len == 7) ? accept<T, ptrdiff_t     >() :              accept<T, unsigned int      >();
+        case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A': case 'r':
+            return (len == 8) ? accept<T, long double>() : accept<T, double>();
+        case 'c':
+            return (len == 3) ? accept<T, wchar_t>() : accept<T, char>();
+        case 's':
+            return (len == 3) ? accept<T, const wchar_t*>() : accept<T, const char*>();
+        case 'p':
+            return accept<T, void*>();
+        case 'n':
+            return (len == 1) ? accept<T, short*    >() : (len == 2) ? accept<T, char*     >() :
+                   (len == 3) ? accept<T, long*     >() : (len == 4) ? accept<T, long long*>() :
+                   (len == 5) ? accept<T, intmax_t* >() : (len == 6) ? accept<T, size_t*   >() :
+                   (len == 7) ? accept<T, ptrdiff_t*>() :              accept<T, int*      >();
+        }
+    }
+    return false;
+}
+
+/*
+    Returns the position after the '%' of the next specifier, or nullptr if there is none.
+*/
+constexpr const char* next_specifier(const char* fmt)
+{
+    for (; *fmt; ++fmt)
+    {
+        if (*fmt != '%') continue;
+        if (*++fmt != '%') return fmt;
+    }
+    return nullptr;
+}
+
+template <typename... T>
+struct accept_format;
+
+template <>
+struct accept_format<>
+{
+    constexpr static bool check(const char* fmt)
+    {
+        return next_specifier(fmt) == nullptr;
+    }
+};
+
+template <typename T1, typename... T>
+struct accept_format<T1, T...>
+{
+    constexpr static bool check(const char* fmt)
+    {
+        const char* p = next_specifier(fmt);
+        return (p != nullptr) && (*p != '\0') &&
+               accept_argument<T1>(p) && accept_format<T...>::check(p + 1);
+    }
+};
+
 template <typename F, CAPO_REQUIRE_(capo::is_closure<F>::value)>
 inline void do_out(F&& out, std::string&& buf)
 {
@@ -183,41 +346,49 @@ inline bool is_specifier(char c)
     static const char sps[] =
     {
         'd', 'i', 'u', 'o', 'x', 'X', 'f', 'F', 'e',
-        'E', 'g', 'G', 'a', 'A', 'c', 's', 'p', 'n'
+        'E', 'g', 'G', 'a', 'A', 'c', 's', 'p', 'n', 'r'
     };
     for (char s : sps) if (s == c) return true;
     return false;
 }
 
-#if defined(__GNUC__)
-#   pragma GCC diagnostic push
-#   pragma GCC diagnostic ignored "-Wformat-security"
-#endif/*__GNUC__*/
 template <typename F, typename... A>
 inline int impl_(F&& out, const char* fmt, A&&... args)
 {
     std::string buf;
-    int n = ::snprintf(nullptr, 0, fmt, std::forward<A>(args)...);
-    if (n > 0)
-    {
-        buf.resize(n);
-        n = ::snprintf(const_cast<char*>(buf.data()), n + 1, fmt, std::forward<A>(args)...);
-        if (n != static_cast<int>(buf.size())) return n;
-    }
+    if (!detail_format::format(buf, fmt, std::forward<A>(args)...)) return -1;
+    int n = static_cast<int>(buf.size());
     do_out(std::forward<F>(out), std::move(buf));
     return n;
 }
-#if defined(__GNUC__)
-#   pragma GCC diagnostic pop
-#endif/*__GNUC__*/
 
 CAPO_CONCEPT_TYPING_(can_shift_left, std::declval<T>() << std::declval<std::string>());
 
 template <typename T>
 CAPO_CONCEPT_(OutputPred, capo::is_closure<T>::value || can_shift_left<underlying<T>>::value);
 
+CAPO_CONCEPT_TYPING_(can_write_bytes, std::declval<T&>().write(static_cast<const void*>(nullptr), 0));
+
+template <typename T>
+CAPO_CONCEPT_(IteratorPred, !std::is_same<underlying<T>, fixed_buffer>::value &&
+                            !can_write_bytes<underlying<T>>::value);
+
 } // namespace detail_printf_
 
+/*
+    Checks a format against the argument types at compile time.
+
+    <code>
+        static_assert(capo::valid_format<int, const char*>("%d: %s"), "Bad format.");
+    <code/>
+*/
+
+template <typename... A>
+constexpr bool valid_format(const char* fmt)
+{
+    return (fmt != nullptr) && detail_printf_::accept_format<A...>::check(fmt);
+}
+
 ////////////////////////////////////////////////////////////////
 /// Print formatted data to output stream
 ////////////////////////////////////////////////////////////////
@@ -237,7 +408,7 @@ template <typename F, typename... A, CAPO_REQUIRE_(detail_printf_::OutputPred<F>
 inline int printf(F&& out, const char* fmt, A&&... args)
 {
     if (fmt == nullptr) return 0;
-    detail_printf_::check(fmt, std::forward<A>(args)...);
+    detail_printf_::verify(fmt, args...);
     return detail_printf_::impl_(std::forward<F>(out), fmt, std::forward<A>(args)...);
 }
 
@@ -247,4 +418,74 @@ inline int printf(const char* fmt, A&&... args)
     return capo::printf(std::cout, fmt, std::forward<A>(args)...);
 }
 
+////////////////////////////////////////////////////////////////
+/// Print formatted data to caller-provided storage, without any heap allocation
+////////////////////////////////////////////////////////////////
+
+template <typename OutputIt>
+struct format_to_n_result
+{
+    OutputIt out;   // the iterator past the last written character
+    size_t   size;  // the total size of the formatted output, even if truncated
+};
+
+/*
+    Writes all the formatted characters through an output iterator.
+    Returns the iterator past the last written character.
+*/
+
+template <typename OutputIt, typename... A, CAPO_REQUIRE_(detail_printf_::IteratorPred<OutputIt>::value)>
+inline OutputIt format_to(OutputIt out, const char* fmt, A&&... args)
+{
+    if (fmt == nullptr) return out;
+    detail_printf_::verify(fmt, args...);
+    detail_format::iterator_buffer<OutputIt> buf { out };
+    detail_format::format(buf, fmt, std::forward<A>(args)...);
+    return buf.it_;
+}
+
+/*
+    Writes at most n characters through an output iterator (no null-terminator).
+    If result.size > n, the output has been truncated.
+*/
+
+template <typename OutputIt, typename... A>
+inline format_to_n_result<OutputIt> format_to_n(OutputIt out, size_t n, const char* fmt, A&&... args)
+{
+    if (fmt == nullptr) return { out, 0 };
+    detail_printf_::verify(fmt, args...);
+    detail_format::iterator_buffer<OutputIt> buf { out, n };
+    detail_format::format(buf, fmt, std::forward<A>(args)...);
+    return { buf.it_, buf.size() };
+}
+
+/*
+    Appends to a fixed_buffer.
+    Returns false if the output has been truncated.
+*/
+
+template <typename... A>
+inline bool format_to(fixed_buffer& out, const char* fmt, A&&... args)
+{
+    if (fmt == nullptr) return !out.truncated();
+    detail_printf_::verify(fmt, args...);
+    return detail_format::format(out, fmt, std::forward<A>(args)...) && !out.truncated();
+}
+
+/*
+    Writes to a file-like object, such as capo::io_file or capo::mem_file.
+    Returns the number of written characters, or -1 if failed.
+*/
+
+template <typename FileT, typename... A, CAPO_REQUIRE_(detail_printf_::can_write_bytes<FileT>::value)>
+inline int format_to(FileT& out, const char* fmt, A&&... args)
+{
+    if (fmt == nullptr) return 0;
+    detail_printf_::verify(fmt, args...);
+    detail_format::file_buffer<FileT> buf { out };
+    bool ok = detail_format::format(buf, fmt, std::forward<A>(args)...);
+    buf.flush();
+    return (ok && !buf.failed()) ? static_cast<int>(buf.size()) : -1;
+}
+
 } // namespace capo
@@ -0,0 +1,332 @@
+/*
+    The Capo Library
+    Code covered by the MIT License
+
+    Author: mutouyun (http://orzz.org)
+*/
+
+#pragma once
+
+#include "capo/clock.hpp"
+#include "capo/histogram.hpp"
+#include "capo/printf.hpp"
+#include "capo/noncopyable.hpp"
+#include "capo/spin_lock.hpp"
+
+#include <vector>       // std::vector
+#include <string>       // std::string
+#include <memory>       // std::unique_ptr
+#include <atomic>       // std::atomic
+#include <mutex>        // std::mutex, std::lock_guard
+#include <algorithm>    // std::stable_sort, std::find
+#include <utility>      // std::move
+#include <cstdint>      // uint64_t
+#include <cstddef>      // size_t
+
+/*
+    The hold time is measured for one of every CAPO_PROFILED_MUTEX_SAMPLE_ acquisitions
+    of a mutex (must be a power of 2). Contended waits are always measured,
+    since reading the clock costs nothing compared with a blocking wait.
+*/
+
+#ifndef CAPO_PROFILED_MUTEX_SAMPLE_
+#define CAPO_PROFILED_MUTEX_SAMPLE_ 64
+#endif/*CAPO_PROFILED_MUTEX_SAMPLE_*/
+
+namespace capo {
+
+/*
+    The statistics of all mutexes sharing a name, the times are in nanoseconds.
+*/
+
+struct lock_stats
+{
+    using histogram_t = capo::histogram<5>;
+
+    std::string name_;
+    size_t      mutexes_      = 0; // currently alive
+    uint64_t    acquisitions_ = 0;
+    uint64_t    contended_    = 0;
+    histogram_t wait_;             // the contended acquisitions
+    histogram_t hold_;             // sampled
+
+    double contention(void) const
+    {
+        return (acquisitions_ == 0) ? 0 : (static_cast<double>(contended_) / acquisitions_);
+    }
+
+    double wait_total(void) const
+    {
+        return wait_.mean() * wait_.count();
+    }
+};
+
+namespace detail_profiled_mutex {
+
+using clock_t = capo::tsc_clock<>;
+
+inline uint64_t now(void)
+{
+    return static_cast<uint64_t>(clock_t::now().time_since_epoch().count());
+}
+
+/*
+    Only written by the thread holding the mutex.
+*/
+struct counters
+{
+    std::atomic<uint64_t> acquisitions_ { 0 };
+    std::atomic<uint64_t> contended_    { 0 };
+
+    static uint64_t inc(std::atomic<uint64_t>& a)
+    {
+        uint64_t n = a.load(std::memory_order_relaxed) + 1;
+        a.store(n, std::memory_order_relaxed);
+        return n;
+    }
+};
+
+/*
+    The histograms are recorded under the lock of the site,
+    only the contended waits & the sampled holds are recorded.
+    (A concurrent_histogram per site would take thread-local keys, which are limited.)
+*/
+struct site
+{
+    using histogram_t = capo::histogram<5>;
+
+    std::string                  name_;
+    std::vector<const counters*> alive_;
+    uint64_t                     acquisitions_ = 0; // of the destroyed mutexes
+    uint64_t                     contended_    = 0;
+    capo::spin_lock              lc_;
+    histogram_t                  wait_;
+    histogram_t                  hold_;
+
+    explicit site(std::string name)
+        : name_(std::move(name))
+    {}
+
+    void record(histogram_t& h, uint64_t v)
+    {
+        std::lock_guard<capo::spin_lock> guard { lc_ };
+        h.record(v);
+    }
+};
+
+} // namespace detail_profiled_mutex
+
+////////////////////////////////////////////////////////////////
+/// Lock contention profiler
+////////////////////////////////////////////////////////////////
+
+/*
+    Aggregates the profiled_mutexes by their names (the lock sites).
+*/
+
+class lock_profiler : capo::noncopyable
+{
+    using site_t = detail_profiled_mutex::site;
+
+    capo::spin_lock                      lc_;
+    std::vector<std::unique_ptr<site_t>> sites_;
+
+    template <typename> friend class profiled_mutex;
+
+    site_t* attach(const char* name, const detail_profiled_mutex::counters* cnt)
+    {
+        std::lock_guard<capo::spin_lock> guard { lc_ };
+        site_t* s = nullptr;
+        for (auto& p : sites_)
+        {
+            if (p->name_ == name)
+            {
+                s = p.get();
+                break;
+            }
+        }
+        if (s == nullptr)
+        {
+            sites_.emplace_back(new site_t(name));
+            s = sites_.back().get();
+        }
+        s->alive_.push_back(cnt);
+        return s;
+    }
+
+    void detach(site_t* s, const detail_profiled_mutex::counters* cnt)
+    {
+        std::lock_guard<capo::spin_lock> guard { lc_ };
+        s->acquisitions_ += cnt->acquisitions_.load(std::memory_order_relaxed);
+        s->contended_    += cnt->contended_   .load(std::memory_order_relaxed);
+        s->alive_.erase(std::find(s->alive_.begin(), s->alive_.end(), cnt));
+    }
+
+public:
+    lock_profiler(void)
+    {
+        detail_profiled_mutex::now(); // calibrate the clock in advance
+    }
+
+    static lock_profiler& global(void)
+    {
+        static lock_profiler inst;
+        return inst;
+    }
+
+    /*
+        The statistics of all lock sites, the worst offenders (the most total wait time) first.
+        Acquisitions made concurrently may or may not be included.
+    */
+    std::vector<lock_stats> sites(void)
+    {
+        std::vector<lock_stats> ret;
+        {
+            std::lock_guard<capo::spin_lock> guard { lc_ };
+            ret.resize(sites_.size());
+            for (size_t i = 0; i < sites_.size(); ++i)
+            {
+                auto& s = *(sites_[i]);
+                auto& r = ret[i];
+                r.name_         = s.name_;
+                r.mutexes_      = s.alive_.size();
+                r.acquisitions_ = s.acquisitions_;
+                r.contended_    = s.contended_;
+                for (auto c : s.alive_)
+                {
+                    r.acquisitions_ += c->acquisitions_.load(std::memory_order_relaxed);
+                    r.contended_    += c->contended_   .load(std::memory_order_relaxed);
+                }
+                std::lock_guard<capo::spin_lock> site_guard { s.lc_ };
+                r.wait_ = s.wait_;
+                r.hold_ = s.hold_;
+            }
+        }
+        std::stable_sort(ret.begin(), ret.end(), [](const lock_stats& a, const lock_stats& b)
+        {
+            if (a.wait_total() != b.wait_total()) return a.wait_total() > b.wait_total();
+            return a.contended_ > b.contended_;
+        });
+        return ret;
+    }
+
+    /*
+        Prints the top n lock sites (the times are in microseconds),
+        the output is the same as capo::printf's.
+    */
+    template <typename F>
+    void report(F&& out, size_t n = 10)
+    {
+        auto st = sites();
+        capo::printf(out, "%-24s %12s %12s %8s %12s %10s %10s %10s %10s\n",
+                     "lock", "acquisitions", "contended", "ratio", "wait(us)",
+                     "wait.p50", "wait.p99", "hold.p50", "hold.p99");
+        for (size_t i = 0; (i < st.size()) && (i < n); ++i)
+        {
+            auto& s = st[i];
+            capo::printf(out, "%-24s %12llu %12llu %7.2f%% %12.3f %10.3f %10.3f %10.3f %10.3f\n",
+                         s.name_.c_str(),
+                         static_cast<unsigned long long>(s.acquisitions_),
+                         static_cast<unsigned long long>(s.contended_),
+                         s.contention() * 100, s.wait_total() / 1e3,
+                         s.wait_.percentile(50) / 1e3, s.wait_.percentile(99) / 1e3,
+                         s.hold_.percentile(50) / 1e3, s.hold_.percentile(99) / 1e3);
+        }
+    }
+};
+
+////////////////////////////////////////////////////////////////
+/// Mutex wrapper for profiling the lock contention
+////////////////////////////////////////////////////////////////
+
+/*
+    Meets the requirements of Lockable, as long as MutexT does.
+    Do things like this:
+    -->
+    capo::profiled_mutex<std::mutex> lc { "cache" };
+    std::lock_guard<decltype(lc)> guard { lc };
+    -->
+    capo::thread_wrapper<Foo, capo::profiled_mutex<capo::spin_lock>> foo;
+    ...
+    capo::lock_profiler::global().report(std::cout);
+
+    <Remarks>
+    An uncontended acquisition costs a try_lock and two stores inside the critical section,
+    plus reading the clock twice for the sampled ones.
+*/
+
+template <typename MutexT = std::mutex>
+class profiled_mutex : capo::noncopyable
+{
+    static_assert((CAPO_PROFILED_MUTEX_SAMPLE_ & (CAPO_PROFILED_MUTEX_SAMPLE_ - 1)) == 0,
+                  "CAPO_PROFILED_MUTEX_SAMPLE_ must be a power of 2.");
+
+    using counters_t = detail_profiled_mutex::counters;
+
+    MutexT                       lc_;
+    counters_t                   cnt_;
+    lock_profiler&               prof_;
+    detail_profiled_mutex::site* site_;
+    uint64_t                     hold_begin_ = 0; // guarded by lc_
+
+    void acquired(void)
+    {
+        uint64_t n = counters_t::inc(cnt_.acquisitions_);
+        if ((n & (CAPO_PROFILED_MUTEX_SAMPLE_ - 1)) == 0)
+            hold_begin_ = detail_profiled_mutex::now();
+    }
+
+public:
+    using mutex_type = MutexT;
+
+    explicit profiled_mutex(const char* name = "(unnamed)", lock_profiler& prof = lock_profiler::global())
+        : prof_(prof)
+        , site_(prof.attach(name, &cnt_))
+    {}
+
+    ~profiled_mutex(void)
+    {
+        prof_.detach(site_, &cnt_);
+    }
+
+    const std::string& name(void) const { return site_->name_; }
+    MutexT& native(void)                { return lc_; }
+
+    bool try_lock(void)
+    {
+        if (!lc_.try_lock()) return false;
+        acquired();
+        return true;
+    }
+
+    void lock(void)
+    {
+        if (lc_.try_lock())
+        {
+            acquired();
+            return;
+        }
+        uint64_t begin = detail_profiled_mutex::now();
+        lc_.lock();
+        uint64_t end = detail_profiled_mutex::now();
+        counters_t::inc(cnt_.contended_);
+        acquired();
+        site_->record(site_->wait_, end - begin);
+    }
+
+    void unlock(void)
+    {
+        uint64_t begin = hold_begin_;
+        if (begin == 0)
+        {
+            lc_.unlock();
+            return;
+        }
+        hold_begin_ = 0;
+        uint64_t end = detail_profiled_mutex::now();
+        lc_.unlock();
+        site_->record(site_->hold_, end - begin);
+    }
+};
+
+} // namespace capo
@@ -0,0 +1,426 @@
+/*
+    The Capo Library
+    Code covered by the MIT License
+
+    Author: mutouyun (http://orzz.org)
+*/
+
+#pragma once
+
+#include "capo/clock.hpp"
+#include "capo/json.hpp"
+#include "capo/printf.hpp"
+#include "capo/noncopyable.hpp"
+#include "capo/scope_guard.hpp"
+#include "capo/spin_lock.hpp"
+#include "capo/thread_local_ptr.hpp"
+#include "capo/unused.hpp"
+
+#include <vector>       // std::vector
+#include <string>       // std::string
+#include <memory>       // std::shared_ptr, std::make_shared
+#include <atomic>       // std::atomic
+#include <mutex>        // std::lock_guard
+#include <algorithm>    // std::sort
+#include <utility>      // std::forward
+#include <cstring>      // std::strcmp
+#include <cstdint>      // uint64_t, uint32_t
+#include <cstddef>      // size_t
+
+/*
+    Define CAPO_PROFILE_ENABLED_ as 0 to compile all CAPO_PROFILE_SCOPE_ out.
+*/
+
+#ifndef CAPO_PROFILE_ENABLED_
+#define CAPO_PROFILE_ENABLED_ 1
+#endif/*CAPO_PROFILE_ENABLED_*/
+
+/*
+    The default size of the event ring of each thread, older events are overwritten
+    (a full ring reports the newest size - 1 events, the oldest slot is the next to be written).
+*/
+
+#ifndef CAPO_PROFILE_RING_SIZE_
+#define CAPO_PROFILE_RING_SIZE_ 16384
+#endif/*CAPO_PROFILE_RING_SIZE_*/
+
+namespace capo {
+
+/*
+    A finished scope, the times are in nanoseconds since the tsc_clock epoch.
+*/
+
+struct profile_event
+{
+    const char* name_;
+    uint64_t    begin_;
+    uint64_t    end_;
+    uint32_t    depth_;
+    uint32_t    tid_;
+};
+
+/*
+    A node of the aggregated call tree, the times are in nanoseconds.
+*/
+
+struct profile_node
+{
+    const char*               name_  = "";
+    uint64_t                  count_ = 0;
+    uint64_t                  total_ = 0;
+    uint64_t                  self_  = 0;
+    std::vector<profile_node> children_;
+
+    profile_node& child(const char* name)
+    {
+        for (auto& c : children_)
+        {
+            if ((c.name_ == name) || (std::strcmp(c.name_, name) == 0)) return c;
+        }
+        children_.emplace_back();
+        children_.back().name_ = name;
+        return children_.back();
+    }
+};
+
+namespace detail_profile {
+
+using clock_t = capo::tsc_clock<>;
+
+inline uint64_t now(void)
+{
+    return static_cast<uint64_t>(clock_t::now().time_since_epoch().count());
+}
+
+/*
+    Single writer (the owner thread), readers copy the newest events and
+    discard the slots which might have been overwritten meanwhile.
+*/
+
+class ring
+{
+    std::vector<profile_event> events_;
+    size_t                     mask_;
+    std::atomic<uint64_t>      count_ { 0 };
+    std::atomic<uint64_t>      base_  { 0 }; // moved forward by clear()
+
+public:
+    const uint32_t    tid_;
+    uint32_t          depth_ = 0;
+    std::atomic<bool> used_  { true };
+
+    ring(size_t size, uint32_t tid)
+        : tid_(tid)
+    {
+        size_t n = 1;
+        while (n < size) n <<= 1;
+        events_.resize(n);
+        mask_ = n - 1;
+    }
+
+    void push(const char* name, uint64_t begin, uint64_t end, uint32_t depth)
+    {
+        uint64_t c = count_.load(std::memory_order_relaxed);
+        events_[c & mask_] = { name, begin, end, depth, tid_ };
+        count_.store(c + 1, std::memory_order_release);
+    }
+
+    void collect(std::vector<profile_event>& out) const
+    {
+        uint64_t cap  = events_.size();
+        uint64_t to   = count_.load(std::memory_order_acquire);
+        uint64_t from = base_.load(std::memory_order_relaxed);
+        if (to - from > cap) from = to - cap;
+        size_t   pos  = out.size();
+        for (uint64_t i = from; i < to; ++i) out.push_back(events_[i & mask_]);
+        // the writer might be overwriting the slot of the event (last - cap) by the event last,
+        // so the copies through (last - cap) might be torn
+        uint64_t last = count_.load(std::memory_order_acquire);
+        if (last + 1 - from > cap)
+        {
+            size_t n = static_cast<size_t>(last + 1 - cap - from);
+            out.erase(out.begin() + pos, out.begin() + pos + (std::min)(n, out.size() - pos));
+        }
+    }
+
+    void clear(void)
+    {
+        base_.store(count_.load(std::memory_order_acquire), std::memory_order_relaxed);
+    }
+};
+
+struct owner
+{
+    std::shared_ptr<ring> ring_;
+
+    ~owner(void) { ring_->used_.store(false, std::memory_order_release); }
+};
+
+inline void finish(profile_node& node)
+{
+    uint64_t sub = 0;
+    for (auto& c : node.children_)
+    {
+        finish(c);
+        sub += c.total_;
+    }
+    node.self_ = (node.total_ > sub) ? (node.total_ - sub) : 0;
+}
+
+template <typename F>
+void print(F&& out, const profile_node& node, int indent)
+{
+    std::string label(static_cast<size_t>(indent) * 2, ' ');
+    label += node.name_;
+    capo::printf(out, "%-40s %10llu %14.3f %14.3f\n", label.c_str(),
+                 static_cast<unsigned long long>(node.count_), node.total_ / 1e3, node.self_ / 1e3);
+    for (auto& c : node.children_) print(out, c, indent + 1);
+}
+
+} // namespace detail_profile
+
+////////////////////////////////////////////////////////////////
+/// Hierarchical scoped profiler
+////////////////////////////////////////////////////////////////
+
+/*
+    Each thread records the finished scopes into its own ring, without locks.
+    When disabled at runtime, a scope costs a relaxed atomic load.
+
+    <Remarks>
+    1. The scope names must have static storage duration (string literals).
+    2. Rings of exited threads are kept (with their events) and reused by new threads.
+    3. If the thread-local key could not be created, the scopes of all threads are recorded flat
+    into a shared ring, under a lock.
+*/
+
+class profiler : capo::noncopyable
+{
+    std::atomic<bool> enabled_;
+    size_t            ring_size_;
+
+    capo::thread_local_ptr<detail_profile::owner>     local_;
+    capo::spin_lock                                   lc_;
+    std::vector<std::shared_ptr<detail_profile::ring>> rings_;
+    uint32_t                                          next_tid_ = 1;
+    capo::spin_lock                                   shared_lc_;
+    std::shared_ptr<detail_profile::ring>             shared_;    // if local_ is invalid
+
+public:
+    explicit profiler(bool enabled = true, size_t ring_size = CAPO_PROFILE_RING_SIZE_)
+        : enabled_(enabled), ring_size_(ring_size)
+    {
+        detail_profile::now(); // calibrate the clock in advance
+    }
+
+    static profiler& global(void)
+    {
+        static profiler inst;
+        return inst;
+    }
+
+    bool enabled(void) const { return enabled_.load(std::memory_order_relaxed); }
+    void enable(bool e = true) { enabled_.store(e, std::memory_order_relaxed); }
+    void disable(void)         { enable(false); }
+
+    /*
+        The ring of the calling thread, or nullptr if the thread-local key could not be created
+        (then the scopes are recorded by push_shared).
+    */
+    detail_profile::ring* local(void)
+    {
+        if (!local_.valid()) return nullptr;
+        detail_profile::owner* o = local_;
+        if (o != nullptr) return o->ring_.get();
+        o = new detail_profile::owner;
+        {
+            std::lock_guard<capo::spin_lock> guard { lc_ };
+            for (auto& r : rings_)
+            {
+                bool expected = false;
+                if (r->used_.compare_exchange_strong(expected, true, std::memory_order_acquire))
+                {
+                    o->ring_ = r;
+                    break;
+                }
+            }
+            if (!o->ring_)
+            {
+                o->ring_ = std::make_shared<detail_profile::ring>(ring_size_, next_tid_++);
+                rings_.push_back(o->ring_);
+            }
+        }
+        local_ = o;
+        return o->ring_.get();
+    }
+
+    /*
+        Records a scope into one ring shared by all threads (under shared_lc_).
+        The depths of the threads could not be told apart, so the scopes are flat (all at depth 0).
+    */
+    void push_shared(const char* name, uint64_t begin, uint64_t end)
+    {
+        std::lock_guard<capo::spin_lock> guard { shared_lc_ };
+        if (!shared_)
+        {
+            std::lock_guard<capo::spin_lock> guard_rings { lc_ };
+            shared_ = std::make_shared<detail_profile::ring>(ring_size_, next_tid_++);
+            rings_.push_back(shared_);
+        }
+        shared_->push(name, begin, end, 0);
+    }
+
+    /*
+        Drops all recorded events.
+    */
+    void clear(void)
+    {
+        std::lock_guard<capo::spin_lock> guard { lc_ };
+        for (auto& r : rings_) r->clear();
+    }
+
+    /*
+        The recorded events of all threads, ordered by thread and begin time
+        (parents before their children).
+    */
+    std::vector<profile_event> events(void)
+    {
+        std::vector<profile_event> evs;
+        {
+            std::lock_guard<capo::spin_lock> guard { lc_ };
+            for (auto& r : rings_) r->collect(evs);
+        }
+        std::sort(evs.begin(), evs.end(), [](const profile_event& a, const profile_event& b)
+        {
+            if (a.tid_   != b.tid_  ) return a.tid_   < b.tid_;
+            if (a.begin_ != b.begin_) return a.begin_ < b.begin_;
+            return a.depth_ < b.depth_;
+        });
+        return evs;
+    }
+
+    /*
+        Merges the scopes of all threads into a call tree keyed by the scope names.
+        The returned root has no name, its total is the sum of the top-level scopes.
+    */
+    profile_node aggregate(void)
+    {
+        profile_node root;
+        struct frame { const profile_event* ev_; profile_node* node_; };
+        std::vector<frame> stack;
+        auto evs = events();
+        for (size_t i = 0; i < evs.size(); ++i)
+        {
+            const profile_event& ev = evs[i];
+            if ((i == 0) || (evs[i - 1].tid_ != ev.tid_)) stack.clear();
+            while (!stack.empty())
+            {
+                const profile_event& top = *stack.back().ev_;
+                if ((ev.end_ <= top.end_) && (ev.depth_ > top.depth_)) break;
+                stack.pop_back();
+            }
+            profile_node& node = (stack.empty() ? root : *stack.back().node_).child(ev.name_);
+            node.count_ += 1;
+            node.total_ += ev.end_ - ev.begin_;
+            if (stack.empty()) root.total_ += ev.end_ - ev.begin_;
+            stack.push_back({ &ev, &node });
+        }
+        detail_profile::finish(root);
+        root.self_ = 0;
+        return root;
+    }
+
+    /*
+        Prints the aggregated call tree (count, total and self time in microseconds),
+        the output is the same as capo::printf's.
+    */
+    template <typename F>
+    void report(F&& out)
+    {
+        profile_node root = aggregate();
+        capo::printf(out, "%-40s %10s %14s %14s\n", "scope", "count", "total(us)", "self(us)");
+        for (auto& c : root.children_) detail_profile::print(out, c, 0);
+    }
+
+    /*
+        Writes the events as Chrome trace_event JSON (chrome://tracing, Perfetto).
+        The output can be anything json_writer accepts.
+    */
+    template <typename F>
+    void write_chrome_trace(F&& out)
+    {
+        auto evs = events();
+        capo::json_writer<F&&> w { std::forward<F>(out) };
+        w.begin_object().key("traceEvents").begin_array();
+        for (size_t i = 0; i < evs.size(); ++i)
+        {
+            const profile_event& ev = evs[i];
+            if ((i == 0) || (evs[i - 1].tid_ != ev.tid_))
+            {
+                std::string name = "thread " + std::to_string(ev.tid_);
+                w.begin_object()
+                 .member("name", "thread_name").member("ph", "M").member("pid", 1).member("tid", ev.tid_)
+                 .key("args").begin_object().member("name", name).end_object()
+                 .end_object();
+            }
+            w.begin_object()
+             .member("name", ev.name_).member("ph", "X").member("pid", 1).member("tid", ev.tid_)
+             .member("ts" , ev.begin_ / 1e3)
+             .member("dur", (ev.end_ - ev.begin_) / 1e3)
+             .end_object();
+        }
+        w.end_array().member("displayTimeUnit", "ns").end_object();
+    }
+};
+
+/*
+    Records the scope into the profiler when it exits.
+*/
+
+inline auto profile_scope(profiler& prof, const char* name)
+{
+    detail_profile::ring* rg = nullptr;
+    uint64_t begin = 0;
+    bool     on    = prof.enabled();
+    if (on)
+    {
+        rg = prof.local();
+        if (rg != nullptr) ++(rg->depth_);
+        begin = detail_profile::now();
+    }
+    return capo::make<scope_guard>([&prof, rg, name, begin, on]
+    {
+        if (!on) return;
+        uint64_t end = detail_profile::now();
+        if (rg != nullptr) rg->push(name, begin, end, --(rg->depth_));
+        else prof.push_shared(name, begin, end);
+    });
+}
+
+inline auto profile_scope(const char* name)
+{
+    return profile_scope(profiler::global(), name);
+}
+
+/*
+    Do things like this:
+    -->
+    void decode(void)
+    {
+        CAPO_PROFILE_SCOPE_("decode");              // into profiler::global()
+        ...
+        {
+            CAPO_PROFILE_SCOPE_(my_prof, "inner");  // into my_prof
+            ...
+        }
+    }
+*/
+
+#if CAPO_PROFILE_ENABLED_
+#   define CAPO_PROFILE_SCOPE_L_(L, ...) auto CAPO_SCOPE_GUARD_V_(L) = capo::profile_scope(__VA_ARGS__)
+#   define CAPO_PROFILE_SCOPE_(...)      CAPO_PROFILE_SCOPE_L_(__LINE__, __VA_ARGS__)
+#else /*!CAPO_PROFILE_ENABLED_*/
+#   define CAPO_PROFILE_SCOPE_(...)
+#endif/*!CAPO_PROFILE_ENABLED_*/
+
+} // namespace capo
@@ -7,16 +7,311 @@
 
 #pragma once
 
-#include <random>   // std::default_random_engine, std::uniform_int_distribution
-#include <utility>  // std::forward
+#include "capo/random_engine.hpp"
+#include "capo/concept.hpp"
+#include "capo/thread_local_ptr.hpp"
+#include "capo/spin_lock.hpp"
+#include "capo/noncopyable.hpp"
+#include "capo/unused.hpp"
+
+#include <random>       // std::default_random_engine, std::uniform_int_distribution, ...
+#include <atomic>       // std::atomic
+#include <vector>       // std::vector
+#include <mutex>        // std::lock_guard
+#include <iterator>     // std::distance, std::begin, std::end
+#include <type_traits>  // std::integral_constant, std::make_unsigned
+#include <algorithm>    // std::min
+#include <utility>      // std::forward
+#include <cmath>        // std::log, std::sqrt, std::cos, std::sin
+#include <cstdint>      // uint64_t, uint32_t
+#include <cstddef>      // size_t
 
 namespace capo {
 
+////////////////////////////////////////////////////////////////
+/// Seeding policies for random
+////////////////////////////////////////////////////////////////
+
+namespace use {
+
+/*
+    seed      - a fixed seed, for reproducible sequences
+    fast_seed - a different seed for every instance, without a std::random_device call
+                (splitmix64 of a global counter, started from std::random_device once)
+    stream    - the index_-th independent stream of a fixed seed, for parallel generation
+*/
+
+struct seed
+{
+    uint64_t value_;
+};
+
+struct fast_seed {};
+
+struct stream
+{
+    uint64_t seed_;
+    uint64_t index_;
+};
+
+} // namespace use
+
+namespace detail_random {
+
+inline uint64_t next_seed(void)
+{
+    static std::atomic<uint64_t> counter
+    {
+        (static_cast<uint64_t>(std::random_device{}()) << 32) ^ std::random_device{}()
+    };
+    return mix64(counter.fetch_add(golden_gamma, std::memory_order_relaxed) + golden_gamma);
+}
+
+CAPO_CONCEPT_TYPING_(can_jump       , std::declval<T&>().jump());
+CAPO_CONCEPT_TYPING_(can_seed_stream, std::declval<T&>().seed(uint64_t{}, uint64_t{}));
+
+/*
+    Moves a seeded engine to its index-th stream:
+    the xor-shift engines jump() index times (2^128 calls apart for xoshiro256**),
+    the PCG engines select the index-th increment, others are reseeded through splitmix64.
+*/
+template <typename E>
+void to_stream(E& eng, uint64_t /*seed*/, uint64_t index, std::integral_constant<int, 0> /*can_jump*/)
+{
+    while (index-- > 0) eng.jump();
+}
+
+template <typename E>
+void to_stream(E& eng, uint64_t seed, uint64_t index, std::integral_constant<int, 1> /*can_seed_stream*/)
+{
+    eng.seed(seed, index);
+}
+
+template <typename E>
+void to_stream(E& eng, uint64_t seed, uint64_t index, std::integral_constant<int, 2>)
+{
+    if (index > 0) eng.seed(mix64(seed + index * golden_gamma));
+}
+
+template <typename E>
+E make_stream(use::stream s)
+{
+    E eng(s.seed_);
+    to_stream(eng, s.seed_, s.index_, std::integral_constant<int, can_jump<E>::value        ? 0 :
+                                                                  can_seed_stream<E>::value ? 1 : 2>{});
+    return eng;
+}
+
+////////////////////////////////////////////////////////////////
+/// Generating in bulk
+////////////////////////////////////////////////////////////////
+
+CAPO_CONCEPT_TYPING_(can_generate, std::declval<T&>().generate(static_cast<uint64_t*>(nullptr), size_t{}));
+
+/*
+    The random bits of an engine: 64 (or 32) means each call gives 64 (or 32) uniform bits,
+    0 means the engine could only be used through the std distributions.
+*/
+template <typename E>
+struct bits_of : std::integral_constant<unsigned,
+    ((E::min() == 0) && (E::max() == 0xffffffffffffffffull)) ? 64 :
+    ((E::min() == 0) && (E::max() == 0xffffffffull))         ? 32 : 0>
+{};
+
+template <typename E>
+uint64_t raw1(E& eng)
+{
+    if (bits_of<E>::value == 64) return static_cast<uint64_t>(eng());
+    uint64_t hi = static_cast<uint64_t>(eng());
+    return (hi << 32) | static_cast<uint64_t>(eng());
+}
+
+template <typename E>
+void raw(E& eng, uint64_t* out, size_t n, std::true_type /*can_generate*/)
+{
+    eng.generate(out, n);
+}
+
+template <typename E>
+void raw(E& eng, uint64_t* out, size_t n, std::false_type)
+{
+    for (size_t i = 0; i < n; ++i) out[i] = raw1(eng);
+}
+
+/*
+    Calls f(bits, count) with blocks of uniform 64-bit values.
+*/
+template <typename E, typename F>
+void for_blocks(E& eng, size_t n, F&& f)
+{
+    uint64_t bits[256];
+    while (n > 0)
+    {
+        size_t c = (std::min)(n, sizeof(bits) / sizeof(bits[0]));
+        raw(eng, bits, c, can_generate<E>{});
+        f(static_cast<const uint64_t*>(bits), c);
+        n -= c;
+    }
+}
+
+/*
+    Uniform in [0, 1), with the precision of F.
+*/
+template <typename F>
+F to_unit(uint64_t x)
+{
+    return (sizeof(F) == sizeof(float)) ? static_cast<F>(static_cast<float>(x >> 40) * (1.0f / 16777216.0f))
+                                        : static_cast<F>(static_cast<double>(x >> 11) * (1.0 / 9007199254740992.0));
+}
+
+/*
+    The transformations of the distributions, without any branch in the hot loops.
+*/
+template <typename D>
+struct bulk : std::false_type {};
+
+/*
+    Lemire's nearly divisionless method on 32-bit ranges, the rare biased values
+    are redrawn afterwards. 64-bit ranges go through the std distribution.
+    See: Daniel Lemire, Fast Random Integer Generation in an Interval
+*/
+template <typename I>
+struct bulk<std::uniform_int_distribution<I>> : std::true_type
+{
+    template <typename E, typename It>
+    static It generate(E& eng, std::uniform_int_distribution<I>& dist, It out, size_t n)
+    {
+        using u_t = typename std::make_unsigned<I>::type;
+        uint64_t range = static_cast<uint64_t>(static_cast<u_t>(static_cast<u_t>(dist.b()) - static_cast<u_t>(dist.a()))) + 1;
+        if ((range > 0x100000000ull) || (range == 0))
+        {
+            for (; n > 0; --n) *out++ = dist(eng);
+            return out;
+        }
+        u_t      a      = static_cast<u_t>(dist.a());
+        uint64_t thresh = (0x100000000ull - range) % range;
+        for_blocks(eng, n, [&](const uint64_t* bits, size_t c)
+        {
+            uint64_t m[256];
+            bool     redraw = false;
+            for (size_t i = 0; i < c; ++i)
+            {
+                m[i]    = (bits[i] >> 32) * range;
+                redraw |= ((m[i] & 0xffffffffu) < thresh);
+            }
+            if (redraw) for (size_t i = 0; i < c; ++i)
+            {
+                while ((m[i] & 0xffffffffu) < thresh) m[i] = (raw1(eng) >> 32) * range;
+            }
+            for (size_t i = 0; i < c; ++i) *out++ = static_cast<I>(static_cast<u_t>(a + (m[i] >> 32)));
+        });
+        return out;
+    }
+};
+
+template <typename F>
+struct bulk<std::uniform_real_distribution<F>> : std::true_type
+{
+    template <typename E, typename It>
+    static It generate(E& eng, std::uniform_real_distribution<F>& dist, It out, size_t n)
+    {
+        F a = dist.a(), w = dist.b() - dist.a();
+        for_blocks(eng, n, [&](const uint64_t* bits, size_t c)
+        {
+            for (size_t i = 0; i < c; ++i) *out++ = a + to_unit<F>(bits[i]) * w;
+        });
+        return out;
+    }
+};
+
+template <>
+struct bulk<std::bernoulli_distribution> : std::true_type
+{
+    template <typename E, typename It>
+    static It generate(E& eng, std::bernoulli_distribution& dist, It out, size_t n)
+    {
+        double t = dist.p() * 18446744073709551616.0; // p * 2^64
+        if (t >= 18446744073709551616.0)
+        {
+            for (; n > 0; --n) *out++ = true;
+            return out;
+        }
+        auto thresh = static_cast<uint64_t>(t);
+        for_blocks(eng, n, [&](const uint64_t* bits, size_t c)
+        {
+            for (size_t i = 0; i < c; ++i) *out++ = (bits[i] < thresh);
+        });
+        return out;
+    }
+};
+
+/*
+    Box-Muller transform, each pair of uniform values gives two normal values.
+*/
+template <typename F>
+struct bulk<std::normal_distribution<F>> : std::true_type
+{
+    template <typename E, typename It>
+    static It generate(E& eng, std::normal_distribution<F>& dist, It out, size_t n)
+    {
+        const double two_pi = 6.283185307179586476925;
+        double mean = dist.mean(), stddev = dist.stddev();
+        for_blocks(eng, n + (n & 1), [&](const uint64_t* bits, size_t c)
+        {
+            double v[256];
+            for (size_t i = 0; i < c; i += 2)
+            {
+                double u1 = static_cast<double>((bits[i] >> 11) + 1) * (1.0 / 9007199254740992.0); // (0, 1]
+                double u2 = to_unit<double>(bits[i + 1]);
+                double r  = std::sqrt(-2.0 * std::log(u1));
+                v[i]      = mean + stddev * r * std::cos(two_pi * u2);
+                v[i + 1]  = mean + stddev * r * std::sin(two_pi * u2);
+            }
+            if (c > n) c = n; // the last odd one
+            for (size_t i = 0; i < c; ++i) *out++ = static_cast<F>(v[i]);
+            n -= c;
+        });
+        return out;
+    }
+};
+
+template <typename E, typename D, typename It>
+It generate_n(E& eng, D& dist, It out, size_t n, std::true_type)
+{
+    return bulk<D>::generate(eng, dist, out, n);
+}
+
+template <typename E, typename D, typename It>
+It generate_n(E& eng, D& dist, It out, size_t n, std::false_type)
+{
+    for (; n > 0; --n) *out++ = dist(eng);
+    return out;
+}
+
+} // namespace detail_random
+
 ////////////////////////////////////////////////////////////////
 /// Simple way of generating random numbers
 ////////////////////////////////////////////////////////////////
 
-template <class Engine       = std::default_random_engine, 
+/*
+    Do things like this:
+    -->
+    capo::random<> rdm { 1, 100 };                                      // seeded by std::random_device
+    capo::random<capo::xoshiro256ss> rdm { capo::use::fast_seed{}, 1, 100 };
+    capo::random<capo::pcg32, std::uniform_real_distribution<>> rdm { capo::use::seed{ 42 } };
+    -->
+    capo::random<capo::xoshiro256ss_x8, std::normal_distribution<>> rdm { capo::use::seed{ 42 } };
+    std::vector<double> samples(1000000);
+    rdm.fill(samples);
+
+    <Remarks>
+    fill and generate_n transform the bits of the engine in blocks for the uniform int (32-bit ranges),
+    uniform real, bernoulli and normal distributions, and fall back to the distribution for the others.
+    The bulk results are deterministic for a given seed, but not the same as calling operator() repeatedly.
+*/
+
+template <class Engine       = std::default_random_engine,
           class Distribution = std::uniform_int_distribution<>>
 class random : public Distribution
 {
@@ -38,6 +333,33 @@ public:
         , engine_(std::random_device{}())
     {}
 
+    template <typename... T>
+    random(use::seed s, T&&... args)
+        : base_t (std::forward<T>(args)...)
+        , engine_(s.value_)
+    {}
+
+    template <typename... T>
+    random(use::fast_seed, T&&... args)
+        : base_t (std::forward<T>(args)...)
+        , engine_(detail_random::next_seed())
+    {}
+
+    template <typename... T>
+    random(use::stream s, T&&... args)
+        : base_t (std::forward<T>(args)...)
+        , engine_(detail_random::make_stream<Engine>(s))
+    {}
+
+    engine_type      & engine(void)       { return engine_; }
+    engine_type const& engine(void) const { return engine_; }
+
+    void seed(uint64_t s)
+    {
+        engine_.seed(s);
+        base_t::reset();
+    }
+
     result_type operator()(void)
     {
         return base_t::operator()(engine_);
@@ -47,6 +369,193 @@ public:
     {
         return base_t::operator()(engine_, parm);
     }
+
+    template <typename OutputIt>
+    OutputIt generate_n(OutputIt out, size_t n)
+    {
+        using fast_t = std::integral_constant<bool, detail_random::bulk<distribution_type>::value &&
+                                                    (detail_random::bits_of<engine_type>::value != 0)>;
+        return detail_random::generate_n(engine_, static_cast<base_t&>(*this), out, n, fast_t{});
+    }
+
+    template <typename ForwardIt>
+    void fill(ForwardIt first, ForwardIt last)
+    {
+        generate_n(first, static_cast<size_t>(std::distance(first, last)));
+    }
+
+    template <typename Container>
+    void fill(Container& c)
+    {
+        fill(std::begin(c), std::end(c));
+    }
+};
+
+////////////////////////////////////////////////////////////////
+/// Per-thread random
+////////////////////////////////////////////////////////////////
+
+namespace detail_random {
+
+struct thread_state
+{
+    std::atomic<uint64_t> seed_ { (static_cast<uint64_t>(std::random_device{}()) << 32) ^ std::random_device{}() };
+    std::atomic<uint64_t> next_index_ { 0 };
+
+    static thread_state& instance(void)
+    {
+        static thread_state st;
+        return st;
+    }
+};
+
+inline uint64_t& thread_index(void)
+{
+    static CAPO_THREAD_LOCAL_POD_ uint64_t index = 0; // 0: not assigned, or index + 1
+    return index;
+}
+
+/* Set by thread_random_index */
+inline bool& thread_indexed(void)
+{
+    static CAPO_THREAD_LOCAL_POD_ bool indexed = false;
+    return indexed;
+}
+
+/*
+    The randoms of the exited threads (of the default indexes), which are reused by the new threads.
+    So the default indexes (and the jumps to reach their streams) are bounded by the number of
+    the threads running at the same time, and a reused stream goes on instead of repeating itself.
+*/
+template <typename R>
+class thread_cache
+{
+    struct entry
+    {
+        uint64_t seed_;
+        R*       r_;
+    };
+
+    capo::spin_lock    lc_;
+    std::vector<entry> free_;
+
+public:
+    static thread_cache& instance(void)
+    {
+        static thread_cache inst;
+        return inst;
+    }
+
+    ~thread_cache(void)
+    {
+        for (auto& e : free_) delete e.r_;
+    }
+
+    /* The ones of another seed are dropped */
+    R* take(uint64_t seed)
+    {
+        std::lock_guard<capo::spin_lock> guard { lc_ };
+        while (!free_.empty())
+        {
+            entry e = free_.back();
+            free_.pop_back();
+            if (e.seed_ == seed) return e.r_;
+            delete e.r_;
+        }
+        return nullptr;
+    }
+
+    void put(uint64_t seed, R* r)
+    {
+        std::lock_guard<capo::spin_lock> guard { lc_ };
+        try { free_.push_back({ seed, r }); }
+        catch (...) { delete r; }
+    }
+};
+
+/* A new random at the stream of the calling thread */
+template <typename R>
+R* new_thread_random(uint64_t seed = thread_state::instance().seed_.load(std::memory_order_relaxed))
+{
+    auto& id = thread_index();
+    if (id == 0) id = thread_state::instance().next_index_.fetch_add(1, std::memory_order_relaxed) + 1;
+    return new R(use::stream{ seed, id - 1 });
+}
+
+/* The random of a thread, which is given back to the cache at the thread exit */
+template <typename R>
+struct thread_owner : capo::noncopyable
+{
+    uint64_t seed_  = thread_state::instance().seed_.load(std::memory_order_relaxed);
+    bool     reuse_ = !thread_indexed();
+    R*       r_     = reuse_ ? thread_cache<R>::instance().take(seed_) : nullptr;
+
+    thread_owner(void)
+    {
+        if (r_ == nullptr) r_ = new_thread_random<R>(seed_);
+    }
+
+    ~thread_owner(void)
+    {
+        if (reuse_) thread_cache<R>::instance().put(seed_, r_);
+        else delete r_;
+    }
 };
 
+} // namespace detail_random
+
+/*
+    Sets the global seed of thread_random, the threads which have not used thread_random yet
+    would see the new seed. By default it is drawn from std::random_device.
+*/
+inline void thread_random_seed(uint64_t seed)
+{
+    detail_random::thread_state::instance().seed_.store(seed, std::memory_order_relaxed);
+}
+
+/*
+    Sets the stream index of the calling thread, before its first use of thread_random.
+    By default the threads are indexed by the order of their first use of thread_random.
+*/
+inline void thread_random_index(uint64_t index)
+{
+    detail_random::thread_index()   = index + 1;
+    detail_random::thread_indexed() = true;
+}
+
+/*
+    The random of the calling thread, created on the first use and deleted at the thread exit.
+    Each thread takes the use::stream of the global seed at its index, so the threads never share
+    a state or a lock, and the sequences are reproducible with a fixed seed and fixed indexes.
+    Without a fixed index, a thread might go on with the random of an exited thread.
+    Do things like this:
+    -->
+    capo::thread_random_seed(42);
+    ...
+    // in the worker threads
+    double x = capo::thread_random<capo::xoshiro256ss, std::uniform_real_distribution<>>()();
+*/
+
+template <class Engine       = capo::xoshiro256ss,
+          class Distribution = std::uniform_int_distribution<>>
+capo::random<Engine, Distribution>& thread_random(void)
+{
+    using random_t = capo::random<Engine, Distribution>;
+    using owner_t  = detail_random::thread_owner<random_t>;
+    static auto& CAPO_UNUSED_ cache = detail_random::thread_cache<random_t>::instance(); // outlives local
+    static capo::thread_local_ptr<owner_t> local;
+    owner_t* o = local;
+    if (o != nullptr) return *(o->r_);
+    if (!local.valid())
+    {
+        // The keys are run out, the random is kept by a plain thread-local pointer,
+        // which could not be deleted (or reused) at the thread exit.
+        static CAPO_THREAD_LOCAL_POD_ random_t* kept = nullptr;
+        if (kept == nullptr) kept = detail_random::new_thread_random<random_t>();
+        return (*kept);
+    }
+    local = o = new owner_t;
+    return *(o->r_);
+}
+
 } // namespace capo
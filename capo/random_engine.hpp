@@ -0,0 +1,501 @@
+/*
+    The Capo Library
+    Code covered by the MIT License
+
+    Author: mutouyun (http://orzz.org)
+*/
+
+#pragma once
+
+#include <limits>       // std::numeric_limits
+#include <cstdint>      // uint64_t, uint32_t
+#include <cstddef>      // size_t
+
+namespace capo {
+namespace detail_random {
+
+inline constexpr uint64_t rotl(uint64_t x, unsigned k)
+{
+    return (x << k) | (x >> (64 - k));
+}
+
+inline constexpr uint64_t rotr(uint64_t x, unsigned k)
+{
+    return (x >> k) | (x << ((64 - k) & 63));
+}
+
+inline constexpr uint32_t rotr(uint32_t x, unsigned k)
+{
+    return (x >> k) | (x << ((32 - k) & 31));
+}
+
+/*
+    The finalizer of splitmix64, a good 64-bit mixing function.
+*/
+inline uint64_t mix64(uint64_t z)
+{
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+    return z ^ (z >> 31);
+}
+
+enum : uint64_t { golden_gamma = 0x9e3779b97f4a7c15ull };
+
+/*
+    For the xor-shift family: jumps the state as if N calls had been made,
+    N is decided by the polynomial in Table.
+*/
+template <typename EngineT, size_t N, size_t M>
+void jump(EngineT& eng, uint64_t (&s)[N], const uint64_t (&table)[M])
+{
+    uint64_t t[N] = {};
+    for (uint64_t j : table)
+    {
+        for (unsigned b = 0; b < 64; ++b)
+        {
+            if (j & (1ull << b))
+                for (size_t i = 0; i < N; ++i) t[i] ^= s[i];
+            eng();
+        }
+    }
+    for (size_t i = 0; i < N; ++i) s[i] = t[i];
+}
+
+////////////////////////////////////////////////////////////////
+/// 128-bit unsigned integer, for pcg64
+////////////////////////////////////////////////////////////////
+
+#if defined(__SIZEOF_INT128__)
+using uint128 = unsigned __int128;
+
+inline constexpr uint128  make128(uint64_t hi, uint64_t lo) { return (static_cast<uint128>(hi) << 64) | lo; }
+inline constexpr uint64_t high64 (uint128 x)                { return static_cast<uint64_t>(x >> 64); }
+inline constexpr uint64_t low64  (uint128 x)                { return static_cast<uint64_t>(x); }
+#else /*!__SIZEOF_INT128__*/
+struct uint128
+{
+    uint64_t hi_, lo_;
+
+    constexpr uint128(uint64_t lo = 0) : hi_(0), lo_(lo) {}
+    constexpr uint128(uint64_t hi, uint64_t lo) : hi_(hi), lo_(lo) {}
+
+    friend uint128 operator+(uint128 a, uint128 b)
+    {
+        uint64_t lo = a.lo_ + b.lo_;
+        return { a.hi_ + b.hi_ + (lo < a.lo_), lo };
+    }
+
+    friend uint128 operator*(uint128 a, uint128 b)
+    {
+        uint64_t a0 = a.lo_ & 0xffffffffu, a1 = a.lo_ >> 32;
+        uint64_t b0 = b.lo_ & 0xffffffffu, b1 = b.lo_ >> 32;
+        uint64_t p00 = a0 * b0, p01 = a0 * b1, p10 = a1 * b0, p11 = a1 * b1;
+        uint64_t mid = (p00 >> 32) + (p01 & 0xffffffffu) + (p10 & 0xffffffffu);
+        uint64_t hi  = p11 + (p01 >> 32) + (p10 >> 32) + (mid >> 32);
+        return { hi + a.hi_ * b.lo_ + a.lo_ * b.hi_, (mid << 32) | (p00 & 0xffffffffu) };
+    }
+
+    friend bool operator==(uint128 a, uint128 b) { return (a.hi_ == b.hi_) && (a.lo_ == b.lo_); }
+};
+
+inline constexpr uint128  make128(uint64_t hi, uint64_t lo) { return { hi, lo }; }
+inline constexpr uint64_t high64 (uint128 x)                { return x.hi_; }
+inline constexpr uint64_t low64  (uint128 x)                { return x.lo_; }
+#endif/*!__SIZEOF_INT128__*/
+
+/*
+    Advances a LCG by delta steps in O(log(delta)).
+    See: Forrest B. Brown, Random Number Generation with Arbitrary Stride
+*/
+template <typename UInt>
+UInt advance_lcg(UInt state, unsigned long long delta, UInt mult, UInt plus)
+{
+    UInt acc_mult = 1, acc_plus = 0;
+    while (delta > 0)
+    {
+        if (delta & 1)
+        {
+            acc_mult = acc_mult * mult;
+            acc_plus = acc_plus * mult + plus;
+        }
+        plus  = (mult + 1) * plus;
+        mult  = mult * mult;
+        delta >>= 1;
+    }
+    return acc_mult * state + acc_plus;
+}
+
+template <typename T>
+struct engine_limits
+{
+    using result_type = T;
+
+    static constexpr result_type min(void) { return 0; }
+    static constexpr result_type max(void) { return (std::numeric_limits<result_type>::max)(); }
+};
+
+} // namespace detail_random
+
+////////////////////////////////////////////////////////////////
+/// Fast non-cryptographic random number engines
+////////////////////////////////////////////////////////////////
+
+/*
+    All engines below meet the requirements of UniformRandomBitGenerator,
+    so they could be used with the std distributions and capo::random.
+    Any 64-bit value is a good seed, seeding costs a few arithmetic operations.
+*/
+
+/*
+    splitmix64, Sebastiano Vigna (2015).
+    Weyl sequence plus a mixing function, discard(n) is O(1).
+*/
+
+class splitmix64 : public detail_random::engine_limits<uint64_t>
+{
+    uint64_t x_;
+
+public:
+    enum : uint64_t { default_seed = 0 };
+
+    explicit splitmix64(uint64_t s = default_seed) : x_(s) {}
+
+    void seed(uint64_t s = default_seed) { x_ = s; }
+
+    result_type operator()(void)
+    {
+        return detail_random::mix64(x_ += detail_random::golden_gamma);
+    }
+
+    void discard(unsigned long long n)
+    {
+        x_ += detail_random::golden_gamma * n;
+    }
+
+    friend bool operator==(const splitmix64& a, const splitmix64& b) { return a.x_ == b.x_; }
+    friend bool operator!=(const splitmix64& a, const splitmix64& b) { return a.x_ != b.x_; }
+};
+
+/*
+    xoshiro256**, David Blackman and Sebastiano Vigna (2018).
+    All-purpose 64-bit generator, period 2^256 - 1.
+    jump() is equivalent to 2^128 calls, long_jump() to 2^192 calls,
+    so each of them could start a non-overlapping stream for a thread.
+*/
+
+class xoshiro256ss : public detail_random::engine_limits<uint64_t>
+{
+    uint64_t s_[4];
+
+    template <size_t> friend class xoshiro256ss_x;
+
+public:
+    enum : uint64_t { default_seed = 0 };
+
+    explicit xoshiro256ss(uint64_t s = default_seed) { seed(s); }
+
+    /* The state is filled by splitmix64 */
+    void seed(uint64_t s = default_seed)
+    {
+        splitmix64 sm { s };
+        for (auto& x : s_) x = sm();
+    }
+
+    result_type operator()(void)
+    {
+        uint64_t r = detail_random::rotl(s_[1] * 5, 7) * 9;
+        uint64_t t = s_[1] << 17;
+        s_[2] ^= s_[0];
+        s_[3] ^= s_[1];
+        s_[1] ^= s_[2];
+        s_[0] ^= s_[3];
+        s_[2] ^= t;
+        s_[3]  = detail_random::rotl(s_[3], 45);
+        return r;
+    }
+
+    void discard(unsigned long long n)
+    {
+        while (n-- > 0) (*this)();
+    }
+
+    void jump(void)
+    {
+        static const uint64_t table[] =
+        {
+            0x180ec6d33cfd0abaull, 0xd5a61266f0c9392cull, 0xa9582618e03fc9aaull, 0x39abdc4529b1661cull
+        };
+        detail_random::jump(*this, s_, table);
+    }
+
+    void long_jump(void)
+    {
+        static const uint64_t table[] =
+        {
+            0x76e15d3efefdcbbfull, 0xc5004e441c522fb3ull, 0x77710069854ee241ull, 0x39109bb02acbe635ull
+        };
+        detail_random::jump(*this, s_, table);
+    }
+
+    friend bool operator==(const xoshiro256ss& a, const xoshiro256ss& b)
+    {
+        return (a.s_[0] == b.s_[0]) && (a.s_[1] == b.s_[1]) && (a.s_[2] == b.s_[2]) && (a.s_[3] == b.s_[3]);
+    }
+    friend bool operator!=(const xoshiro256ss& a, const xoshiro256ss& b) { return !(a == b); }
+};
+
+/*
+    Lanes of xoshiro256** running side by side, for generating in bulk.
+    The states are stored lane by lane (structure of arrays), so the compiler could
+    vectorize a step of all the lanes. Lane 0 is xoshiro256ss(seed), and the other lanes
+    are jump()ed from their previous ones, so the lanes never overlap.
+
+    <Remarks>
+    The outputs are interleaved (lane 0, lane 1, ..., lane 0, ...),
+    they are not the same as a single xoshiro256ss.
+*/
+
+template <size_t Lanes>
+class xoshiro256ss_x : public detail_random::engine_limits<uint64_t>
+{
+    static_assert(Lanes > 0, "Lanes must be greater than 0.");
+
+    uint64_t s0_[Lanes], s1_[Lanes], s2_[Lanes], s3_[Lanes];
+    uint64_t buf_[Lanes];
+    size_t   pos_ = Lanes;
+
+public:
+    enum : uint64_t { default_seed = 0 };
+    enum : size_t   { lanes = Lanes };
+
+    explicit xoshiro256ss_x(uint64_t s = default_seed) { seed(s); }
+
+    void seed(uint64_t s = default_seed)
+    {
+        xoshiro256ss x { s };
+        for (size_t i = 0; i < Lanes; ++i)
+        {
+            s0_[i] = x.s_[0];
+            s1_[i] = x.s_[1];
+            s2_[i] = x.s_[2];
+            s3_[i] = x.s_[3];
+            x.jump();
+        }
+        pos_ = Lanes;
+    }
+
+    /* Steps all the lanes, writes Lanes outputs */
+    void next(uint64_t* out)
+    {
+        for (size_t i = 0; i < Lanes; ++i)
+        {
+            uint64_t r = detail_random::rotl(s1_[i] * 5, 7) * 9;
+            uint64_t t = s1_[i] << 17;
+            s2_[i] ^= s0_[i];
+            s3_[i] ^= s1_[i];
+            s1_[i] ^= s2_[i];
+            s0_[i] ^= s3_[i];
+            s2_[i] ^= t;
+            s3_[i]  = detail_random::rotl(s3_[i], 45);
+            out[i]  = r;
+        }
+    }
+
+    /* The same as n calls of operator() */
+    void generate(uint64_t* out, size_t n)
+    {
+        for (; (pos_ < Lanes) && (n > 0); --n) *out++ = buf_[pos_++];
+        for (; n >= Lanes; n -= Lanes, out += Lanes) next(out);
+        for (; n > 0; --n) *out++ = (*this)();
+    }
+
+    result_type operator()(void)
+    {
+        if (pos_ == Lanes)
+        {
+            next(buf_);
+            pos_ = 0;
+        }
+        return buf_[pos_++];
+    }
+
+    void discard(unsigned long long n)
+    {
+        while (n-- > 0) (*this)();
+    }
+
+    friend bool operator==(const xoshiro256ss_x& a, const xoshiro256ss_x& b)
+    {
+        for (size_t i = 0; i < Lanes; ++i)
+        {
+            if ((a.s0_[i] != b.s0_[i]) || (a.s1_[i] != b.s1_[i]) ||
+                (a.s2_[i] != b.s2_[i]) || (a.s3_[i] != b.s3_[i])) return false;
+        }
+        if (a.pos_ != b.pos_) return false;
+        for (size_t i = a.pos_; i < Lanes; ++i)
+            if (a.buf_[i] != b.buf_[i]) return false;
+        return true;
+    }
+    friend bool operator!=(const xoshiro256ss_x& a, const xoshiro256ss_x& b) { return !(a == b); }
+};
+
+using xoshiro256ss_x4 = xoshiro256ss_x<4>;
+using xoshiro256ss_x8 = xoshiro256ss_x<8>;
+
+/*
+    xoroshiro128+, David Blackman and Sebastiano Vigna (2018).
+    The fastest one for generating floating-point numbers (the lowest bits are weak),
+    period 2^128 - 1. jump() is equivalent to 2^64 calls, long_jump() to 2^96 calls.
+*/
+
+class xoroshiro128p : public detail_random::engine_limits<uint64_t>
+{
+    uint64_t s_[2];
+
+public:
+    enum : uint64_t { default_seed = 0 };
+
+    explicit xoroshiro128p(uint64_t s = default_seed) { seed(s); }
+
+    void seed(uint64_t s = default_seed)
+    {
+        splitmix64 sm { s };
+        for (auto& x : s_) x = sm();
+    }
+
+    result_type operator()(void)
+    {
+        uint64_t s0 = s_[0], s1 = s_[1];
+        uint64_t r  = s0 + s1;
+        s1 ^= s0;
+        s_[0] = detail_random::rotl(s0, 24) ^ s1 ^ (s1 << 16);
+        s_[1] = detail_random::rotl(s1, 37);
+        return r;
+    }
+
+    void discard(unsigned long long n)
+    {
+        while (n-- > 0) (*this)();
+    }
+
+    void jump(void)
+    {
+        static const uint64_t table[] = { 0xdf900294d8f554a5ull, 0x170865df4b3201fcull };
+        detail_random::jump(*this, s_, table);
+    }
+
+    void long_jump(void)
+    {
+        static const uint64_t table[] = { 0xd2a98b26625eee7bull, 0xdddf9b1090aa7ac1ull };
+        detail_random::jump(*this, s_, table);
+    }
+
+    friend bool operator==(const xoroshiro128p& a, const xoroshiro128p& b)
+    {
+        return (a.s_[0] == b.s_[0]) && (a.s_[1] == b.s_[1]);
+    }
+    friend bool operator!=(const xoroshiro128p& a, const xoroshiro128p& b) { return !(a == b); }
+};
+
+/*
+    PCG, Melissa O'Neill (2014), see: http://www.pcg-random.org
+    pcg32 - 64-bit state, XSH-RR output, the same as pcg32_random_r of pcg-c-basic.
+    pcg64 - 128-bit state, XSL-RR output, the same as pcg64_random_r of pcg-c.
+    Different streams of the same seed never overlap, advance(n) is O(log(n)).
+*/
+
+class pcg32 : public detail_random::engine_limits<uint32_t>
+{
+    uint64_t state_, inc_;
+
+    enum : uint64_t { multiplier = 6364136223846793005ull };
+
+    void step(void) { state_ = state_ * multiplier + inc_; }
+
+public:
+    enum : uint64_t
+    {
+        default_seed   = 0x853c49e6748fea9bull,
+        default_stream = 0xda3e39cb94b95bdbull >> 1
+    };
+
+    explicit pcg32(uint64_t s = default_seed, uint64_t stream = default_stream) { seed(s, stream); }
+
+    void seed(uint64_t s = default_seed, uint64_t stream = default_stream)
+    {
+        state_ = 0;
+        inc_   = (stream << 1) | 1;
+        step();
+        state_ += s;
+        step();
+    }
+
+    result_type operator()(void)
+    {
+        uint64_t old = state_;
+        step();
+        auto x = static_cast<uint32_t>(((old >> 18) ^ old) >> 27);
+        return detail_random::rotr(x, static_cast<unsigned>(old >> 59));
+    }
+
+    void advance(unsigned long long delta)
+    {
+        state_ = detail_random::advance_lcg<uint64_t>(state_, delta, multiplier, inc_);
+    }
+
+    void discard(unsigned long long n) { advance(n); }
+
+    friend bool operator==(const pcg32& a, const pcg32& b) { return (a.state_ == b.state_) && (a.inc_ == b.inc_); }
+    friend bool operator!=(const pcg32& a, const pcg32& b) { return !(a == b); }
+};
+
+class pcg64 : public detail_random::engine_limits<uint64_t>
+{
+    using uint128 = detail_random::uint128;
+
+    uint128 state_, inc_;
+
+    static uint128 multiplier(void)
+    {
+        return detail_random::make128(2549297995355413924ull, 4865540595714422341ull);
+    }
+
+    void step(void) { state_ = state_ * multiplier() + inc_; }
+
+public:
+    enum : uint64_t
+    {
+        default_seed   = 0x853c49e6748fea9bull,
+        default_stream = 0xda3e39cb94b95bdbull >> 1
+    };
+
+    explicit pcg64(uint64_t s = default_seed, uint64_t stream = default_stream) { seed(s, stream); }
+
+    void seed(uint64_t s = default_seed, uint64_t stream = default_stream)
+    {
+        state_ = 0;
+        inc_   = detail_random::make128(stream >> 63, (stream << 1) | 1);
+        step();
+        state_ = state_ + s;
+        step();
+    }
+
+    result_type operator()(void)
+    {
+        step();
+        uint64_t hi = detail_random::high64(state_);
+        return detail_random::rotr(hi ^ detail_random::low64(state_), static_cast<unsigned>(hi >> 58));
+    }
+
+    void advance(unsigned long long delta)
+    {
+        state_ = detail_random::advance_lcg<uint128>(state_, delta, multiplier(), inc_);
+    }
+
+    void discard(unsigned long long n) { advance(n); }
+
+    friend bool operator==(const pcg64& a, const pcg64& b) { return (a.state_ == b.state_) && (a.inc_ == b.inc_); }
+    friend bool operator!=(const pcg64& a, const pcg64& b) { return !(a == b); }
+};
+
+} // namespace capo
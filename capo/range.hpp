@@ -13,6 +13,8 @@
 
 #include <stdexcept>    // std::logic_error
 #include <utility>      // std::forward
+#include <tuple>        // std::get, std::tuple_element
+#include <type_traits>  // std::integral_constant
 
 namespace capo {
 namespace detail_range {
@@ -30,6 +32,21 @@ struct arithmetic_range
     }
 };
 
+} // namespace detail_range
+
+namespace detail_sequence {
+
+template <>
+struct closed_form<detail_range::arithmetic_range> : std::integral_constant<form, form::linear>
+{
+    template <typename Tp>
+    static auto step(const Tp& x) -> typename std::tuple_element<1, Tp>::type { return std::get<1>(x); }
+};
+
+} // namespace detail_sequence
+
+namespace detail_range {
+
 ////////////////////////////////////////////////////////////////
 /// The impl class
 ////////////////////////////////////////////////////////////////
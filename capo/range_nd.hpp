@@ -0,0 +1,593 @@
+/*
+    The Capo Library
+    Code covered by the MIT License
+
+    Author: mutouyun (http://orzz.org)
+*/
+
+#pragma once
+
+#include "capo/range.hpp"
+#include "capo/assert.hpp"
+#include "capo/spin_lock.hpp"
+
+#include <array>        // std::array
+#include <vector>       // std::vector
+#include <thread>       // std::thread
+#include <algorithm>    // std::min, std::max
+#include <atomic>       // std::atomic
+#include <mutex>        // std::lock_guard
+#include <exception>    // std::exception_ptr, std::current_exception, std::rethrow_exception
+#include <iterator>     // std::forward_iterator_tag, std::random_access_iterator_tag
+#include <type_traits>  // std::common_type, std::is_arithmetic, std::enable_if
+#include <stdexcept>    // std::logic_error
+#include <utility>      // std::forward
+#include <tuple>        // std::get
+#include <cstdint>      // uint64_t, uint8_t
+#include <cstddef>      // size_t, ptrdiff_t
+
+namespace capo {
+namespace use {
+
+////////////////////////////////////////////////////////////////
+/// Traversal orders of range_nd
+////////////////////////////////////////////////////////////////
+
+struct row_major    {}; // the last dimension changes fastest
+struct column_major {}; // the first dimension changes fastest
+struct morton       {}; // Z-order curve, neighbours in all dimensions stay close
+
+} // namespace use
+
+namespace detail_range_nd {
+
+/*
+    One dimension, the same as a capo::range: first + step * i, for i in [0, size).
+*/
+
+template <typename T>
+struct dim
+{
+    T      first_, step_;
+    size_t size_;
+
+    T at(size_t i) const
+    {
+        T a = first_;
+        a += static_cast<T>(step_ * i);
+        return a;
+    }
+};
+
+template <typename T, typename U>
+dim<T> make_dim(const detail_range::impl<U>& r)
+{
+    auto it = r.begin();
+    return { static_cast<T>(std::get<0>(it.get_tuple())), static_cast<T>(std::get<1>(it.get_tuple())), r.size() };
+}
+
+template <typename T, typename U>
+auto make_dim(const U& extent) -> typename std::enable_if<std::is_arithmetic<U>::value, dim<T>>::type
+{
+    return make_dim<T>(capo::range(extent));
+}
+
+template <typename U>
+struct value_of                           { using type = U; };
+template <typename U>
+struct value_of<detail_range::impl<U>>    { using type = U; };
+
+template <size_t N>
+using index_t = std::array<size_t, N>;
+
+////////////////////////////////////////////////////////////////
+/// Layouts, mapping the positions of a traversal to the indices
+////////////////////////////////////////////////////////////////
+
+/*
+    A layout has:
+    space()           - the count of positions
+    locate(pos, idx)  - the indices at pos, returns false if pos is not in the index space
+    next(pos, idx)    - steps to the next valid position
+*/
+
+template <class Order, size_t N>
+class layout;
+
+template <size_t N>
+class layout<use::row_major, N>
+{
+    index_t<N> ext_;
+
+public:
+    using iterator_category = std::random_access_iterator_tag;
+
+    explicit layout(const index_t<N>& ext) : ext_(ext) {}
+
+    size_t space(void) const
+    {
+        size_t n = 1;
+        for (auto e : ext_) n *= e;
+        return n;
+    }
+
+    bool locate(size_t pos, index_t<N>& idx) const
+    {
+        for (size_t d = N; d > 0; --d)
+        {
+            idx[d - 1] = pos % ext_[d - 1];
+            pos /= ext_[d - 1];
+        }
+        return true;
+    }
+
+    void next(size_t& pos, index_t<N>& idx) const
+    {
+        ++pos;
+        for (size_t d = N; d > 0; --d)
+        {
+            if (++idx[d - 1] < ext_[d - 1]) return;
+            if (d > 1) idx[d - 1] = 0;
+        }
+    }
+};
+
+template <size_t N>
+class layout<use::column_major, N>
+{
+    index_t<N> ext_;
+
+public:
+    using iterator_category = std::random_access_iterator_tag;
+
+    explicit layout(const index_t<N>& ext) : ext_(ext) {}
+
+    size_t space(void) const
+    {
+        size_t n = 1;
+        for (auto e : ext_) n *= e;
+        return n;
+    }
+
+    bool locate(size_t pos, index_t<N>& idx) const
+    {
+        for (size_t d = 0; d < N; ++d)
+        {
+            idx[d] = pos % ext_[d];
+            pos /= ext_[d];
+        }
+        return true;
+    }
+
+    void next(size_t& pos, index_t<N>& idx) const
+    {
+        ++pos;
+        for (size_t d = 0; d < N; ++d)
+        {
+            if (++idx[d] < ext_[d]) return;
+            if (d + 1 < N) idx[d] = 0;
+        }
+    }
+};
+
+/*
+    The bits of the indices are interleaved from the lowest, the dimensions running out of bits
+    are left out, so the space is the product of the extents rounded up to powers of 2
+    (at most 2 ^ N times of the count of elements), and the positions outside are skipped.
+*/
+
+template <size_t N>
+class layout<use::morton, N>
+{
+    index_t<N> ext_;
+    uint8_t    owner_[64]; // the dimension of each bit of a position
+    uint8_t    shift_[64]; // the bit of the index of the dimension
+    size_t     bits_ = 0;
+
+    bool inside(const index_t<N>& idx) const
+    {
+        for (size_t d = 0; d < N; ++d)
+            if (idx[d] >= ext_[d]) return false;
+        return true;
+    }
+
+public:
+    using iterator_category = std::forward_iterator_tag;
+
+    explicit layout(const index_t<N>& ext) : ext_(ext)
+    {
+        size_t need[N], ext_bits[N];
+        for (size_t d = 0; d < N; ++d)
+        {
+            need[d] = 0;
+            while ((size_t(1) << need[d]) < ext_[d]) ++need[d];
+            ext_bits[d] = need[d];
+        }
+        for (bool more = true; more;)
+        {
+            more = false;
+            for (size_t d = 0; d < N; ++d)
+            {
+                if (need[d] == 0) continue;
+                CAPO_ENSURE_(bits_ < 63)(bits_)
+                    .except(std::logic_error("The index space is too large for the morton order."));
+                owner_[bits_] = static_cast<uint8_t>(d);
+                shift_[bits_] = static_cast<uint8_t>(ext_bits[d] - need[d]);
+                ++bits_;
+                more = (--need[d] > 0) || more;
+            }
+        }
+    }
+
+    size_t space(void) const { return size_t(1) << bits_; }
+
+    bool locate(size_t pos, index_t<N>& idx) const
+    {
+        idx.fill(0);
+        for (size_t b = 0; b < bits_; ++b)
+            idx[owner_[b]] |= ((pos >> b) & 1) << shift_[b];
+        return inside(idx);
+    }
+
+    /*
+        pos + 1 clears the trailing ones and sets the lowest zero,
+        so only the bits of the indices at these positions change.
+    */
+    void next(size_t& pos, index_t<N>& idx) const
+    {
+        do
+        {
+            size_t b = 0;
+            while ((pos >> b) & 1) ++b;
+            if (b >= bits_)
+            {
+                pos = space();
+                return;
+            }
+            for (size_t k = 0; k < b; ++k) idx[owner_[k]] &= ~(size_t(1) << shift_[k]);
+            idx[owner_[b]] |= size_t(1) << shift_[b];
+            ++pos;
+        } while (!inside(idx));
+    }
+};
+
+template <typename T, size_t N, class Order>
+class tiles;
+
+////////////////////////////////////////////////////////////////
+/// The impl class
+////////////////////////////////////////////////////////////////
+
+template <typename T, size_t N, class Order>
+class impl
+{
+    template <typename, size_t, class> friend class tiles;
+
+public:
+    using value_type  = std::array<T, N>;
+    using index_type  = index_t<N>;
+    using layout_type = layout<Order, N>;
+    using size_type   = size_t;
+
+    class iterator
+    {
+        const impl* r_   = nullptr;
+        size_t      pos_ = 0;
+        index_type  idx_ {};
+
+        friend class impl;
+
+        iterator(const impl* r, size_t pos) : r_(r), pos_(pos)
+        {
+            if (pos_ < r_->lay_.space()) r_->lay_.locate(pos_, idx_);
+        }
+
+    public:
+        using iterator_category = typename layout_type::iterator_category;
+        using value_type        = typename impl::value_type;
+        using difference_type   = std::ptrdiff_t;
+        using pointer           = void;
+        using reference         = value_type;
+
+        iterator(void) = default;
+
+        /* The indices of the current element */
+        const index_type& index(void) const { return idx_; }
+
+        value_type operator*(void) const
+        {
+            value_type p;
+            for (size_t d = 0; d < N; ++d) p[d] = r_->dims_[d].at(idx_[d]);
+            return p;
+        }
+
+        value_type operator[](difference_type n) const { return *((*this) + n); }
+
+        iterator& operator++(void)
+        {
+            r_->lay_.next(pos_, idx_);
+            return (*this);
+        }
+
+        iterator operator++(int)
+        {
+            iterator old(*this);
+            ++(*this);
+            return old;
+        }
+
+        iterator& operator--(void)              { return (*this) -= 1; }
+        iterator  operator--(int)               { iterator old(*this); --(*this); return old; }
+
+        iterator& operator+=(difference_type n)
+        {
+            pos_ += static_cast<size_t>(n);
+            if (pos_ < r_->lay_.space()) r_->lay_.locate(pos_, idx_);
+            return (*this);
+        }
+
+        iterator& operator-=(difference_type n) { return (*this) += -n; }
+
+        iterator operator+(difference_type n) const { iterator r(*this); return r += n; }
+        iterator operator-(difference_type n) const { iterator r(*this); return r -= n; }
+        friend iterator operator+(difference_type n, const iterator& it) { return it + n; }
+
+        difference_type operator-(const iterator& rhs) const
+        {
+            return static_cast<difference_type>(pos_ - rhs.pos_);
+        }
+
+        bool operator==(const iterator& rhs) const { return (pos_ == rhs.pos_); }
+        bool operator!=(const iterator& rhs) const { return (pos_ != rhs.pos_); }
+        bool operator< (const iterator& rhs) const { return (pos_ <  rhs.pos_); }
+        bool operator> (const iterator& rhs) const { return (pos_ >  rhs.pos_); }
+        bool operator<=(const iterator& rhs) const { return (pos_ <= rhs.pos_); }
+        bool operator>=(const iterator& rhs) const { return (pos_ >= rhs.pos_); }
+    };
+
+    using const_iterator = iterator;
+
+private:
+    std::array<dim<T>, N> dims_;
+    layout_type           lay_;
+
+    static index_type extents_of(const std::array<dim<T>, N>& dims)
+    {
+        index_type ext;
+        for (size_t d = 0; d < N; ++d) ext[d] = dims[d].size_;
+        return ext;
+    }
+
+public:
+    explicit impl(const std::array<dim<T>, N>& dims)
+        : dims_(dims)
+        , lay_ (extents_of(dims))
+    {}
+
+    size_type size  (void)     const { size_t n = 1; for (auto& d : dims_) n *= d.size_; return n; }
+    size_type extent(size_t d) const { return dims_[d].size_; }
+
+    iterator begin(void) const { return { this, 0 }; }
+    iterator end  (void) const { return { this, lay_.space() }; }
+
+    /*
+        The cache blocks of the given sizes (the ones at the ends might be smaller),
+        each tile is a range_nd of the same order, the tiles are in the same order too.
+    */
+    tiles<T, N, Order> tile(const index_type& sizes) const
+    {
+        return { *this, sizes };
+    }
+
+    template <typename... S>
+    tiles<T, N, Order> tile(S... sizes) const
+    {
+        static_assert(sizeof...(S) == N, "The count of the tile sizes must be the same as the dimensions.");
+        return tile(index_type {{ static_cast<size_t>(sizes)... }});
+    }
+};
+
+/*
+    The tiles of a range_nd, the same as a range_nd of the tile grid.
+*/
+
+template <typename T, size_t N, class Order>
+class tiles
+{
+public:
+    using value_type = impl<T, N, Order>;
+    using size_type  = size_t;
+
+private:
+    using grid_t = impl<size_t, N, Order>;
+
+    std::array<dim<T>, N> dims_;
+    index_t<N>            sizes_;
+    grid_t                grid_;
+
+    static std::array<dim<size_t>, N> grid_of(const std::array<dim<T>, N>& dims, index_t<N>& sizes)
+    {
+        std::array<dim<size_t>, N> g;
+        for (size_t d = 0; d < N; ++d)
+        {
+            if (sizes[d] == 0) sizes[d] = 1;
+            g[d] = { 0, 1, (dims[d].size_ + sizes[d] - 1) / sizes[d] };
+        }
+        return g;
+    }
+
+    value_type make(const index_t<N>& g) const
+    {
+        std::array<dim<T>, N> t;
+        for (size_t d = 0; d < N; ++d)
+        {
+            size_t i = g[d] * sizes_[d];
+            t[d] = { dims_[d].at(i), dims_[d].step_, (std::min)(sizes_[d], dims_[d].size_ - i) };
+        }
+        return value_type { t };
+    }
+
+public:
+    class iterator
+    {
+        const tiles*              t_ = nullptr;
+        typename grid_t::iterator it_;
+
+        friend class tiles;
+
+        iterator(const tiles* t, typename grid_t::iterator it) : t_(t), it_(it) {}
+
+    public:
+        using iterator_category = typename grid_t::iterator::iterator_category;
+        using value_type        = typename tiles::value_type;
+        using difference_type   = std::ptrdiff_t;
+        using pointer           = void;
+        using reference         = value_type;
+
+        iterator(void) = default;
+
+        const index_t<N>& index(void) const { return it_.index(); }
+
+        value_type operator*(void) const                      { return t_->make(it_.index()); }
+        value_type operator[](difference_type n) const        { return *((*this) + n); }
+
+        iterator& operator++(void)                             { ++it_; return (*this); }
+        iterator  operator++(int)                              { iterator old(*this); ++it_; return old; }
+        iterator& operator--(void)                             { --it_; return (*this); }
+        iterator  operator--(int)                              { iterator old(*this); --it_; return old; }
+        iterator& operator+=(difference_type n)                { it_ += n; return (*this); }
+        iterator& operator-=(difference_type n)                { it_ -= n; return (*this); }
+        iterator  operator+ (difference_type n) const          { return { t_, it_ + n }; }
+        iterator  operator- (difference_type n) const          { return { t_, it_ - n }; }
+        friend iterator operator+(difference_type n, const iterator& it) { return it + n; }
+        difference_type operator-(const iterator& rhs) const  { return it_ - rhs.it_; }
+
+        bool operator==(const iterator& rhs) const { return (it_ == rhs.it_); }
+        bool operator!=(const iterator& rhs) const { return (it_ != rhs.it_); }
+        bool operator< (const iterator& rhs) const { return (it_ <  rhs.it_); }
+        bool operator> (const iterator& rhs) const { return (it_ >  rhs.it_); }
+        bool operator<=(const iterator& rhs) const { return (it_ <= rhs.it_); }
+        bool operator>=(const iterator& rhs) const { return (it_ >= rhs.it_); }
+    };
+
+    using const_iterator = iterator;
+
+    tiles(const impl<T, N, Order>& r, index_t<N> sizes)
+        : dims_ (r.dims_)
+        , sizes_(sizes)
+        , grid_ (grid_of(dims_, sizes_))
+    {}
+
+    size_type size(void) const { return grid_.size(); }
+
+    iterator begin(void) const { return { this, grid_.begin() }; }
+    iterator end  (void) const { return { this, grid_.end  () }; }
+};
+
+} // namespace detail_range_nd
+
+////////////////////////////////////////////////////////////////
+/// Make a multi-dimensional range
+////////////////////////////////////////////////////////////////
+
+/*
+    Each dimension is an extent or a capo::range, the elements are std::array<T, N>.
+    Do things like this:
+    -->
+    for (auto p : capo::range_nd(rows, cols)) m[p[0]][p[1]] = ...;
+    -->
+    auto r = capo::range_nd<capo::use::morton>(capo::range(0, 64, 2), 64);
+    capo::parallel_for_each(r.tile(16, 16), [&](const auto& t)
+    {
+        for (auto p : t) ...
+    });
+*/
+
+template <class Order = use::row_major, typename... A>
+auto range_nd(const A&... dims)
+    -> detail_range_nd::impl<typename std::common_type<typename detail_range_nd::value_of<A>::type...>::type,
+                             sizeof...(A), Order>
+{
+    using t_t = typename std::common_type<typename detail_range_nd::value_of<A>::type...>::type;
+    return detail_range_nd::impl<t_t, sizeof...(A), Order>
+    {
+        std::array<detail_range_nd::dim<t_t>, sizeof...(A)> {{ detail_range_nd::make_dim<t_t>(dims)... }}
+    };
+}
+
+////////////////////////////////////////////////////////////////
+/// Run f on each element of a range (such as the tiles of a range_nd), in parallel
+////////////////////////////////////////////////////////////////
+
+namespace detail_range_nd {
+
+template <typename It>
+struct shared_iterator
+{
+    capo::spin_lock lc_;
+    It              it_, end_;
+
+    bool take(It& it)
+    {
+        std::lock_guard<capo::spin_lock> guard { lc_ };
+        if (it_ == end_) return false;
+        it = it_++;
+        return true;
+    }
+};
+
+/* The random-access ranges are shared by an atomic index, the others by a locked iterator */
+
+template <typename It, typename F>
+void run_part(shared_iterator<It>& shared, std::atomic<size_t>& next, F& f, std::random_access_iterator_tag)
+{
+    size_t n = static_cast<size_t>(shared.end_ - shared.it_);
+    for (size_t i; (i = next.fetch_add(1, std::memory_order_relaxed)) < n;) f(shared.it_[i]);
+}
+
+template <typename It, typename F, typename Tag>
+void run_part(shared_iterator<It>& shared, std::atomic<size_t>&, F& f, Tag)
+{
+    for (It it; shared.take(it);) f(*it);
+}
+
+} // namespace detail_range_nd
+
+/*
+    The calling thread works as one of the threads, (threads == 0) means hardware_concurrency.
+    The elements are taken one by one, so they are better to be coarse (like the tiles).
+    The first exception thrown by f is rethrown after all threads are joined.
+*/
+
+template <typename R, typename F>
+void parallel_for_each(const R& r, F&& f, size_t threads = 0)
+{
+    using it_t = typename std::decay<decltype(std::begin(r))>::type;
+    if (threads == 0) threads = (std::max)(std::thread::hardware_concurrency(), 1u);
+
+    std::atomic<size_t>                    next { 0 };
+    detail_range_nd::shared_iterator<it_t> shared { {}, std::begin(r), std::end(r) };
+    std::exception_ptr                     err;
+    capo::spin_lock                        err_lc;
+
+    auto work = [&]
+    {
+        try
+        {
+            detail_range_nd::run_part(shared, next, f, typename std::iterator_traits<it_t>::iterator_category{});
+        }
+        catch (...)
+        {
+            std::lock_guard<capo::spin_lock> guard { err_lc };
+            if (!err) err = std::current_exception();
+        }
+    };
+
+    std::vector<std::thread> ths;
+    for (size_t i = 1; i < threads; ++i) ths.emplace_back(work);
+    work();
+    for (auto& t : ths) t.join();
+    if (err) std::rethrow_exception(err);
+}
+
+} // namespace capo
@@ -10,12 +10,18 @@
 #include "capo/assert.hpp"
 #include "capo/iterator.hpp"
 
-#include <type_traits>  // std::add_const, std::add_lvalue_reference
-#include <tuple>        // std::tuple, std::tie
+#include <type_traits>  // std::add_const, std::add_lvalue_reference, std::is_integral, ...
+#include <tuple>        // std::tuple, std::tie, std::get
 #include <stdexcept>    // std::logic_error
 #include <utility>      // std::forward, std::move, std::swap
+#include <algorithm>    // std::copy
 #include <cstddef>      // size_t
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#   include <emmintrin.h> // __m128i, _mm_add_epi32, ...
+#   define CAPO_SEQUENCE_SSE2_
+#endif
+
 namespace capo {
 namespace use {
 
@@ -143,6 +149,7 @@ template <class PolicyT, typename T, class IterT = capo::iterator<PolicyT, T>>
 class impl
 {
 public:
+    using policy_type     = PolicyT;
     using iterator        = IterT;
     using const_iterator  = const iterator;
     using value_type      = T;
@@ -191,4 +198,372 @@ auto sequence(size_t begin, size_t end, U&&... args)
     return { begin, end, std::forward<U>(args)... };
 }
 
+namespace detail_sequence {
+
+////////////////////////////////////////////////////////////////
+/// Closed forms of the policies
+////////////////////////////////////////////////////////////////
+
+enum class form
+{
+    none,       // computed by iterating
+    linear,     // a + d * i
+    exponential // a * q ^ i
+};
+
+/*
+    Specialize it for the policies having a closed form,
+    step(state) gives d or q from the state tuple.
+*/
+
+template <class PolicyT>
+struct closed_form : std::integral_constant<form, form::none> {};
+
+template <int D>
+struct closed_form<use::arithmetic<D>> : std::integral_constant<form, form::linear>
+{
+    template <typename Tp> static int step(const Tp&) { return D; }
+};
+
+template <int Q>
+struct closed_form<use::geometric<Q>> : std::integral_constant<form, form::exponential>
+{
+    template <typename Tp> static int step(const Tp&) { return Q; }
+};
+
+////////////////////////////////////////////////////////////////
+/// Lane stepping
+////////////////////////////////////////////////////////////////
+
+/*
+    The elements are computed in blocks of Lanes.
+    The integers are stepped lane by lane with the wrapping arithmetic, like the iterator does;
+    the floating points are computed from an index vector, so the rounding errors do not accumulate.
+*/
+
+enum : size_t { Lanes = 8 };
+
+template <typename T, bool = std::is_integral<T>::value>
+struct wrap                 { using type = typename std::make_unsigned<T>::type; };
+template <typename T>
+struct wrap<T, false>       { using type = T; };
+
+template <typename T>
+using wrap_t = typename wrap<T>::type;
+
+template <typename T>
+using is_lane_type = std::integral_constant<bool, std::is_arithmetic<T>::value && !std::is_same<T, bool>::value>;
+
+/*
+    8 lanes in SSE2 registers, for the 32-bit and 64-bit unsigned integers, float and double.
+    The others (and the multiplications of integers, which SSE2 does not have) use the plain arrays.
+*/
+
+template <typename T, typename = void>
+struct vec8
+{
+    enum : bool { value = false };
+};
+
+#if defined(CAPO_SEQUENCE_SSE2_)
+template <typename T>
+struct vec8<T, typename std::enable_if<std::is_unsigned<T>::value && (sizeof(T) == 4)>::type>
+{
+    enum : bool { value = true };
+    __m128i v_[2];
+
+    void load (const T* p)      { for (int i = 0; i < 2; ++i) v_[i] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p) + i); }
+    void store(void* p)   const { for (int i = 0; i < 2; ++i) _mm_storeu_si128(reinterpret_cast<__m128i*>(p) + i, v_[i]); }
+    void add  (const vec8& r)   { for (int i = 0; i < 2; ++i) v_[i] = _mm_add_epi32(v_[i], r.v_[i]); }
+    void set1 (T x)             { v_[0] = v_[1] = _mm_set1_epi32(static_cast<int>(x)); }
+};
+
+template <typename T>
+struct vec8<T, typename std::enable_if<std::is_unsigned<T>::value && (sizeof(T) == 8)>::type>
+{
+    enum : bool { value = true };
+    __m128i v_[4];
+
+    void load (const T* p)      { for (int i = 0; i < 4; ++i) v_[i] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p) + i); }
+    void store(void* p)   const { for (int i = 0; i < 4; ++i) _mm_storeu_si128(reinterpret_cast<__m128i*>(p) + i, v_[i]); }
+    void add  (const vec8& r)   { for (int i = 0; i < 4; ++i) v_[i] = _mm_add_epi64(v_[i], r.v_[i]); }
+    void set1 (T x)
+    {
+        T a[Lanes] = { x, x, x, x, x, x, x, x };
+        load(a);
+    }
+};
+
+template <>
+struct vec8<float>
+{
+    enum : bool { value = true };
+    __m128 v_[2];
+
+    void load (const float* p)  { for (int i = 0; i < 2; ++i) v_[i] = _mm_loadu_ps(p + i * 4); }
+    void store(float* p)  const { for (int i = 0; i < 2; ++i) _mm_storeu_ps(p + i * 4, v_[i]); }
+    void add  (const vec8& r)   { for (int i = 0; i < 2; ++i) v_[i] = _mm_add_ps(v_[i], r.v_[i]); }
+    void mul  (const vec8& r)   { for (int i = 0; i < 2; ++i) v_[i] = _mm_mul_ps(v_[i], r.v_[i]); }
+    void set1 (float x)         { v_[0] = v_[1] = _mm_set1_ps(x); }
+};
+
+template <>
+struct vec8<double>
+{
+    enum : bool { value = true };
+    __m128d v_[4];
+
+    void load (const double* p) { for (int i = 0; i < 4; ++i) v_[i] = _mm_loadu_pd(p + i * 2); }
+    void store(double* p) const { for (int i = 0; i < 4; ++i) _mm_storeu_pd(p + i * 2, v_[i]); }
+    void add  (const vec8& r)   { for (int i = 0; i < 4; ++i) v_[i] = _mm_add_pd(v_[i], r.v_[i]); }
+    void mul  (const vec8& r)   { for (int i = 0; i < 4; ++i) v_[i] = _mm_mul_pd(v_[i], r.v_[i]); }
+    void set1 (double x)        { for (int i = 0; i < 4; ++i) v_[i] = _mm_set1_pd(x); }
+};
+#endif/*CAPO_SEQUENCE_SSE2_*/
+
+template <typename T, bool = std::is_integral<T>::value>
+class linear_lanes
+{
+    using w_t = wrap_t<T>;
+
+    w_t lane_[Lanes], step_;
+
+    void fill(T* out, size_t blocks, std::true_type /*vec8*/)
+    {
+        vec8<w_t> lane, step;
+        lane.load(lane_);
+        step.set1(step_);
+        for (; blocks > 0; --blocks, out += Lanes)
+        {
+            lane.store(out);
+            lane.add(step);
+        }
+        lane.store(lane_);
+    }
+
+    void fill(T* out, size_t blocks, std::false_type)
+    {
+        w_t lane[Lanes], step = step_; // locals, out cannot alias them
+        std::copy(lane_, lane_ + Lanes, lane);
+        for (; blocks > 0; --blocks, out += Lanes)
+        {
+            for (size_t j = 0; j < Lanes; ++j)
+            {
+                out [j] = static_cast<T>(lane[j]);
+                lane[j] = static_cast<w_t>(lane[j] + step);
+            }
+        }
+        std::copy(lane, lane + Lanes, lane_);
+    }
+
+public:
+    using value_type = T;
+
+    linear_lanes(T a, T d)
+    {
+        for (size_t j = 0; j < Lanes; ++j)
+            lane_[j] = static_cast<w_t>(static_cast<w_t>(a) + static_cast<w_t>(d) * j);
+        step_ = static_cast<w_t>(static_cast<w_t>(d) * Lanes);
+    }
+
+    void fill(T* out, size_t blocks)
+    {
+        fill(out, blocks, std::integral_constant<bool, vec8<w_t>::value>{});
+    }
+};
+
+template <typename T>
+class linear_lanes<T, false>
+{
+    T idx_[Lanes], a_, d_;
+
+    void fill(T* out, size_t blocks, std::true_type /*vec8*/)
+    {
+        vec8<T> idx, a, d, n, x;
+        idx.load(idx_);
+        a.set1(a_);
+        d.set1(d_);
+        n.set1(static_cast<T>(Lanes));
+        for (; blocks > 0; --blocks, out += Lanes)
+        {
+            x = idx;
+            x.mul(d);
+            x.add(a);
+            x.store(out);
+            idx.add(n);
+        }
+        idx.store(idx_);
+    }
+
+    void fill(T* out, size_t blocks, std::false_type)
+    {
+        T idx[Lanes], a = a_, d = d_;
+        std::copy(idx_, idx_ + Lanes, idx);
+        for (; blocks > 0; --blocks, out += Lanes)
+        {
+            for (size_t j = 0; j < Lanes; ++j)
+            {
+                out[j]  = a + idx[j] * d;
+                idx[j] += static_cast<T>(Lanes);
+            }
+        }
+        std::copy(idx, idx + Lanes, idx_);
+    }
+
+public:
+    using value_type = T;
+
+    linear_lanes(T a, T d) : a_(a), d_(d)
+    {
+        for (size_t j = 0; j < Lanes; ++j) idx_[j] = static_cast<T>(j);
+    }
+
+    void fill(T* out, size_t blocks)
+    {
+        fill(out, blocks, std::integral_constant<bool, vec8<T>::value>{});
+    }
+};
+
+template <typename T>
+class exponential_lanes
+{
+    using w_t = wrap_t<T>;
+
+    w_t lane_[Lanes], step_;
+
+    void fill(T* out, size_t blocks, std::true_type /*vec8*/)
+    {
+        vec8<T> lane, step;
+        lane.load(lane_);
+        step.set1(step_);
+        for (; blocks > 0; --blocks, out += Lanes)
+        {
+            lane.store(out);
+            lane.mul(step);
+        }
+        lane.store(lane_);
+    }
+
+    void fill(T* out, size_t blocks, std::false_type)
+    {
+        w_t lane[Lanes], step = step_;
+        std::copy(lane_, lane_ + Lanes, lane);
+        for (; blocks > 0; --blocks, out += Lanes)
+        {
+            for (size_t j = 0; j < Lanes; ++j)
+            {
+                out [j] = static_cast<T>(lane[j]);
+                lane[j] = static_cast<w_t>(lane[j] * step);
+            }
+        }
+        std::copy(lane, lane + Lanes, lane_);
+    }
+
+public:
+    using value_type = T;
+
+    exponential_lanes(T a, T q)
+    {
+        step_ = 1;
+        for (size_t j = 0; j < Lanes; ++j)
+        {
+            lane_[j] = static_cast<w_t>(static_cast<w_t>(a) * step_);
+            step_    = static_cast<w_t>(step_ * static_cast<w_t>(q));
+        }
+    }
+
+    void fill(T* out, size_t blocks)
+    {
+        fill(out, blocks, std::integral_constant<bool, std::is_floating_point<T>::value && vec8<T>::value>{});
+    }
+};
+
+/* Writes directly, if out is a pointer to the value type of the lanes */
+
+template <class L>
+typename L::value_type* write_lanes(L& l, size_t n, typename L::value_type* out, std::true_type)
+{
+    l.fill(out, n / Lanes);
+    out += (n / Lanes) * Lanes;
+    if ((n %= Lanes) == 0) return out;
+    typename L::value_type buf[Lanes];
+    l.fill(buf, 1);
+    return std::copy(buf, buf + n, out);
+}
+
+template <class L, typename OutIt>
+OutIt write_lanes(L& l, size_t n, OutIt out, std::false_type)
+{
+    typename L::value_type buf[Lanes * 8];
+    for (size_t k; n > 0; n -= k)
+    {
+        k = (n < Lanes * 8) ? n : Lanes * 8;
+        l.fill(buf, (k + Lanes - 1) / Lanes);
+        out = std::copy(buf, buf + k, out);
+    }
+    return out;
+}
+
+template <class L, typename OutIt>
+OutIt write_lanes(L& l, size_t n, OutIt out)
+{
+    return write_lanes(l, n, out, std::is_same<OutIt, typename L::value_type*>{});
+}
+
+template <typename Seq, typename OutIt>
+OutIt materialize(const Seq& seq, OutIt out, std::integral_constant<form, form::none>)
+{
+    return std::copy(seq.begin(), seq.end(), out);
+}
+
+template <typename Seq, typename OutIt>
+OutIt materialize(const Seq& seq, OutIt out, std::integral_constant<form, form::linear>)
+{
+    using t_t = typename Seq::value_type;
+    using c_t = closed_form<typename Seq::policy_type>;
+    auto it = seq.begin();
+    linear_lanes<t_t> l { std::get<0>(it.get_tuple()), static_cast<t_t>(c_t::step(it.get_tuple())) };
+    return write_lanes(l, seq.size(), out);
+}
+
+template <typename Seq, typename OutIt>
+OutIt materialize(const Seq& seq, OutIt out, std::integral_constant<form, form::exponential>)
+{
+    using t_t = typename Seq::value_type;
+    using c_t = closed_form<typename Seq::policy_type>;
+    auto it = seq.begin();
+    exponential_lanes<t_t> l { std::get<0>(it.get_tuple()), static_cast<t_t>(c_t::step(it.get_tuple())) };
+    return write_lanes(l, seq.size(), out);
+}
+
+} // namespace detail_sequence
+
+////////////////////////////////////////////////////////////////
+/// Write all elements of a sequence to an output iterator
+////////////////////////////////////////////////////////////////
+
+/*
+    For the policies having a closed form (arithmetic, geometric, and the arithmetic range),
+    the elements of the integral and floating point types are computed with the lane stepping,
+    and written directly if out is a T*. Otherwise it is the same as std::copy.
+    Returns the end of the written elements. Do things like this:
+    -->
+    std::vector<int> offsets(r.size());
+    capo::materialize(r, offsets.data());
+
+    <Remarks>
+    The linear floating points are the same as the iterator's random access (b[i]) gives,
+    which might differ from the ones accumulated by ++ in the last bits.
+*/
+
+template <class PolicyT, typename T, class IterT, typename OutIt>
+OutIt materialize(const detail_sequence::impl<PolicyT, T, IterT>& seq, OutIt out)
+{
+    using form_t = std::integral_constant<detail_sequence::form,
+                                          detail_sequence::is_lane_type<T>::value ?
+                                          detail_sequence::closed_form<PolicyT>::value :
+                                          detail_sequence::form::none>;
+    return detail_sequence::materialize(seq, out, form_t{});
+}
+
 } // namespace capo
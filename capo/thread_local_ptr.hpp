@@ -53,7 +53,7 @@ namespace detail_thread_local_ptr
 
         static map_t* records(map_t* rec)
         {
-            CAPO_THREAD_LOCAL_SET(key(), rec);
+            static_cast<void>(CAPO_THREAD_LOCAL_SET(key(), rec));
             return rec;
         }
 
@@ -141,28 +141,39 @@ template <typename T>
 class thread_local_ptr
 {
     CAPO_THREAD_LOCAL_KEY_ key_;
+    bool                   valid_;
+
+    static void destroy(void* p)
+    {
+        delete static_cast<T*>(p);
+    }
 
 public:
     thread_local_ptr(void)
     {
-        CAPO_THREAD_LOCAL_CREATE(key_, [](void* p)
-        {
-            delete static_cast<T*>(p);
-        });
+#if defined(CAPO_OS_WIN_)
+        CAPO_THREAD_LOCAL_CREATE(key_, &thread_local_ptr::destroy);
+        valid_ = (key_ != TLS_OUT_OF_INDEXES);
+#else /*!CAPO_OS_WIN_*/
+        valid_ = (CAPO_THREAD_LOCAL_CREATE(key_, &thread_local_ptr::destroy) == 0);
+#endif/*!CAPO_OS_WIN_*/
     }
 
     ~thread_local_ptr(void)
     {
-        CAPO_THREAD_LOCAL_DELETE(key_);
+        if (valid_) CAPO_THREAD_LOCAL_DELETE(key_);
     }
 
+    /* False if the key could not be created (e.g. the keys are run out), nothing could be stored then */
+    bool valid(void) const { return valid_; }
+
     T* operator=(T* ptr)
     {
-        CAPO_THREAD_LOCAL_SET(key_, ptr);
+        if (valid_) static_cast<void>(CAPO_THREAD_LOCAL_SET(key_, ptr));
         return ptr;
     }
 
-    operator T*(void) const { return static_cast<T*>(CAPO_THREAD_LOCAL_GET(key_)); }
+    operator T*(void) const { return valid_ ? static_cast<T*>(CAPO_THREAD_LOCAL_GET(key_)) : nullptr; }
 
     T&       operator*(void)       { return *static_cast<T*>(*this); }
     const T& operator*(void) const { return *static_cast<T*>(*this); }
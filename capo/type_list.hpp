@@ -7,7 +7,10 @@
 
 #pragma once
 
-#include <type_traits> // std::integral_constant
+#include <type_traits>      // std::integral_constant
+#include <utility>          // std::index_sequence, std::make_index_sequence
+#include <initializer_list> // std::initializer_list
+#include <cstddef>          // size_t
 
 namespace capo {
 
@@ -101,6 +104,248 @@ struct types_empty<TypesT<>>
      : std::true_type
 {};
 
+////////////////////////////////////////////////////////////////
+/// Helpers
+////////////////////////////////////////////////////////////////
+
+/*
+    The algorithms below expand the packs in place, instead of peeling off
+    one type per recursion, so the instantiation depth is O(1) or O(log n).
+*/
+
+namespace detail_type_list {
+
+template <typename T>
+struct wrap { using type = T; };
+
+constexpr size_t clamp(int n, size_t size)
+{
+    return (n < 0) ? 0 : ((static_cast<size_t>(n) > size) ? size : static_cast<size_t>(n));
+}
+
+constexpr int first_true(std::initializer_list<bool> flags)
+{
+    for (size_t i = 0; i < flags.size(); ++i)
+        if (flags.begin()[i]) return static_cast<int>(i);
+    return -1;
+}
+
+/*
+    Random access.
+    The types are spread into a set of bases,
+    the overload resolution picks out the one with index I.
+    And wrap<T> is a base of the set if T is in it.
+*/
+
+template <size_t I, typename T>
+struct indexed : wrap<T> {};
+
+template <typename Seq, typename... T>
+struct index_map_;
+
+template <size_t... I, typename... T>
+struct index_map_<std::index_sequence<I...>, T...> : indexed<I, T>... {};
+
+template <typename... T>
+using index_map = index_map_<std::index_sequence_for<T...>, T...>;
+
+template <size_t I, typename T>
+wrap<T> lookup(const indexed<I, T>*);
+
+template <size_t I, typename MapT>
+using lookup_t = typename decltype(lookup<I>(static_cast<MapT*>(nullptr)))::type;
+
+template <size_t I, typename... T>
+using at_t = lookup_t<I, index_map<T...>>;
+
+// The memoized lookup, for accessing the same one repeatedly
+
+template <size_t I, typename MapT>
+struct element
+{
+    using type = lookup_t<I, MapT>;
+};
+
+template <typename TypesT>
+struct map_of;
+
+template <typename... T,
+          template <typename...> class TypesT>
+struct map_of<TypesT<T...>>
+{
+    using type = index_map<T...>;
+};
+
+template <typename MapT, typename T>
+using contains = std::is_base_of<wrap<T>, MapT>;
+
+// Gather the types of a map, in the order of Seq
+
+template <typename EmptyT, typename MapT, typename Seq>
+struct gather;
+
+template <template <typename...> class TypesT, typename MapT, size_t... K>
+struct gather<TypesT<>, MapT, std::index_sequence<K...>>
+{
+    using type = TypesT<lookup_t<K, MapT>...>;
+};
+
+/*
+    Make a list with [B, E) of T...
+*/
+
+template <template <typename...> class TypesT, size_t B, typename MapT, typename Seq>
+struct slice_;
+
+template <template <typename...> class TypesT, size_t B, typename MapT, size_t... I>
+struct slice_<TypesT, B, MapT, std::index_sequence<I...>>
+{
+    using type = TypesT<lookup_t<B + I, MapT>...>;
+};
+
+template <template <typename...> class TypesT, size_t B, size_t E, typename... T>
+using slice_t = typename slice_<TypesT, B, index_map<T...>, std::make_index_sequence<E - B>>::type;
+
+/*
+    Join 2 lists, the result uses the template of the first one
+*/
+
+template <typename T, typename U>
+struct join;
+
+template <typename... T, typename... U,
+          template <typename...> class TypesT,
+          template <typename...> class TypesU>
+struct join<TypesT<T...>, TypesU<U...>>
+{
+    using type = TypesT<T..., U...>;
+};
+
+template <typename T, typename U>
+using join_t = typename join<T, U>::type;
+
+template <typename T>
+struct as_list
+{
+    using type = types<T>;
+};
+
+template <typename... T,
+          template <typename...> class TypesT>
+struct as_list<TypesT<T...>>
+{
+    using type = TypesT<T...>;
+};
+
+/*
+    Join all the lists, by halves
+*/
+
+template <typename... L>
+struct concat;
+
+template <typename L1>
+struct concat<L1>
+{
+    using type = L1;
+};
+
+template <typename L1, typename L2>
+struct concat<L1, L2> : join<L1, L2>
+{};
+
+template <typename L1, typename L2, typename L3, typename... L>
+struct concat<L1, L2, L3, L...>
+{
+private:
+    enum : size_t { size = sizeof...(L) + 3, half = size / 2 };
+    using head = typename slice_t<concat, 0   , half, L1, L2, L3, L...>::type;
+    using tail = typename slice_t<concat, half, size, L1, L2, L3, L...>::type;
+public:
+    using type = join_t<head, tail>;
+};
+
+/*
+    Make a list with U..., and splice the ones which are lists
+*/
+
+template <bool Splice, typename EmptyT, typename... U>
+struct splice_;
+
+template <template <typename...> class TypesT, typename... U>
+struct splice_<false, TypesT<>, U...>
+{
+    using type = TypesT<U...>;
+};
+
+template <template <typename...> class TypesT, typename... U>
+struct splice_<true, TypesT<>, U...>
+     : concat<TypesT<>, typename as_list<U>::type...>
+{};
+
+template <typename EmptyT, typename... U>
+using splice = splice_<(first_true({ is_types<U>::value... }) >= 0), EmptyT, U...>;
+
+/*
+    Keep the types which are flagged with true
+*/
+
+template <size_t N>
+struct positions
+{
+    size_t at_[N + 1];
+    size_t size_;
+};
+
+template <size_t N>
+constexpr positions<N> make_positions(std::initializer_list<bool> flags)
+{
+    positions<N> pos {};
+    for (size_t i = 0; i < flags.size(); ++i)
+        if (flags.begin()[i]) pos.at_[pos.size_++] = i;
+    return pos;
+}
+
+template <bool... K>
+struct flags
+{
+    static constexpr positions<sizeof...(K)> pos_ = make_positions<sizeof...(K)>({ K... });
+};
+
+template <bool... K>
+constexpr positions<sizeof...(K)> flags<K...>::pos_;
+
+template <typename EmptyT, typename MapT, typename FlagsT, typename Seq>
+struct pick;
+
+template <template <typename...> class TypesT, typename MapT, typename FlagsT, size_t... I>
+struct pick<TypesT<>, MapT, FlagsT, std::index_sequence<I...>>
+{
+    using type = TypesT<lookup_t<FlagsT::pos_.at_[I], MapT>...>;
+};
+
+template <typename TypesT, bool... K>
+struct filter;
+
+template <typename... T, bool... K,
+          template <typename...> class TypesT>
+struct filter<TypesT<T...>, K...>
+     : pick<TypesT<>, index_map<T...>, flags<K...>, std::make_index_sequence<flags<K...>::pos_.size_>>
+{};
+
+// Drop the types which are in MapT
+
+template <typename MapT, typename TypesT>
+struct exclude;
+
+template <typename MapT, typename... T,
+          template <typename...> class TypesT>
+struct exclude<MapT, TypesT<T...>>
+     : filter<TypesT<T...>, !contains<MapT, T>::value...>
+{};
+
+} // namespace detail_type_list
+
 ////////////////////////////////////////////////////////////////
 /// Element access
 ////////////////////////////////////////////////////////////////
@@ -115,17 +360,12 @@ struct types_at : check_is_index_valid<TypesT, IndexN>
     using type = TypesT;
 };
 
-template <typename T1, typename... T, int N,
-          template <typename...> class TypesT>
-struct types_at<TypesT<T1, T...>, N>
-     : types_at<TypesT<T...>, N - 1>
-{};
-
-template <typename T1, typename... T,
+template <typename... T, int N,
           template <typename...> class TypesT>
-struct types_at<TypesT<T1, T...>, 0>
+struct types_at<TypesT<T...>, N>
+     : check_is_index_valid<TypesT<T...>, N>
 {
-    using type = T1;
+    using type = detail_type_list::at_t<detail_type_list::clamp(N, sizeof...(T) - 1), T...>;
 };
 
 template <typename TypesT, int IndexN>
@@ -212,27 +452,47 @@ using types_link_t = typename types_link<T, U>::type;
     Assign types content
 */
 
-template <int N, typename T>
-struct types_assign
+namespace detail_type_list {
+
+// Repeat a list N times, by doubling
+
+template <size_t N, typename TypesT>
+struct repeat
 {
-    static_assert(N >= 0, "N cannot be less than 0!");
 private:
-    using tail = typename types_assign<N - 1, T>::type;
+    using half = typename repeat<N / 2, TypesT>::type;
 public:
-    using type = typename types_link<T, tail>::type;
+    using type = join_t<join_t<half, half>, typename repeat<N % 2, TypesT>::type>;
 };
 
-template <typename T>
-struct types_assign<0, T>
+template <typename... T,
+          template <typename...> class TypesT>
+struct repeat<0, TypesT<T...>>
 {
-    using type = types<>;
+    using type = TypesT<>;
 };
 
-template <typename... T,
+template <typename TypesT>
+struct repeat<1, TypesT>
+{
+    using type = TypesT;
+};
+
+} // namespace detail_type_list
+
+template <int N, typename T>
+struct types_assign
+     : detail_type_list::repeat<detail_type_list::clamp(N, N), types<T>>
+{
+    static_assert(N >= 0, "N cannot be less than 0!");
+};
+
+template <int N, typename... T,
           template <typename...> class TypesT>
-struct types_assign<0, TypesT<T...>>
+struct types_assign<N, TypesT<T...>>
+     : detail_type_list::repeat<detail_type_list::clamp(N, N), TypesT<T...>>
 {
-    using type = TypesT<>;
+    static_assert(N >= 0, "N cannot be less than 0!");
 };
 
 template <int N, typename T>
@@ -243,7 +503,7 @@ using types_assign_t = typename types_assign<N, T>::type;
 ////////////////////////////////////////////////////////////////
 
 /*
-    Insert elements
+    Insert an element, a list is inserted as one element (not spliced)
 */
 
 template <typename TypesT, int IndexN, typename T>
@@ -253,28 +513,18 @@ struct types_insert : check_is_types<TypesT>
     using type = TypesT;
 };
 
-template <typename T1, typename... T, int N, typename U,
+template <typename... T, int N, typename U,
           template <typename...> class TypesT>
-struct types_insert<TypesT<T1, T...>, N, U>
+struct types_insert<TypesT<T...>, N, U>
 {
+    static_assert(N >= 0,                              "Index is out of range!");
+    static_assert(N <= static_cast<int>(sizeof...(T)), "Index is out of range!");
 private:
-    using tail = typename types_insert<TypesT<T...>, N - 1, U>::type;
+    enum : size_t { size = sizeof...(T), index = detail_type_list::clamp(N, size) };
+    using head = detail_type_list::slice_t<TypesT, 0    , index, T...>;
+    using tail = detail_type_list::slice_t<TypesT, index, size , T...>;
 public:
-    using type = typename types_link<T1, tail>::type;
-};
-
-template <typename T1, typename... T, typename U,
-          template <typename...> class TypesT>
-struct types_insert<TypesT<T1, T...>, 0, U>
-{
-    using type = typename types_link<U, TypesT<T1, T...>>::type;
-};
-
-template <typename U,
-          template <typename...> class TypesT>
-struct types_insert<TypesT<>, 0, U>
-{
-    using type = typename types_link<U, TypesT<>>::type;
+    using type = detail_type_list::join_t<detail_type_list::join_t<head, TypesT<U>>, tail>;
 };
 
 template <typename TypesT, int IndexN, typename T>
@@ -291,29 +541,24 @@ struct types_erase : check_is_types<TypesT>
     using type = TypesT;
 };
 
-template <typename T1, typename... T, int N, int C,
+template <typename... T, int N, int C,
           template <typename...> class TypesT>
-struct types_erase<TypesT<T1, T...>, N, C>
+struct types_erase<TypesT<T...>, N, C>
+     : check_is_index_valid<TypesT<T...>, N>
 {
+    static_assert(C > 0,                                   "Count is too small!");
+    static_assert(C <= static_cast<int>(sizeof...(T)) - N, "Count is too large!");
 private:
-    using tail = typename types_erase<TypesT<T...>, N - 1, C>::type;
+    enum : size_t
+    {
+        size  = sizeof...(T),
+        first = detail_type_list::clamp(N, size),
+        last  = detail_type_list::clamp(N + ((C < 0) ? 0 : C), size)
+    };
+    using head = detail_type_list::slice_t<TypesT, 0   , first, T...>;
+    using tail = detail_type_list::slice_t<TypesT, last, size , T...>;
 public:
-    using type = typename types_link<T1, tail>::type;
-};
-
-template <typename T1, typename... T, int C,
-          template <typename...> class TypesT>
-struct types_erase<TypesT<T1, T...>, 0, C>
-     : check_is_count_valid<TypesT<T1, T...>, C>
-{
-    using type = typename types_erase<TypesT<T...>, 0, C - 1>::type;
-};
-
-template <typename T1, typename... T,
-          template <typename...> class TypesT>
-struct types_erase<TypesT<T1, T...>, 0, 1>
-{
-    using type = TypesT<T...>;
+    using type = detail_type_list::join_t<head, tail>;
 };
 
 template <typename TypesT, int IndexN, int CountN = 1>
@@ -332,18 +577,10 @@ struct types_find : std::integral_constant<int, -1>
                   , check_is_types<TypesT>
 {};
 
-template <typename T1, typename... T, typename U,
-          template <typename...> class TypesT>
-struct types_find<TypesT<T1, T...>, U>
-     : std::integral_constant<int, 
-                             (types_find<TypesT<T...>, U>::value == -1 ? -1 :
-                              types_find<TypesT<T...>, U>::value + 1)>
-{};
-
-template <typename T1, typename... T,
+template <typename... T, typename U,
           template <typename...> class TypesT>
-struct types_find<TypesT<T1, T...>, T1>
-     : std::integral_constant<int, 0>
+struct types_find<TypesT<T...>, U>
+     : std::integral_constant<int, detail_type_list::first_true({ std::is_same<T, U>::value... })>
 {};
 
 /*
@@ -364,17 +601,12 @@ struct types_foreach : check_is_types<TypesT>
     using type = TypesT;
 };
 
-template <typename T1, typename... T,
+template <typename... T,
           template <typename> class Do_,
           template <typename...> class TypesT>
-struct types_foreach<TypesT<T1, T...>, Do_>
-{
-private:
-    using tail = typename types_foreach<TypesT<T...>, Do_>::type;
-    using done = typename Do_<T1>::type;
-public:
-    using type = typename types_link<done, tail>::type;
-};
+struct types_foreach<TypesT<T...>, Do_>
+     : detail_type_list::splice<TypesT<>, typename Do_<T>::type...>
+{};
 
 /*
     For each one in the types, do something if the conditional is true
@@ -408,19 +640,23 @@ using types_replace_t = typename types_replace<TypesT, T, U>::type;
 */
 
 template <typename TypesT, typename T>
-struct types_remove
-     : types_replace<TypesT, T, types<>>
+struct types_remove : check_is_types<TypesT>
+{
+    using type = TypesT;
+};
+
+template <typename... T, typename U,
+          template <typename...> class TypesT>
+struct types_remove<TypesT<T...>, U>
+     : detail_type_list::filter<TypesT<T...>, !std::is_same<T, U>::value...>
 {};
 
-template <typename TypesT, typename U1, typename... U,
+template <typename... T, typename U1, typename... U,
+          template <typename...> class TypesT,
           template <typename...> class TypesU>
-struct types_remove<TypesT, TypesU<U1, U...>>
-{
-private:
-    using rm_t = typename types_remove<TypesT, U1>::type;
-public:
-    using type = typename types_remove<rm_t, TypesU<U...>>::type;
-};
+struct types_remove<TypesT<T...>, TypesU<U1, U...>>
+     : detail_type_list::exclude<detail_type_list::index_map<U1, U...>, TypesT<T...>>
+{};
 
 template <typename TypesT, typename T>
 using types_remove_t = typename types_remove<TypesT, T>::type;
@@ -429,23 +665,55 @@ using types_remove_t = typename types_remove<TypesT, T>::type;
     Remove duplicate types
 */
 
+namespace detail_type_list {
+
+/*
+    Compact both halves, then drop the types of the latter one
+    which are already in the former one.
+*/
+
 template <typename TypesT>
-struct types_compact : check_is_types<TypesT>
-{
-    using type = TypesT;
-};
+struct compact;
 
-template <typename T1, typename... T,
+template <typename... T,
           template <typename...> class TypesT>
-struct types_compact<TypesT<T1, T...>>
+struct compact<TypesT<T...>>
 {
 private:
-    using rm_t = typename types_remove<TypesT<T...>, T1>::type;
-    using tail = typename types_compact<rm_t>::type;
+    enum : size_t { size = sizeof...(T), half = size / 2 };
+    using head = typename compact<slice_t<TypesT, 0   , half, T...>>::type;
+    using tail = typename compact<slice_t<TypesT, half, size, T...>>::type;
 public:
-    using type = typename types_link<T1, tail>::type;
+    using type = join_t<head, typename exclude<typename map_of<head>::type, tail>::type>;
+};
+
+template <template <typename...> class TypesT>
+struct compact<TypesT<>>
+{
+    using type = TypesT<>;
+};
+
+template <typename T1,
+          template <typename...> class TypesT>
+struct compact<TypesT<T1>>
+{
+    using type = TypesT<T1>;
+};
+
+} // namespace detail_type_list
+
+template <typename TypesT>
+struct types_compact : check_is_types<TypesT>
+{
+    using type = TypesT;
 };
 
+template <typename... T,
+          template <typename...> class TypesT>
+struct types_compact<TypesT<T...>>
+     : detail_type_list::compact<TypesT<T...>>
+{};
+
 template <typename TypesT>
 using types_compact_t = typename types_compact<TypesT>::type;
 
@@ -453,21 +721,30 @@ using types_compact_t = typename types_compact<TypesT>::type;
     Reverse the types
 */
 
+namespace detail_type_list {
+
+template <typename EmptyT, typename MapT, typename Seq>
+struct reverse;
+
+template <template <typename...> class TypesT, typename MapT, size_t... I>
+struct reverse<TypesT<>, MapT, std::index_sequence<I...>>
+{
+    using type = TypesT<lookup_t<sizeof...(I) - 1 - I, MapT>...>;
+};
+
+} // namespace detail_type_list
+
 template <class TypesT>
 struct types_reverse : check_is_types<TypesT>
 {
     using type = TypesT;
 };
 
-template <typename T1, typename... T,
+template <typename... T,
           template <typename...> class TypesT>
-struct types_reverse<TypesT<T1, T...>>
-{
-private:
-    using head = typename types_reverse<TypesT<T...>>::type;
-public:
-    using type = typename types_link<head, T1>::type;
-};
+struct types_reverse<TypesT<T...>>
+     : detail_type_list::reverse<TypesT<>, detail_type_list::index_map<T...>, std::index_sequence_for<T...>>
+{};
 
 template <typename TypesT>
 using types_reverse_t = typename types_reverse<TypesT>::type;
@@ -476,6 +753,32 @@ using types_reverse_t = typename types_reverse<TypesT>::type;
     Select the most satisfactory type
 */
 
+namespace detail_type_list {
+
+/*
+    Reduce [B, B + N) by halves.
+    For a strict weak ordering, this gives the same result as folding from the right:
+    the earlier one wins only if it is strictly better.
+*/
+
+template <template <typename, typename> class If_, typename MapT, size_t B, size_t N, bool = (N == 1)>
+struct select
+{
+private:
+    using head = typename select<If_, MapT, B        , N / 2    >::type;
+    using tail = typename select<If_, MapT, B + N / 2, N - N / 2>::type;
+public:
+    using type = typename std::conditional<If_<head, tail>::value, head, tail>::type;
+};
+
+template <template <typename, typename> class If_, typename MapT, size_t B, size_t N>
+struct select<If_, MapT, B, N, true>
+{
+    using type = lookup_t<B, MapT>;
+};
+
+} // namespace detail_type_list
+
 template <typename TypesT,
           template <typename, typename> class If_>
 struct types_select_if : check_is_types<TypesT>
@@ -487,20 +790,8 @@ template <typename T1, typename... T,
           template <typename, typename> class If_,
           template <typename...> class TypesT>
 struct types_select_if<TypesT<T1, T...>, If_>
-{
-private:
-    using select_t = typename types_select_if<TypesT<T...>, If_>::type;
-public:
-    using type = typename std::conditional<If_<T1, select_t>::value, T1, select_t>::type;
-};
-
-template <typename T1,
-          template <typename, typename> class If_,
-          template <typename...> class TypesT>
-struct types_select_if<TypesT<T1>, If_>
-{
-    using type = T1;
-};
+     : detail_type_list::select<If_, detail_type_list::index_map<T1, T...>, 0, sizeof...(T) + 1>
+{};
 
 template <typename TypesT,
           template <typename, typename> class If_>
@@ -510,39 +801,122 @@ using types_select_if_t = typename types_select_if<TypesT, If_>::type;
     Sort types
 */
 
-template <class TypesT,
-          template <typename, typename> class If_>
-struct types_sort_if : check_is_types<TypesT>
-{
-    using type = TypesT;
-};
+namespace detail_type_list {
 
-template <typename T1, typename... T,
-          template <typename, typename> class If_,
+/*
+    Whether T goes before U, when T is from the former (Order < 0) or the latter (Order > 0) part.
+    The result is the same as selecting the most satisfactory one repeatedly,
+    so the latter one goes first if neither of them is better.
+*/
+
+template <int Order, template <typename, typename> class If_, typename T, typename U>
+struct before
+     : std::integral_constant<bool, If_<T, U>::value>
+{};
+
+template <template <typename, typename> class If_, typename T, typename U>
+struct before<1, If_, T, U>
+     : std::integral_constant<bool, !If_<U, T>::value>
+{};
+
+// Binary search the first one in [Lo, Hi) of the sorted MapT, which T goes before
+
+template <int Order, template <typename, typename> class If_, typename T,
+          typename MapT, size_t Lo, size_t Hi, bool = (Lo == Hi)>
+struct lower_bound
+     : std::conditional<before<Order, If_, T, typename element<Lo + (Hi - Lo) / 2, MapT>::type>::value,
+                        lower_bound<Order, If_, T, MapT, Lo, Lo + (Hi - Lo) / 2>,
+                        lower_bound<Order, If_, T, MapT, Lo + (Hi - Lo) / 2 + 1, Hi>>::type
+{};
+
+template <int Order, template <typename, typename> class If_, typename T,
+          typename MapT, size_t Lo, size_t Hi>
+struct lower_bound<Order, If_, T, MapT, Lo, Hi, true>
+     : std::integral_constant<size_t, Lo>
+{};
+
+/*
+    Merge 2 sorted lists.
+    The final position of each type is its index in its own list,
+    plus the count of the types going before it in the other list.
+*/
+
+template <template <typename, typename> class If_, typename MapT, typename MapU,
+          typename TypesT, typename TypesU, typename SeqT, typename SeqU>
+struct merged;
+
+template <template <typename, typename> class If_, typename MapT, typename MapU,
+          typename... T, typename... U, size_t... I, size_t... J,
+          template <typename...> class TypesT,
+          template <typename...> class TypesU>
+struct merged<If_, MapT, MapU, TypesT<T...>, TypesU<U...>, std::index_sequence<I...>, std::index_sequence<J...>>
+     : indexed<I + lower_bound<-1, If_, T, MapU, 0, sizeof...(U)>::value, T>...
+     , indexed<J + lower_bound< 1, If_, U, MapT, 0, sizeof...(T)>::value, U>...
+{};
+
+template <template <typename, typename> class If_, typename TypesT, typename TypesU>
+struct merge;
+
+template <template <typename, typename> class If_, typename... T, typename... U,
+          template <typename...> class TypesT,
+          template <typename...> class TypesU>
+struct merge<If_, TypesT<T...>, TypesU<U...>>
+     : gather<TypesT<>, merged<If_, index_map<T...>, index_map<U...>, TypesT<T...>, TypesU<U...>,
+                               std::index_sequence_for<T...>, std::index_sequence_for<U...>>,
+              std::make_index_sequence<sizeof...(T) + sizeof...(U)>>
+{};
+
+// Sort both halves, then merge them
+
+template <template <typename, typename> class If_, typename TypesT>
+struct sort;
+
+template <template <typename, typename> class If_, typename... T,
           template <typename...> class TypesT>
-struct types_sort_if<TypesT<T1, T...>, If_>
+struct sort<If_, TypesT<T...>>
 {
 private:
-    using types_t = TypesT<T1, T...>;
-    using sl_t = typename types_select_if<types_t, If_>::type;
-    using er_t = typename types_erase<types_t, types_find<types_t, sl_t>::value>::type;
-    using tail = typename types_sort_if<er_t, If_>::type;
+    enum : size_t { size = sizeof...(T), half = size / 2 };
+    using head = typename sort<If_, slice_t<TypesT, 0   , half, T...>>::type;
+    using tail = typename sort<If_, slice_t<TypesT, half, size, T...>>::type;
 public:
-    using type = typename types_link<sl_t, tail>::type;
+    using type = typename merge<If_, head, tail>::type;
 };
 
-template <typename T1,
-          template <typename, typename> class If_,
+template <template <typename, typename> class If_,
+          template <typename...> class TypesT>
+struct sort<If_, TypesT<>>
+{
+    using type = TypesT<>;
+};
+
+template <template <typename, typename> class If_, typename T1,
           template <typename...> class TypesT>
-struct types_sort_if<TypesT<T1>, If_>
+struct sort<If_, TypesT<T1>>
 {
     using type = TypesT<T1>;
 };
 
+} // namespace detail_type_list
+
+template <class TypesT,
+          template <typename, typename> class If_>
+struct types_sort_if : check_is_types<TypesT>
+{
+    using type = TypesT;
+};
+
+template <typename... T,
+          template <typename, typename> class If_,
+          template <typename...> class TypesT>
+struct types_sort_if<TypesT<T...>, If_>
+     : detail_type_list::sort<If_, TypesT<T...>>
+{};
+
 template <class TypesT,
           template <typename, typename> class If_>
 using types_sort_if_t = typename types_sort_if<TypesT, If_>::type;
 
 ////////////////////////////////////////////////////////////////
 
-} // namespace capo
\ No newline at end of file
+} // namespace capo
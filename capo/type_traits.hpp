@@ -152,6 +152,14 @@ struct function_traits
 template <typename T, typename U>
 CAPO_CONCEPT_(Different, !std::is_same<capo::underlying<T>, capo::underlying<U>>::value);
 
+/*
+    Passes a type as a value, e.g. to a generic lambda:
+    [](auto tag) { using T = typename decltype(tag)::type; }
+*/
+
+template <typename T>
+struct type_tag { using type = T; };
+
 ////////////////////////////////////////////////////////////////
 
 } // namespace capo
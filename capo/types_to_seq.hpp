@@ -10,6 +10,7 @@
 #include "capo/type_list.hpp"
 
 #include <type_traits>  // std::integral_constant
+#include <utility>      // std::integer_sequence, std::make_integer_sequence
 #include <cstddef>      // size_t
 
 namespace capo {
@@ -24,22 +25,19 @@ struct constant_seq : std::integral_constant<size_t, sizeof...(N)>
 
 namespace detail_size_to_seq_ {
 
-template <size_t N>
-struct impl_
-{
-    using type = typename impl_<N - 1>::type::next;
-};
+template <typename Seq>
+struct impl_;
 
-template <>
-struct impl_<0>
+template <int... N>
+struct impl_<std::integer_sequence<int, N...>>
 {
-    using type = constant_seq<>;
+    using type = constant_seq<N...>;
 };
 
 } // namespace detail_size_to_seq_
 
 template <size_t N>
-using size_to_seq = typename detail_size_to_seq_::impl_<N>::type;
+using size_to_seq = typename detail_size_to_seq_::impl_<std::make_integer_sequence<int, static_cast<int>(N)>>::type;
 
 template <typename... T>
 using types_to_seq = size_to_seq<sizeof...(T)>;
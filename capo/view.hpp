@@ -0,0 +1,677 @@
+/*
+    The Capo Library
+    Code covered by the MIT License
+
+    Author: mutouyun (http://orzz.org)
+*/
+
+#pragma once
+
+#include <iterator>     // std::begin, std::end, std::iterator_traits, std::distance, ...
+#include <type_traits>  // std::decay, std::conditional, std::is_base_of, std::common_type
+#include <tuple>        // std::tuple, std::get
+#include <utility>      // std::forward, std::move, std::pair, std::index_sequence
+#include <algorithm>    // std::min
+#include <cstddef>      // size_t, ptrdiff_t
+
+namespace capo {
+namespace detail_view {
+
+template <typename R>
+using iterator_of = typename std::decay<decltype(std::begin(std::declval<const R&>()))>::type;
+
+template <typename It>
+using category_of = typename std::iterator_traits<It>::iterator_category;
+
+template <typename It>
+using reference_of = typename std::iterator_traits<It>::reference;
+
+template <typename It>
+using is_random_access = std::is_base_of<std::random_access_iterator_tag, category_of<It>>;
+
+/*
+    The weaker one of the category of It and Max.
+*/
+template <typename It, typename Max>
+using category_max = typename std::conditional<std::is_base_of<Max, category_of<It>>::value,
+                                               Max, category_of<It>>::type;
+
+/*
+    Moves it forward n steps at most, stops at end.
+    Returns the steps which could not be made.
+*/
+template <typename It>
+size_t advance_bounded(It& it, size_t n, const It& end, std::random_access_iterator_tag)
+{
+    auto d = static_cast<size_t>(end - it);
+    if (n > d)
+    {
+        it = end;
+        return n - d;
+    }
+    it += static_cast<typename std::iterator_traits<It>::difference_type>(n);
+    return 0;
+}
+
+template <typename It, typename Tag>
+size_t advance_bounded(It& it, size_t n, const It& end, Tag)
+{
+    for (; (n > 0) && (it != end); --n) ++it;
+    return n;
+}
+
+template <typename It>
+size_t advance_bounded(It& it, size_t n, const It& end)
+{
+    return advance_bounded(it, n, end, category_of<It>{});
+}
+
+template <typename It>
+It next_bounded(It it, size_t n, const It& end)
+{
+    advance_bounded(it, n, end);
+    return it;
+}
+
+////////////////////////////////////////////////////////////////
+/// Iterator facade
+////////////////////////////////////////////////////////////////
+
+/*
+    The primitives could be private, as long as the iterator is a friend of access.
+*/
+struct access
+{
+    template <typename It>
+    static auto dereference(const It& it) -> decltype(it.dereference()) { return it.dereference(); }
+
+    template <typename It> static bool equal    (const It& a, const It& b) { return a.equal(b); }
+    template <typename It> static void increment(It& it)                   { it.increment(); }
+    template <typename It> static void decrement(It& it)                   { it.decrement(); }
+    template <typename It> static void advance  (It& it, std::ptrdiff_t n) { it.advance(n); }
+
+    template <typename It>
+    static std::ptrdiff_t distance(const It& a, const It& b) { return a.distance_to(b); }
+};
+
+/*
+    Makes a complete iterator from the primitives of Derived:
+    dereference(), equal(rhs), increment(), and decrement(), advance(n), distance_to(rhs)
+    for the bidirectional and random-access ones.
+*/
+
+template <typename Derived, typename Value, typename Reference, typename Category>
+class iterator_facade
+{
+    Derived      & self(void)       { return static_cast<Derived      &>(*this); }
+    Derived const& self(void) const { return static_cast<Derived const&>(*this); }
+
+public:
+    using iterator_category = Category;
+    using value_type        = Value;
+    using difference_type   = std::ptrdiff_t;
+    using reference         = Reference;
+    using pointer           = void;
+
+    reference operator*(void) const { return access::dereference(self()); }
+
+    /* By value, the reference may point into the temporary iterator (e.g. the elements of a capo::range) */
+    value_type operator[](difference_type n) const { return *(self() + n); }
+
+    Derived& operator++(void)
+    {
+        access::increment(self());
+        return self();
+    }
+
+    Derived& operator--(void)
+    {
+        access::decrement(self());
+        return self();
+    }
+
+    Derived operator++(int)
+    {
+        Derived old(self());
+        ++(*this);
+        return old;
+    }
+
+    Derived operator--(int)
+    {
+        Derived old(self());
+        --(*this);
+        return old;
+    }
+
+    Derived& operator+=(difference_type n)
+    {
+        access::advance(self(), n);
+        return self();
+    }
+
+    Derived& operator-=(difference_type n)
+    {
+        access::advance(self(), -n);
+        return self();
+    }
+
+    Derived operator+(difference_type n) const
+    {
+        Derived r(self());
+        return r += n;
+    }
+
+    Derived operator-(difference_type n) const
+    {
+        Derived r(self());
+        return r -= n;
+    }
+
+    friend Derived operator+(difference_type n, const Derived& it) { return it + n; }
+
+    difference_type operator-(const Derived& rhs) const { return access::distance(rhs, self()); }
+
+    friend bool operator==(const Derived& a, const Derived& b) { return  access::equal(a, b); }
+    friend bool operator!=(const Derived& a, const Derived& b) { return !access::equal(a, b); }
+    friend bool operator< (const Derived& a, const Derived& b) { return (a - b) <  0; }
+    friend bool operator> (const Derived& a, const Derived& b) { return (a - b) >  0; }
+    friend bool operator<=(const Derived& a, const Derived& b) { return (a - b) <= 0; }
+    friend bool operator>=(const Derived& a, const Derived& b) { return (a - b) >= 0; }
+};
+
+////////////////////////////////////////////////////////////////
+/// Pipe syntax
+////////////////////////////////////////////////////////////////
+
+template <typename F>
+struct adaptor
+{
+    F f_;
+};
+
+template <typename F>
+adaptor<F> make_adaptor(F f)
+{
+    return { std::move(f) };
+}
+
+template <typename R, typename F>
+auto operator|(R&& r, adaptor<F> a) -> decltype(a.f_(std::forward<R>(r)))
+{
+    return a.f_(std::forward<R>(r));
+}
+
+} // namespace detail_view
+
+////////////////////////////////////////////////////////////////
+/// Lazy views over ranges (capo::range, capo::sequence and containers)
+////////////////////////////////////////////////////////////////
+
+/*
+    A view holds its underlying range by reference if it is an lvalue, or by value if it is an rvalue,
+    so the chains of views never dangle. The elements are computed while iterating, without any
+    temporary container, and a chain over a contiguous container is inlined into a single loop.
+    The iterators keep the category of the underlying ones when possible (filter makes them forward).
+    Do things like this:
+    -->
+    for (auto x : v | capo::view::filter(is_odd) | capo::view::transform(square) | capo::view::take(10))
+    {
+        ...
+    }
+    -->
+    for (auto p : capo::view::zip(keys, values)) std::get<0>(p) ...
+*/
+
+namespace view {
+
+/*
+    [begin, end) of an iterator pair.
+*/
+
+template <typename It>
+class subrange
+{
+    It b_, e_;
+
+public:
+    using iterator = It;
+
+    subrange(It b, It e) : b_(std::move(b)), e_(std::move(e)) {}
+
+    It begin(void) const { return b_; }
+    It end  (void) const { return e_; }
+
+    size_t size (void) const { return static_cast<size_t>(std::distance(b_, e_)); }
+    bool   empty(void) const { return (b_ == e_); }
+};
+
+/*
+    transform - f(x) of each element.
+*/
+
+template <typename R, typename F>
+class transform_view
+{
+    R r_;
+    F f_;
+
+    using base_t = detail_view::iterator_of<R>;
+    using ref_t  = decltype(std::declval<const F&>()(*std::declval<base_t>()));
+
+public:
+    class iterator : public detail_view::iterator_facade<iterator, typename std::decay<ref_t>::type, ref_t,
+                                                         detail_view::category_of<base_t>>
+    {
+        friend struct detail_view::access;
+        friend class transform_view;
+
+        base_t   it_;
+        const F* f_ = nullptr;
+
+        iterator(base_t it, const F* f) : it_(std::move(it)), f_(f) {}
+
+        ref_t dereference(void) const             { return (*f_)(*it_); }
+        bool  equal(const iterator& rhs) const    { return it_ == rhs.it_; }
+        void  increment(void)                     { ++it_; }
+        void  decrement(void)                     { --it_; }
+        void  advance(std::ptrdiff_t n)           { it_ += n; }
+        std::ptrdiff_t distance_to(const iterator& rhs) const { return rhs.it_ - it_; }
+
+    public:
+        iterator(void) = default;
+    };
+
+    template <typename R_, typename F_>
+    transform_view(R_&& r, F_&& f) : r_(std::forward<R_>(r)), f_(std::forward<F_>(f)) {}
+
+    iterator begin(void) const { return { std::begin(r_), &f_ }; }
+    iterator end  (void) const { return { std::end  (r_), &f_ }; }
+};
+
+template <typename R, typename F>
+transform_view<R, typename std::decay<F>::type> transform(R&& r, F&& f)
+{
+    return { std::forward<R>(r), std::forward<F>(f) };
+}
+
+template <typename F>
+auto transform(F f)
+{
+    return detail_view::make_adaptor([f](auto&& r) { return view::transform(std::forward<decltype(r)>(r), f); });
+}
+
+/*
+    filter - the elements satisfying p(x).
+*/
+
+template <typename R, typename P>
+class filter_view
+{
+    R r_;
+    P p_;
+
+    using base_t = detail_view::iterator_of<R>;
+
+public:
+    class iterator : public detail_view::iterator_facade<iterator,
+                                                         typename std::iterator_traits<base_t>::value_type,
+                                                         detail_view::reference_of<base_t>,
+                                                         detail_view::category_max<base_t, std::forward_iterator_tag>>
+    {
+        friend struct detail_view::access;
+        friend class filter_view;
+
+        base_t   it_, end_;
+        const P* p_ = nullptr;
+
+        iterator(base_t it, base_t end, const P* p)
+            : it_(std::move(it)), end_(std::move(end)), p_(p)
+        {
+            skip();
+        }
+
+        void skip(void)
+        {
+            while ((it_ != end_) && !(*p_)(*it_)) ++it_;
+        }
+
+        detail_view::reference_of<base_t> dereference(void) const { return *it_; }
+        bool equal(const iterator& rhs) const { return it_ == rhs.it_; }
+        void increment(void)
+        {
+            ++it_;
+            skip();
+        }
+
+    public:
+        iterator(void) = default;
+    };
+
+    template <typename R_, typename P_>
+    filter_view(R_&& r, P_&& p) : r_(std::forward<R_>(r)), p_(std::forward<P_>(p)) {}
+
+    iterator begin(void) const { return { std::begin(r_), std::end(r_), &p_ }; }
+    iterator end  (void) const { return { std::end  (r_), std::end(r_), &p_ }; }
+};
+
+template <typename R, typename P>
+filter_view<R, typename std::decay<P>::type> filter(R&& r, P&& p)
+{
+    return { std::forward<R>(r), std::forward<P>(p) };
+}
+
+template <typename P>
+auto filter(P p)
+{
+    return detail_view::make_adaptor([p](auto&& r) { return view::filter(std::forward<decltype(r)>(r), p); });
+}
+
+/*
+    take - the first n elements, drop - all but the first n elements.
+    The iterators are the underlying ones, finding the bound is O(1) for the random-access ranges.
+*/
+
+template <typename R>
+class take_view
+{
+    R      r_;
+    size_t n_;
+
+public:
+    using iterator = detail_view::iterator_of<R>;
+
+    template <typename R_>
+    take_view(R_&& r, size_t n) : r_(std::forward<R_>(r)), n_(n) {}
+
+    iterator begin(void) const { return std::begin(r_); }
+    iterator end  (void) const { return detail_view::next_bounded(begin(), n_, iterator(std::end(r_))); }
+};
+
+template <typename R>
+class drop_view
+{
+    R      r_;
+    size_t n_;
+
+public:
+    using iterator = detail_view::iterator_of<R>;
+
+    template <typename R_>
+    drop_view(R_&& r, size_t n) : r_(std::forward<R_>(r)), n_(n) {}
+
+    iterator begin(void) const { return detail_view::next_bounded(iterator(std::begin(r_)), n_, end()); }
+    iterator end  (void) const { return std::end(r_); }
+};
+
+template <typename R>
+take_view<R> take(R&& r, size_t n)
+{
+    return { std::forward<R>(r), n };
+}
+
+inline auto take(size_t n)
+{
+    return detail_view::make_adaptor([n](auto&& r) { return view::take(std::forward<decltype(r)>(r), n); });
+}
+
+template <typename R>
+drop_view<R> drop(R&& r, size_t n)
+{
+    return { std::forward<R>(r), n };
+}
+
+inline auto drop(size_t n)
+{
+    return detail_view::make_adaptor([n](auto&& r) { return view::drop(std::forward<decltype(r)>(r), n); });
+}
+
+/*
+    stride - every n-th element, chunk - the subranges of n elements (the last one might be shorter).
+*/
+
+template <typename R, bool Chunk>
+class step_view
+{
+    R      r_;
+    size_t n_;
+
+    using base_t = detail_view::iterator_of<R>;
+    using ref_t  = typename std::conditional<Chunk, subrange<base_t>, detail_view::reference_of<base_t>>::type;
+    using val_t  = typename std::conditional<Chunk, subrange<base_t>,
+                                             typename std::iterator_traits<base_t>::value_type>::type;
+
+public:
+    class iterator : public detail_view::iterator_facade<iterator, val_t, ref_t, detail_view::category_of<base_t>>
+    {
+        friend struct detail_view::access;
+        friend class step_view;
+
+        base_t it_, end_;
+        size_t n_       = 1;
+        size_t missing_ = 0; // the steps could not be made at the end, for going back
+
+        iterator(base_t it, base_t end, size_t n, size_t missing)
+            : it_(std::move(it)), end_(std::move(end)), n_(n), missing_(missing)
+        {}
+
+        ref_t deref(std::false_type) const { return *it_; }
+        ref_t deref(std::true_type)  const { return { it_, detail_view::next_bounded(it_, n_, end_) }; }
+
+        ref_t dereference(void) const          { return deref(std::integral_constant<bool, Chunk>{}); }
+        bool  equal(const iterator& rhs) const { return it_ == rhs.it_; }
+        void  increment(void)                  { missing_ = detail_view::advance_bounded(it_, n_, end_); }
+
+        void decrement(void)
+        {
+            std::advance(it_, -static_cast<std::ptrdiff_t>(n_ - missing_));
+            missing_ = 0;
+        }
+
+        void advance(std::ptrdiff_t k)
+        {
+            if (k > 0) missing_ = detail_view::advance_bounded(it_, n_ * static_cast<size_t>(k), end_);
+            else
+            if (k < 0)
+            {
+                it_ -= static_cast<std::ptrdiff_t>(n_ * static_cast<size_t>(-k) - missing_);
+                missing_ = 0;
+            }
+        }
+
+        std::ptrdiff_t distance_to(const iterator& rhs) const
+        {
+            return ((rhs.it_ - it_) + static_cast<std::ptrdiff_t>(rhs.missing_) - static_cast<std::ptrdiff_t>(missing_))
+                 / static_cast<std::ptrdiff_t>(n_);
+        }
+
+    public:
+        iterator(void) = default;
+    };
+
+    template <typename R_>
+    step_view(R_&& r, size_t n) : r_(std::forward<R_>(r)), n_((n == 0) ? 1 : n) {}
+
+    iterator begin(void) const
+    {
+        return { std::begin(r_), std::end(r_), n_, 0 };
+    }
+
+    iterator end(void) const
+    {
+        base_t b = std::begin(r_), e = std::end(r_);
+        auto   d = static_cast<size_t>(std::distance(b, e));
+        return { e, e, n_, (n_ - d % n_) % n_ };
+    }
+};
+
+template <typename R>
+step_view<R, false> stride(R&& r, size_t n)
+{
+    return { std::forward<R>(r), n };
+}
+
+inline auto stride(size_t n)
+{
+    return detail_view::make_adaptor([n](auto&& r) { return view::stride(std::forward<decltype(r)>(r), n); });
+}
+
+template <typename R>
+step_view<R, true> chunk(R&& r, size_t n)
+{
+    return { std::forward<R>(r), n };
+}
+
+inline auto chunk(size_t n)
+{
+    return detail_view::make_adaptor([n](auto&& r) { return view::chunk(std::forward<decltype(r)>(r), n); });
+}
+
+/*
+    enumerate - the pairs of (index, element).
+*/
+
+template <typename R>
+class enumerate_view
+{
+    R r_;
+
+    using base_t = detail_view::iterator_of<R>;
+    using ref_t  = std::pair<size_t, detail_view::reference_of<base_t>>;
+
+public:
+    class iterator : public detail_view::iterator_facade<iterator, ref_t, ref_t, detail_view::category_of<base_t>>
+    {
+        friend struct detail_view::access;
+        friend class enumerate_view;
+
+        base_t it_;
+        size_t i_ = 0;
+
+        iterator(base_t it, size_t i) : it_(std::move(it)), i_(i) {}
+
+        ref_t dereference(void) const          { return { i_, *it_ }; }
+        bool  equal(const iterator& rhs) const { return it_ == rhs.it_; }
+        void  increment(void)                  { ++it_; ++i_; }
+        void  decrement(void)                  { --it_; --i_; }
+        void  advance(std::ptrdiff_t n)        { it_ += n; i_ += static_cast<size_t>(n); }
+        std::ptrdiff_t distance_to(const iterator& rhs) const { return rhs.it_ - it_; }
+
+    public:
+        iterator(void) = default;
+    };
+
+    template <typename R_>
+    explicit enumerate_view(R_&& r) : r_(std::forward<R_>(r)) {}
+
+    iterator begin(void) const { return { std::begin(r_), 0 }; }
+    iterator end  (void) const
+    {
+        base_t b = std::begin(r_), e = std::end(r_);
+        return { e, static_cast<size_t>(std::distance(b, e)) };
+    }
+};
+
+template <typename R>
+enumerate_view<R> enumerate(R&& r)
+{
+    return enumerate_view<R>{ std::forward<R>(r) };
+}
+
+inline auto enumerate(void)
+{
+    return detail_view::make_adaptor([](auto&& r) { return view::enumerate(std::forward<decltype(r)>(r)); });
+}
+
+/*
+    zip - the tuples of the elements at the same positions, as long as the shortest range.
+*/
+
+template <typename... R>
+class zip_view
+{
+    std::tuple<R...> rs_;
+
+    using ref_t = std::tuple<detail_view::reference_of<detail_view::iterator_of<R>>...>;
+    using val_t = std::tuple<typename std::iterator_traits<detail_view::iterator_of<R>>::value_type...>;
+    using cat_t = typename std::common_type<detail_view::category_of<detail_view::iterator_of<R>>...>::type;
+    using seq_t = std::index_sequence_for<R...>;
+
+    enum : bool { random_access = std::is_base_of<std::random_access_iterator_tag, cat_t>::value };
+
+public:
+    class iterator : public detail_view::iterator_facade<iterator, val_t, ref_t, cat_t>
+    {
+        friend struct detail_view::access;
+        friend class zip_view;
+
+        std::tuple<detail_view::iterator_of<R>...> its_;
+
+        template <typename F, size_t... N>
+        void each(F&& f, std::index_sequence<N...>)
+        {
+            int dummy[] = { 0, (f(std::get<N>(its_)), 0)... };
+            static_cast<void>(dummy);
+        }
+
+        template <size_t... N>
+        ref_t deref(std::index_sequence<N...>) const { return ref_t(*std::get<N>(its_)...); }
+
+        template <size_t... N>
+        bool any_equal(const iterator& rhs, std::index_sequence<N...>) const
+        {
+            bool r = false;
+            int dummy[] = { 0, (r = r || (std::get<N>(its_) == std::get<N>(rhs.its_)), 0)... };
+            static_cast<void>(dummy);
+            return r;
+        }
+
+        ref_t dereference(void) const          { return deref(seq_t{}); }
+        bool  equal(const iterator& rhs) const { return any_equal(rhs, seq_t{}); }
+        void  increment(void)                  { each([](auto& it) { ++it; }, seq_t{}); }
+        void  decrement(void)                  { each([](auto& it) { --it; }, seq_t{}); }
+        void  advance(std::ptrdiff_t n)        { each([n](auto& it) { it += n; }, seq_t{}); }
+        std::ptrdiff_t distance_to(const iterator& rhs) const { return std::get<0>(rhs.its_) - std::get<0>(its_); }
+
+    public:
+        iterator(void) = default;
+        explicit iterator(std::tuple<detail_view::iterator_of<R>...> its) : its_(std::move(its)) {}
+    };
+
+private:
+    template <size_t... N>
+    iterator make_begin(std::index_sequence<N...>) const
+    {
+        return iterator{ std::make_tuple(detail_view::iterator_of<R>(std::begin(std::get<N>(rs_)))...) };
+    }
+
+    /* The random-access iterators end together, at the shortest size */
+    template <size_t... N>
+    iterator make_end(std::true_type, std::index_sequence<N...>) const
+    {
+        std::ptrdiff_t n = (std::min)({ static_cast<std::ptrdiff_t>(std::end(std::get<N>(rs_)) - std::begin(std::get<N>(rs_)))... });
+        return make_begin(seq_t{}) + n;
+    }
+
+    template <size_t... N>
+    iterator make_end(std::false_type, std::index_sequence<N...>) const
+    {
+        return iterator{ std::make_tuple(detail_view::iterator_of<R>(std::end(std::get<N>(rs_)))...) };
+    }
+
+public:
+    template <typename... R_>
+    explicit zip_view(R_&&... rs) : rs_(std::forward<R_>(rs)...) {}
+
+    iterator begin(void) const { return make_begin(seq_t{}); }
+    iterator end  (void) const { return make_end(std::integral_constant<bool, random_access>{}, seq_t{}); }
+};
+
+template <typename... R>
+zip_view<R...> zip(R&&... rs)
+{
+    return zip_view<R...>{ std::forward<R>(rs)... };
+}
+
+} // namespace view
+} // namespace capo
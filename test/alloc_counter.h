@@ -0,0 +1,40 @@
+#pragma once
+
+#include <atomic>
+#include <new>
+#include <cstddef>
+#include <cstdlib>
+
+/*
+    Counts the heap allocations, by replacing the global operator new & delete.
+    All the forms go through the same pair of functions (malloc & free),
+    so an array or sized delete always matches the new it comes from.
+
+    The replacements are definitions, so a test module should include it only once.
+*/
+
+std::atomic<size_t> ut_alloc_count { 0 };
+
+namespace ut_alloc_counter_ {
+
+inline void* allocate(size_t size)
+{
+    ut_alloc_count.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc{};
+}
+
+inline void deallocate(void* p) noexcept
+{
+    std::free(p);
+}
+
+} // namespace ut_alloc_counter_
+
+void* operator new  (size_t size) { return ut_alloc_counter_::allocate(size); }
+void* operator new[](size_t size) { return ut_alloc_counter_::allocate(size); }
+
+void operator delete  (void* p) noexcept         { ut_alloc_counter_::deallocate(p); }
+void operator delete[](void* p) noexcept         { ut_alloc_counter_::deallocate(p); }
+void operator delete  (void* p, size_t) noexcept { ut_alloc_counter_::deallocate(p); }
+void operator delete[](void* p, size_t) noexcept { ut_alloc_counter_::deallocate(p); }
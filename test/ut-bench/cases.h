@@ -0,0 +1,137 @@
+#pragma once
+
+TEST_METHOD(stats)
+{
+    capo::bench_stats s { 100, { 5, 1, 4, 2, 3 } };
+    EXPECT_EQ(100u, s.iterations_);
+    EXPECT_DOUBLE_EQ(3.0, s.mean_);
+    EXPECT_DOUBLE_EQ(3.0, s.median_);
+    EXPECT_DOUBLE_EQ(1.0, s.min_);
+    EXPECT_DOUBLE_EQ(5.0, s.max_);
+    EXPECT_NEAR(1.5811, s.stddev_, 1e-4);
+    EXPECT_DOUBLE_EQ(4.6, s.percentile(90));
+    EXPECT_DOUBLE_EQ(1.0, s.percentile(0));
+    EXPECT_DOUBLE_EQ(5.0, s.percentile(100));
+    EXPECT_DOUBLE_EQ(0.0, capo::bench_stats{}.percentile(50));
+}
+
+TEST_METHOD(calibration)
+{
+    capo::bench b;
+    b.verbose(false).samples(5).min_time(std::chrono::milliseconds(2));
+    size_t calls = 0;
+    auto& r = b.run("counter", [&] { ++calls; capo::do_not_optimize(calls); });
+    EXPECT_EQ(5u, r.stats_.samples_.size());
+    EXPECT_LT(1000u, r.stats_.iterations_);
+    EXPECT_LE(r.stats_.iterations_ * 5, calls);
+    EXPECT_LT(0.0, r.stats_.median_);
+    EXPECT_GT(1000.0, r.stats_.median_);
+
+    calls = 0;
+    b.warmup(std::chrono::nanoseconds(0)).iterations(7);
+    auto& f = b.run("fixed", [&] { ++calls; capo::clobber_memory(); });
+    EXPECT_EQ(7u, f.stats_.iterations_);
+    EXPECT_EQ(35u, calls);
+}
+
+TEST_METHOD(frozen_clock)
+{
+    capo::basic_bench<ut_bench_::frozen_clock> b;
+    b.verbose(false).samples(2).iterations(3).warmup(std::chrono::milliseconds(1));
+    size_t calls = 0;
+    auto& r = b.run("frozen", [&] { ++calls; capo::clobber_memory(); });
+    EXPECT_EQ(3006u, calls); // 1000 warmup rounds at most
+    EXPECT_EQ(0.0, r.stats_.median_);
+}
+
+TEST_METHOD(params)
+{
+    capo::bench b;
+    b.verbose(false).samples(3).min_time(std::chrono::microseconds(100));
+    std::vector<char> src(4096), dst(4096);
+    b.run("memcpy", { 16, 4096 }, [&](int n)
+    {
+        std::memcpy(dst.data(), src.data(), static_cast<size_t>(n));
+        capo::clobber_memory();
+    });
+    std::atomic<size_t> count { 0 };
+    b.run_threads("fetch_add", { 1, 2 }, [&](size_t) { count.fetch_add(1, std::memory_order_relaxed); });
+    ASSERT_EQ(4u, b.results().size());
+    EXPECT_EQ("memcpy/16"             , b.results()[0].name_);
+    EXPECT_EQ("memcpy/4096"           , b.results()[1].name_);
+    EXPECT_EQ("fetch_add/threads:1"   , b.results()[2].name_);
+    EXPECT_EQ("fetch_add/threads:2"   , b.results()[3].name_);
+    EXPECT_LT(b.results()[0].stats_.median_, b.results()[1].stats_.median_);
+}
+
+TEST_METHOD(output)
+{
+    capo::bench b;
+    b.verbose(false).samples(3).min_time(std::chrono::microseconds(100));
+    int x = 0;
+    b.run("a", [&] { capo::do_not_optimize(++x); });
+    b.run("b", [&] { capo::do_not_optimize(--x); });
+
+    std::ostringstream csv;
+    b.write_csv(csv);
+    std::string text = csv.str();
+    EXPECT_EQ(0u, text.find("name,iterations,samples,mean_ns,median_ns,stddev_ns,min_ns,max_ns,p90_ns,p99_ns\na,"));
+    EXPECT_NE(std::string::npos, text.find("\nb,"));
+
+    std::string json;
+    b.write_json(json);
+    EXPECT_EQ(0u, json.find("{\"benchmarks\":[{\"name\":\"a\",\"iterations\":"));
+    EXPECT_NE(std::string::npos, json.find("\"p99_ns\":"));
+
+    // "a" becomes 10 times slower than the baseline, "b" is not in the baseline
+    std::istringstream base { "name,median_ns\na," + std::to_string(b.results()[0].stats_.median_ / 10) + "\n" };
+    capo::bench c;
+    c.verbose(false).samples(3).min_time(std::chrono::microseconds(100));
+    ASSERT_TRUE(c.load_baseline(base));
+    c.run("a", [&] { capo::do_not_optimize(++x); });
+    c.run("b", [&] { capo::do_not_optimize(--x); });
+    EXPECT_LT(0.0, c.results()[0].baseline_);
+    EXPECT_EQ(0.0, c.results()[1].baseline_);
+    auto rs = c.regressions(1.0);
+    ASSERT_EQ(1u, rs.size());
+    EXPECT_EQ("a", rs[0].name_);
+
+    std::istringstream bad { "id,value\n" };
+    EXPECT_FALSE(c.load_baseline(bad));
+}
+
+TEST_METHOD(suite)
+{
+    using namespace ut_bench_;
+    capo::bench b;
+    b.verbose(false);
+    if (const char* path = env("CAPO_BENCH_BASELINE"))
+    {
+        std::ifstream in { path };
+        if (!b.load_baseline(in)) capo::output("invalid baseline: {0}\n", path);
+    }
+
+    b.run("clock/steady_clock", [] { capo::do_not_optimize(std::chrono::steady_clock::now()); });
+    b.run("clock/tsc_clock"   , [] { capo::do_not_optimize(capo::tsc_clock<>::now()); });
+    b.run("clock/coarse_clock", [] { capo::do_not_optimize(capo::coarse_clock::now()); });
+
+    capo::spin_lock sl;
+    std::mutex      mx;
+    b.run("lock/spin_lock" , [&] { sl.lock(); sl.unlock(); });
+    b.run("lock/std::mutex", [&] { mx.lock(); mx.unlock(); });
+
+    capo::histogram<> h;
+    uint64_t v = 0;
+    b.run("histogram/record", [&] { h.record(v += 997); capo::do_not_optimize(&h); });
+
+    capo::profiler prof { true, 1024 };
+    b.run("profiler/scope", [&] { CAPO_PROFILE_SCOPE_(prof, "scope"); });
+
+    char buf[64];
+    int  i = 0;
+    b.run("printf/format_to", [&]
+    {
+        capo::do_not_optimize(capo::format_to(buf, "%d, %s, %f", ++i, "str", 3.14));
+    });
+    finish(b);
+}
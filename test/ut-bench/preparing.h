@@ -0,0 +1,67 @@
+#pragma once
+
+#include "capo/bench.hpp"
+#include "capo/clock.hpp"
+#include "capo/histogram.hpp"
+#include "capo/profiler.hpp"
+#include "capo/spin_lock.hpp"
+#include "capo/printf.hpp"
+#include "capo/output.hpp"
+
+#include <string>
+#include <vector>
+#include <sstream>
+#include <fstream>
+#include <mutex>
+#include <cstring>
+#include <cstdlib>
+
+namespace ut_bench_ {
+
+/*
+    The suite writes its results when these environment variables are set:
+    CAPO_BENCH_CSV      - the path of the CSV output (can be used as a baseline)
+    CAPO_BENCH_JSON     - the path of the JSON output
+    CAPO_BENCH_BASELINE - the path of a CSV output to compare with
+*/
+
+inline const char* env(const char* name)
+{
+    const char* v = std::getenv(name);
+    return ((v == nullptr) || (*v == '\0')) ? nullptr : v;
+}
+
+/*
+    A clock that never moves, as a clock too coarse for the cases would look like.
+*/
+
+struct frozen_clock
+{
+    using duration   = std::chrono::nanoseconds;
+    using rep        = duration::rep;
+    using period     = duration::period;
+    using time_point = std::chrono::time_point<frozen_clock>;
+    static const bool is_steady = true;
+
+    static time_point now(void) { return time_point{}; }
+};
+
+template <typename B>
+void finish(B& b)
+{
+    b.report(std::cout);
+    if (const char* path = env("CAPO_BENCH_CSV"))
+    {
+        std::ofstream out { path };
+        b.write_csv(out);
+    }
+    if (const char* path = env("CAPO_BENCH_JSON"))
+    {
+        std::ofstream out { path };
+        b.write_json(out);
+    }
+    for (auto& r : b.regressions(0.1))
+        capo::output("regression: {0} {1:.1f}%\n", r.name_, r.change() * 100);
+}
+
+} // namespace ut_bench_
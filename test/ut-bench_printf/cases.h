@@ -0,0 +1,186 @@
+#pragma once
+
+/*
+    Each group formats the same text in several ways:
+    memcpy (the cost of copying the result only), snprintf, std::ostringstream,
+    capo::format_to, capo::printf and capo::output.
+*/
+
+#define UT_BENCH_PRINTF_BASELINES_(TEXT, SNPRINTF_ARGS, STREAM_EXPR)                        \
+    const std::string expect = TEXT;                                                       \
+    char buf[256];                                                                         \
+    run("memcpy", [&]                                                                      \
+    {                                                                                      \
+        std::memcpy(buf, expect.data(), expect.size());                                    \
+        sink_size = expect.size();                                                         \
+    });                                                                                    \
+    run("snprintf", [&]                                                                    \
+    {                                                                                      \
+        sink_size = ::snprintf SNPRINTF_ARGS;                                              \
+    });                                                                                    \
+    EXPECT_STREQ(expect.c_str(), buf);                                                     \
+    run("std::ostringstream", [&]                                                          \
+    {                                                                                      \
+        std::ostringstream ss;                                                             \
+        ss << STREAM_EXPR;                                                                 \
+        sink_size = ss.str().size();                                                       \
+    })
+
+TEST_METHOD(integer)
+{
+    using namespace ut_bench_printf_;
+    capo::output("\n[integer]\n");
+    int a = 123456789, b = -42;
+    UT_BENCH_PRINTF_BASELINES_("123456789, -42, ff", (buf, sizeof(buf), "%d, %d, %x", a, b, 255),
+                               a << ", " << b << ", " << std::hex << 255);
+    std::string str;
+    auto fr = run("capo::format_to", [&]
+    {
+        sink_size = static_cast<size_t>(capo::format_to(buf, "%d, %d, %x", a, b, 255) - buf);
+    });
+    EXPECT_EQ(0.0, fr.allocs_);
+    auto pr = run("capo::printf", [&]
+    {
+        sink_size = static_cast<size_t>(capo::printf(capo::use::strout(str), "%d, %d, %x", a, b, 255));
+    });
+    EXPECT_STREQ(expect.c_str(), str.c_str());
+    EXPECT_GE(1.0, pr.allocs_);
+    run("capo::output", [&]
+    {
+        capo::output(capo::use::strout(str), "{0}, {1}, {2:x}", a, b, 255);
+    });
+    EXPECT_STREQ(expect.c_str(), str.c_str());
+}
+
+TEST_METHOD(floating)
+{
+    using namespace ut_bench_printf_;
+    capo::output("\n[floating]\n");
+    double a = 3.14159265358979, b = 1.5e-7;
+    UT_BENCH_PRINTF_BASELINES_("3.141593, 1.500e-07", (buf, sizeof(buf), "%f, %.3e", a, b),
+                               std::fixed << a << ", " << std::scientific << std::setprecision(3) << b);
+    std::string str;
+    auto fr = run("capo::format_to", [&]
+    {
+        sink_size = static_cast<size_t>(capo::format_to(buf, "%f, %.3e", a, b) - buf);
+    });
+    EXPECT_EQ(0.0, fr.allocs_);
+    run("capo::printf", [&]
+    {
+        capo::printf(capo::use::strout(str), "%f, %.3e", a, b);
+    });
+    EXPECT_STREQ(expect.c_str(), str.c_str());
+    run("capo::printf (%r)", [&]
+    {
+        capo::printf(capo::use::strout(str), "%r, %r", a, b);
+    });
+    EXPECT_STREQ("3.14159265358979, 1.5e-07", str.c_str());
+    run("capo::output", [&]
+    {
+        capo::output(capo::use::strout(str), "{0}, {1:.3e}", a, b);
+    });
+    EXPECT_STREQ(expect.c_str(), str.c_str());
+}
+
+TEST_METHOD(string)
+{
+    using namespace ut_bench_printf_;
+    capo::output("\n[string]\n");
+    const char* a = "Hello";
+    std::string b = "World, this is a longer string argument";
+    UT_BENCH_PRINTF_BASELINES_("Hello, World, this is a longer string argument!",
+                               (buf, sizeof(buf), "%s, %s!", a, b.c_str()), a << ", " << b << "!");
+    std::string str;
+    auto fr = run("capo::format_to", [&]
+    {
+        sink_size = static_cast<size_t>(capo::format_to(buf, "%s, %s!", a, b.c_str()) - buf);
+    });
+    EXPECT_EQ(0.0, fr.allocs_);
+    run("capo::printf", [&]
+    {
+        capo::printf(capo::use::strout(str), "%s, %s!", a, b.c_str());
+    });
+    EXPECT_STREQ(expect.c_str(), str.c_str());
+    run("capo::output", [&]
+    {
+        capo::output(capo::use::strout(str), "{0}, {1}!", a, b);
+    });
+    EXPECT_STREQ(expect.c_str(), str.c_str());
+}
+
+TEST_METHOD(positional)
+{
+    using namespace ut_bench_printf_;
+    capo::output("\n[positional]\n");
+    int a = 1, b = 2;
+    UT_BENCH_PRINTF_BASELINES_("2 1 2 1", (buf, sizeof(buf), "%2$d %1$d %2$d %1$d", a, b),
+                               b << " " << a << " " << b << " " << a);
+    std::string str;
+    run("capo::output", [&]
+    {
+        capo::output(capo::use::strout(str), "{1} {0} {1} {0}", a, b);
+    });
+    EXPECT_STREQ(expect.c_str(), str.c_str());
+}
+
+TEST_METHOD(custom)
+{
+    using namespace ut_bench_printf_;
+    capo::output("\n[custom]\n");
+    UT_BENCH_PRINTF_BASELINES_("value: custom(123, abc)", (buf, sizeof(buf), "value: custom(%d, %s)", 123, "abc"),
+                               "value: custom(" << 123 << ", " << "abc" << ")");
+    std::string str;
+    run("capo::output", [&]
+    {
+        capo::output(capo::use::strout(str), "value: {}", custom{});
+    });
+    EXPECT_STREQ(expect.c_str(), str.c_str());
+}
+
+TEST_METHOD(multi_line)
+{
+    using namespace ut_bench_printf_;
+    capo::output("\n[multi-line follower]\n");
+    UT_BENCH_PRINTF_BASELINES_("a = 1\nb = 2.5\nc = str\n",
+                               (buf, sizeof(buf), "a = %d\nb = %.1f\nc = %s\n", 1, 2.5, "str"),
+                               "a = " << 1 << "\nb = " << 2.5 << "\nc = " << "str" << "\n");
+    std::string str;
+    run("capo::output", [&]
+    {
+        capo::output(capo::use::strout(str), "a = {}", 1).ln()
+                    ("b = {:.1f}", 2.5).ln()
+                    ("c = {}", "str").ln();
+    });
+    EXPECT_STREQ(expect.c_str(), str.c_str());
+}
+
+TEST_METHOD(mixed)
+{
+    using namespace ut_bench_printf_;
+    capo::output("\n[mixed]\n");
+    int a = 123;
+    double b = 30.75;
+    UT_BENCH_PRINTF_BASELINES_("123, 0000007b, 30.750000, str", (buf, sizeof(buf), "%d, %08x, %f, %s", a, a, b, "str"),
+                               a << ", " << std::hex << std::setw(8) << std::setfill('0') << a << ", "
+                                 << std::dec << std::fixed << b << ", " << "str");
+    std::string str;
+    run("capo::printf", [&]
+    {
+        capo::printf(capo::use::strout(str), "%d, %08x, %f, %s", a, a, b, "str");
+    });
+    EXPECT_STREQ(expect.c_str(), str.c_str());
+    run("capo::output", [&]
+    {
+        capo::output(capo::use::strout(str), "{0}, {1:08x}, {2:.6f}, {3}", a, a, b, "str");
+    });
+    EXPECT_STREQ(expect.c_str(), str.c_str());
+}
+
+TEST_METHOD(check_format)
+{
+    using namespace ut_bench_printf_;
+    capo::output("\n[check format] (cached: {0})\n", CAPO_PRINTF_CHECK_CACHE_);
+    int i = 0;
+    run("check", [&] { capo::detail_printf_::check("%d, %s, %08x, %.3f", ++i, "abc", 0xbeefu, 3.14); });
+    run("verify", [&] { capo::detail_printf_::verify("%d, %s, %08x, %.3f", ++i, "abc", 0xbeefu, 3.14); });
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "capo/printf.hpp"
+#include "capo/output.hpp"
+#include "capo/format.hpp"
+#include "capo/bench.hpp"
+
+#include <string>
+#include <sstream>
+#include <iomanip>
+#include <atomic>
+#include <new>
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
+
+#include "test/alloc_counter.h" // counts the heap allocations
+
+namespace ut_bench_printf_ {
+
+struct result
+{
+    double ns_;
+    double allocs_;
+};
+
+volatile size_t sink_size = 0;
+
+/*
+    Times f with capo::bench, then counts the allocations of 1000 calls.
+*/
+template <typename F>
+result run(const char* name, F&& f)
+{
+    capo::bench b;
+    b.verbose(false).samples(5).min_time(std::chrono::milliseconds(4));
+    double ns = b.run(name, f).stats_.median_;
+    size_t allocs = ut_alloc_count.load(std::memory_order_relaxed);
+    for (int i = 0; i < 1000; ++i) f();
+    allocs = ut_alloc_count.load(std::memory_order_relaxed) - allocs;
+    result r { ns, double(allocs) / 1000 };
+    capo::printf("%-32s %10.1f ns/call %8.2f allocs/call\n", name, r.ns_, r.allocs_);
+    return r;
+}
+
+struct custom
+{
+    template <typename T>
+    void operator()(capo::follower<T>&& out) const
+    {
+        out("custom({0}, {1})", 123, "abc");
+    }
+};
+
+} // namespace ut_bench_printf_
@@ -0,0 +1,74 @@
+#pragma once
+
+TEST_METHOD(uncontended)
+{
+    using namespace ut_bench_sync_;
+    capo::output("\n[uncontended]\n");
+    capo::bench b;
+    setup(b);
+    std::mutex m;
+    capo::spin_lock s;
+    uint64_t value = 0;
+    b.run("std::mutex"     , [&] { std::lock_guard<std::mutex>      g { m }; ++value; });
+    b.run("capo::spin_lock", [&] { std::lock_guard<capo::spin_lock> g { s }; ++value; });
+#if defined(CAPO_OS_LINUX_)
+    futex_mutex f;
+    b.run("futex_mutex"    , [&] { std::lock_guard<futex_mutex>     g { f }; ++value; });
+#endif/*CAPO_OS_LINUX_*/
+    capo::thread_wrapper<counter, std::mutex>      wm;
+    capo::thread_wrapper<counter, capo::spin_lock> ws;
+    b.run("thread_wrapper<std::mutex>"     , [&] { wm.call(&counter::inc, 0); });
+    b.run("thread_wrapper<capo::spin_lock>", [&] { ws.call(&counter::inc, 0); });
+    capo::do_not_optimize(value);
+    EXPECT_LT(0u, value);
+    EXPECT_LT(0u, wm.value_);
+    EXPECT_LT(0u, ws.value_);
+}
+
+TEST_METHOD(contended)
+{
+    using namespace ut_bench_sync_;
+    capo::output("\n[contended] ns per acquisition, all threads together\n");
+    capo::bench b;
+    setup(b);
+    for (size_t cs : cs_lengths())
+    {
+        EXPECT_LT(0u, lock_throughput<std::mutex>     (b, "std::mutex"     , cs));
+        EXPECT_LT(0u, lock_throughput<capo::spin_lock>(b, "capo::spin_lock", cs));
+#if defined(CAPO_OS_LINUX_)
+        EXPECT_LT(0u, lock_throughput<futex_mutex>    (b, "futex_mutex"    , cs));
+#endif/*CAPO_OS_LINUX_*/
+        EXPECT_LT(0u, wrapper_throughput<std::mutex>     (b, "thread_wrapper<std::mutex>"     , cs));
+        EXPECT_LT(0u, wrapper_throughput<capo::spin_lock>(b, "thread_wrapper<capo::spin_lock>", cs));
+    }
+}
+
+TEST_METHOD(fairness)
+{
+    using namespace ut_bench_sync_;
+    capo::output("\n[fairness] acquisitions per thread in 50 ms\n");
+    capo::printf(std::cout, "%-24s %8s %8s %14s %10s %10s\n", "lock", "threads", "cs", "acquisitions", "spread", "cv");
+    size_t tn = thread_counts().back();
+    for (size_t cs : cs_lengths())
+    {
+        EXPECT_LT(0u, print_fairness<std::mutex>     ("std::mutex"     , tn, cs).total_);
+        EXPECT_LT(0u, print_fairness<capo::spin_lock>("capo::spin_lock", tn, cs).total_);
+#if defined(CAPO_OS_LINUX_)
+        EXPECT_LT(0u, print_fairness<futex_mutex>    ("futex_mutex"    , tn, cs).total_);
+#endif/*CAPO_OS_LINUX_*/
+    }
+}
+
+TEST_METHOD(handoff)
+{
+    using namespace ut_bench_sync_;
+    capo::output("\n[handoff] ns per round trip between two threads\n");
+    capo::bench b;
+    setup(b);
+    EXPECT_LT(0.0, handoff<capo::semaphore>(b, "capo::semaphore"));
+    EXPECT_LT(0.0, handoff<waiter_event>   (b, "capo::waiter"));
+    EXPECT_LT(0.0, handoff<cv_semaphore>   (b, "std::condition_variable"));
+#if defined(CAPO_OS_LINUX_)
+    EXPECT_LT(0.0, handoff<futex_semaphore>(b, "futex_semaphore"));
+#endif/*CAPO_OS_LINUX_*/
+}
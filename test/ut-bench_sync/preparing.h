@@ -0,0 +1,324 @@
+#pragma once
+
+#include "capo/bench.hpp"
+#include "capo/spin_lock.hpp"
+#include "capo/semaphore.hpp"
+#include "capo/waiter.hpp"
+#include "capo/thread_wrapper.hpp"
+#include "capo/printf.hpp"
+#include "capo/output.hpp"
+#include "capo/detect_plat.hpp"
+
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <cstdlib>
+#include <cstdint>
+
+#if defined(CAPO_OS_LINUX_)
+#include <unistd.h>         // syscall
+#include <sys/syscall.h>    // SYS_futex
+#include <linux/futex.h>    // FUTEX_WAIT_PRIVATE, FUTEX_WAKE_PRIVATE
+#endif/*CAPO_OS_LINUX_*/
+
+namespace ut_bench_sync_ {
+
+/*
+    The suite can be tuned with these environment variables:
+    CAPO_BENCH_THREADS - the max thread count of the sweeps (default: hardware_concurrency, at least 4)
+    CAPO_BENCH_CS      - the critical section lengths, in spins, separated by commas (default: 0,50,500)
+*/
+
+inline std::vector<size_t> env_list(const char* name, std::vector<size_t> def)
+{
+    const char* v = std::getenv(name);
+    if ((v == nullptr) || (*v == '\0')) return def;
+    std::vector<size_t> ret;
+    for (char* e = nullptr; *v != '\0'; v = (*e == ',') ? e + 1 : e)
+    {
+        ret.push_back(static_cast<size_t>(std::strtoull(v, &e, 10)));
+        if (e == v) break;
+    }
+    return ret;
+}
+
+inline std::vector<size_t> thread_counts(void)
+{
+    size_t max = env_list("CAPO_BENCH_THREADS", { (std::max)(std::thread::hardware_concurrency(), 4u) })[0];
+    std::vector<size_t> ret;
+    for (size_t n = 1; n < max; n *= 2) ret.push_back(n);
+    ret.push_back(max);
+    return ret;
+}
+
+inline std::vector<size_t> cs_lengths(void)
+{
+    return env_list("CAPO_BENCH_CS", { 0, 50, 500 });
+}
+
+/*
+    Simulates the work inside a critical section.
+*/
+inline void spin(size_t n)
+{
+    for (size_t i = 0; i < n; ++i) capo::do_not_optimize(i);
+}
+
+inline void setup(capo::bench& b)
+{
+    b.samples(5).min_time(std::chrono::milliseconds(5)).warmup(std::chrono::milliseconds(1));
+}
+
+////////////////////////////////////////////////////////////////
+/// Baselines
+////////////////////////////////////////////////////////////////
+
+#if defined(CAPO_OS_LINUX_)
+inline void futex_wait(std::atomic<int>& a, int v)
+{
+    ::syscall(SYS_futex, reinterpret_cast<int*>(&a), FUTEX_WAIT_PRIVATE, v, nullptr, nullptr, 0);
+}
+
+inline void futex_wake(std::atomic<int>& a, int n)
+{
+    ::syscall(SYS_futex, reinterpret_cast<int*>(&a), FUTEX_WAKE_PRIVATE, n, nullptr, nullptr, 0);
+}
+
+/*
+    See: Ulrich Drepper, Futexes Are Tricky, Mutex, Take 2
+    0: unlocked, 1: locked, 2: locked and might have waiters
+*/
+class futex_mutex
+{
+    std::atomic<int> state_ { 0 };
+
+public:
+    bool try_lock(void)
+    {
+        int c = 0;
+        return state_.compare_exchange_strong(c, 1, std::memory_order_acquire);
+    }
+
+    void lock(void)
+    {
+        int c = 0;
+        if (state_.compare_exchange_strong(c, 1, std::memory_order_acquire)) return;
+        if (c != 2) c = state_.exchange(2, std::memory_order_acquire);
+        while (c != 0)
+        {
+            futex_wait(state_, 2);
+            c = state_.exchange(2, std::memory_order_acquire);
+        }
+    }
+
+    void unlock(void)
+    {
+        if (state_.exchange(0, std::memory_order_release) != 1) futex_wake(state_, 1);
+    }
+};
+
+class futex_semaphore
+{
+    std::atomic<int> count_ { 0 };
+
+public:
+    void wait(void)
+    {
+        for (;;)
+        {
+            int c = count_.load(std::memory_order_relaxed);
+            if (c == 0) futex_wait(count_, 0);
+            else if (count_.compare_exchange_weak(c, c - 1, std::memory_order_acquire)) return;
+        }
+    }
+
+    void post(void)
+    {
+        count_.fetch_add(1, std::memory_order_release);
+        futex_wake(count_, 1);
+    }
+};
+#endif/*CAPO_OS_LINUX_*/
+
+/*
+    The plain std::condition_variable event, notifying only one waiter.
+*/
+class cv_semaphore
+{
+    std::mutex              lock_;
+    std::condition_variable cond_;
+    long                    counter_ = 0;
+
+public:
+    void wait(void)
+    {
+        std::unique_lock<std::mutex> lc { lock_ };
+        cond_.wait(lc, [this] { return counter_ > 0; });
+        --counter_;
+    }
+
+    void post(void)
+    {
+        {
+            std::lock_guard<std::mutex> lc { lock_ };
+            ++counter_;
+        }
+        cond_.notify_one();
+    }
+};
+
+/*
+    capo::waiter as an auto-reset event.
+*/
+class waiter_event
+{
+    capo::waiter w_;
+
+public:
+    void wait(void) { w_.wait(); }
+    void post(void) { w_.notify_one(); }
+};
+
+////////////////////////////////////////////////////////////////
+/// Measurements
+////////////////////////////////////////////////////////////////
+
+struct counter
+{
+    uint64_t value_ = 0;
+
+    void inc(size_t cs)
+    {
+        spin(cs);
+        ++value_;
+    }
+};
+
+/*
+    Lock, spin and unlock, on 1 to N threads. Returns the final count.
+*/
+template <typename MutexT>
+uint64_t lock_throughput(capo::bench& b, const std::string& name, size_t cs)
+{
+    MutexT lc;
+    uint64_t value = 0;
+    b.run_threads(name + "/cs:" + std::to_string(cs), thread_counts(), [&](size_t)
+    {
+        std::lock_guard<MutexT> guard { lc };
+        spin(cs);
+        ++value;
+    });
+    return value;
+}
+
+template <typename MutexT>
+uint64_t wrapper_throughput(capo::bench& b, const std::string& name, size_t cs)
+{
+    capo::thread_wrapper<counter, MutexT> cnt;
+    b.run_threads(name + "/cs:" + std::to_string(cs), thread_counts(), [&](size_t)
+    {
+        cnt.call(&counter::inc, cs);
+    });
+    return cnt.value_;
+}
+
+/*
+    The acquisitions of each thread, during a fixed period.
+    spread_ is (max - min) / mean, cv_ is the coefficient of variation.
+*/
+struct fairness_t
+{
+    std::vector<uint64_t> counts_;
+    uint64_t total_  = 0;
+    double   spread_ = 0;
+    double   cv_     = 0;
+};
+
+template <typename MutexT>
+fairness_t fairness(size_t thread_count, size_t cs, std::chrono::milliseconds period)
+{
+    MutexT lc;
+    fairness_t f;
+    f.counts_.resize(thread_count);
+    std::atomic<bool> stop { false };
+    std::vector<std::thread> ths;
+    for (size_t t = 0; t < thread_count; ++t)
+    {
+        ths.emplace_back([&, t]
+        {
+            uint64_t n = 0;
+            while (!stop.load(std::memory_order_relaxed))
+            {
+                std::lock_guard<MutexT> guard { lc };
+                spin(cs);
+                ++n;
+            }
+            f.counts_[t] = n;
+        });
+    }
+    std::this_thread::sleep_for(period);
+    stop.store(true, std::memory_order_relaxed);
+    for (auto& th : ths) th.join();
+
+    double mean = 0, var = 0;
+    for (auto n : f.counts_) f.total_ += n;
+    mean = static_cast<double>(f.total_) / thread_count;
+    for (auto n : f.counts_) var += (n - mean) * (n - mean);
+    if (mean > 0)
+    {
+        auto mm = std::minmax_element(f.counts_.begin(), f.counts_.end());
+        f.spread_ = (*mm.second - *mm.first) / mean;
+        f.cv_     = std::sqrt(var / thread_count) / mean;
+    }
+    return f;
+}
+
+template <typename MutexT>
+fairness_t print_fairness(const char* name, size_t thread_count, size_t cs)
+{
+    auto f = fairness<MutexT>(thread_count, cs, std::chrono::milliseconds(50));
+    capo::printf(std::cout, "%-24s %8zu %8zu %14llu %10.3f %10.3f\n", name, thread_count, cs,
+                 static_cast<unsigned long long>(f.total_), f.spread_, f.cv_);
+    return f;
+}
+
+/*
+    Round trips between the calling thread and a partner thread,
+    the handoff latency is half of a round trip. Returns the median in ns.
+*/
+template <typename EventT>
+double handoff(capo::bench& b, const std::string& name)
+{
+    EventT ping, pong;
+    std::atomic<bool> stop { false };
+    uint64_t rounds = 0;
+    std::thread partner { [&]
+    {
+        for (;;)
+        {
+            ping.wait();
+            if (stop.load(std::memory_order_relaxed)) break;
+            pong.post();
+        }
+    } };
+    double ns = b.run(name, [&]
+    {
+        ping.post();
+        pong.wait();
+        ++rounds;
+    }).stats_.median_;
+    stop.store(true, std::memory_order_relaxed);
+    ping.post();
+    partner.join();
+    capo::do_not_optimize(rounds);
+    return ns;
+}
+
+} // namespace ut_bench_sync_
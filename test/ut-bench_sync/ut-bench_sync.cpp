@@ -0,0 +1,10 @@
+#include "gtest/gtest.h"
+
+////////////////////////////////////////////////////////////////
+
+#define TEST_METHOD(TEST_NAME) TEST(bench_sync, TEST_NAME)
+
+////////////////////////////////////////////////////////////////
+
+#include "preparing.h"
+#include "cases.h"
\ No newline at end of file
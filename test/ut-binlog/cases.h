@@ -0,0 +1,165 @@
+#pragma once
+
+TEST_METHOD(types)
+{
+    using namespace ut_binlog_;
+    const char* path = "ut-binlog-types.blog";
+    std::string name = "capo";
+    int  i = -123456;
+    long long ll = 1234567890123LL;
+    unsigned u = 0xdeadbeef;
+    double d = 3.14159265358979;
+    float f = 2.5f;
+    char c = 'x';
+    short sh = -7;
+    void* p = reinterpret_cast<void*>(0x12345678);
+    {
+        capo::binlog_writer wt { path };
+        ASSERT_TRUE(wt.valid());
+        CAPO_BINLOG_(wt, info , "no argument");
+        CAPO_BINLOG_(wt, info , "%s, %d, %lld, %08x", name, i, ll, u);
+        CAPO_BINLOG_(wt, warn , "[%10.3f|%-6.1f|%e|%r]", d, f, d, d);
+        CAPO_BINLOG_(wt, error, "%c %d %p %s %%", c, sh, p, "literal");
+        CAPO_BINLOG_(wt, fatal, "%d %u", true, false);
+        CAPO_BINLOG_(wt, trace, "compiled out in release");
+    }
+    auto list = read_all(path);
+#if defined(NDEBUG)
+    ASSERT_EQ(size_t(5), list.size());
+#else
+    ASSERT_EQ(size_t(6), list.size());
+#endif
+    EXPECT_STREQ("no argument", list[0].text_.c_str());
+    EXPECT_STREQ(sprint("%s, %d, %lld, %08x", name.c_str(), i, ll, u).c_str(), list[1].text_.c_str());
+    EXPECT_STREQ(sprint("[%10.3f|%-6.1f|%e|%r]", d, f, d, d).c_str(), list[2].text_.c_str());
+    EXPECT_STREQ(sprint("%c %d %p %s %%", c, sh, p, "literal").c_str(), list[3].text_.c_str());
+    EXPECT_STREQ("1 0", list[4].text_.c_str());
+    EXPECT_TRUE(capo::log_level::warn == list[2].level_);
+    EXPECT_NE(std::string::npos, std::string(list[2].file_).find("cases.h"));
+    for (size_t n = 1; n < 5; ++n)
+    {
+        EXPECT_LE(list[n - 1].time_, list[n].time_);
+        EXPECT_EQ(list[n - 1].line_ + 1, list[n].line_);
+    }
+    std::remove(path);
+}
+
+TEST_METHOD(time_range)
+{
+    using namespace ut_binlog_;
+    const char* path = "ut-binlog-range.blog";
+    const int LoopN = 20000;
+    {
+        capo::binlog_writer wt { path, 1024 }; // small blocks
+        for (int i = 0; i < LoopN; ++i)
+            CAPO_BINLOG_(wt, info, "%d", i);
+    }
+    capo::binlog_reader rd { path };
+    ASSERT_TRUE(rd.valid());
+    EXPECT_TRUE(rd.indexed());
+    EXPECT_LT(size_t(10), rd.blocks());
+
+    auto list = read_all(path);
+    ASSERT_EQ(size_t(LoopN), list.size());
+    for (int i = 0; i < LoopN; ++i)
+        ASSERT_EQ(i, std::atoi(list[i].text_.c_str()));
+
+    uint64_t from = list[LoopN / 4].time_, to = list[LoopN / 2].time_;
+    auto part = read_all(path, from, to);
+    ASSERT_FALSE(part.empty());
+    for (auto& e : part)
+    {
+        EXPECT_LE(from, e.time_);
+        EXPECT_GE(to, e.time_);
+    }
+    size_t expect = 0;
+    for (auto& e : list) if (e.time_ >= from && e.time_ <= to) ++expect;
+    EXPECT_EQ(expect, part.size());
+    std::remove(path);
+}
+
+TEST_METHOD(unclosed)
+{
+    using namespace ut_binlog_;
+    const char* path = "ut-binlog-unclosed.blog";
+    const char* copy = "ut-binlog-unclosed-copy.blog";
+    {
+        capo::binlog_writer wt { path, 256 };
+        for (int i = 0; i < 1000; ++i)
+            CAPO_BINLOG_(wt, info, "%s-%d", "rec", i);
+        wt.flush();
+        copy_file(path, copy); // as if the process crashed here
+    }
+    capo::binlog_reader rd { copy };
+    ASSERT_TRUE(rd.valid());
+    EXPECT_FALSE(rd.indexed());
+    std::vector<std::string> texts;
+    rd.read([&](const capo::binlog_entry& e) { texts.push_back(e.text_); });
+    ASSERT_EQ(size_t(1000), texts.size());
+    EXPECT_STREQ("rec-999", texts.back().c_str());
+    std::remove(path);
+    std::remove(copy);
+}
+
+TEST_METHOD(write_failure)
+{
+    // "/dev/full" fails every write with ENOSPC (skipped if there is no such device)
+    capo::binlog_writer wt { "/dev/full", 256 };
+    if (!wt.valid()) return;
+    for (int i = 0; (i < 100000) && wt.valid(); ++i)
+        CAPO_BINLOG_(wt, info, "%s-%d", "rec", i);
+    EXPECT_FALSE(wt.valid());
+    EXPECT_FALSE(wt.flush());
+    EXPECT_FALSE(wt.close());
+    CAPO_BINLOG_(wt, info, "%d", 1); // ignored
+}
+
+TEST_METHOD(multi_thread)
+{
+    using namespace ut_binlog_;
+    const char* path = "ut-binlog-mt.blog";
+    const int ThreadN = 4, LoopN = 10000;
+    {
+        capo::binlog_writer wt { path };
+        std::vector<std::thread> ths;
+        for (int t = 0; t < ThreadN; ++t)
+            ths.emplace_back([&wt, t]
+            {
+                for (int i = 0; i < LoopN; ++i) CAPO_BINLOG_(wt, info, "%d %d", t, i);
+            });
+        for (auto& th : ths) th.join();
+    }
+    auto list = read_all(path);
+    ASSERT_EQ(size_t(ThreadN * LoopN), list.size());
+    int next[ThreadN] = {};
+    for (auto& e : list)
+    {
+        int t = -1, i = -1;
+        std::sscanf(e.text_.c_str(), "%d %d", &t, &i);
+        ASSERT_TRUE(t >= 0 && t < ThreadN);
+        ASSERT_EQ(next[t]++, i);
+    }
+    std::remove(path);
+}
+
+TEST_METHOD(bad_format)
+{
+    capo::binlog_writer wt { "ut-binlog-bad.blog" };
+    // the format of a site is checked at its first call
+    auto bad = [&] { CAPO_BINLOG_(wt, info, "%d %d", 1); };
+    EXPECT_THROW(bad(), std::invalid_argument);
+    wt.close();
+    std::remove("ut-binlog-bad.blog");
+}
+
+TEST_METHOD(latency)
+{
+    const char* path = "ut-binlog-latency.blog";
+    int i = 0;
+    {
+        capo::binlog_writer wt { path };
+        capo::bench b;
+        b.run("binlog_writer::write", [&] { CAPO_BINLOG_(wt, info, "%d, %s, %f", ++i, "hello", 3.14); });
+    }
+    std::remove(path);
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include "capo/binlog.hpp"
+#include "capo/printf.hpp"
+#include "capo/output.hpp"
+#include "capo/bench.hpp"
+
+#include <string>
+#include <vector>
+#include <thread>
+#include <fstream>
+#include <iterator>
+#include <cstdio>
+
+namespace ut_binlog_ {
+
+std::vector<capo::binlog_entry> read_all(const char* path,
+                                         uint64_t from = 0, uint64_t to = (std::numeric_limits<uint64_t>::max)())
+{
+    std::vector<capo::binlog_entry> list;
+    capo::binlog_reader rd { path };
+    rd.read([&](const capo::binlog_entry& e) { list.push_back(e); }, from, to);
+    return list;
+}
+
+template <typename... A>
+std::string sprint(const char* fmt, A&&... args)
+{
+    std::string str;
+    capo::printf(capo::use::strout(str), fmt, std::forward<A>(args)...);
+    return str;
+}
+
+void copy_file(const char* from, const char* to)
+{
+    std::ifstream in(from, std::ios::binary);
+    std::ofstream out(to, std::ios::binary);
+    out << in.rdbuf();
+}
+
+} // namespace ut_binlog_
@@ -0,0 +1,69 @@
+#pragma once
+
+TEST_METHOD(tsc_clock)
+{
+    using namespace ut_clock_;
+    capo::output("invariant tsc: {0}, frequency: {1} MHz\n",
+                 capo::tsc_clock<>::invariant(), capo::tsc_clock<>::frequency() / 1e6);
+    EXPECT_LT(0.0, capo::tsc_clock<>::frequency());
+
+    auto t0 = capo::tsc_clock<capo::use::tsc_rdtscp>::now();
+    auto t1 = capo::tsc_clock<capo::use::tsc_lfence>::now();
+    auto t2 = capo::tsc_clock<>::now();
+    EXPECT_LE(t0.time_since_epoch().count(), t1.time_since_epoch().count());
+    EXPECT_LE(t1.time_since_epoch().count(), t2.time_since_epoch().count());
+
+    capo::stopwatch<1, capo::tsc_clock<>> sw(true);
+    capo::stopwatch<> ref(true);
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    auto ms  = sw .elapsed<std::chrono::microseconds>() / 1000.0;
+    auto ref_ms = ref.elapsed<std::chrono::microseconds>() / 1000.0;
+    capo::output("tsc stopwatch: {0} ms, steady stopwatch: {1} ms\n", ms, ref_ms);
+    EXPECT_NEAR(ref_ms, ms, ref_ms * 0.1);
+}
+
+TEST_METHOD(coarse_clock)
+{
+    auto t0 = capo::coarse_clock::now();
+    capo::stopwatch<1, capo::coarse_clock> sw(true);
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    EXPECT_LE(t0, capo::coarse_clock::now());
+    auto ms = sw.elapsed<std::chrono::milliseconds>();
+    EXPECT_LE(40, ms);
+}
+
+TEST_METHOD(cpu_clock)
+{
+    using namespace ut_clock_;
+    capo::stopwatch<2, capo::thread_cpu_clock> sw(true);
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    sw.pause();
+    spin_for(std::chrono::milliseconds(50));
+    auto sleep_ms = sw.elapsed<std::chrono::milliseconds, 0>();
+    auto spin_ms  = sw.elapsed<std::chrono::milliseconds, 1>();
+    capo::output("thread cpu: sleep {0} ms, sleep + spin {1} ms\n", sleep_ms, spin_ms);
+    EXPECT_GT(20, sleep_ms);
+    EXPECT_LE(20, spin_ms - sleep_ms);
+
+    capo::stopwatch<1, capo::process_cpu_clock> psw(true);
+    std::thread th1 { [] { spin_for(std::chrono::milliseconds(50)); } };
+    std::thread th2 { [] { spin_for(std::chrono::milliseconds(50)); } };
+    th1.join();
+    th2.join();
+    auto proc_ms = psw.elapsed<std::chrono::milliseconds>();
+    capo::output("process cpu: 2 threads spin 50 ms, {0} ms\n", proc_ms);
+    EXPECT_LE(40, proc_ms);
+}
+
+TEST_METHOD(now_cost)
+{
+    using namespace ut_clock_;
+    capo::bench b;
+    now_cost<std::chrono::steady_clock>             (b, "steady_clock::now");
+    now_cost<capo::tsc_clock<>>                     (b, "tsc_clock::now");
+    now_cost<capo::tsc_clock<capo::use::tsc_lfence>>(b, "tsc_clock<tsc_lfence>::now");
+    now_cost<capo::tsc_clock<capo::use::tsc_rdtscp>>(b, "tsc_clock<tsc_rdtscp>::now");
+    now_cost<capo::coarse_clock>                    (b, "coarse_clock::now");
+    now_cost<capo::thread_cpu_clock>                (b, "thread_cpu_clock::now");
+    now_cost<capo::process_cpu_clock>               (b, "process_cpu_clock::now");
+}
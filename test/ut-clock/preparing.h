@@ -0,0 +1,31 @@
+#pragma once
+
+#include "capo/clock.hpp"
+#include "capo/stopwatch.hpp"
+#include "capo/bench.hpp"
+#include "capo/output.hpp"
+
+#include <chrono>
+#include <thread>
+
+namespace ut_clock_ {
+
+volatile unsigned sink = 0;
+
+inline void spin_for(std::chrono::milliseconds ms)
+{
+    auto until = std::chrono::steady_clock::now() + ms;
+    while (std::chrono::steady_clock::now() < until) sink = sink + 1;
+}
+
+/*
+    The cost of ClockT::now(), in nanoseconds.
+*/
+template <typename ClockT>
+double now_cost(capo::bench& b, const char* name)
+{
+    ClockT::now(); // calibrate, if necessary
+    return b.run(name, [] { capo::do_not_optimize(ClockT::now()); }).stats_.median_;
+}
+
+} // namespace ut_clock_
@@ -41,3 +41,45 @@ TEST_METHOD(constant_array)
         EXPECT_EQ(xx[i], yy[i]) << "At index: " << i;
     }
 }
+
+TEST_METHOD(constexpr_array)
+{
+    using namespace ut_constant_array_;
+
+    using constant_array = capo::constant_array<int>;
+
+    constexpr std::array<int, 10> expect {{ 0, 1, 4, 2, 2, 4, 1, 0, 1, 4 }};
+    static_assert(same(squares, expect), "");
+    static_assert(same(sorted, (std::array<int, 10> {{ 0, 0, 1, 1, 1, 2, 2, 4, 4, 4 }})), "");
+    static_assert(same(capo::array_sort_greater(squares), (std::array<int, 10> {{ 4, 4, 4, 2, 2, 1, 1, 1, 0, 0 }})), "");
+
+    // stable
+    static_assert(same(capo::array_sort_if(squares, by_parity {}), (std::array<int, 10> {{ 0, 4, 2, 2, 4, 0, 4, 1, 1, 1 }})), "");
+
+    static_assert(same(capo::array_assign<3>(7), (std::array<int, 3> {{ 7, 7, 7 }})), "");
+    static_assert(same(capo::array_link(capo::array_assign<2>(1), capo::array_assign<1>(2)), (std::array<int, 3> {{ 1, 1, 2 }})), "");
+    static_assert(same(capo::array_insert<1>(capo::array_assign<2>(0), -1), (std::array<int, 3> {{ 0, -1, 0 }})), "");
+    static_assert(same(capo::array_erase<1, 8>(squares), (std::array<int, 2> {{ 0, 4 }})), "");
+    static_assert(capo::array_find(squares, 2) == 3, "");
+    static_assert(capo::array_find(squares, 3) == -1, "");
+    static_assert(capo::array_exist(squares, 4), "");
+    static_assert(capo::array_count(squares, 4) == 3, "");
+    static_assert(capo::array_distinct(squares) == 4, "");
+    static_assert(std::get<2>(capo::array_foreach(squares, add_one)) == 5, "");
+    static_assert(same(capo::array_replace(squares, 4, 3), (std::array<int, 10> {{ 0, 1, 3, 2, 2, 3, 1, 0, 1, 3 }})), "");
+    static_assert(same(capo::array_remove<10 - capo::array_count(squares, 1)>(squares, 1), (std::array<int, 7> {{ 0, 4, 2, 2, 4, 0, 4 }})), "");
+    static_assert(same(capo::array_compact<capo::array_distinct(squares)>(squares), (std::array<int, 4> {{ 0, 1, 4, 2 }})), "");
+    static_assert(std::get<0>(capo::array_reverse(capo::array_link(sorted, capo::array_assign<1>(9)))) == 9, "");
+    EXPECT_THROW(capo::array_remove<8>(squares, 1), std::invalid_argument);
+
+    // to & from the constant arrays
+    using arr = constant_array::from_array<10, sorted>;
+    EXPECT_EQ((capo::type_name<constant_array::type<0, 0, 1, 1, 1, 2, 2, 4, 4, 4>>()), capo::type_name<arr>());
+    EXPECT_EQ((capo::type_name<constant_array::sort_less<constant_array::from_array<10, squares>>>()), capo::type_name<arr>());
+    constexpr auto back = constant_array::to_array<constant_array::reverse<arr>>();
+    static_assert(same(back, capo::array_reverse(sorted)), "");
+    for (size_t i = 0; i < sorted.size(); ++i)
+    {
+        EXPECT_EQ(sorted[i], arr::value[i]) << "At index: " << i;
+    }
+}
@@ -5,10 +5,33 @@
 #include "capo/countof.hpp"
 
 #include <iostream>
+#include <array>
+#include <cstddef>
 
 namespace ut_constant_array_ {
 
 template <int N>
 struct make_bigger : std::integral_constant<int, (N + 1)> {};
 
+/* The operator== of std::array is not constexpr before C++20 */
+template <typename T, size_t N>
+constexpr bool same(const std::array<T, N>& a, const std::array<T, N>& b)
+{
+    for (size_t i = 0; i < N; ++i)
+        if (a[i] != b[i]) return false;
+    return true;
+}
+
+constexpr int square_mod7(size_t i) { return static_cast<int>(i * i % 7); }
+
+constexpr int add_one(int n) { return n + 1; }
+
+struct by_parity
+{
+    constexpr bool operator()(int x, int y) const { return (x % 2) < (y % 2); }
+};
+
+static constexpr std::array<int, 10> squares = capo::make_array<10>(square_mod7);   // 0 1 4 2 2 4 1 0 1 4
+static constexpr std::array<int, 10> sorted  = capo::array_sort_less(squares);
+
 } // namespace ut_constant_array_
\ No newline at end of file
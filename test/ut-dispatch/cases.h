@@ -0,0 +1,119 @@
+#pragma once
+
+TEST_METHOD(dispatch)
+{
+    using namespace ut_dispatch_;
+
+    std::vector<std::string> names;
+    for (size_t i = 0; i < 3; ++i)
+    {
+        capo::dispatch<capo::types<int, double, std::string>>(i, [&](auto tag)
+        {
+            names.push_back(capo::type_name<typename decltype(tag)::type>());
+        });
+    }
+    ASSERT_EQ(3u, names.size());
+    EXPECT_EQ(capo::type_name<int>()        , names[0]);
+    EXPECT_EQ(capo::type_name<double>()     , names[1]);
+    EXPECT_EQ(capo::type_name<std::string>(), names[2]);
+
+    // The return values & the arguments
+    auto size_of = [](auto tag, size_t n) { return sizeof(typename decltype(tag)::type) * n; };
+    EXPECT_EQ(sizeof(char)  * 3, (capo::dispatch<capo::types<char, short, long>>(0, size_of, 3)));
+    EXPECT_EQ(sizeof(short) * 3, (capo::dispatch<capo::types<char, short, long>>(1, size_of, 3)));
+    EXPECT_EQ(sizeof(long)  * 3, (capo::dispatch<capo::types<char, short, long>>(2, size_of, 3)));
+
+    // The references are forwarded
+    int x = 0;
+    capo::dispatch<capo::types<int>>(0, [](auto, int& r) { r = 42; }, x);
+    EXPECT_EQ(42, x);
+    std::unique_ptr<int> p { new int(1) };
+    auto q = capo::dispatch<capo::types<void>>(0, [](auto, std::unique_ptr<int>&& r) { return std::move(r); }, std::move(p));
+    EXPECT_EQ(nullptr, p);
+    EXPECT_EQ(1, *q);
+
+    // An overloaded visitor
+    circle c { 1 };
+    rect   r { 2, 3 };
+    tri    t { 4, 5 };
+    const void* objs[] = { &c, &r, &t };
+    EXPECT_EQ(3 , capo::dispatch<shapes>(0, area {}, objs[0]));
+    EXPECT_EQ(6 , capo::dispatch<shapes>(1, area {}, objs[1]));
+    EXPECT_EQ(10, capo::dispatch<shapes>(2, area {}, objs[2]));
+}
+
+TEST_METHOD(multi_dispatch)
+{
+    using namespace ut_dispatch_;
+
+    using list1 = capo::types<char, short, int>;
+    using list2 = capo::types<float, double>;
+    for (size_t i = 0; i < 3; ++i)
+    for (size_t j = 0; j < 2; ++j)
+    {
+        auto names = capo::multi_dispatch<list1, list2>(i, j, [](auto t1, auto t2, const std::string& sep)
+        {
+            return capo::type_name<typename decltype(t1)::type>() + sep +
+                   capo::type_name<typename decltype(t2)::type>();
+        }, "/");
+        std::string expect;
+        capo::dispatch<list1>(i, [&](auto t1)
+        {
+            capo::dispatch<list2>(j, [&](auto t2)
+            {
+                expect = capo::type_name<typename decltype(t1)::type>() + "/" +
+                         capo::type_name<typename decltype(t2)::type>();
+            });
+        });
+        EXPECT_EQ(expect, names) << "At: " << i << ", " << j;
+    }
+
+    // e.g. the collisions of the shapes
+    auto collide = [](auto t1, auto t2)
+    {
+        return std::is_same<typename decltype(t1)::type, typename decltype(t2)::type>::value ? 1 : 0;
+    };
+    int n = 0;
+    for (size_t i = 0; i < 3; ++i)
+    for (size_t j = 0; j < 3; ++j) n += capo::multi_dispatch<shapes, shapes>(i, j, collide);
+    EXPECT_EQ(3, n);
+}
+
+TEST_METHOD(benchmark)
+{
+    using namespace ut_dispatch_;
+
+    const size_t n = 4096;
+    capo::random<> rdm { 0, 7 };
+    std::vector<size_t> tags(n);
+    for (auto& t : tags) t = static_cast<size_t>(rdm());
+
+    std::unique_ptr<base> objs[] =
+    {
+        std::unique_ptr<base> { new derived<0> }, std::unique_ptr<base> { new derived<1> },
+        std::unique_ptr<base> { new derived<2> }, std::unique_ptr<base> { new derived<3> },
+        std::unique_ptr<base> { new derived<4> }, std::unique_ptr<base> { new derived<5> },
+        std::unique_ptr<base> { new derived<6> }, std::unique_ptr<base> { new derived<7> }
+    };
+    capo::bench b;
+    b.samples(5);
+
+    b.run("8 random tags/if-else chain", [&]
+    {
+        uint32_t r = 0;
+        for (size_t t : tags) r = if_else(t, r);
+        capo::do_not_optimize(r);
+    });
+    b.run("8 random tags/virtual call", [&]
+    {
+        uint32_t r = 0;
+        for (size_t t : tags) r = objs[t]->exec(r);
+        capo::do_not_optimize(r);
+    });
+    b.run("8 random tags/capo::dispatch", [&]
+    {
+        uint32_t r = 0;
+        for (size_t t : tags) r = capo::dispatch<works>(t, [](auto tag, uint32_t x) { return decltype(tag)::type::exec(x); }, r);
+        capo::do_not_optimize(r);
+    });
+}
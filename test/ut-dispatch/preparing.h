@@ -0,0 +1,70 @@
+#pragma once
+
+#include "capo/dispatch.hpp"
+#include "capo/type_name.hpp"
+#include "capo/random.hpp"
+#include "capo/bench.hpp"
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <utility>
+#include <cstddef>
+#include <cstdint>
+
+namespace ut_dispatch_ {
+
+/* Some shapes with a runtime tag */
+
+struct circle { double r_; };
+struct rect   { double w_, h_; };
+struct tri    { double b_, h_; };
+
+using shapes = capo::types<circle, rect, tri>;
+
+struct area
+{
+    double operator()(capo::type_tag<circle>, const void* p) const { auto s = static_cast<const circle*>(p); return 3 * s->r_ * s->r_; }
+    double operator()(capo::type_tag<rect>  , const void* p) const { auto s = static_cast<const rect*  >(p); return s->w_ * s->h_;     }
+    double operator()(capo::type_tag<tri>   , const void* p) const { auto s = static_cast<const tri*   >(p); return s->b_ * s->h_ / 2; }
+};
+
+/* For the benchmark, 8 kinds of the work (unsigned, which wraps instead of overflowing) */
+
+template <int N> struct work;
+template <> struct work<0> { static uint32_t exec(uint32_t x) { return x + 1;             } };
+template <> struct work<1> { static uint32_t exec(uint32_t x) { return x * 3;             } };
+template <> struct work<2> { static uint32_t exec(uint32_t x) { return x ^ 0x5a5a;        } };
+template <> struct work<3> { static uint32_t exec(uint32_t x) { return (x >> 1) + 7;      } };
+template <> struct work<4> { static uint32_t exec(uint32_t x) { return x - (x >> 3);      } };
+template <> struct work<5> { static uint32_t exec(uint32_t x) { return x * x + 1;         } };
+template <> struct work<6> { static uint32_t exec(uint32_t x) { return (x << 2) ^ (x >> 5); } };
+template <> struct work<7> { static uint32_t exec(uint32_t x) { return ~x;                } };
+
+using works = capo::types<work<0>, work<1>, work<2>, work<3>, work<4>, work<5>, work<6>, work<7>>;
+
+struct base
+{
+    virtual ~base() {}
+    virtual uint32_t exec(uint32_t x) const = 0;
+};
+
+template <int N>
+struct derived : base
+{
+    uint32_t exec(uint32_t x) const override { return work<N>::exec(x); }
+};
+
+inline uint32_t if_else(size_t i, uint32_t x)
+{
+    if      (i == 0) return work<0>::exec(x);
+    else if (i == 1) return work<1>::exec(x);
+    else if (i == 2) return work<2>::exec(x);
+    else if (i == 3) return work<3>::exec(x);
+    else if (i == 4) return work<4>::exec(x);
+    else if (i == 5) return work<5>::exec(x);
+    else if (i == 6) return work<6>::exec(x);
+    else             return work<7>::exec(x);
+}
+
+} // namespace ut_dispatch_
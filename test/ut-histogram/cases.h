@@ -0,0 +1,180 @@
+#pragma once
+
+TEST_METHOD(buckets)
+{
+    using namespace ut_histogram_;
+    using h_t = capo::histogram<>;
+    EXPECT_EQ(0u, h_t::index_of(0));
+    EXPECT_EQ(h_t::bucket_count - 1, h_t::index_of(~uint64_t(0)));
+    for (size_t i = 1; i < h_t::bucket_count; ++i)
+    {
+        ASSERT_EQ(h_t::upper_of(i - 1) + 1, h_t::lower_of(i));
+        ASSERT_EQ(i, h_t::index_of(h_t::lower_of(i)));
+        ASSERT_EQ(i, h_t::index_of(h_t::upper_of(i)));
+    }
+    rand_t rdm { 0, ~uint64_t(0) };
+    for (int i = 0; i < 100000; ++i)
+    {
+        uint64_t v = rdm() >> (i % 64);
+        size_t   x = h_t::index_of(v);
+        ASSERT_LE(h_t::lower_of(x), v);
+        ASSERT_GE(h_t::upper_of(x), v);
+        ASSERT_LE(double(h_t::upper_of(x) - h_t::lower_of(x)), double(v) / 64 + 1);
+    }
+}
+
+TEST_METHOD(percentile)
+{
+    using namespace ut_histogram_;
+    capo::histogram<> h;
+    EXPECT_EQ(0u, h.percentile(50));
+
+    rand_t rdm { 100, 10000000 };
+    std::vector<uint64_t> vals;
+    for (int i = 0; i < 100000; ++i)
+    {
+        vals.push_back(rdm());
+        h.record(vals.back());
+    }
+    std::sort(vals.begin(), vals.end());
+    EXPECT_EQ(vals.size(), h.count());
+    EXPECT_EQ(vals.front(), h.min());
+    EXPECT_EQ(vals.back() , h.max());
+    EXPECT_EQ(vals.front(), h.percentile(0));
+    EXPECT_EQ(vals.back() , h.percentile(100));
+    for (double p : { 1.0, 10.0, 50.0, 90.0, 99.0, 99.9, 99.99 })
+    {
+        double v = double(exact(vals, p));
+        EXPECT_NEAR(v, double(h.percentile(p)), v / 64) << p;
+    }
+    double sum = 0;
+    for (auto v : vals) sum += double(v);
+    EXPECT_NEAR(sum / vals.size(), h.mean(), 1.0);
+
+    h.clear();
+    EXPECT_EQ(0u, h.count());
+    h.record(std::chrono::microseconds(3));
+    EXPECT_EQ(3000u, h.min());
+    EXPECT_EQ(3000u, h.median());
+}
+
+TEST_METHOD(merge)
+{
+    capo::histogram<> a, b, c;
+    for (uint64_t i = 1; i <= 1000; ++i)
+    {
+        a.record(i);
+        b.record(i * 1000);
+        c.record(i);
+        c.record(i * 1000);
+    }
+    a += b;
+    EXPECT_EQ(c.count(), a.count());
+    EXPECT_EQ(c.min(), a.min());
+    EXPECT_EQ(c.max(), a.max());
+    EXPECT_EQ(c.percentile(75), a.percentile(75));
+    EXPECT_DOUBLE_EQ(c.mean(), a.mean());
+
+    std::string buf = a.encode();
+    capo::output("encoded: {0} bytes\n", buf.size());
+    capo::histogram<> d;
+    EXPECT_TRUE(d.decode(buf));
+    EXPECT_EQ(a.count(), d.count());
+    EXPECT_EQ(a.min(), d.min());
+    EXPECT_EQ(a.max(), d.max());
+    for (double p : { 10.0, 50.0, 90.0, 99.0 })
+        EXPECT_EQ(a.percentile(p), d.percentile(p)) << p;
+    EXPECT_FALSE(d.decode(buf.data(), buf.size() - 1));
+    EXPECT_FALSE(capo::histogram<5>{}.decode(buf));
+}
+
+TEST_METHOD(concurrent)
+{
+    capo::concurrent_histogram<> h;
+    const int thread_count = 4, count = 100000;
+    for (int round = 0; round < 2; ++round) // the second round reuses the shards
+    {
+        std::vector<std::thread> ths;
+        for (int t = 0; t < thread_count; ++t)
+        {
+            ths.emplace_back([&h, t, count]
+            {
+                for (int i = 1; i <= count; ++i) h.record(uint64_t(i * (t + 1)));
+            });
+        }
+        for (auto& th : ths) th.join();
+    }
+    auto s = h.snapshot();
+    EXPECT_EQ(uint64_t(2 * thread_count * count), s.count());
+    EXPECT_EQ(1u, s.min());
+    EXPECT_EQ(uint64_t(count * thread_count), s.max());
+}
+
+TEST_METHOD(out_of_tls_keys)
+{
+    // Uses up the thread-local keys, then the histogram records into a shared shard
+    std::vector<std::unique_ptr<capo::thread_local_ptr<int>>> keys;
+    for (int i = 0; i < 100000; ++i)
+    {
+        keys.emplace_back(new capo::thread_local_ptr<int>);
+        if (!keys.back()->valid()) break;
+    }
+    ASSERT_FALSE(keys.back()->valid());
+    {
+        capo::concurrent_histogram<> h;
+        const int thread_count = 4, count = 10000;
+        std::vector<std::thread> ths;
+        for (int t = 0; t < thread_count; ++t)
+        {
+            ths.emplace_back([&h, count]
+            {
+                for (int i = 1; i <= count; ++i) h.record(uint64_t(i));
+            });
+        }
+        for (auto& th : ths) th.join();
+        auto s = h.snapshot();
+        EXPECT_EQ(uint64_t(thread_count * count), s.count());
+        EXPECT_EQ(uint64_t(count), s.max());
+    }
+    keys.clear();
+    capo::thread_local_ptr<int> p;
+    EXPECT_TRUE(p.valid());
+}
+
+TEST_METHOD(record_scope)
+{
+    capo::histogram<> h;
+    for (int i = 0; i < 3; ++i)
+    {
+        CAPO_HISTOGRAM_SCOPE_(h);
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    {
+        auto guard = capo::record_scope<capo::tsc_clock<>>(h);
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    EXPECT_EQ(4u, h.count());
+    EXPECT_LE(10000000u, h.min());
+    capo::output("scope p50: {0} us\n", h.median() / 1000.0);
+}
+
+TEST_METHOD(benchmark)
+{
+    using namespace ut_histogram_;
+    capo::histogram<> h;
+    capo::concurrent_histogram<> ch;
+    std::vector<uint64_t> vals(1024);
+    rand_t rdm { 0, 1000000000 };
+    for (auto& v : vals) v = rdm();
+    size_t i = 0;
+    capo::bench b;
+    b.run("histogram::record", [&]
+    {
+        h.record(vals[++i & 1023]);
+        capo::do_not_optimize(&h);
+    });
+    b.run("concurrent_histogram::record", [&] { ch.record(vals[++i & 1023]); });
+    b.run("concurrent_histogram::snapshot", [&] { capo::do_not_optimize(ch.snapshot().count()); });
+    b.run_threads("concurrent_histogram::record", { 1, 2, 4 }, [&](size_t t) { ch.record(vals[t]); });
+    EXPECT_LT(0u, h.count());
+}
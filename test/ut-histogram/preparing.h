@@ -0,0 +1,30 @@
+#pragma once
+
+#include "capo/histogram.hpp"
+#include "capo/clock.hpp"
+#include "capo/bench.hpp"
+#include "capo/random.hpp"
+#include "capo/output.hpp"
+
+#include <vector>
+#include <memory>
+#include <thread>
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <cmath>
+
+namespace ut_histogram_ {
+
+using rand_t = capo::random<std::mt19937_64, std::uniform_int_distribution<uint64_t>>;
+
+/*
+    Exact percentile of a sorted vector, the same rank rule as histogram::percentile.
+*/
+inline uint64_t exact(const std::vector<uint64_t>& sorted, double p)
+{
+    auto rank = static_cast<size_t>(std::ceil(p / 100 * sorted.size()));
+    return sorted[(rank == 0) ? 0 : rank - 1];
+}
+
+} // namespace ut_histogram_
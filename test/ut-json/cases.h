@@ -0,0 +1,188 @@
+#pragma once
+
+TEST_METHOD(writer)
+{
+    using namespace ut_json_;
+    std::string str;
+    {
+        capo::json_writer<std::string&> w { str };
+        w.begin_object()
+            .member("null", nullptr)
+            .member("bool", true)
+            .member("int", -123)
+            .member("uint", 18446744073709551615ull)
+            .member("double", 0.1)
+            .member("nan", std::numeric_limits<double>::quiet_NaN())
+            .member("str", "a\"b\\c\n")
+            .member("vec", std::vector<int> { 1, 2, 3 })
+            .member("point", point { 1, 2 })
+            .key("empty").begin_array().end_array()
+         .end_object();
+        EXPECT_EQ(size_t(0), w.depth());
+    }
+    EXPECT_STREQ("{\"null\":null,\"bool\":true,\"int\":-123,\"uint\":18446744073709551615,"
+                 "\"double\":0.1,\"nan\":null,\"str\":\"a\\\"b\\\\c\\n\",\"vec\":[1,2,3],"
+                 "\"point\":{\"x\":1,\"y\":2},\"empty\":[]}", str.c_str());
+
+    // runtime nesting checks
+    capo::json_writer<std::string&> w { str };
+    w.begin_object();
+    EXPECT_THROW(w.value(1), std::invalid_argument);
+    EXPECT_THROW(w.end_array(), std::invalid_argument);
+    w.key("a");
+    EXPECT_THROW(w.key("b"), std::invalid_argument);
+    EXPECT_THROW(w.end_object(), std::invalid_argument);
+}
+
+TEST_METHOD(scope)
+{
+    using namespace ut_json_;
+    std::string str;
+    {
+        capo::json_writer<std::string&> w { str };
+        auto arr = capo::json(w).object()
+                                    .member("id", 7)
+                                    .key("list").array();
+        for (int i = 0; i < 3; ++i) arr.object().member("i", i).end();
+        arr.end()
+           .key("name").value("capo")
+           .key("sub").object().end()
+        .end();
+    }
+    EXPECT_STREQ("{\"id\":7,\"list\":[{\"i\":0},{\"i\":1},{\"i\":2}],\"name\":\"capo\",\"sub\":{}}", str.c_str());
+
+    // the misuses do not compile
+    capo::json_writer<std::string&> w { str };
+    using root_t   = decltype(capo::json(w));
+    using object_t = decltype(capo::json(w).object());
+    using key_t    = decltype(capo::json(w).object().key("k"));
+    using array_t  = decltype(capo::json(w).array());
+    EXPECT_TRUE (can_value<root_t  >::value);
+    EXPECT_FALSE(can_key  <root_t  >::value);
+    EXPECT_FALSE(can_end  <root_t  >::value);
+    EXPECT_FALSE(can_value<object_t>::value);
+    EXPECT_TRUE (can_key  <object_t>::value);
+    EXPECT_TRUE (can_end  <object_t>::value);
+    EXPECT_TRUE (can_value<key_t   >::value);
+    EXPECT_FALSE(can_key  <key_t   >::value);
+    EXPECT_FALSE(can_end  <key_t   >::value);
+    EXPECT_TRUE (can_value<array_t >::value);
+    EXPECT_FALSE(can_key  <array_t >::value);
+    EXPECT_TRUE (can_end  <array_t >::value);
+}
+
+TEST_METHOD(escape)
+{
+    using namespace ut_json_;
+    capo::random<> rdm { 0, 255 };
+    for (int n = 0; n < 2000; ++n)
+    {
+        std::string s(static_cast<size_t>(n % 80), ' ');
+        for (auto& c : s)
+        {
+            int r = rdm();
+            c = (r < 200) ? static_cast<char>('a' + r % 26) : static_cast<char>(r - 200); // some controls
+            if (r == 199) c = '"';
+            if (r == 198) c = '\\';
+            if (r == 197) c = static_cast<char>(0xe4); // utf-8 bytes pass through
+        }
+        std::string out;
+        capo::detail_json::write_escaped(out, s.data(), s.size());
+        ASSERT_STREQ(escape(s).c_str(), out.c_str());
+    }
+}
+
+TEST_METHOD(incremental)
+{
+    using namespace ut_json_;
+    const int LoopN = 10000;
+    std::string expect;
+    {
+        capo::json_writer<std::string&> w { expect };
+        w.begin_array();
+        for (int i = 0; i < LoopN; ++i) w.value("element\t" + std::to_string(i));
+        w.end_array();
+    }
+
+    // closure: every chunk is bounded
+    std::string chunks;
+    size_t max_chunk = 0, count = 0;
+    {
+        capo::json_writer<std::function<void(std::string&&)>> w
+        {
+            [&](std::string&& s) { max_chunk = (std::max)(max_chunk, s.size()); chunks += s; ++count; }, 256
+        };
+        w.begin_array();
+        for (int i = 0; i < LoopN; ++i) w.value("element\t" + std::to_string(i));
+        w.end_array();
+    }
+    EXPECT_EQ(expect, chunks);
+    EXPECT_LT(size_t(100), count);
+    EXPECT_GT(size_t(256 + 64), max_chunk);
+
+    // mem_file
+    capo::mem_file mf;
+    {
+        capo::json_writer<capo::mem_file&> w { mf, 512 };
+        w.begin_array();
+        for (int i = 0; i < LoopN; ++i) w.value("element\t" + std::to_string(i));
+        w.end_array();
+    }
+    capo::file::buf_type rd(static_cast<size_t>(mf.size()));
+    mf.seek(0, std::ios_base::beg);
+    mf.read(&rd);
+    EXPECT_EQ(expect, std::string(rd.begin(), rd.end()));
+
+    // ostream
+    std::ostringstream ss;
+    {
+        capo::json_writer<std::ostream&> w { ss, 128 };
+        w.begin_array();
+        for (int i = 0; i < LoopN; ++i) w.value("element\t" + std::to_string(i));
+        w.end_array();
+    }
+    EXPECT_EQ(expect, ss.str());
+
+    // fixed_buffer
+    char buf[64];
+    capo::fixed_buffer fb { buf };
+    {
+        capo::json_writer<capo::fixed_buffer&> w { fb, 16 };
+        w.begin_array().value(1).value("two").value(3.5).end_array();
+    }
+    EXPECT_STREQ("[1,\"two\",3.5]", fb.c_str());
+}
+
+TEST_METHOD(benchmark)
+{
+    std::string text(1000, 'x');
+    text[500] = '\n';
+    size_t total = 0, count = 0;
+    int i = 0;
+    capo::bench b;
+    {
+        capo::json_writer<std::function<void(std::string&&)>> w
+        {
+            [&](std::string&& s) { total += s.size(); }
+        };
+        w.begin_array();
+        auto& r = b.run("json_writer", [&]
+        {
+            ++i;
+            w.begin_object().member("id", i).member("value", i * 0.5).member("text", text).end_object();
+            ++count;
+        });
+        w.end_array();
+        w.flush();
+        capo::output("json_writer: \t{0} MB/s\n", double(total) / count * 1000.0 / r.stats_.median_);
+    }
+    std::string out;
+    b.run("concatenate", [&]
+    {
+        ++i;
+        out.clear();
+        out += "{\"id\":" + std::to_string(i) + ",\"value\":" + std::to_string(i * 0.5) + ",\"text\":\"";
+        for (char c : text) { if (c == '\n') out += "\\n"; else out += c; }
+        out += "\"}";
+    });
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "capo/json.hpp"
+#include "capo/file.hpp"
+#include "capo/output.hpp"
+#include "capo/bench.hpp"
+#include "capo/random.hpp"
+
+#include <string>
+#include <vector>
+#include <sstream>
+#include <limits>
+#include <functional>
+#include <algorithm>
+#include <cstdio>
+
+namespace ut_json_ {
+
+struct point
+{
+    int x_, y_;
+
+    template <typename F>
+    void operator()(capo::json_writer<F>& w) const
+    {
+        w.begin_object().member("x", x_).member("y", y_).end_object();
+    }
+};
+
+/*
+    The reference implementation of escaping, without SIMD.
+*/
+std::string escape(const std::string& s)
+{
+    std::string r = "\"";
+    for (unsigned char c : s)
+    {
+        switch (c)
+        {
+        case '"' : r += "\\\""; break;
+        case '\\': r += "\\\\"; break;
+        case '\b': r += "\\b" ; break;
+        case '\f': r += "\\f" ; break;
+        case '\n': r += "\\n" ; break;
+        case '\r': r += "\\r" ; break;
+        case '\t': r += "\\t" ; break;
+        default:
+            if (c < 0x20)
+            {
+                char buf[8];
+                std::snprintf(buf, sizeof(buf), "\\u%04x", c);
+                r += buf;
+            }
+            else r += static_cast<char>(c);
+        }
+    }
+    return r + "\"";
+}
+
+CAPO_CONCEPT_TYPING_(can_value, std::declval<T&>().value(1));
+CAPO_CONCEPT_TYPING_(can_key  , std::declval<T&>().key("k"));
+CAPO_CONCEPT_TYPING_(can_end  , std::declval<T&>().end());
+
+} // namespace ut_json_
@@ -0,0 +1,278 @@
+#pragma once
+
+TEST_METHOD(basic)
+{
+    using namespace ut_logger_;
+    const char* path = "ut-logger-basic.log";
+    std::remove(path);
+    {
+        capo::logger<> lg { path };
+        EXPECT_TRUE(lg.valid());
+        std::string name = "capo";
+        lg.info ("Hello, %s! %d %.2f %c", name, 123, 3.14159, 'x');
+        lg.warn ("%s|%s|%p", "literal", (const char*)nullptr, (void*)0x1234);
+        lg.error("%d %d", 1); // mismatched arguments are reported by the background thread
+        lg.set_level(capo::log_level::error);
+        lg.warn ("filtered at runtime");
+        lg.flush();
+        EXPECT_EQ(size_t(3), lg.written());
+    }
+    auto lines = read_lines(path);
+    ASSERT_EQ(size_t(3), lines.size());
+    EXPECT_NE(std::string::npos, lines[0].find(" INFO  [0] "));
+    EXPECT_STREQ("Hello, capo! 123 3.14 x", message(lines[0]).c_str());
+    EXPECT_STREQ("literal||0x1234", message(lines[1]).c_str());
+    EXPECT_EQ(0u, message(lines[2]).find("<bad format: "));
+    std::remove(path);
+}
+
+TEST_METHOD(compile_time_level)
+{
+    using namespace ut_logger_;
+    const char* path = "ut-logger-level.log";
+    std::remove(path);
+    {
+        capo::logger<> lg { path };
+        evaluated = 0;
+        CAPO_LOG_(lg, trace, "%d", touch()); // compiled out
+        CAPO_LOG_(lg, debug, "%d", touch());
+        lg.trace("%d", 0);                   // compiled out too
+        lg.flush();
+        EXPECT_EQ(1, evaluated);
+        EXPECT_EQ(size_t(1), lg.written());
+    }
+    auto lines = read_lines(path);
+    ASSERT_EQ(size_t(1), lines.size());
+    EXPECT_STREQ("1", message(lines[0]).c_str());
+    std::remove(path);
+}
+
+TEST_METHOD(multi_thread)
+{
+    using namespace ut_logger_;
+    const char* path = "ut-logger-mt.log";
+    std::remove(path);
+    const int ThreadN = 4, LoopN = 20000;
+    {
+        capo::logger<capo::use::log_block> lg { path, 0, 0, 4096 };
+        std::vector<std::thread> ths;
+        for (int t = 0; t < ThreadN; ++t)
+            ths.emplace_back([&lg, t]
+            {
+                for (int i = 0; i < LoopN; ++i) lg.info("%d %d %s", t, i, "padding padding padding");
+            });
+        for (auto& th : ths) th.join();
+        lg.flush();
+        EXPECT_EQ(size_t(ThreadN * LoopN), lg.written());
+        EXPECT_EQ(size_t(0), lg.dropped());
+    }
+    auto lines = read_lines(path);
+    ASSERT_EQ(size_t(ThreadN * LoopN), lines.size());
+    // the records of each thread keep their order
+    int next[ThreadN] = {};
+    for (auto& line : lines)
+    {
+        int t = -1, i = -1;
+        std::sscanf(message(line).c_str(), "%d %d", &t, &i);
+        ASSERT_TRUE(t >= 0 && t < ThreadN);
+        ASSERT_EQ(next[t], i);
+        ++next[t];
+    }
+    std::remove(path);
+}
+
+TEST_METHOD(out_of_tls_keys)
+{
+    using namespace ut_logger_;
+    const char* path = "ut-logger-keys.log";
+    std::remove(path);
+    const int ThreadN = 4, LoopN = 5000;
+    // uses up the thread-local keys, then all threads write into a shared ring
+    std::vector<std::unique_ptr<capo::thread_local_ptr<int>>> keys;
+    for (int i = 0; i < 100000; ++i)
+    {
+        keys.emplace_back(new capo::thread_local_ptr<int>);
+        if (!keys.back()->valid()) break;
+    }
+    ASSERT_FALSE(keys.back()->valid());
+    {
+        capo::logger<capo::use::log_block> lg { path, 0, 0, 4096 };
+        keys.clear();
+        std::vector<std::thread> ths;
+        for (int t = 0; t < ThreadN; ++t)
+            ths.emplace_back([&lg, t]
+            {
+                for (int i = 0; i < LoopN; ++i) lg.info("%d %d", t, i);
+            });
+        for (auto& th : ths) th.join();
+        lg.flush();
+        EXPECT_EQ(size_t(ThreadN * LoopN), lg.written());
+    }
+    auto lines = read_lines(path);
+    ASSERT_EQ(size_t(ThreadN * LoopN), lines.size());
+    int next[ThreadN] = {};
+    for (auto& line : lines)
+    {
+        EXPECT_NE(std::string::npos, line.find(" [0] "));
+        int t = -1, i = -1;
+        std::sscanf(message(line).c_str(), "%d %d", &t, &i);
+        ASSERT_TRUE(t >= 0 && t < ThreadN);
+        ASSERT_EQ(next[t]++, i);
+    }
+    std::remove(path);
+}
+
+TEST_METHOD(drop_policy)
+{
+    using namespace ut_logger_;
+    const char* path = "ut-logger-drop.log";
+    std::remove(path);
+    const int LoopN = 100000;
+    size_t ok = 0;
+    {
+        capo::logger<capo::use::log_drop> lg { path, 0, 0, 4096 };
+        for (int i = 0; i < LoopN; ++i)
+            if (lg.info("%d", i)) ++ok;
+        lg.flush();
+        EXPECT_EQ(size_t(LoopN), ok + lg.dropped());
+        EXPECT_EQ(ok, lg.written());
+    }
+    EXPECT_EQ(ok, read_lines(path).size());
+    std::remove(path);
+}
+
+TEST_METHOD(long_string)
+{
+    using namespace ut_logger_;
+    const char* path = "ut-logger-long.log";
+    std::remove(path);
+    {
+        capo::logger<> lg { path, 0, 0, 4096 };
+        lg.info("%d:%s:%d", 1, std::string(5000, 'x'), 2);
+    }
+    auto lines = read_lines(path);
+    ASSERT_EQ(size_t(1), lines.size());
+    std::string msg = message(lines[0]);
+    EXPECT_EQ(0u, msg.find("1:xxx"));
+    EXPECT_EQ(msg.size() - 2, msg.rfind(":2"));
+    EXPECT_LT(msg.size(), size_t(1024));
+    std::remove(path);
+}
+
+TEST_METHOD(wide_string)
+{
+    using namespace ut_logger_;
+    const char* path = "ut-logger-wide.log";
+    std::remove(path);
+    {
+        capo::logger<> lg { path };
+        wchar_t buf[] = L"stack";
+        // The wide strings are copied, the sources may be gone before being formatted
+        lg.info("%c%ls|%ls|%s|%ls", 'x', buf, std::wstring(L"temporary"), "narrow", (const wchar_t*)nullptr);
+        buf[0] = L'S';
+        lg.info("%ls", std::wstring(3000, L'w'));
+    }
+    auto lines = read_lines(path);
+    ASSERT_EQ(size_t(2), lines.size());
+    EXPECT_STREQ("xstack|temporary|narrow|", message(lines[0]).c_str());
+    std::string msg = message(lines[1]);
+    EXPECT_EQ(0u, msg.find("www"));
+    EXPECT_EQ(std::string::npos, msg.find_first_not_of('w'));
+    std::remove(path);
+}
+
+#if !defined(CAPO_OS_WIN_)
+TEST_METHOD(interrupted_write)
+{
+    using namespace ut_logger_;
+    // writes into a FIFO, while a timer signal (without SA_RESTART) keeps interrupting writev
+    const char* path = "ut-logger-fifo";
+    ::unlink(path);
+    ASSERT_EQ(0, ::mkfifo(path, 0600));
+    std::string data(1 << 20, 'x');
+    std::vector<capo::log_file::chunk> cks;
+    for (size_t i = 0; i < data.size(); i += 1000)
+        cks.push_back({ data.data() + i, (std::min)(size_t(1000), data.size() - i) });
+    size_t got = 0;
+    std::thread rd([&got, path]
+    {
+        sigset_t set;
+        sigemptyset(&set);
+        sigaddset(&set, SIGALRM);
+        pthread_sigmask(SIG_BLOCK, &set, nullptr);
+        int fd = ::open(path, O_RDONLY);
+        char buf[4096];
+        for (ssize_t r; (r = ::read(fd, buf, sizeof(buf))) != 0;)
+        {
+            if (r > 0) got += static_cast<size_t>(r);
+            else if (errno != EINTR) break;
+        }
+        ::close(fd);
+    });
+    {
+        capo::log_file f { path };
+        ASSERT_TRUE(f.valid());
+        struct sigaction sa {}, old {};
+        sa.sa_handler = &on_alarm;
+        sigaction(SIGALRM, &sa, &old);
+        itimerval tv { { 0, 50 }, { 0, 50 } }, off {};
+        setitimer(ITIMER_REAL, &tv, nullptr);
+        bool ok = true;
+        for (int i = 0; i < 8; ++i) ok = f.write(cks.data(), cks.size()) && ok;
+        setitimer(ITIMER_REAL, &off, nullptr);
+        sigaction(SIGALRM, &old, nullptr);
+        EXPECT_TRUE(ok);
+        EXPECT_EQ(data.size() * 8, f.size());
+    }
+    rd.join();
+    EXPECT_EQ(data.size() * 8, got);
+    ::unlink(path);
+}
+#endif/*!CAPO_OS_WIN_*/
+
+TEST_METHOD(rotation)
+{
+    using namespace ut_logger_;
+    const char* path = "ut-logger-rotate.log";
+    const char* olds[] = { "ut-logger-rotate.log.1", "ut-logger-rotate.log.2", "ut-logger-rotate.log.3" };
+    std::remove(path);
+    for (auto p : olds) std::remove(p);
+    {
+        capo::logger<capo::use::log_block> lg { path, 1024, 2 };
+        for (int i = 0; i < 200; ++i)
+        {
+            lg.info("%04d", i);
+            if (i % 10 == 0) lg.flush();
+        }
+    }
+    auto cur = read_lines(path);
+    auto ol1 = read_lines(olds[0]);
+    auto ol2 = read_lines(olds[1]);
+    EXPECT_TRUE(read_lines(olds[2]).empty());
+    ASSERT_FALSE(cur.empty());
+    ASSERT_FALSE(ol1.empty());
+    ASSERT_FALSE(ol2.empty());
+    EXPECT_STREQ("0199", message(cur.back()).c_str());
+    // the files are continuous
+    EXPECT_EQ(std::atoi(message(ol2.back()).c_str()) + 1, std::atoi(message(ol1.front()).c_str()));
+    EXPECT_EQ(std::atoi(message(ol1.back()).c_str()) + 1, std::atoi(message(cur.front()).c_str()));
+    std::remove(path);
+    for (auto p : olds) std::remove(p);
+}
+
+TEST_METHOD(latency)
+{
+    using namespace ut_logger_;
+    const char* path = "ut-logger-latency.log";
+    std::remove(path);
+    int i = 0;
+    {
+        capo::logger<capo::use::log_block> lg { path, 0, 0, 1024 * 1024 };
+        lg.info("warm up");
+        capo::bench b;
+        // 10 x 1000 records, all of them can be held by the ring
+        b.warmup(std::chrono::nanoseconds(0)).iterations(1000).samples(10);
+        b.run("logger::info", [&] { lg.info("%d, %s, %f", ++i, "hello", 3.14); });
+    }
+    std::remove(path);
+}
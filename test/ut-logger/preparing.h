@@ -0,0 +1,53 @@
+#pragma once
+
+#define CAPO_LOG_LEVEL_ 1 /* log_level::debug */
+
+#include "capo/logger.hpp"
+#include "capo/output.hpp"
+#include "capo/bench.hpp"
+
+#include <string>
+#include <vector>
+#include <thread>
+#include <memory>
+#include <fstream>
+#include <cstdio>
+#include <cstdlib>
+
+#if !defined(CAPO_OS_WIN_)
+#   include <fcntl.h>
+#   include <unistd.h>
+#   include <signal.h>
+#   include <pthread.h>
+#   include <sys/stat.h>
+#   include <sys/time.h>
+#   include <cerrno>
+#endif/*!CAPO_OS_WIN_*/
+
+namespace ut_logger_ {
+
+std::vector<std::string> read_lines(const char* path)
+{
+    std::vector<std::string> lines;
+    std::ifstream in(path);
+    for (std::string line; std::getline(in, line);) lines.push_back(line);
+    return lines;
+}
+
+/*
+    Returns the message part of a line: "date time level [tid] message".
+*/
+std::string message(const std::string& line)
+{
+    auto p = line.find("] ");
+    return (p == std::string::npos) ? "" : line.substr(p + 2);
+}
+
+#if !defined(CAPO_OS_WIN_)
+inline void on_alarm(int) {}
+#endif/*!CAPO_OS_WIN_*/
+
+int evaluated = 0;
+int touch(void) { return ++evaluated; }
+
+} // namespace ut_logger_
@@ -0,0 +1,86 @@
+#pragma once
+
+TEST_METHOD(crc32)
+{
+    using namespace ut_lookup_table_;
+
+    static_assert(crc32<>::value[0]   == 0x00000000u, "");
+    static_assert(crc32<>::value[1]   == 0x77073096u, "");
+    static_assert(crc32<>::value[255] == 0x2d02ef8du, "");
+
+    // The check values of the catalogue of CRC algorithms
+    EXPECT_EQ(0xcbf43926u, crc32<>::update(0, "123456789", 9));
+    EXPECT_EQ(0xe3069283u, crc32<0x82f63b78>::update(0, "123456789", 9)); // CRC-32C
+    EXPECT_EQ(0u, crc32<>::update(0, "", 0));
+
+    uint32_t crc = crc32<>::update(0, "12345", 5);
+    EXPECT_EQ(0xcbf43926u, crc32<>::update(crc, "6789", 4));
+}
+
+TEST_METHOD(popcount8)
+{
+    using namespace ut_lookup_table_;
+
+    static_assert(popcount8::value[0x00] == 0, "");
+    static_assert(popcount8::value[0xff] == 8, "");
+    for (unsigned i = 0; i < 256; ++i)
+    {
+        int n = 0;
+        for (unsigned v = i; v != 0; v &= v - 1) ++n;
+        EXPECT_EQ(n, popcount8::value[i]) << "At index: " << i;
+    }
+}
+
+TEST_METHOD(digits)
+{
+    using namespace ut_lookup_table_;
+
+    EXPECT_EQ(std::string("00010203040506070809"), std::string(digits::digits2.data(), 20));
+    EXPECT_EQ(std::string("9899"), std::string(digits::digits2.data() + 196, 4));
+    for (int i = 0; i < 100; ++i)
+    {
+        char buf[3] = {};
+        std::memcpy(buf, digits::digits2.data() + i * 2, 2);
+        EXPECT_EQ(i, std::stoi(buf));
+    }
+    EXPECT_EQ(std::string("0123456789abcdef"), std::string(digits::lower.data(), 16));
+    EXPECT_EQ(std::string("0123456789ABCDEF"), std::string(digits::upper.data(), 16));
+    for (int c = 0; c < 256; ++c)
+    {
+        const char* p = std::strchr("0123456789abcdefABCDEF", c);
+        int expect = ((c == 0) || (p == nullptr)) ? -1 : static_cast<int>(std::strtol(std::string(1, static_cast<char>(c)).c_str(), nullptr, 16));
+        EXPECT_EQ(expect, digits::value[c]) << "At char: " << c;
+    }
+}
+
+TEST_METHOD(base64)
+{
+    using namespace ut_lookup_table_;
+
+    static_assert(base64<>::encode[0] == 'A' && base64<>::encode[62] == '+' && base64<>::encode[63] == '/', "");
+    static_assert(base64<true>::encode[62] == '-' && base64<true>::encode[63] == '_', "");
+    static_assert(base64<>::decode['+'] == 62 && base64<>::decode['-'] == -1, "");
+    static_assert(base64<true>::decode['-'] == 62 && base64<true>::decode['='] == -1, "");
+
+    for (int i = 0; i < 64; ++i)
+    {
+        EXPECT_EQ(i, base64<>    ::decode[static_cast<uint8_t>(base64<>    ::encode[i])]);
+        EXPECT_EQ(i, base64<true>::decode[static_cast<uint8_t>(base64<true>::encode[i])]);
+    }
+
+    // RFC 4648, the test vectors
+    EXPECT_EQ("",         base64_encode<false>(""));
+    EXPECT_EQ("Zg==",     base64_encode<false>("f"));
+    EXPECT_EQ("Zm8=",     base64_encode<false>("fo"));
+    EXPECT_EQ("Zm9v",     base64_encode<false>("foo"));
+    EXPECT_EQ("Zm9vYg==", base64_encode<false>("foob"));
+    EXPECT_EQ("Zm9vYmE=", base64_encode<false>("fooba"));
+    EXPECT_EQ("Zm9vYmFy", base64_encode<false>("foobar"));
+    EXPECT_EQ("foobar",   base64_decode<false>("Zm9vYmFy"));
+    EXPECT_EQ("fooba",    base64_decode<false>("Zm9vYmE="));
+
+    std::string bin = "\xfb\xff\xbf";
+    EXPECT_EQ("+/+/", base64_encode<false>(bin));
+    EXPECT_EQ("-_-_", base64_encode<true >(bin));
+    EXPECT_EQ(bin,    base64_decode<true >("-_-_"));
+}
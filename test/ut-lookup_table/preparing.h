@@ -0,0 +1,59 @@
+#pragma once
+
+#include "capo/lookup_table.hpp"
+
+#include <string>
+#include <cstring>
+#include <cstddef>
+#include <cstdint>
+
+namespace ut_lookup_table_ {
+
+using capo::lookup_table::crc32;
+using capo::lookup_table::popcount8;
+using capo::lookup_table::digits;
+using capo::lookup_table::base64;
+
+template <bool UrlN>
+std::string base64_encode(const std::string& src)
+{
+    std::string ret;
+    size_t i = 0;
+    for (; i + 3 <= src.size(); i += 3)
+    {
+        uint32_t v = (static_cast<uint8_t>(src[i]) << 16) | (static_cast<uint8_t>(src[i + 1]) << 8) | static_cast<uint8_t>(src[i + 2]);
+        for (int k = 18; k >= 0; k -= 6) ret.push_back(base64<UrlN>::encode[(v >> k) & 0x3f]);
+    }
+    if (i < src.size())
+    {
+        uint32_t v = static_cast<uint8_t>(src[i]) << 16;
+        if (i + 1 < src.size()) v |= static_cast<uint8_t>(src[i + 1]) << 8;
+        ret.push_back(base64<UrlN>::encode[(v >> 18) & 0x3f]);
+        ret.push_back(base64<UrlN>::encode[(v >> 12) & 0x3f]);
+        ret.push_back((i + 1 < src.size()) ? base64<UrlN>::encode[(v >> 6) & 0x3f] : '=');
+        ret.push_back('=');
+    }
+    return ret;
+}
+
+template <bool UrlN>
+std::string base64_decode(const std::string& src)
+{
+    std::string ret;
+    uint32_t v = 0;
+    int bits = 0;
+    for (char c : src)
+    {
+        int8_t d = base64<UrlN>::decode[static_cast<uint8_t>(c)];
+        if (d < 0) break;
+        v = (v << 6) | static_cast<uint32_t>(d);
+        if ((bits += 6) >= 8)
+        {
+            bits -= 8;
+            ret.push_back(static_cast<char>((v >> bits) & 0xff));
+        }
+    }
+    return ret;
+}
+
+} // namespace ut_lookup_table_
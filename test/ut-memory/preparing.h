@@ -2,14 +2,13 @@
 
 #include "capo/output.hpp"
 #include "capo/random.hpp"
-#include "capo/stopwatch.hpp"
+#include "capo/bench.hpp"
 #include "capo/assert.hpp"
 #include "capo/unused.hpp"
 #include "capo/type_name.hpp"
 #include "capo/memory.hpp"
 
 #include <vector>
-#include <thread>
 #include <future>
 
 namespace ut_memory_ {
@@ -115,8 +114,6 @@ struct test_alloc<AllocT, capo::alloc_concept::RegionAlloc>
 template <class AllocT>
 size_t test_alloc<AllocT, capo::alloc_concept::RegionAlloc>::alloced_ = 0;
 
-volatile bool is_not_started;
-
 #define TEST_CYCLES__(C, A1, A2) do      \
 {                                        \
     CAPO_UNUSED_ AllocT alc;             \
@@ -146,7 +143,6 @@ void working_proc(size_t& alloced_size, const std::vector<int>* ix)
     static const size_t TEST_CYCL = (TestCycl / ThreadN / 2) - 1;
     void** ptrs = new void*[TestCont];
     memset(ptrs, 0, sizeof(void*) * TestCont);
-    while (is_not_started) std::this_thread::yield();
     TEST_CYCLES__(2, if (x == 0) alloced_size += s, 
                      if (x == 0) alloced_size -= s);
     for (size_t i = 0; i < TEST_CYCL; ++i)
@@ -162,21 +158,21 @@ template <typename AllocT, size_t ThreadN, size_t IndexN>
 void test_memory_pool(const char* name)
 {
     capo::output("{0} test: \t", name);
-    is_not_started = true;
 
-    struct {
-        size_t      alloced_size_ = 0;
-        std::thread working_ { &working_proc<test_alloc<AllocT>, ThreadN>, std::ref(alloced_size_), index[IndexN] };
-    } threads[ThreadN];
+    size_t alloced_sizes[ThreadN] = {};
+    capo::bench b;
+    b.verbose(false).warmup(std::chrono::nanoseconds(0)).iterations(1).samples(1);
+    b.run_threads(name, { ThreadN }, [&alloced_sizes](size_t t)
+    {
+        working_proc<test_alloc<AllocT>, ThreadN>(alloced_sizes[t], index[IndexN]);
+    });
+    auto& r = b.results().back();
 
-    is_not_started = false;
-    capo::stopwatch<> sw(true);
-    for (auto& t : threads) t.working_.join();
+    size_t alloced_size = 0;
+    for (size_t s : alloced_sizes) alloced_size += s;
 
-    auto value = sw.elapsed<std::chrono::milliseconds>();
+    auto value = static_cast<long long>(r.stats_.median_ / 1e6);
     size_t alloced_malc = test_alloc<AllocT>::alloced();
-    size_t alloced_size = 0;
-    for (auto& t : threads) alloced_size += t.alloced_size_;
     size_t fragment = alloced_malc ? alloced_malc - alloced_size : 0;
 
     capo::output("{0} ms, allocated: {1} bytes, Fragment: {2} bytes, {3:.2}%\n",
@@ -0,0 +1,162 @@
+#pragma once
+
+TEST_METHOD(exposition)
+{
+    capo::metrics_registry reg;
+    auto get  = reg.counter("http_requests_total", "Total requests.", { { "method", "get" } });
+    auto post = reg.counter("http_requests_total", "Total requests.", { { "method", "post" } });
+    auto temp = reg.gauge  ("temperature", "Current \\ temperature.");
+    auto lat  = reg.histogram("latency_seconds", "", { { "path", "/a\"b" } }, { 0.1, 0.5, 1 });
+
+    get.inc();
+    get.add(2);
+    post.inc();
+    temp.set(20.5);
+    temp.dec();
+    lat.observe(0.05);
+    lat.observe(0.1);
+    lat.observe(std::chrono::milliseconds(700));
+    lat.observe(3.0);
+
+    // the same (name, labels) is resolved into the same metric
+    reg.counter("http_requests_total", "", { { "method", "get" } }).inc();
+    EXPECT_EQ(19.5, temp.value());
+
+    EXPECT_EQ(
+        "# HELP http_requests_total Total requests.\n"
+        "# TYPE http_requests_total counter\n"
+        "http_requests_total{method=\"get\"} 4\n"
+        "http_requests_total{method=\"post\"} 1\n"
+        "# HELP temperature Current \\\\ temperature.\n"
+        "# TYPE temperature gauge\n"
+        "temperature 19.5\n"
+        "# TYPE latency_seconds histogram\n"
+        "latency_seconds_bucket{path=\"/a\\\"b\",le=\"0.1\"} 2\n"
+        "latency_seconds_bucket{path=\"/a\\\"b\",le=\"0.5\"} 2\n"
+        "latency_seconds_bucket{path=\"/a\\\"b\",le=\"1\"} 3\n"
+        "latency_seconds_bucket{path=\"/a\\\"b\",le=\"+Inf\"} 4\n"
+        "latency_seconds_sum{path=\"/a\\\"b\"} 3.85\n"
+        "latency_seconds_count{path=\"/a\\\"b\"} 4\n", reg.snapshot());
+
+    EXPECT_THROW(reg.gauge("http_requests_total"), std::invalid_argument);
+    EXPECT_THROW(reg.histogram("h", "", {}, { 1, 0.5 }), std::invalid_argument);
+    capo::metrics_registry small { 4 };
+    EXPECT_THROW(small.histogram("h", "", {}, { 1, 2, 3 }), std::invalid_argument);
+}
+
+TEST_METHOD(out_of_slots)
+{
+    capo::metrics_registry reg { 2 };
+    auto a = reg.counter("a_total");
+    auto b = reg.counter("b_total");
+    EXPECT_THROW(reg.counter("c_total"), std::invalid_argument);
+    EXPECT_THROW(reg.counter("a_total", "", { { "k", "v" } }), std::invalid_argument);
+    // the failed ones are not added, so they could not alias the slots of others
+    EXPECT_THROW(reg.counter("c_total"), std::invalid_argument);
+    a.inc();
+    b.add(2);
+    EXPECT_EQ(
+        "# TYPE a_total counter\n"
+        "a_total 1\n"
+        "# TYPE b_total counter\n"
+        "b_total 2\n", reg.snapshot());
+}
+
+TEST_METHOD(out_of_tls_keys)
+{
+    // uses up the thread-local keys, then all threads update a shared shard
+    std::vector<std::unique_ptr<capo::thread_local_ptr<int>>> keys;
+    for (int i = 0; i < 100000; ++i)
+    {
+        keys.emplace_back(new capo::thread_local_ptr<int>);
+        if (!keys.back()->valid()) break;
+    }
+    ASSERT_FALSE(keys.back()->valid());
+    {
+        capo::metrics_registry reg;
+        keys.clear();
+        auto c = reg.counter("ops_total");
+        auto h = reg.histogram("lat", "", {}, { 1 });
+        const int thread_count = 4, count = 10000;
+        std::vector<std::thread> ths;
+        for (int t = 0; t < thread_count; ++t)
+        {
+            ths.emplace_back([&]
+            {
+                for (int i = 0; i < count; ++i)
+                {
+                    c.inc();
+                    h.observe(0.5);
+                }
+            });
+        }
+        for (auto& th : ths) th.join();
+        auto text = reg.snapshot();
+        EXPECT_NE(std::string::npos, text.find("ops_total 40000\n"));
+        EXPECT_NE(std::string::npos, text.find("lat_count 40000\n"));
+    }
+}
+
+TEST_METHOD(threads)
+{
+    capo::metrics_registry reg;
+    auto c = reg.counter("ops_total");
+    auto h = reg.histogram("op_seconds", "", {}, { 1, 10 });
+    const int thread_count = 4, count = 100000;
+    for (int round = 0; round < 2; ++round) // the second round reuses the slots
+    {
+        std::vector<std::thread> ths;
+        for (int t = 0; t < thread_count; ++t)
+        {
+            ths.emplace_back([&]
+            {
+                for (int i = 0; i < count; ++i)
+                {
+                    c.inc();
+                    h.observe(i % 2 ? 0.5 : 5.0);
+                }
+            });
+        }
+        std::string last;
+        for (int i = 0; i < 10; ++i) last = reg.snapshot(); // concurrently
+        for (auto& th : ths) th.join();
+    }
+    std::string text = reg.snapshot();
+    EXPECT_NE(std::string::npos, text.find("ops_total 800000\n"));
+    EXPECT_NE(std::string::npos, text.find("op_seconds_bucket{le=\"1\"} 400000\n"));
+    EXPECT_NE(std::string::npos, text.find("op_seconds_bucket{le=\"+Inf\"} 800000\n"));
+    EXPECT_NE(std::string::npos, text.find("op_seconds_sum 2200000\n"));
+}
+
+TEST_METHOD(collector)
+{
+    using namespace ut_metrics_;
+    const char* path = "ut-metrics.prom";
+    std::remove(path);
+    capo::metrics_registry reg;
+    auto c = reg.counter("events_total");
+    {
+        capo::metrics_collector col { reg, path, std::chrono::milliseconds(10) };
+        c.inc();
+        std::this_thread::sleep_for(std::chrono::milliseconds(30));
+        c.inc();
+    }
+    EXPECT_EQ("# TYPE events_total counter\nevents_total 2\n", read_file(path));
+    std::remove(path);
+}
+
+TEST_METHOD(benchmark)
+{
+    capo::metrics_registry reg;
+    auto c = reg.counter("c");
+    auto g = reg.gauge("g");
+    auto h = reg.histogram("h");
+    double v = 0;
+    capo::bench b;
+    b.run("metric_counter::inc", [&] { c.inc(); });
+    b.run("metric_gauge::set", [&] { g.set(v += 1); });
+    b.run("metric_gauge::add", [&] { g.add(1); });
+    b.run("metric_histogram::observe", [&] { h.observe(v += 0.001); });
+    b.run_threads("metric_counter::inc", { 1, 2, 4 }, [&](size_t) { c.inc(); });
+    b.run("metrics_registry::snapshot", [&] { capo::do_not_optimize(reg.snapshot()); });
+}
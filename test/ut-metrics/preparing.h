@@ -0,0 +1,24 @@
+#pragma once
+
+#include "capo/metrics.hpp"
+#include "capo/bench.hpp"
+
+#include <string>
+#include <vector>
+#include <thread>
+#include <memory>
+#include <fstream>
+#include <sstream>
+#include <cstdio>
+
+namespace ut_metrics_ {
+
+inline std::string read_file(const char* path)
+{
+    std::ifstream in { path };
+    std::ostringstream ss;
+    ss << in.rdbuf();
+    return ss.str();
+}
+
+} // namespace ut_metrics_
@@ -0,0 +1,148 @@
+#pragma once
+
+TEST_METHOD(strings)
+{
+    using namespace ut_perfect_hash_;
+
+    static_assert(methods.size() == 9, "");
+    static_assert(*methods.find("POST") == 3, "");
+    static_assert(methods.find("post") == nullptr, "");
+    static_assert(methods.contains("PATCH"), "");
+    static_assert(!methods.contains("PATCHES"), "");
+
+    EXPECT_EQ(1, methods.at("GET"));
+    EXPECT_EQ(5, methods.at(std::string("DELETE")));
+    EXPECT_EQ(7, methods.at("OPTIONS-and-more", 7));
+    EXPECT_EQ(nullptr, methods.find(""));
+    EXPECT_EQ(nullptr, methods.find(std::string("GE")));
+    EXPECT_EQ(nullptr, methods.find("GETS", 4));
+    EXPECT_THROW(methods.at("LINK"), std::out_of_range);
+
+    for (size_t i = 0; i < capo::countof(header_names); ++i)
+    {
+        std::string name = header_names[i];
+        EXPECT_EQ(i, headers.at(name));
+        EXPECT_EQ(nullptr, headers.find(name + "-"));
+        EXPECT_EQ(nullptr, headers.find(name.substr(1)));
+    }
+}
+
+TEST_METHOD(integers)
+{
+    using namespace ut_perfect_hash_;
+
+    static_assert(statuses.contains(404), "");
+    static_assert(!statuses.contains(405), "");
+
+    EXPECT_STREQ("Not Found", statuses.at(404));
+    EXPECT_STREQ("OK"       , statuses.at(200));
+    EXPECT_EQ(nullptr, statuses.find(0));
+    EXPECT_EQ(nullptr, statuses.find(-404));
+
+    std::set<size_t> slots;
+    for (size_t i = 0; i < sparse_count; ++i)
+    {
+        long long k = static_cast<long long>(i) * 7919 - 100000;
+        ASSERT_EQ(i, sparse.at(k));
+        ASSERT_FALSE(sparse.contains(k + 1));
+        slots.insert(sparse.index(k));
+    }
+    EXPECT_EQ(sparse_count, slots.size());
+    EXPECT_EQ(sparse_count - 1, *slots.rbegin());
+}
+
+TEST_METHOD(enums)
+{
+    using namespace ut_perfect_hash_;
+
+    constexpr auto values = capo::make_perfect_map<color, const char*>
+    ({
+        { color::red, "#f00" }, { color::green, "#0f0" }, { color::blue, "#00f" }
+    });
+    static_assert(values.contains(color::green), "");
+    static_assert(!values.contains(color::white), "");
+    EXPECT_STREQ("#00f", values.at(color::blue));
+
+    // enum <-> string
+    for (size_t i = 0; i < capo::countof(color_names); ++i)
+    {
+        color c = static_cast<color>(colors.at(color_names[i]));
+        EXPECT_EQ(static_cast<color>(i), c);
+        EXPECT_STREQ(color_names[i], color_names[static_cast<size_t>(c)]);
+    }
+    static_assert(static_cast<color>(*colors.find("magenta")) == color::magenta, "");
+    EXPECT_FALSE(colors.contains("purple"));
+
+    // The stored keys
+    for (size_t s = 0; s < colors.size(); ++s)
+    {
+        auto k = colors.key(s);
+        EXPECT_EQ(s, colors.index(k.data(), k.size()));
+        EXPECT_STREQ(color_names[colors.value(s)], k.data());
+    }
+}
+
+TEST_METHOD(duplicates)
+{
+    // The keys are compared by their contents, not by the pointers
+    char get[] = "GET";
+    try
+    {
+        capo::make_perfect_map<const char*, int>({ { "GET", 1 }, { "POST", 2 }, { get, 3 } });
+        ADD_FAILURE();
+    }
+    catch (const std::invalid_argument& e)
+    {
+        EXPECT_STREQ("perfect_map: duplicate keys", e.what());
+    }
+    EXPECT_THROW((capo::make_perfect_map<int, int>({ { 1, 1 }, { 2, 2 }, { 1, 3 } })), std::invalid_argument);
+}
+
+TEST_METHOD(benchmark)
+{
+    using namespace ut_perfect_hash_;
+
+    std::map<std::string, size_t> ordered;
+    std::unordered_map<std::string, size_t> unordered;
+    std::vector<std::string> names;
+    for (size_t i = 0; i < capo::countof(header_names); ++i)
+    {
+        ordered  [header_names[i]] = i;
+        unordered[header_names[i]] = i;
+        names.push_back(header_names[i]);
+        names.push_back(std::string(header_names[i]) + "-X"); // misses
+    }
+    capo::bench b;
+    b.samples(5);
+
+    b.run("headers/std::map", [&]
+    {
+        size_t r = 0;
+        for (const auto& n : names)
+        {
+            auto it = ordered.find(n);
+            if (it != ordered.end()) r += it->second;
+        }
+        capo::do_not_optimize(r);
+    });
+    b.run("headers/std::unordered_map", [&]
+    {
+        size_t r = 0;
+        for (const auto& n : names)
+        {
+            auto it = unordered.find(n);
+            if (it != unordered.end()) r += it->second;
+        }
+        capo::do_not_optimize(r);
+    });
+    b.run("headers/capo::perfect_map", [&]
+    {
+        size_t r = 0;
+        for (const auto& n : names)
+        {
+            auto v = headers.find(n);
+            if (v != nullptr) r += *v;
+        }
+        capo::do_not_optimize(r);
+    });
+}
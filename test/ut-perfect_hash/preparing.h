@@ -0,0 +1,79 @@
+#pragma once
+
+#include "capo/perfect_hash.hpp"
+#include "capo/countof.hpp"
+#include "capo/bench.hpp"
+
+#include <string>
+#include <vector>
+#include <set>
+#include <map>
+#include <unordered_map>
+#include <utility>
+#include <stdexcept>
+#include <cstddef>
+
+namespace ut_perfect_hash_ {
+
+enum class color { red, green, blue, cyan, magenta, yellow, black, white };
+
+constexpr const char* color_names[] =
+{
+    "red", "green", "blue", "cyan", "magenta", "yellow", "black", "white"
+};
+
+constexpr auto colors = capo::make_perfect_index(color_names);
+
+constexpr auto methods = capo::make_perfect_map<const char*, int>
+({
+    { "GET"    , 1 },
+    { "HEAD"   , 2 },
+    { "POST"   , 3 },
+    { "PUT"    , 4 },
+    { "DELETE" , 5 },
+    { "CONNECT", 6 },
+    { "OPTIONS", 7 },
+    { "TRACE"  , 8 },
+    { "PATCH"  , 9 }
+});
+
+constexpr const char* header_names[] =
+{
+    "Accept", "Accept-Charset", "Accept-Encoding", "Accept-Language", "Accept-Ranges",
+    "Age", "Allow", "Authorization", "Cache-Control", "Connection",
+    "Content-Encoding", "Content-Language", "Content-Length", "Content-Location", "Content-Range",
+    "Content-Type", "Cookie", "Date", "ETag", "Expect",
+    "Expires", "From", "Host", "If-Match", "If-Modified-Since",
+    "If-None-Match", "If-Range", "If-Unmodified-Since", "Last-Modified", "Location",
+    "Max-Forwards", "Pragma", "Proxy-Authenticate", "Proxy-Authorization", "Range",
+    "Referer", "Retry-After", "Server", "Set-Cookie", "TE",
+    "Trailer", "Transfer-Encoding", "Upgrade", "User-Agent", "Vary",
+    "Via", "WWW-Authenticate", "Warning"
+};
+
+constexpr auto headers = capo::make_perfect_index(header_names);
+
+constexpr auto statuses = capo::make_perfect_map<int, const char*>
+({
+    { 200, "OK"                    },
+    { 201, "Created"               },
+    { 204, "No Content"            },
+    { 301, "Moved Permanently"     },
+    { 304, "Not Modified"          },
+    { 400, "Bad Request"           },
+    { 403, "Forbidden"             },
+    { 404, "Not Found"             },
+    { 500, "Internal Server Error" },
+    { 503, "Service Unavailable"   }
+});
+
+template <size_t... I>
+constexpr auto make_sparse(std::index_sequence<I...>)
+{
+    return capo::make_perfect_map<long long, size_t>({ { static_cast<long long>(I) * 7919 - 100000, I }... });
+}
+
+constexpr size_t sparse_count = 1000;
+constexpr auto sparse = make_sparse(std::make_index_sequence<sparse_count> {});
+
+} // namespace ut_perfect_hash_
@@ -20,6 +20,194 @@ TEST_METHOD(printf_case)
     EXPECT_THROW(capo::printf(std::cout, "%d\n"    , 123, "123"), std::invalid_argument);
 }
 
+TEST_METHOD(format_integer)
+{
+    const char* fmts[] =
+    {
+        "%d", "%i", "%5d", "%-5d|", "%05d", "%+d", "% d", "%.3d", "%8.3d", "%-+8.3d|", "%.0d", "%+05d"
+    };
+    int ints[] = { 0, 1, -1, 7, 42, -42, 100, 99999, -123456, INT_MAX, INT_MIN };
+    for (const char* f : fmts)
+        for (int v : ints) EXPECT_SAME_PRINTF(f, v);
+
+    const char* ufmts[] =
+    {
+        "%u", "%o", "%x", "%X", "%#o", "%#x", "%#X", "%08x", "%#08x", "%-#8x|", "%.5x", "%#.0o", "%.0x"
+    };
+    unsigned uints[] = { 0, 1, 8, 255, 256, 4096, 0xdeadbeef, UINT_MAX };
+    for (const char* f : ufmts)
+        for (unsigned v : uints) EXPECT_SAME_PRINTF(f, v);
+
+    EXPECT_SAME_PRINTF("%hhd %hd %hhu %hu", 300, 70000, -1, -1);
+    EXPECT_SAME_PRINTF("%ld %lu %lx", LONG_MIN, ULONG_MAX, ULONG_MAX);
+    EXPECT_SAME_PRINTF("%lld %llu %llo", LLONG_MIN, ULLONG_MAX, ULLONG_MAX);
+    EXPECT_SAME_PRINTF("%zu %td %jd", (size_t)12345, (ptrdiff_t)-12345, (intmax_t)-1);
+}
+
+TEST_METHOD(format_string)
+{
+    EXPECT_SAME_PRINTF("[%s][%5s][%-5s][%.2s][%5.1s]", "abc", "abc", "abc", "abc", "abc");
+    EXPECT_SAME_PRINTF("[%c][%3c][%-3c]", 'a', 'b', 'c');
+    EXPECT_SAME_PRINTF("[%p][%20p][%-20p]", (void*)0x1234, (void*)0xabcdef, (void*)1);
+    EXPECT_SAME_PRINTF("[%p][%10p]", (void*)nullptr, (void*)nullptr);
+    EXPECT_SAME_PRINTF("100%% %s %%", "done");
+
+    int n = 0;
+    std::string str;
+    capo::printf(capo::use::strout(str), "12345%n678", &n);
+    EXPECT_STREQ("12345678", str.c_str());
+    EXPECT_EQ(5, n);
+}
+
+TEST_METHOD(format_float)
+{
+    const char* fmts[] =
+    {
+        "%f", "%.0f", "%.1f", "%.3f", "%#.0f", "%10.2f", "%-10.2f|", "%010.3f", "%+f", "% f", "%.10f", "%.20f",
+        "%e", "%.0e", "%.2e", "%#.0e", "%12.3e", "%-12.3E|", "%+.4e", "%.15e", "%.17e",
+        "%g", "%.3g", "%#g", "%G", "%a"
+    };
+    double dbls[] =
+    {
+        0.0, -0.0, 1.0, -1.0, 0.1, 0.5, 1.5, 2.5, 123.321, -123.321, 3.14159265358979, 1e-5, 1.25e-7, 0.125,
+        1e10, 123456789.987654321, 1e21, 1.7976931348623157e308, 4.9e-324, 2.2250738585072014e-308, 1.0 / 3,
+        std::numeric_limits<double>::infinity(), -std::numeric_limits<double>::infinity()
+    };
+    for (const char* f : fmts)
+        for (double v : dbls) EXPECT_SAME_PRINTF(f, v);
+
+    capo::random<std::mt19937_64, std::uniform_real_distribution<>> rdm { -1e6, 1e6 };
+    for (int i = 0; i < 10000; ++i)
+    {
+        double v = rdm();
+        EXPECT_SAME_PRINTF("%f", v);
+        EXPECT_SAME_PRINTF("%.3f", v);
+        EXPECT_SAME_PRINTF("%e", v);
+    }
+    EXPECT_SAME_PRINTF("%f %e", 0.1, 0.1);
+    EXPECT_SAME_PRINTF("%Lf %Le", 1.5L, 1.5L);
+}
+
+TEST_METHOD(format_shortest)
+{
+    using namespace ut_printf_;
+
+    EXPECT_STREQ("0"                      , shortest(0.0).c_str());
+    EXPECT_STREQ("-0"                     , shortest(-0.0).c_str());
+    EXPECT_STREQ("0.1"                    , shortest(0.1).c_str());
+    EXPECT_STREQ("0.1"                    , shortest(0.1f).c_str());
+    EXPECT_STREQ("123.321"                , shortest(123.321).c_str());
+    EXPECT_STREQ("100"                    , shortest(100.0).c_str());
+    EXPECT_STREQ("0.000001"               , shortest(1e-6).c_str());
+    EXPECT_STREQ("1e-07"                  , shortest(1e-7).c_str());
+    EXPECT_STREQ("1e+22"                  , shortest(1e22).c_str());
+    EXPECT_STREQ("1.7976931348623157e+308", shortest(1.7976931348623157e308).c_str());
+    EXPECT_STREQ("5e-324"                 , shortest(4.9e-324).c_str());
+    EXPECT_STREQ("inf"                    , shortest(std::numeric_limits<double>::infinity()).c_str());
+    EXPECT_STREQ("-12345"                 , shortest(-12345).c_str());
+    EXPECT_STREQ("18446744073709551615"   , shortest(ULLONG_MAX).c_str());
+
+    char small[4];
+    EXPECT_EQ(nullptr, capo::to_chars(small, small + sizeof(small), 123.456));
+
+    std::mt19937_64 rdm { 5489u };
+    for (int i = 0; i < 100000; ++i)
+    {
+        uint64_t bits = rdm();
+        double v;
+        memcpy(&v, &bits, sizeof(v));
+        if (v != v || v - v != 0) continue; // nan or inf
+        EXPECT_EQ(v, std::strtod(shortest(v).c_str(), nullptr));
+        float f;
+        uint32_t fbits = static_cast<uint32_t>(bits >> 32);
+        memcpy(&f, &fbits, sizeof(f));
+        if (f != f || f - f != 0) continue;
+        EXPECT_EQ(f, std::strtof(shortest(f).c_str(), nullptr));
+    }
+
+    std::string str;
+    capo::printf(capo::use::strout(str), "%r, %8r|%-8r|", 0.3, 2.5f, 1e100);
+    EXPECT_STREQ("0.3,      2.5|1e+100  |", str.c_str());
+}
+
+////////////////////////////////////////////////////////////////
+
+TEST_METHOD(format_to)
+{
+    char str[64] = {};
+    size_t allocs = ut_alloc_count;
+    char* end = capo::format_to(str, "%d, %s, %08x, %.3f", -123, "abc", 0xbeef, 3.14159);
+    EXPECT_EQ(allocs, ut_alloc_count.load());
+    *end = '\0';
+    EXPECT_STREQ("-123, abc, 0000beef, 3.142", str);
+
+    std::string out;
+    capo::format_to(std::back_inserter(out), "%s = %r", "pi", 3.14159);
+    EXPECT_STREQ("pi = 3.14159", out.c_str());
+
+    auto r = capo::format_to_n(str, 5, "%d", 123456789);
+    EXPECT_EQ(size_t(9), r.size);
+    EXPECT_EQ(str + 5, r.out);
+    EXPECT_EQ(0, ::strncmp(str, "12345", 5));
+
+    char fix[8];
+    capo::fixed_buffer fb { fix };
+    allocs = ut_alloc_count;
+    EXPECT_TRUE (capo::format_to(fb, "%d", 1234));
+    EXPECT_FALSE(capo::format_to(fb, "%s", "5678"));
+    EXPECT_EQ(allocs, ut_alloc_count.load());
+    EXPECT_TRUE (fb.truncated());
+    EXPECT_EQ(size_t(7), fb.size());
+    EXPECT_STREQ("1234567", fb.c_str());
+    fb.clear();
+    EXPECT_TRUE (capo::format_to(fb, "%5.1f", 2.25));
+    EXPECT_STREQ("  2.2", fb.c_str());
+
+    capo::mem_file mf;
+    std::string big(1000, 'x');
+    EXPECT_EQ(1004, capo::format_to(mf, "%s%04d", big.c_str(), 7));
+    EXPECT_EQ(capo::file::size_type(1004), mf.size());
+    capo::file::buf_type rd(1004);
+    mf.seek(0, std::ios_base::beg);
+    EXPECT_EQ(capo::file::size_type(1004), mf.read(&rd));
+    EXPECT_STREQ((big + "0007").c_str(), std::string(rd.begin(), rd.end()).c_str());
+
+    EXPECT_THROW(capo::format_to(fb, "%d %d", 1), std::invalid_argument);
+}
+
+////////////////////////////////////////////////////////////////
+
+TEST_METHOD(check_format)
+{
+    static_assert( capo::valid_format<>("100%% done"), "");
+    static_assert( capo::valid_format<int, const char*, double>("%d, %s, %.2f"), "");
+    static_assert( capo::valid_format<long long, size_t, char*>("%lld %zu %s"), "");
+    static_assert( capo::valid_format<void*, wchar_t>("%p %lc"), "");
+    static_assert(!capo::valid_format<int>("%d %d"), "");
+    static_assert(!capo::valid_format<int, int>("%d"), "");
+    static_assert(!capo::valid_format<const char*>("%d"), "");
+    static_assert(!capo::valid_format<int>("%s"), "");
+    static_assert(!capo::valid_format<int>("%"), "");
+
+    std::string str;
+    const char* fmt = "%d, %s";
+    for (int i = 0; i < 3; ++i)
+    {
+        EXPECT_EQ(5, capo::printf(capo::use::strout(str), fmt, i, "ab"));
+    }
+    // the same format with other argument types is checked again
+    EXPECT_THROW(capo::printf(capo::use::strout(str), fmt, "ab", 1), std::invalid_argument);
+    EXPECT_THROW(capo::printf(capo::use::strout(str), fmt, 1), std::invalid_argument);
+
+    // many call sites of a common signature are all kept
+    using cache_t = capo::detail_printf_::check_cache<long, char>;
+    static const char fmts[64][8] = {};
+    for (auto& f : fmts) cache_t::insert(f);
+    size_t hits = 0;
+    for (auto& f : fmts) if (cache_t::find(f)) ++hits;
+    EXPECT_EQ(size_t(64), hits);
+}
+
 ////////////////////////////////////////////////////////////////
 
 TEST_METHOD(output_case)
@@ -46,6 +234,9 @@ TEST_METHOD(output_case)
 
     capo::output(out, "{0}, {3}, {1}, {2}", 0, 1, 2, 3);
     EXPECT_STREQ("0, 3, 1, 2", buf.c_str());
+
+    capo::output(out, "{0:r} {1:r} {2:10.3r}|", 0.1, 1e-7, 2.5);
+    EXPECT_STREQ("0.1 1e-07        2.5|", buf.c_str());
 }
 
 TEST_METHOD(space_case)
@@ -2,10 +2,22 @@
 
 #include "capo/printf.hpp"
 #include "capo/output.hpp"
+#include "capo/format.hpp"
+#include "capo/random.hpp"
+#include "capo/file.hpp"
 
 #include <string>
+#include <limits>
+#include <climits>
+#include <cstdlib>
+#include <cstdio>
+#include <new>
+#include <iterator>
+#include <atomic>
 #include <string.h>
 
+#include "test/alloc_counter.h" // counts the heap allocations, for checking the format_to family
+
 namespace ut_printf_ {
 
 std::string buf;
@@ -43,4 +55,39 @@ public:
     }
 };
 
+#if defined(__GNUC__)
+#   pragma GCC diagnostic push
+#   pragma GCC diagnostic ignored "-Wformat-nonliteral"
+#   pragma GCC diagnostic ignored "-Wformat-security"
+#endif/*__GNUC__*/
+template <typename... A>
+std::string std_printf(const char* fmt, A... args)
+{
+    char str[512];
+    ::snprintf(str, sizeof(str), fmt, args...);
+    return str;
+}
+#if defined(__GNUC__)
+#   pragma GCC diagnostic pop
+#endif/*__GNUC__*/
+
+template <typename... A>
+std::string capo_printf(const char* fmt, A... args)
+{
+    std::string str;
+    capo::printf(capo::use::strout(str), fmt, args...);
+    return str;
+}
+
+#define EXPECT_SAME_PRINTF(FMT, ...) \
+    EXPECT_STREQ(ut_printf_::std_printf(FMT, __VA_ARGS__).c_str(), ut_printf_::capo_printf(FMT, __VA_ARGS__).c_str())
+
+template <typename T>
+std::string shortest(T val)
+{
+    char str[64];
+    char* end = capo::to_chars(str, str + sizeof(str), val);
+    return (end == nullptr) ? "" : std::string(str, end);
+}
+
 } // namespace ut_printf_
@@ -0,0 +1,138 @@
+#pragma once
+
+TEST_METHOD(uncontended)
+{
+    capo::lock_profiler prof;
+    {
+        capo::profiled_mutex<capo::spin_lock> lc { "single", prof };
+        EXPECT_EQ("single", lc.name());
+        for (int i = 0; i < 1000; ++i)
+        {
+            lc.lock();
+            lc.unlock();
+        }
+        EXPECT_TRUE(lc.try_lock());
+        EXPECT_FALSE(lc.try_lock());
+        lc.unlock();
+        auto st = prof.sites();
+        ASSERT_EQ(1u, st.size());
+        EXPECT_EQ(1u   , st[0].mutexes_);
+        EXPECT_EQ(1001u, st[0].acquisitions_);
+        EXPECT_EQ(0u   , st[0].contended_);
+        EXPECT_EQ(0u   , st[0].wait_.count());
+        EXPECT_EQ(1001u / CAPO_PROFILED_MUTEX_SAMPLE_, st[0].hold_.count());
+    }
+    // the counts of the destroyed mutexes are kept
+    auto st = prof.sites();
+    ASSERT_EQ(1u, st.size());
+    EXPECT_EQ(0u   , st[0].mutexes_);
+    EXPECT_EQ(1001u, st[0].acquisitions_);
+}
+
+TEST_METHOD(sites)
+{
+    using namespace ut_profiled_mutex_;
+    capo::lock_profiler prof;
+    capo::profiled_mutex<std::mutex> hot { "hot", prof }, cold { "cold", prof };
+    std::vector<std::unique_ptr<capo::profiled_mutex<capo::spin_lock>>> buckets;
+    for (int i = 0; i < 4; ++i)
+        buckets.emplace_back(new capo::profiled_mutex<capo::spin_lock>("bucket", prof));
+    int value = 0;
+    hammer(hot, value, 4, 50000);
+    EXPECT_EQ(200000, value);
+    hammer(cold, value, 1, 1000);
+    for (auto& b : buckets) hammer(*b, value, 1, 100);
+
+    // a contended wait, long enough to be the worst one
+    hot.lock();
+    std::thread th { [&] { hot.lock(); hot.unlock(); } };
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    hot.unlock();
+    th.join();
+
+    auto st = prof.sites();
+    ASSERT_EQ(3u, st.size());
+    EXPECT_EQ("hot", st[0].name_);
+    EXPECT_EQ(200002u, st[0].acquisitions_);
+    EXPECT_LT(0u, st[0].contended_);
+    EXPECT_EQ(st[0].contended_, st[0].wait_.count());
+    EXPECT_LE(10000000u, st[0].wait_.max());
+    for (size_t i = 1; i < 3; ++i)
+    {
+        if (st[i].name_ == "bucket")
+        {
+            EXPECT_EQ(4u  , st[i].mutexes_);
+            EXPECT_EQ(400u, st[i].acquisitions_);
+        }
+        else
+        {
+            EXPECT_EQ("cold", st[i].name_);
+            EXPECT_EQ(1000u, st[i].acquisitions_);
+        }
+        EXPECT_EQ(0u, st[i].contended_);
+    }
+
+    std::string text;
+    prof.report([&text](std::string&& s) { text += s; }, 2);
+    std::cout << text;
+    EXPECT_EQ(3u, std::count(text.begin(), text.end(), '\n'));
+    EXPECT_EQ(0u, text.find("lock"));
+    EXPECT_NE(std::string::npos, text.find("\nhot "));
+}
+
+TEST_METHOD(many_sites)
+{
+    using namespace ut_profiled_mutex_;
+    // More sites than the thread-local keys, a site should not take any of them
+    capo::lock_profiler prof;
+    std::vector<std::unique_ptr<capo::profiled_mutex<capo::spin_lock>>> mutexes;
+    std::vector<std::string> names;
+    for (int i = 0; i < 2000; ++i) names.push_back("site" + std::to_string(i));
+    for (auto& n : names) mutexes.emplace_back(new capo::profiled_mutex<capo::spin_lock>(n.c_str(), prof));
+    int value = 0;
+    hammer(*mutexes.back(), value, 2, 10000);
+    EXPECT_EQ(20000, value);
+    capo::thread_local_ptr<int> p;
+    EXPECT_TRUE(p.valid());
+    auto st = prof.sites();
+    ASSERT_EQ(names.size(), st.size());
+    auto it = std::find_if(st.begin(), st.end(), [](const capo::lock_stats& s) { return s.name_ == "site1999"; });
+    ASSERT_NE(st.end(), it);
+    EXPECT_EQ(uint64_t(20000), it->acquisitions_);
+    EXPECT_EQ(it->contended_, it->wait_.count());
+}
+
+TEST_METHOD(thread_wrapper)
+{
+    using namespace ut_profiled_mutex_;
+    capo::thread_wrapper<counter, capo::profiled_mutex<capo::spin_lock>> cnt;
+    std::vector<std::thread> ths;
+    for (int t = 0; t < 4; ++t)
+    {
+        ths.emplace_back([&] { for (int i = 0; i < 10000; ++i) cnt.call(&counter::inc); });
+    }
+    for (auto& th : ths) th.join();
+    EXPECT_EQ(40000, cnt.value_);
+    for (auto& s : capo::lock_profiler::global().sites())
+    {
+        if (s.name_ == "(unnamed)")
+        {
+            EXPECT_LE(40000u, s.acquisitions_);
+        }
+    }
+}
+
+TEST_METHOD(overhead)
+{
+    capo::lock_profiler prof;
+    std::mutex m1;
+    capo::spin_lock s1;
+    capo::profiled_mutex<std::mutex> m2 { "bench/mutex", prof };
+    capo::profiled_mutex<capo::spin_lock> s2 { "bench/spin_lock", prof };
+    int value = 0;
+    capo::bench b;
+    b.run("std::mutex"                    , [&] { std::lock_guard<decltype(m1)> g { m1 }; capo::do_not_optimize(++value); });
+    b.run("profiled_mutex<std::mutex>"    , [&] { std::lock_guard<decltype(m2)> g { m2 }; capo::do_not_optimize(++value); });
+    b.run("capo::spin_lock"               , [&] { std::lock_guard<decltype(s1)> g { s1 }; capo::do_not_optimize(++value); });
+    b.run("profiled_mutex<capo::spin_lock>", [&] { std::lock_guard<decltype(s2)> g { s2 }; capo::do_not_optimize(++value); });
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "capo/profiled_mutex.hpp"
+#include "capo/thread_wrapper.hpp"
+#include "capo/spin_lock.hpp"
+#include "capo/bench.hpp"
+
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <chrono>
+#include <memory>
+#include <iostream>
+#include <algorithm>
+
+namespace ut_profiled_mutex_ {
+
+struct counter
+{
+    int value_ = 0;
+    void inc(void) { ++value_; }
+};
+
+template <typename MutexT>
+void hammer(MutexT& lc, int& value, int thread_count, int count)
+{
+    std::vector<std::thread> ths;
+    for (int t = 0; t < thread_count; ++t)
+    {
+        ths.emplace_back([&]
+        {
+            for (int i = 0; i < count; ++i)
+            {
+                std::lock_guard<MutexT> guard { lc };
+                ++value;
+            }
+        });
+    }
+    for (auto& th : ths) th.join();
+}
+
+} // namespace ut_profiled_mutex_
@@ -0,0 +1,141 @@
+#pragma once
+
+TEST_METHOD(call_tree)
+{
+    using namespace ut_profiler_;
+    capo::profiler prof;
+    for (int i = 0; i < 2; ++i) decode(prof);
+    std::thread { [&prof] { decode(prof); } }.join();
+
+    auto evs = prof.events();
+    ASSERT_EQ(12u, evs.size());
+    EXPECT_STREQ("decode", evs[0].name_);
+    EXPECT_EQ(0u, evs[0].depth_);
+    EXPECT_STREQ("parse", evs[1].name_);
+    EXPECT_EQ(1u, evs[1].depth_);
+    EXPECT_LE(evs[0].begin_, evs[1].begin_);
+    EXPECT_GE(evs[0].end_, evs[1].end_);
+
+    auto root = prof.aggregate();
+    ASSERT_EQ(1u, root.children_.size());
+    auto dec = find(root, "decode");
+    ASSERT_NE(nullptr, dec);
+    EXPECT_EQ(3u, dec->count_);
+    auto par = find(*dec, "parse");
+    ASSERT_NE(nullptr, par);
+    EXPECT_EQ(9u, par->count_);
+    EXPECT_EQ(dec->total_, dec->self_ + par->total_);
+    EXPECT_LE(9 * 100000u, par->total_);
+    EXPECT_LE(3 * 100000u, dec->self_);
+    prof.report(std::cout);
+
+    prof.clear();
+    EXPECT_TRUE(prof.events().empty());
+}
+
+TEST_METHOD(disabled)
+{
+    using namespace ut_profiler_;
+    capo::profiler prof { false };
+    decode(prof);
+    EXPECT_TRUE(prof.events().empty());
+    prof.enable();
+    decode(prof);
+    EXPECT_EQ(4u, prof.events().size());
+
+    capo::profiler::global().clear();
+    {
+        CAPO_PROFILE_SCOPE_("global");
+    }
+    EXPECT_EQ(1u, capo::profiler::global().events().size());
+}
+
+TEST_METHOD(ring_overwrite)
+{
+    capo::profiler prof { true, 16 };
+    for (int i = 0; i < 100; ++i)
+    {
+        CAPO_PROFILE_SCOPE_(prof, "loop");
+    }
+    auto evs = prof.events();
+    // the oldest one is discarded, since the next push would overwrite it
+    EXPECT_EQ(15u, evs.size());
+    EXPECT_EQ(1u, prof.aggregate().children_.size());
+}
+
+TEST_METHOD(full_ring)
+{
+    capo::detail_profile::ring r { 8, 1 };
+    std::vector<capo::profile_event> evs;
+    for (uint64_t i = 0; i < 7; ++i) r.push("e", i, i + 1, 0);
+    r.collect(evs);
+    EXPECT_EQ(7u, evs.size());
+    // full: the slot of the event 0 is the one the event 8 will be written into
+    r.push("e", 7, 8, 0);
+    evs.clear();
+    r.collect(evs);
+    ASSERT_EQ(7u, evs.size());
+    EXPECT_EQ(1u, evs.front().begin_);
+    EXPECT_EQ(7u, evs.back ().begin_);
+    for (uint64_t i = 8; i < 20; ++i) r.push("e", i, i + 1, 0);
+    evs.clear();
+    r.collect(evs);
+    ASSERT_EQ(7u, evs.size());
+    EXPECT_EQ(13u, evs.front().begin_);
+    EXPECT_EQ(19u, evs.back ().begin_);
+}
+
+TEST_METHOD(out_of_tls_keys)
+{
+    // uses up the thread-local keys, then all threads record into a shared ring
+    std::vector<std::unique_ptr<capo::thread_local_ptr<int>>> keys;
+    for (int i = 0; i < 100000; ++i)
+    {
+        keys.emplace_back(new capo::thread_local_ptr<int>);
+        if (!keys.back()->valid()) break;
+    }
+    ASSERT_FALSE(keys.back()->valid());
+    capo::profiler prof;
+    keys.clear();
+    std::vector<std::thread> ths;
+    for (int t = 0; t < 4; ++t)
+    {
+        ths.emplace_back([&prof]
+        {
+            for (int i = 0; i < 100; ++i)
+            {
+                CAPO_PROFILE_SCOPE_(prof, "outer");
+                CAPO_PROFILE_SCOPE_(prof, "inner");
+            }
+        });
+    }
+    for (auto& th : ths) th.join();
+    EXPECT_EQ(800u, prof.events().size());
+    auto root = prof.aggregate();
+    ASSERT_EQ(2u, root.children_.size()); // flat
+    EXPECT_EQ(400u, root.children_[0].count_);
+    EXPECT_EQ(400u, root.children_[1].count_);
+}
+
+TEST_METHOD(chrome_trace)
+{
+    using namespace ut_profiler_;
+    capo::profiler prof;
+    decode(prof);
+    std::string json;
+    prof.write_chrome_trace(json);
+    EXPECT_EQ(0u, json.find("{\"traceEvents\":[{\"name\":\"thread_name\",\"ph\":\"M\""));
+    EXPECT_NE(std::string::npos, json.find("{\"name\":\"decode\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":"));
+    EXPECT_NE(std::string::npos, json.find("\"displayTimeUnit\":\"ns\"}"));
+    EXPECT_EQ('}', json.back());
+}
+
+TEST_METHOD(overhead)
+{
+    capo::profiler prof { true, 1024 };
+    capo::bench b;
+    b.run("enabled scope", [&] { CAPO_PROFILE_SCOPE_(prof, "enabled"); });
+    prof.disable();
+    b.run("disabled scope", [&] { CAPO_PROFILE_SCOPE_(prof, "disabled"); });
+    EXPECT_EQ(1023u, prof.events().size()); // a full ring keeps size - 1 events
+}
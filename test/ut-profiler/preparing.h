@@ -0,0 +1,42 @@
+#pragma once
+
+#include "capo/profiler.hpp"
+#include "capo/bench.hpp"
+#include "capo/output.hpp"
+
+#include <string>
+#include <thread>
+#include <memory>
+#include <vector>
+#include <chrono>
+#include <iostream>
+
+namespace ut_profiler_ {
+
+inline void spin_for(std::chrono::microseconds us)
+{
+    auto until = std::chrono::steady_clock::now() + us;
+    while (std::chrono::steady_clock::now() < until) ;
+}
+
+inline void parse(capo::profiler& prof)
+{
+    CAPO_PROFILE_SCOPE_(prof, "parse");
+    spin_for(std::chrono::microseconds(100));
+}
+
+inline void decode(capo::profiler& prof)
+{
+    CAPO_PROFILE_SCOPE_(prof, "decode");
+    for (int i = 0; i < 3; ++i) parse(prof);
+    spin_for(std::chrono::microseconds(100));
+}
+
+inline const capo::profile_node* find(const capo::profile_node& node, const char* name)
+{
+    for (auto& c : node.children_)
+        if (std::string(c.name_) == name) return &c;
+    return nullptr;
+}
+
+} // namespace ut_profiler_
@@ -0,0 +1,299 @@
+#pragma once
+
+TEST_METHOD(reference)
+{
+    using namespace ut_random_;
+    // the outputs of the reference implementations
+    capo::splitmix64 sm;
+    expect_sequence(sm, { 0xe220a8397b1dcdafull, 0x6e789e6aa1b965f4ull, 0x06c45d188009454full });
+    capo::xoshiro256ss x256 { 42 };
+    expect_sequence(x256, { 0x15780b2e0c2ec716ull, 0x6104d9866d113a7eull, 0xae17533239e499a1ull });
+    capo::xoroshiro128p x128 { 42 };
+    expect_sequence(x128, { 0xe6c71559e2525f98ull, 0x13b69ac93ec06b57ull, 0x879006cb74f40d36ull });
+    capo::pcg32 p32 { 42, 54 };
+    expect_sequence(p32, { 0xa15c02b7u, 0x7b47f409u, 0xba1d3330u, 0x83d2f293u, 0xbfa4784bu, 0xcbed606eu });
+    capo::pcg64 p64 { 42, 54 };
+    expect_sequence(p64, { 0x86b1da1d72062b68ull, 0x1304aa46c9853d39ull, 0xa3670e9e0dd50358ull });
+}
+
+TEST_METHOD(jump)
+{
+    capo::xoshiro256ss x256 { 42 };
+    x256.jump();
+    EXPECT_EQ(0x50086ef83cbf4f4aull, x256());
+    x256.seed(42);
+    x256.long_jump();
+    EXPECT_EQ(0xa0a4cb7719d49439ull, x256());
+
+    capo::xoroshiro128p x128 { 42 };
+    x128.jump();
+    EXPECT_EQ(0x4f2de712b4b57c7dull, x128());
+    x128.seed(42);
+    x128.long_jump();
+    EXPECT_EQ(0xb8a898c0f4cf1e85ull, x128());
+
+    // advance(n) and discard(n) are the same as n calls
+    capo::splitmix64 sm1 { 7 }, sm2 { 7 };
+    capo::pcg32 p1 { 7 }, p2 { 7 };
+    capo::pcg64 q1 { 7 }, q2 { 7 };
+    for (int i = 0; i < 12345; ++i) { sm1(); p1(); q1(); }
+    sm2.discard(12345);
+    p2.advance(12345);
+    q2.advance(12345);
+    EXPECT_TRUE(sm1 == sm2);
+    EXPECT_TRUE(p1 == p2);
+    EXPECT_TRUE(q1 == q2);
+    EXPECT_EQ(p1(), p2());
+    EXPECT_EQ(q1(), q2());
+
+    // different streams
+    capo::pcg32 s1 { 7, 1 }, s2 { 7, 2 };
+    EXPECT_TRUE(s1 != s2);
+}
+
+TEST_METHOD(random)
+{
+    capo::random<capo::xoshiro256ss> r1 { capo::use::seed{ 42 }, 1, 6 }, r2 { capo::use::seed{ 42 }, 1, 6 };
+    std::set<int> seen;
+    for (int i = 0; i < 1000; ++i)
+    {
+        int v = r1();
+        EXPECT_EQ(v, r2());
+        ASSERT_LE(1, v);
+        ASSERT_GE(6, v);
+        seen.insert(v);
+    }
+    EXPECT_EQ(6u, seen.size());
+
+    capo::random<capo::pcg32, std::uniform_real_distribution<>> r3 { capo::use::fast_seed{} }, r4 { capo::use::fast_seed{} };
+    EXPECT_NE(r3.engine(), r4.engine());
+    double sum = 0;
+    for (int i = 0; i < 10000; ++i)
+    {
+        double v = r3();
+        ASSERT_LE(0.0, v);
+        ASSERT_GT(1.0, v);
+        sum += v;
+    }
+    EXPECT_NEAR(0.5, sum / 10000, 0.02);
+
+    r3.seed(5);
+    r4.seed(5);
+    EXPECT_EQ(r3(), r4());
+
+    capo::random<> r5 { capo::use::seed{ 1 } }, r6 { capo::use::seed{ 1 } };
+    EXPECT_EQ(r5(), r6());
+
+    capo::random<capo::xoroshiro128p, std::normal_distribution<>> r7 { capo::use::fast_seed{}, 10.0, 1.0 };
+    sum = 0;
+    for (int i = 0; i < 10000; ++i) sum += r7();
+    EXPECT_NEAR(10.0, sum / 10000, 0.1);
+}
+
+TEST_METHOD(lanes)
+{
+    // lane i of xoshiro256ss_x is xoshiro256ss jumped i times
+    capo::xoshiro256ss_x4 x4 { 42 };
+    capo::xoshiro256ss    xs[4] = { capo::xoshiro256ss{ 42 }, capo::xoshiro256ss{ 42 }, capo::xoshiro256ss{ 42 }, capo::xoshiro256ss{ 42 } };
+    for (int i = 1; i < 4; ++i) for (int j = i; j < 4; ++j) xs[j].jump();
+    EXPECT_EQ(0x15780b2e0c2ec716ull, x4());
+    EXPECT_EQ(0x50086ef83cbf4f4aull, x4());
+    for (int i = 2; i < 4; ++i) EXPECT_EQ(xs[i](), x4()) << i;
+    xs[0](); xs[1]();
+    for (int k = 0; k < 100; ++k) for (auto& x : xs) ASSERT_EQ(x(), x4());
+
+    // generate is the same as the calls
+    capo::xoshiro256ss_x8 a { 7 }, b { 7 };
+    uint64_t buf[37];
+    a();
+    a.generate(buf, 37);
+    b();
+    for (auto v : buf) ASSERT_EQ(b(), v);
+    EXPECT_TRUE(a == b);
+}
+
+TEST_METHOD(bulk)
+{
+    using namespace ut_random_;
+    const double pi = 3.14159265358979323846;
+    check_bulk<capo::xoshiro256ss_x8, std::uniform_int_distribution<int>>(3.5, 35.0 / 12, 1, 6);
+    check_bulk<capo::xoshiro256ss_x4, std::uniform_int_distribution<unsigned>>(0.5 * 4294967295.0, 4294967296.0 * 4294967296.0 / 12, 0u, 0xffffffffu);
+    check_bulk<capo::xoshiro256ss, std::uniform_int_distribution<int64_t>>(0, 1e24 / 3, -1000000000000ll, 1000000000000ll);
+    check_bulk<capo::xoshiro256ss_x8, std::uniform_real_distribution<double>>(0, 4.0 / 3, -2.0, 2.0);
+    check_bulk<capo::pcg32, std::uniform_real_distribution<float>>(0.5, 1.0 / 12);
+    check_bulk<capo::xoshiro256ss_x8, std::bernoulli_distribution>(0.3, 0.21, 0.3);
+    check_bulk<capo::xoshiro256ss_x8, std::normal_distribution<double>>(10, 4, 10.0, 2.0);
+    check_bulk<capo::xoroshiro128p, std::normal_distribution<float>>(0, 1);
+    check_bulk<std::mt19937_64, std::uniform_real_distribution<double>>(0.5, 1.0 / 12);
+    // the fallbacks
+    check_bulk<capo::xoshiro256ss_x8, std::exponential_distribution<double>>(0.5, 0.25, 2.0);
+    check_bulk<std::minstd_rand, std::uniform_int_distribution<int>>(0, 1.0 / 3 * 100 * 101 / 1, -100, 100);
+    check_bulk<std::minstd_rand, std::uniform_real_distribution<double>>(pi / 2, pi * pi / 12, 0.0, pi);
+
+    std::vector<bool> bits(1000);
+    capo::random<capo::xoshiro256ss_x4, std::bernoulli_distribution> all { capo::use::seed{ 1 }, 1.0 };
+    all.fill(bits);
+    EXPECT_EQ(1000, std::count(bits.begin(), bits.end(), true));
+    capo::random<capo::xoshiro256ss_x4, std::bernoulli_distribution> none { capo::use::seed{ 1 }, 0.0 };
+    none.fill(bits);
+    EXPECT_EQ(0, std::count(bits.begin(), bits.end(), true));
+
+    std::vector<int> dice(10000);
+    capo::random<capo::xoshiro256ss_x8> r { capo::use::seed{ 9 }, 1, 6 };
+    r.fill(dice);
+    EXPECT_EQ(1, *std::min_element(dice.begin(), dice.end()));
+    EXPECT_EQ(6, *std::max_element(dice.begin(), dice.end()));
+}
+
+TEST_METHOD(bulk_benchmark)
+{
+    std::vector<int>    iv(4096);
+    std::vector<double> dv(4096);
+    std::vector<char>   bv(4096);
+    capo::bench b;
+    capo::random<std::default_random_engine, std::uniform_int_distribution<int>> si { 0, 999 };
+    capo::random<capo::xoshiro256ss        , std::uniform_int_distribution<int>> xi { capo::use::seed{ 1 }, 0, 999 };
+    capo::random<capo::xoshiro256ss_x8     , std::uniform_int_distribution<int>> vi { capo::use::seed{ 1 }, 0, 999 };
+    b.run("uniform_int/std::default_random_engine/loop", [&] { for (auto& v : iv) v = si(); capo::do_not_optimize(iv.data()); });
+    b.run("uniform_int/capo::xoshiro256ss/loop"        , [&] { for (auto& v : iv) v = xi(); capo::do_not_optimize(iv.data()); });
+    b.run("uniform_int/capo::xoshiro256ss/fill"        , [&] { xi.fill(iv); capo::do_not_optimize(iv.data()); });
+    b.run("uniform_int/capo::xoshiro256ss_x8/fill"     , [&] { vi.fill(iv); capo::do_not_optimize(iv.data()); });
+
+    capo::random<std::default_random_engine, std::uniform_real_distribution<>> sr;
+    capo::random<capo::xoshiro256ss_x8     , std::uniform_real_distribution<>> vr { capo::use::seed{ 1 } };
+    b.run("uniform_real/std::default_random_engine/loop", [&] { for (auto& v : dv) v = sr(); capo::do_not_optimize(dv.data()); });
+    b.run("uniform_real/capo::xoshiro256ss_x8/fill"     , [&] { vr.fill(dv); capo::do_not_optimize(dv.data()); });
+
+    capo::random<std::default_random_engine, std::bernoulli_distribution> sb { 0.3 };
+    capo::random<capo::xoshiro256ss_x8     , std::bernoulli_distribution> vb { capo::use::seed{ 1 }, 0.3 };
+    b.run("bernoulli/std::default_random_engine/loop", [&] { for (auto& v : bv) v = sb(); capo::do_not_optimize(bv.data()); });
+    b.run("bernoulli/capo::xoshiro256ss_x8/fill"     , [&] { vb.fill(bv); capo::do_not_optimize(bv.data()); });
+
+    capo::random<std::default_random_engine, std::normal_distribution<>> sn;
+    capo::random<capo::xoshiro256ss_x8     , std::normal_distribution<>> vn { capo::use::seed{ 1 } };
+    b.run("normal/std::default_random_engine/loop", [&] { for (auto& v : dv) v = sn(); capo::do_not_optimize(dv.data()); });
+    b.run("normal/capo::xoshiro256ss_x8/fill"     , [&] { vn.fill(dv); capo::do_not_optimize(dv.data()); });
+}
+
+TEST_METHOD(streams)
+{
+    // every stream of the same seed differs, and is reproducible
+    capo::random<capo::xoshiro256ss> x0 { capo::use::stream{ 42, 0 } }, x1 { capo::use::stream{ 42, 1 } };
+    capo::xoshiro256ss j { 42 };
+    j.jump();
+    EXPECT_EQ(capo::xoshiro256ss{ 42 }, x0.engine());
+    EXPECT_EQ(j, x1.engine());
+    capo::random<capo::pcg32> p1 { capo::use::stream{ 42, 1 } };
+    EXPECT_EQ((capo::pcg32{ 42, 1 }), p1.engine());
+    capo::random<std::mt19937> m1 { capo::use::stream{ 42, 1 } }, m2 { capo::use::stream{ 42, 2 } };
+    EXPECT_NE(m1.engine(), m2.engine());
+
+    using rand_t = capo::random<capo::xoshiro256ss, std::uniform_int_distribution<uint64_t>>;
+    const int thread_count = 4, count = 1000;
+    capo::thread_random_seed(42);
+    std::vector<std::vector<uint64_t>> got(thread_count);
+    std::vector<std::thread> ths;
+    for (int t = 0; t < thread_count; ++t)
+    {
+        ths.emplace_back([&got, t]
+        {
+            capo::thread_random_index(static_cast<uint64_t>(t));
+            auto& r = capo::thread_random<capo::xoshiro256ss, std::uniform_int_distribution<uint64_t>>();
+            EXPECT_EQ(&r, (&capo::thread_random<capo::xoshiro256ss, std::uniform_int_distribution<uint64_t>>()));
+            for (int i = 0; i < count; ++i) got[t].push_back(r());
+        });
+    }
+    for (auto& th : ths) th.join();
+    std::set<uint64_t> all;
+    for (int t = 0; t < thread_count; ++t)
+    {
+        rand_t expected { capo::use::stream{ 42, static_cast<uint64_t>(t) } };
+        for (int i = 0; i < count; ++i) ASSERT_EQ(expected(), got[t][i]);
+        all.insert(got[t].begin(), got[t].end());
+    }
+    EXPECT_EQ(static_cast<size_t>(thread_count * count), all.size());
+
+    // indexed by the order of the first use
+    ths.clear();
+    std::vector<int> first(thread_count);
+    for (int t = 0; t < thread_count; ++t)
+    {
+        ths.emplace_back([&first, t] { first[t] = capo::thread_random<capo::pcg32>()(); });
+    }
+    for (auto& th : ths) th.join();
+    EXPECT_EQ(static_cast<size_t>(thread_count), std::set<int>(first.begin(), first.end()).size());
+}
+
+TEST_METHOD(thread_reuse)
+{
+    // the randoms of the exited threads are reused, instead of taking new streams
+    auto& st = capo::detail_random::thread_state::instance();
+    std::set<uint64_t> all;
+    uint64_t index = st.next_index_.load();
+    for (int t = 0; t < 64; ++t)
+    {
+        std::thread { [&all]
+        {
+            auto& r = capo::thread_random<capo::xoroshiro128p, std::uniform_int_distribution<uint64_t>>();
+            for (int i = 0; i < 10; ++i) all.insert(r());
+        } }.join();
+    }
+    EXPECT_GE(index + 1, st.next_index_.load());
+    EXPECT_EQ(size_t(640), all.size()); // a reused stream goes on
+}
+
+TEST_METHOD(thread_out_of_tls_keys)
+{
+    std::vector<std::unique_ptr<capo::thread_local_ptr<int>>> keys;
+    for (int i = 0; i < 100000; ++i)
+    {
+        keys.emplace_back(new capo::thread_local_ptr<int>);
+        if (!keys.back()->valid()) break;
+    }
+    ASSERT_FALSE(keys.back()->valid());
+    // the first use is after the keys are run out
+    auto& r = capo::thread_random<capo::pcg64, std::uniform_int_distribution<uint64_t>>();
+    EXPECT_EQ(&r, (&capo::thread_random<capo::pcg64, std::uniform_int_distribution<uint64_t>>()));
+    uint64_t a = r(), b = capo::thread_random<capo::pcg64, std::uniform_int_distribution<uint64_t>>()();
+    EXPECT_NE(a, b);
+    keys.clear();
+}
+
+TEST_METHOD(benchmark)
+{
+    capo::bench b;
+    std::default_random_engine e1;
+    std::mt19937               e2;
+    std::mt19937_64            e3;
+    capo::splitmix64           e4;
+    capo::xoshiro256ss         e5;
+    capo::xoroshiro128p        e6;
+    capo::pcg32                e7;
+    capo::pcg64                e8;
+    b.run("std::default_random_engine", [&] { capo::do_not_optimize(e1()); });
+    b.run("std::mt19937"              , [&] { capo::do_not_optimize(e2()); });
+    b.run("std::mt19937_64"           , [&] { capo::do_not_optimize(e3()); });
+    b.run("capo::splitmix64"          , [&] { capo::do_not_optimize(e4()); });
+    b.run("capo::xoshiro256ss"        , [&] { capo::do_not_optimize(e5()); });
+    b.run("capo::xoroshiro128p"       , [&] { capo::do_not_optimize(e6()); });
+    b.run("capo::pcg32"               , [&] { capo::do_not_optimize(e7()); });
+    b.run("capo::pcg64"               , [&] { capo::do_not_optimize(e8()); });
+    b.run("seed/std::random_device"   , [&] { capo::random<> r; capo::do_not_optimize(r.engine()); });
+    b.run("seed/use::fast_seed"       , [&] { capo::random<capo::xoshiro256ss> r { capo::use::fast_seed{} }; capo::do_not_optimize(r.engine()); });
+    capo::random<capo::xoshiro256ss, std::uniform_real_distribution<>> ur { capo::use::fast_seed{} };
+    capo::random<std::default_random_engine, std::uniform_real_distribution<>> sr;
+    b.run("uniform_real/std::default_random_engine", [&] { capo::do_not_optimize(sr()); });
+    b.run("uniform_real/capo::xoshiro256ss"        , [&] { capo::do_not_optimize(ur()); });
+
+    std::mutex lc;
+    capo::random<capo::xoshiro256ss> shared { capo::use::fast_seed{} };
+    b.run_threads("shared+std::mutex", { 1, 2, 4 }, [&](size_t)
+    {
+        std::lock_guard<std::mutex> guard { lc };
+        capo::do_not_optimize(shared());
+    });
+    b.run_threads("thread_random", { 1, 2, 4 }, [&](size_t)
+    {
+        capo::do_not_optimize(capo::thread_random()());
+    });
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "capo/random.hpp"
+#include "capo/random_engine.hpp"
+#include "capo/bench.hpp"
+
+#include <random>
+#include <vector>
+#include <set>
+#include <thread>
+#include <memory>
+#include <mutex>
+#include <cmath>
+#include <algorithm>
+#include <cstdint>
+
+namespace ut_random_ {
+
+template <typename EngineT, size_t N>
+void expect_sequence(EngineT& eng, const typename EngineT::result_type (&expected)[N])
+{
+    for (auto v : expected) EXPECT_EQ(v, eng());
+}
+
+template <typename T>
+void moments(const std::vector<T>& v, double& mean, double& var)
+{
+    mean = var = 0;
+    for (auto x : v) mean += static_cast<double>(x);
+    mean /= v.size();
+    for (auto x : v) var += (static_cast<double>(x) - mean) * (static_cast<double>(x) - mean);
+    var /= v.size();
+}
+
+/*
+    Checks the bulk results of the engines, against the moments of the distribution.
+*/
+template <typename EngineT, typename DistT, typename... A>
+void check_bulk(double mean, double var, A... args)
+{
+    using value_t = typename DistT::result_type;
+    capo::random<EngineT, DistT> r1 { capo::use::seed{ 123 }, args... }, r2 { capo::use::seed{ 123 }, args... };
+    std::vector<value_t> v1(100001), v2(v1.size());
+    r1.fill(v1);
+    r2.generate_n(v2.begin(), 1000);
+    r2.fill(v2.begin() + 1000, v2.end());
+    EXPECT_TRUE(v1 == v2) << "the results should only depend on the seed";
+    double m, s;
+    moments(v1, m, s);
+    EXPECT_NEAR(mean, m, 0.02 * std::sqrt(var) + 1e-9);
+    EXPECT_NEAR(var , s, 0.05 * var + 1e-9);
+}
+
+} // namespace ut_random_
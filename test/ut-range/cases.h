@@ -155,3 +155,66 @@ TEST_METHOD(char_case)
         ++i;
     }
 }
+
+TEST_METHOD(random_access)
+{
+    auto r = capo::range(10, 1000000, 3);
+    auto b = r.begin(), e = r.end();
+    EXPECT_EQ(static_cast<std::ptrdiff_t>(r.size()), e - b);
+    EXPECT_EQ(static_cast<std::ptrdiff_t>(r.size()), std::distance(b, e));
+    EXPECT_EQ(10 + 3 * 1000, b[1000]);
+    EXPECT_EQ(10 + 3 * 1000, *(b + 1000));
+    EXPECT_EQ(10 + 3 * 999 , *(1000 + b - 1));
+    EXPECT_TRUE(b < e);
+    EXPECT_TRUE(b + 5 >= b + 5);
+
+    auto it = b;
+    std::advance(it, 12345);
+    EXPECT_EQ(10 + 3 * 12345, *it);
+    EXPECT_EQ(10 + 3 * 12346, *++it);
+    it -= 12346;
+    EXPECT_EQ(10, *it);
+
+    auto lb = std::lower_bound(b, e, 500000);
+    EXPECT_EQ(500002, *lb);
+    EXPECT_EQ(lb, std::partition_point(b, e, [](int x) { return x < 500000; }));
+
+    // split in O(1)
+    auto mid = b + (e - b) / 2;
+    EXPECT_EQ(static_cast<std::ptrdiff_t>(r.size()), (mid - b) + (e - mid));
+    EXPECT_EQ(*(mid - 1) + 3, *mid);
+
+    auto d = capo::range(8, 7, -0.1);
+    EXPECT_DOUBLE_EQ(7.5, d.begin()[5]);
+    EXPECT_DOUBLE_EQ(7.1, *(d.end() - 1));
+
+    // The elements are values, so a reverse_iterator doesn't dangle
+    static_assert(std::is_same<int, std::iterator_traits<decltype(b)>::reference>::value, "");
+    auto rb = std::make_reverse_iterator(capo::range(0, 10, 1).end());
+    EXPECT_EQ(9, *rb);
+    EXPECT_EQ(7, rb[2]);
+    std::vector<int> rev(std::make_reverse_iterator(capo::range(0, 5, 1).end()),
+                         std::make_reverse_iterator(capo::range(0, 5, 1).begin()));
+    EXPECT_EQ((std::vector<int> { 4, 3, 2, 1, 0 }), rev);
+}
+
+TEST_METHOD(materialize)
+{
+    using namespace ut_range_;
+
+    auto r = capo::range(-7, 1000, 3);
+    std::vector<int> v(r.size());
+    EXPECT_EQ(v.data() + v.size(), capo::materialize(r, v.data()));
+    EXPECT_TRUE(std::equal(v.begin(), v.end(), r.begin()));
+
+    auto f = capo::range(1.5f, -2.f, -0.1f);
+    std::vector<float> fv;
+    capo::materialize(f, std::back_inserter(fv));
+    ASSERT_EQ(f.size(), fv.size());
+    for (size_t i = 0; i < fv.size(); ++i) EXPECT_EQ(f.begin()[i], fv[i]) << "At index: " << i;
+
+    std::vector<Foo> xv;
+    capo::materialize(capo::range(Foo(15), Foo(20.7), 0.8), std::back_inserter(xv)); // the generic way
+    EXPECT_EQ(8u, xv.size());
+    EXPECT_DOUBLE_EQ(20.6, (double)xv.back());
+}
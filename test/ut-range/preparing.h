@@ -5,6 +5,10 @@
 #include "capo/type_traits.hpp"
 #include "capo/concept.hpp"
 
+#include <iterator>
+#include <algorithm>
+#include <vector>
+
 namespace ut_range_ {
     
 class Foo : capo::inherit_chain<Foo, capo::unequal     , capo::comparable
@@ -0,0 +1,138 @@
+#pragma once
+
+TEST_METHOD(orders)
+{
+    using namespace ut_range_nd_;
+
+    auto rm = capo::range_nd(2, 3);
+    EXPECT_EQ(6u, rm.size());
+    EXPECT_EQ((std::vector<p2>{ { 0, 0 }, { 0, 1 }, { 0, 2 }, { 1, 0 }, { 1, 1 }, { 1, 2 } }), collect(rm));
+
+    auto cm = capo::range_nd<capo::use::column_major>(2, 3);
+    EXPECT_EQ((std::vector<p2>{ { 0, 0 }, { 1, 0 }, { 0, 1 }, { 1, 1 }, { 0, 2 }, { 1, 2 } }), collect(cm));
+
+    auto zm = capo::range_nd<capo::use::morton>(4, 4);
+    EXPECT_EQ((std::vector<p2>{ { 0, 0 }, { 1, 0 }, { 0, 1 }, { 1, 1 }, { 2, 0 }, { 3, 0 }, { 2, 1 }, { 3, 1 },
+                                { 0, 2 }, { 1, 2 }, { 0, 3 }, { 1, 3 }, { 2, 2 }, { 3, 2 }, { 2, 3 }, { 3, 3 } }),
+              collect(zm));
+
+    /* the extents not being powers of 2 */
+    auto zx = collect(capo::range_nd<capo::use::morton>(5, 3, 7));
+    EXPECT_EQ(105u, zx.size());
+    std::set<std::array<int, 3>> uniq(zx.begin(), zx.end());
+    EXPECT_EQ(105u, uniq.size());
+    EXPECT_EQ((std::array<int, 3>{{ 0, 0, 0 }}), zx.front());
+}
+
+TEST_METHOD(dimensions)
+{
+    using namespace ut_range_nd_;
+
+    auto r = capo::range_nd(capo::range(10, 20, 5), capo::range(3, 0, -1));
+    EXPECT_EQ(2u, r.extent(0));
+    EXPECT_EQ(3u, r.extent(1));
+    EXPECT_EQ((std::vector<p2>{ { 10, 3 }, { 10, 2 }, { 10, 1 }, { 15, 3 }, { 15, 2 }, { 15, 1 } }), collect(r));
+
+    auto d = capo::range_nd(capo::range(0.0, 1.0, 0.25), 2);
+    EXPECT_EQ(8u, d.size());
+    EXPECT_DOUBLE_EQ(0.75, (*(d.begin() + 6))[0]);
+    EXPECT_DOUBLE_EQ(1.0 , (*(d.begin() + 7))[1]);
+
+    /* random access on row-major */
+    auto big = capo::range_nd(100, 200, 300);
+    auto b   = big.begin();
+    auto it = b + (7 * 200 * 300 + 8 * 300 + 9);
+    EXPECT_EQ((std::array<int, 3>{{ 7, 8, 9 }}), *it);
+    EXPECT_EQ((std::array<size_t, 3>{{ 7, 8, 9 }}), it.index());
+    EXPECT_EQ((std::array<int, 3>{{ 7, 8, 8 }}), it[-1]);
+    EXPECT_EQ(7 * 200 * 300 + 8 * 300 + 9, it - b);
+
+    EXPECT_THROW(capo::range_nd<capo::use::morton>(size_t(1) << 40, size_t(1) << 30), std::logic_error);
+}
+
+TEST_METHOD(tiles)
+{
+    using namespace ut_range_nd_;
+
+    auto r  = capo::range_nd(5, 7);
+    auto ts = r.tile(2, 3);
+    EXPECT_EQ(9u, ts.size());
+    std::vector<int> hit(35);
+    size_t n = 0;
+    for (auto t : ts)
+    {
+        EXPECT_LE(t.extent(0), 2u);
+        EXPECT_LE(t.extent(1), 3u);
+        for (auto p : t) ++hit[p[0] * 7 + p[1]];
+        ++n;
+    }
+    EXPECT_EQ(9u, n);
+    for (int h : hit) EXPECT_EQ(1, h);
+
+    auto last = ts.begin()[8];
+    EXPECT_EQ((std::vector<p2>{ { 4, 6 } }), collect(last));
+    EXPECT_EQ((std::vector<p2>{ { 2, 3 }, { 2, 4 }, { 2, 5 }, { 3, 3 }, { 3, 4 }, { 3, 5 } }), collect(ts.begin()[4]));
+
+    /* the tiles of a morton range are in the morton order too */
+    auto zt = capo::range_nd<capo::use::morton>(capo::range(0, 16, 2), 8).tile(2, 4);
+    std::vector<p2> firsts;
+    for (auto t : zt) firsts.push_back(*t.begin());
+    EXPECT_EQ((std::vector<p2>{ { 0, 0 }, { 4, 0 }, { 0, 4 }, { 4, 4 }, { 8, 0 }, { 12, 0 }, { 8, 4 }, { 12, 4 } }), firsts);
+}
+
+TEST_METHOD(parallel)
+{
+    using namespace ut_range_nd_;
+
+    std::vector<std::atomic<int>> hit(64 * 48);
+    for (auto& h : hit) h = 0;
+    auto r = capo::range_nd(64, 48);
+    capo::parallel_for_each(r.tile(16, 16), [&](const decltype(r)& t)
+    {
+        for (auto p : t) ++hit[static_cast<size_t>(p[0] * 48 + p[1])];
+    }, 4);
+    for (auto& h : hit) EXPECT_EQ(1, h);
+
+    std::atomic<int> tiles { 0 };
+    capo::parallel_for_each(capo::range_nd<capo::use::morton>(33, 17).tile(8, 8), [&](const auto&) { ++tiles; }, 3);
+    EXPECT_EQ(15, tiles);
+
+    EXPECT_THROW(capo::parallel_for_each(capo::range(10), [](int i)
+    {
+        if (i == 5) throw std::runtime_error("5");
+    }, 2), std::runtime_error);
+}
+
+TEST_METHOD(benchmark)
+{
+    using namespace ut_range_nd_;
+
+    const int n = 1024;
+    std::vector<float> a(n * n), t(n * n);
+    for (size_t i = 0; i < a.size(); ++i) a[i] = static_cast<float>(i);
+    capo::bench b;
+    b.samples(5);
+
+    b.run("transpose/hand-written", [&]
+    {
+        for (int i = 0; i < n; ++i)
+            for (int j = 0; j < n; ++j) t[j * n + i] = a[i * n + j];
+        capo::do_not_optimize(t.data());
+    });
+    b.run("transpose/range_nd", [&]
+    {
+        for (auto p : capo::range_nd(n, n)) t[p[1] * n + p[0]] = a[p[0] * n + p[1]];
+        capo::do_not_optimize(t.data());
+    });
+    b.run("transpose/range_nd tiles 32x32", [&]
+    {
+        for (auto tl : capo::range_nd(n, n).tile(32, 32))
+            for (auto p : tl) t[p[1] * n + p[0]] = a[p[0] * n + p[1]];
+        capo::do_not_optimize(t.data());
+    });
+    b.run("transpose/range_nd morton", [&]
+    {
+        for (auto p : capo::range_nd<capo::use::morton>(n, n)) t[p[1] * n + p[0]] = a[p[0] * n + p[1]];
+        capo::do_not_optimize(t.data());
+    });
+}
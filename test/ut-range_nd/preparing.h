@@ -0,0 +1,27 @@
+#pragma once
+
+#include "capo/range_nd.hpp"
+#include "capo/bench.hpp"
+
+#include <vector>
+#include <array>
+#include <set>
+#include <atomic>
+#include <stdexcept>
+#include <iterator>
+#include <algorithm>
+#include <cstdint>
+
+namespace ut_range_nd_ {
+
+template <typename R>
+auto collect(const R& r)
+{
+    std::vector<typename R::value_type> ret;
+    for (auto p : r) ret.push_back(p);
+    return ret;
+}
+
+using p2 = std::array<int, 2>;
+
+} // namespace ut_range_nd_
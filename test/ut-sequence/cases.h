@@ -32,3 +32,85 @@ TEST_METHOD(fibonacci)
         EXPECT_EQ(fb[i], x) << "At index: " << i;
     }
 }
+
+TEST_METHOD(random_access)
+{
+    auto xx = capo::sequence<capo::use::arithmetic<2>, int>(1, 21, 1);
+    auto b  = xx.begin(), e = xx.end();
+    EXPECT_EQ(20, e - b);
+    EXPECT_EQ(39, b[19]);
+    EXPECT_EQ(21, *(b + 10));
+    EXPECT_EQ(25, *std::lower_bound(b, e, 24));
+    auto it = b + 15;
+    EXPECT_EQ(29, *--it);
+    EXPECT_EQ(19, *(it -= 5));
+
+    auto gg = capo::sequence<capo::use::geometric<3>, unsigned long long>(1, 30, 1ull);
+    EXPECT_EQ(29, std::distance(gg.begin(), gg.end()));
+    EXPECT_EQ(6561ull, gg.begin()[8]);
+    EXPECT_EQ(22876792454961ull, *(gg.end() - 1)); // 3 ^ 28
+    EXPECT_EQ(59049ull, *std::lower_bound(gg.begin(), gg.end(), 50000ull));
+
+    auto ff = capo::sequence<capo::use::fibonacci, unsigned long long>(0, 90, 0ull, 1ull);
+    auto fb = ff.begin();
+    EXPECT_EQ(6765ull, fb[20]);
+    EXPECT_EQ(1779979416004714189ull, *(ff.end() - 1)); // F(89)
+    std::advance(fb, 50);
+    EXPECT_EQ(12586269025ull, *fb);
+    EXPECT_EQ(20365011074ull, *++fb);
+    EXPECT_EQ(7778742049ull , fb[-2]);
+}
+
+TEST_METHOD(materialize)
+{
+    auto xx = capo::sequence<capo::use::arithmetic<3>, int>(1, 1001, 5);
+    std::vector<int> xv(xx.size());
+    EXPECT_EQ(xv.data() + xv.size(), capo::materialize(xx, xv.data()));
+    EXPECT_TRUE(std::equal(xv.begin(), xv.end(), xx.begin()));
+
+    std::vector<int> xl;
+    capo::materialize(xx, std::back_inserter(xl));
+    EXPECT_EQ(xv, xl);
+
+    auto dd = capo::sequence<capo::use::arithmetic<-1>, double>(1, 20, 0.5);
+    std::vector<double> dv(dd.size());
+    capo::materialize(dd, dv.data());
+    for (size_t i = 0; i < dv.size(); ++i) EXPECT_EQ(dd.begin()[i], dv[i]) << "At index: " << i;
+
+    auto gg = capo::sequence<capo::use::geometric<3>, unsigned long long>(1, 50, 1ull); // wraps around
+    std::vector<unsigned long long> gv(gg.size());
+    capo::materialize(gg, gv.data());
+    EXPECT_TRUE(std::equal(gv.begin(), gv.end(), gg.begin()));
+
+    auto gd = capo::sequence<capo::use::geometric<-2>, double>(1, 40, 0.75);
+    std::vector<double> gdv(gd.size());
+    capo::materialize(gd, gdv.data());
+    EXPECT_TRUE(std::equal(gdv.begin(), gdv.end(), gd.begin()));
+
+    auto ff = capo::sequence<capo::use::fibonacci, unsigned long long>(0, 30, 0ull, 1ull);
+    std::vector<unsigned long long> fv(ff.size());
+    capo::materialize(ff, fv.data());
+    EXPECT_EQ(514229ull, fv.back());
+
+    // a wider output type, is the same as std::copy
+    auto rr = capo::range(0, 20, 3);
+    std::vector<long> rv(rr.size());
+    EXPECT_EQ(rv.data() + rv.size(), capo::materialize(rr, rv.data()));
+    EXPECT_EQ((std::vector<long> { 0, 3, 6, 9, 12, 15, 18 }), rv);
+    std::vector<double> rd(rr.size());
+    capo::materialize(rr, rd.data());
+    EXPECT_TRUE(std::equal(rd.begin(), rd.end(), rr.begin()));
+}
+
+TEST_METHOD(materialize_benchmark)
+{
+    auto xx = capo::sequence<capo::use::arithmetic<4>, int>(1, 4097, 0);
+    auto gg = capo::sequence<capo::use::geometric<3>, uint64_t>(1, 4097, uint64_t(1));
+    std::vector<int>      xv(xx.size());
+    std::vector<uint64_t> gv(gg.size());
+    capo::bench b;
+    b.run("arithmetic/int/std::copy"   , [&] { std::copy(xx.begin(), xx.end(), xv.data()); capo::do_not_optimize(xv.data()); });
+    b.run("arithmetic/int/materialize" , [&] { capo::materialize(xx, xv.data()); capo::do_not_optimize(xv.data()); });
+    b.run("geometric/uint64/std::copy"  , [&] { std::copy(gg.begin(), gg.end(), gv.data()); capo::do_not_optimize(gv.data()); });
+    b.run("geometric/uint64/materialize", [&] { capo::materialize(gg, gv.data()); capo::do_not_optimize(gv.data()); });
+}
@@ -1,4 +1,11 @@
 #pragma once
 
 #include "capo/sequence.hpp"
+#include "capo/range.hpp"
 #include "capo/countof.hpp"
+#include "capo/bench.hpp"
+
+#include <iterator>
+#include <algorithm>
+#include <vector>
+#include <cstdint>
@@ -85,7 +85,16 @@ TEST_METHOD(types_insert)
     }
     {
         using t_t = types_insert_t<types_t, 2, types<void, void*, void**>>;
-        EXPECT_EQ((type_name<types<short, int, void, void*, void**, unsigned char, long long, float&, const double, long*>>()), type_name<t_t>());
+        EXPECT_EQ((type_name<types<short, int, types<void, void*, void**>, unsigned char, long long, float&, const double, long*>>()), type_name<t_t>());
+    }
+    {
+        using t_t = types_insert_t<types<int, types<char>>, 1, types<void, types<void*>>>;
+        EXPECT_EQ((type_name<types<int, types<void, types<void*>>, types<char>>>()), type_name<t_t>());
+        EXPECT_EQ(3, types_size<t_t>::value);
+    }
+    {
+        using t_t = types_insert_t<std::tuple<int>, 0, types<>>;
+        EXPECT_EQ((type_name<std::tuple<types<>, int>>()), type_name<t_t>());
     }
     {
         //using t_t = types_insert_t<types_t, types_size<types_t>::value + 1, void>;
@@ -241,4 +250,49 @@ TEST_METHOD(types_sort_if)
         using t_t = types_sort_if_t<types<int>, is_large>;
         EXPECT_EQ((type_name<types<int>>()), type_name<t_t>());
     }
-}
\ No newline at end of file
+}
+
+TEST_METHOD(types_long)
+{
+    using namespace ut_type_list_;
+    using l_t = tags_t<1000>;
+    EXPECT_EQ(1000, types_size<l_t>::value);
+    EXPECT_EQ(type_name<tag<999>>(), type_name<types_back_t<l_t>>());
+    EXPECT_EQ(type_name<tag<512>>(), (type_name<types_at_t<l_t, 512>>()));
+    EXPECT_EQ(777, (types_find<l_t, tag<777>>::value));
+    EXPECT_EQ(type_name<tag<999>>(), type_name<types_front_t<types_reverse_t<l_t>>>());
+    {
+        using t_t = types_erase_t<l_t, 1, 998>;
+        EXPECT_EQ((type_name<types<tag<0>, tag<999>>>()), type_name<t_t>());
+    }
+    {
+        using t_t = types_insert_t<l_t, 500, void>;
+        EXPECT_EQ(type_name<void>(), (type_name<types_at_t<t_t, 500>>()));
+        EXPECT_EQ(type_name<tag<500>>(), (type_name<types_at_t<t_t, 501>>()));
+    }
+    {
+        using t_t = types_compact_t<types_link_t<tags_t<300>, types_reverse_t<tags_t<300>>>>;
+        EXPECT_EQ(type_name<tags_t<300>>(), type_name<t_t>());
+    }
+    {
+        using t_t = types_remove_t<l_t, types<tag<0>, tag<999>>>;
+        EXPECT_EQ((type_name<tags_t<999>>()), (type_name<types_insert_t<t_t, 0, tag<0>>>()));
+    }
+    {
+        using t_t = types_assign_t<1000, int>;
+        EXPECT_EQ(1000, types_size<t_t>::value);
+    }
+    {
+        // The last one wins if neither of them is better
+        using t_t = types_select_if_t<l_t, is_large>;
+        EXPECT_EQ(type_name<tag<987>>(), type_name<t_t>());
+    }
+    {
+        using t_t = types_sort_if_t<tags_t<200>, is_large>;
+        EXPECT_EQ(200, types_size<t_t>::value);
+        // The equivalent ones are in reverse order
+        EXPECT_EQ(type_name<tag<194>>(), type_name<types_front_t<t_t>>());
+        EXPECT_EQ(type_name<tag<0>>()  , type_name<types_back_t<t_t>>());
+        EXPECT_EQ(type_name<tag<13>>() , (type_name<types_at_t<t_t, 198>>()));
+    }
+}
@@ -4,6 +4,8 @@
 #include "capo/type_name.hpp"
 
 #include <tuple>
+#include <utility>
+#include <cstddef>
 
 namespace ut_type_list_ {
 
@@ -13,4 +15,24 @@ using types_t = types<short, int, unsigned char, long long, float&, const double
 template <typename T, typename U>
 struct is_large : std::integral_constant<bool, (sizeof(T) > sizeof(U))> {};
 
+/*
+    The long type-lists, for checking the instantiation depth.
+    The size of tag<I> is (I % 13 + 1).
+*/
+
+template <size_t I>
+struct tag { char c_[I % 13 + 1]; };
+
+template <typename Seq>
+struct make_tags;
+
+template <size_t... I>
+struct make_tags<std::index_sequence<I...>>
+{
+    using type = types<tag<I>...>;
+};
+
+template <size_t N>
+using tags_t = typename make_tags<std::make_index_sequence<N>>::type;
+
 } // namespace ut_type_list_
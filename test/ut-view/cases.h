@@ -0,0 +1,176 @@
+#pragma once
+
+TEST_METHOD(transform_filter)
+{
+    using namespace ut_view_;
+    namespace v = capo::view;
+
+    auto src = iota(10);
+    auto sq  = src | v::transform([](int x) { return x * x; });
+    EXPECT_TRUE(is_random_access(sq));
+    EXPECT_EQ(10, sq.end() - sq.begin());
+    EXPECT_EQ(49, sq.begin()[7]);
+    EXPECT_EQ((std::vector<int>{ 0, 1, 4, 9, 16, 25, 36, 49, 64, 81 }), to_vector(sq));
+
+    auto odd = v::filter(src, [](int x) { return (x & 1) != 0; });
+    EXPECT_FALSE(is_random_access(odd));
+    EXPECT_EQ((std::vector<int>{ 1, 3, 5, 7, 9 }), to_vector(odd));
+
+    /* the elements of an lvalue container are writable through filter */
+    for (auto& x : src | v::filter([](int x) { return x > 7; })) x = 0;
+    EXPECT_EQ((std::vector<int>{ 0, 1, 2, 3, 4, 5, 6, 7, 0, 0 }), src);
+
+    std::list<int> ls { 1, 2, 3, 4 };
+    EXPECT_EQ((std::vector<int>{ 4, 8 }),
+              to_vector(ls | v::filter([](int x) { return x % 2 == 0; }) | v::transform([](int x) { return x * 2; })));
+}
+
+TEST_METHOD(take_drop)
+{
+    using namespace ut_view_;
+    namespace v = capo::view;
+
+    auto r = capo::range(100) | v::drop(10) | v::take(5);
+    EXPECT_TRUE(is_random_access(r));
+    EXPECT_EQ(5, std::distance(r.begin(), r.end()));
+    EXPECT_EQ((std::vector<int>{ 10, 11, 12, 13, 14 }), to_vector(r));
+
+    EXPECT_EQ((std::vector<int>{ 0, 1, 2 }), to_vector(v::take(iota(3), 10)));
+    EXPECT_TRUE(to_vector(v::drop(iota(3), 10)).empty());
+
+    /* the views own the rvalues, nothing dangles */
+    auto fib = capo::sequence<capo::use::fibonacci, unsigned long long>(0, 20, 0ull, 1ull)
+             | v::filter([](unsigned long long x) { return x % 2 == 0; })
+             | v::take(4);
+    EXPECT_EQ((std::vector<unsigned long long>{ 0, 2, 8, 34 }), to_vector(fib));
+
+    std::list<int> ls { 1, 2, 3, 4, 5 };
+    EXPECT_EQ((std::vector<int>{ 3, 4 }), to_vector(ls | v::drop(2) | v::take(2)));
+}
+
+TEST_METHOD(stride_chunk)
+{
+    using namespace ut_view_;
+    namespace v = capo::view;
+
+    auto s = iota(10) | v::stride(3);
+    EXPECT_TRUE(is_random_access(s));
+    EXPECT_EQ((std::vector<int>{ 0, 3, 6, 9 }), to_vector(s));
+    EXPECT_EQ(4, s.end() - s.begin());
+    EXPECT_EQ(9, *(s.end() - 1));
+    EXPECT_EQ(6, *(--(--s.end())));
+    EXPECT_EQ(s.end(), s.begin() + 4);
+
+    auto t = iota(9) | v::stride(3);
+    EXPECT_EQ(3, t.end() - t.begin());
+    EXPECT_EQ(6, *(t.end() - 1));
+
+    auto c = iota(7) | v::chunk(3);
+    EXPECT_EQ(3, c.end() - c.begin());
+    std::vector<std::vector<int>> cs;
+    for (auto sub : c) cs.push_back(to_vector(sub));
+    EXPECT_EQ((std::vector<std::vector<int>>{ { 0, 1, 2 }, { 3, 4, 5 }, { 6 } }), cs);
+    EXPECT_EQ(1u, c.begin()[2].size());
+
+    std::list<int> ls { 1, 2, 3, 4, 5 };
+    EXPECT_EQ((std::vector<int>{ 1, 3, 5 }), to_vector(ls | v::stride(2)));
+    EXPECT_EQ(3, std::distance((ls | v::chunk(2)).begin(), (ls | v::chunk(2)).end()));
+}
+
+TEST_METHOD(zip_enumerate)
+{
+    using namespace ut_view_;
+    namespace v = capo::view;
+
+    std::vector<std::string> names { "a", "b", "c" };
+    auto z = v::zip(capo::range(10), names);
+    EXPECT_TRUE(is_random_access(z));
+    EXPECT_EQ(3, z.end() - z.begin());
+    std::string s;
+    for (auto p : z) s += std::to_string(std::get<0>(p)) + std::get<1>(p);
+    EXPECT_EQ("0a1b2c", s);
+    EXPECT_EQ("c", std::get<1>(z.begin()[2]));
+    EXPECT_EQ(2  , std::get<0>(z.begin()[2]));
+    EXPECT_EQ(7  , (capo::range(10) | v::transform([](int x) { return x + 5; })).begin()[2]);
+
+    std::list<int> ls { 7, 8, 9, 10 };
+    for (auto p : v::zip(ls, names)) std::get<1>(p) += "!";
+    EXPECT_EQ("c!", names[2]);
+
+    size_t n = 0;
+    for (auto p : names | v::enumerate())
+    {
+        EXPECT_EQ(n, p.first);
+        EXPECT_EQ(names[n], p.second);
+        ++n;
+    }
+    EXPECT_EQ(3u, n);
+    auto e = v::enumerate(iota(5) | v::stride(2));
+    EXPECT_EQ(2u, (*(e.begin() + 2)).first);
+    EXPECT_EQ(4 , (*(e.begin() + 2)).second);
+}
+
+TEST_METHOD(algorithms)
+{
+    using namespace ut_view_;
+    namespace v = capo::view;
+
+    auto sq = capo::range(1000) | v::transform([](int x) { return x * 2; });
+    auto it = std::lower_bound(sq.begin(), sq.end(), 501);
+    EXPECT_EQ(251, it - sq.begin());
+    EXPECT_EQ(502, *it);
+    EXPECT_EQ(999 * 1000, std::accumulate(sq.begin(), sq.end(), 0));
+
+    auto rev = to_vector(v::take(capo::range(5), 5));
+    std::reverse(rev.begin(), rev.end());
+    EXPECT_EQ((std::vector<int>{ 4, 3, 2, 1, 0 }), rev);
+}
+
+TEST_METHOD(benchmark)
+{
+    using namespace ut_view_;
+    namespace v = capo::view;
+
+    std::vector<int> src = iota(4096);
+    capo::bench b;
+
+    b.run("transform+take/hand-written", [&]
+    {
+        int64_t sum = 0;
+        for (size_t i = 0; i < 4000; ++i) sum += int64_t(src[i]) * 3 + 1;
+        capo::do_not_optimize(sum);
+    });
+    b.run("transform+take/view", [&]
+    {
+        int64_t sum = 0;
+        for (auto x : src | v::transform([](int x) { return int64_t(x) * 3 + 1; }) | v::take(4000)) sum += x;
+        capo::do_not_optimize(sum);
+    });
+
+    b.run("filter+transform/hand-written", [&]
+    {
+        int64_t sum = 0;
+        for (auto x : src) if (x % 3 == 0) sum += int64_t(x) * x;
+        capo::do_not_optimize(sum);
+    });
+    b.run("filter+transform/view", [&]
+    {
+        int64_t sum = 0;
+        for (auto x : src | v::filter([](int x) { return x % 3 == 0; })
+                          | v::transform([](int x) { return int64_t(x) * x; })) sum += x;
+        capo::do_not_optimize(sum);
+    });
+
+    b.run("zip+transform/hand-written", [&]
+    {
+        int64_t sum = 0;
+        for (size_t i = 0; i < src.size(); ++i) sum += int64_t(src[i]) * int64_t(i);
+        capo::do_not_optimize(sum);
+    });
+    b.run("zip+transform/view", [&]
+    {
+        int64_t sum = 0;
+        for (auto p : v::zip(src, capo::range(4096))) sum += int64_t(std::get<0>(p)) * std::get<1>(p);
+        capo::do_not_optimize(sum);
+    });
+}
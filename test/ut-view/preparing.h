@@ -0,0 +1,44 @@
+#pragma once
+
+#include "capo/view.hpp"
+#include "capo/range.hpp"
+#include "capo/sequence.hpp"
+#include "capo/bench.hpp"
+
+#include <vector>
+#include <list>
+#include <string>
+#include <tuple>
+#include <iterator>
+#include <algorithm>
+#include <numeric>
+#include <type_traits>
+#include <cstdint>
+
+namespace ut_view_ {
+
+template <typename R>
+auto to_vector(const R& r)
+{
+    std::vector<typename std::decay<decltype(*std::begin(r))>::type> ret;
+    for (auto&& x : r) ret.push_back(x);
+    return ret;
+}
+
+template <typename R>
+using category_of = typename std::iterator_traits<decltype(std::begin(std::declval<R&>()))>::iterator_category;
+
+template <typename R>
+constexpr bool is_random_access(const R&)
+{
+    return std::is_same<category_of<R>, std::random_access_iterator_tag>::value;
+}
+
+inline std::vector<int> iota(int n)
+{
+    std::vector<int> v(static_cast<size_t>(n));
+    for (int i = 0; i < n; ++i) v[static_cast<size_t>(i)] = i;
+    return v;
+}
+
+} // namespace ut_view_
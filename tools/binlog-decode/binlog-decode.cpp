@@ -0,0 +1,82 @@
+/*
+    The Capo Library
+    Code covered by the MIT License
+
+    Author: mutouyun (http://orzz.org)
+*/
+
+/*
+    Decodes a binary log written by capo::binlog_writer into text.
+
+    Usage: binlog-decode --input=<file> [--from=<ns>] [--to=<ns>]
+    The time range is in nanoseconds since epoch, both ends are inclusive.
+*/
+
+#include "capo/binlog.hpp"
+#include "capo/cmdline.hpp"
+#include "capo/printf.hpp"
+
+#include <string>
+#include <limits>
+#include <ctime>
+#include <cstdlib>
+#include <cstdint>
+
+namespace {
+
+std::string time_text(uint64_t ns)
+{
+    std::time_t sec = static_cast<std::time_t>(ns / 1000000000);
+    std::tm tm {};
+#if defined(CAPO_OS_WIN_)
+    ::localtime_s(&tm, &sec);
+#else /*!CAPO_OS_WIN_*/
+    ::localtime_r(&sec, &tm);
+#endif/*!CAPO_OS_WIN_*/
+    char buf[32];
+    std::strftime(buf, sizeof(buf), "%Y-%m-%d %H:%M:%S", &tm);
+    return buf;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    std::string input;
+    uint64_t from = 0, to = (std::numeric_limits<uint64_t>::max)();
+
+    capo::cmdline::parser cmd;
+    cmd.push(capo::cmdline::options
+    {
+        {
+            "-i", "--input", "The binary log file.", true, "",
+            [&](auto&, auto& str) { input = str; }
+        },
+        {
+            "-f", "--from", "Begin of the time range (ns since epoch).", false, "0",
+            [&](auto&, auto& str) { from = std::strtoull(str.c_str(), nullptr, 10); }
+        },
+        {
+            "-t", "--to", "End of the time range (ns since epoch).", false, "",
+            [&](auto&, auto& str) { if (!str.empty()) to = std::strtoull(str.c_str(), nullptr, 10); }
+        }
+    });
+    cmd.exec(argc, argv);
+    if (input.empty()) return 1;
+
+    capo::binlog_reader rd { input };
+    if (!rd.valid())
+    {
+        capo::printf("Cannot open binary log: %s\n", input.c_str());
+        return 1;
+    }
+    if (!rd.indexed())
+        capo::printf("Warning: %s has no index, the blocks are scanned.\n", input.c_str());
+    rd.read([](const capo::binlog_entry& e)
+    {
+        capo::printf("%s.%06u %s %s:%u %s\n", time_text(e.time_).c_str(),
+                     static_cast<unsigned>((e.time_ / 1000) % 1000000),
+                     capo::log_level_name(e.level_), e.file_, e.line_, e.text_.c_str());
+    }, from, to);
+    return 0;
+}
@@ -0,0 +1,167 @@
+/*
+    The Capo Library
+    Code covered by the MIT License
+
+    Author: mutouyun (http://orzz.org)
+*/
+
+/*
+    Measures the compile time and the peak memory of the capo::types_* algorithms,
+    on the type-lists with different lengths.
+
+    Usage: type_list-bench --include=<path> [--compiler=<cxx>] [--sizes=<n,n,...>]
+    <path> is the directory holding capo/type_list.hpp, so two checkouts can be compared.
+    Each algorithm is compiled alone with -fsyntax-only, a failed compilation
+    (e.g. exceeding the template instantiation depth) is reported as "failed".
+*/
+
+#include "capo/cmdline.hpp"
+#include "capo/printf.hpp"
+#include "capo/detect_plat.hpp"
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <chrono>
+#include <cstdlib>
+#include <cstdio>
+
+#if !defined(CAPO_OS_WIN_)
+#include <unistd.h>         // fork, execl
+#include <sys/wait.h>       // wait4
+#include <sys/resource.h>   // rusage
+#endif/*!CAPO_OS_WIN_*/
+
+namespace {
+
+/*
+    The list is generated by std::make_index_sequence,
+    so the source stays the same size whatever the length is.
+*/
+
+const char* const prologue = R"(#include "capo/type_list.hpp"
+#include <utility>
+#include <cstddef>
+
+constexpr int N = CAPO_BENCH_TYPES;
+
+template <size_t I> struct tag { char c_[I % 13 + 1]; };
+
+template <typename Seq> struct make;
+template <size_t... I> struct make<std::index_sequence<I...>> { using type = capo::types<tag<I>...>; };
+
+using list_t = make<std::make_index_sequence<N>>::type;
+
+template <typename T, typename U>
+struct is_large : std::integral_constant<bool, (sizeof(T) > sizeof(U))> {};
+)";
+
+struct algorithm
+{
+    const char* name_;
+    const char* code_;
+};
+
+const algorithm algorithms[] =
+{
+    { "at"       , "using r_t = capo::types_at_t<list_t, N - 1>;"                                },
+    { "assign"   , "using r_t = capo::types_assign_t<N, int>;"                                   },
+    { "insert"   , "using r_t = capo::types_insert_t<list_t, N / 2, void>;"                      },
+    { "erase"    , "using r_t = capo::types_erase_t<list_t, N / 2, N / 4>;"                      },
+    { "find"     , "static_assert(capo::types_find<list_t, tag<N - 1>>::value == N - 1, \"\");"  },
+    { "remove"   , "using r_t = capo::types_remove_t<list_t, tag<N / 2>>;"                       },
+    { "compact"  , "using r_t = capo::types_compact_t<capo::types_link_t<list_t, list_t>>;"      },
+    { "reverse"  , "using r_t = capo::types_reverse_t<list_t>;"                                  },
+    { "select_if", "using r_t = capo::types_select_if_t<list_t, is_large>;"                      },
+    { "sort_if"  , "using r_t = capo::types_sort_if_t<list_t, is_large>;"                        },
+};
+
+struct result
+{
+    bool   ok_;
+    double ms_;
+    long   kb_;
+};
+
+#if !defined(CAPO_OS_WIN_)
+result compile(const std::string& cmd)
+{
+    auto beg = std::chrono::steady_clock::now();
+    pid_t pid = ::fork();
+    if (pid == 0)
+    {
+        ::execl("/bin/sh", "sh", "-c", cmd.c_str(), static_cast<char*>(nullptr));
+        ::_exit(127);
+    }
+    int status = 0;
+    struct rusage ru {};
+    // The rusage of the child covers its waited descendants, e.g. cc1plus
+    ::wait4(pid, &status, 0, &ru);
+    std::chrono::duration<double, std::milli> ms = std::chrono::steady_clock::now() - beg;
+    return { (pid > 0) && WIFEXITED(status) && (WEXITSTATUS(status) == 0), ms.count(), ru.ru_maxrss };
+}
+#endif/*!CAPO_OS_WIN_*/
+
+std::vector<int> parse_sizes(const std::string& str)
+{
+    std::vector<int> ret;
+    for (const char* v = str.c_str(); *v != '\0';)
+    {
+        char* e = nullptr;
+        long n = std::strtol(v, &e, 10);
+        if (e == v) break;
+        if (n > 0) ret.push_back(static_cast<int>(n));
+        v = (*e == ',') ? e + 1 : e;
+    }
+    return ret;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    std::string include, compiler = "g++", sizes = "100,500,1000";
+
+    capo::cmdline::parser cmd;
+    cmd.push(capo::cmdline::options
+    {
+        {
+            "-i", "--include", "The directory holding capo/type_list.hpp.", true, "",
+            [&](auto&, auto& str) { include = str; }
+        },
+        {
+            "-c", "--compiler", "The compiler command.", false, "g++",
+            [&](auto&, auto& str) { compiler = str; }
+        },
+        {
+            "-s", "--sizes", "The lengths of the type-lists.", false, "100,500,1000",
+            [&](auto&, auto& str) { sizes = str; }
+        }
+    });
+    cmd.exec(argc, argv);
+    if (include.empty()) return 1;
+
+#if defined(CAPO_OS_WIN_)
+    capo::printf("The compile-time benchmark needs fork & wait4, which is not supported on windows.\n");
+    return 1;
+#else /*!CAPO_OS_WIN_*/
+    std::string src = "type_list-bench.tmp.cpp";
+    capo::printf("%-10s %6s %12s %12s\n", "algorithm", "types", "time (ms)", "memory (KB)");
+    for (int n : parse_sizes(sizes))
+    {
+        for (const auto& a : algorithms)
+        {
+            {
+                std::ofstream out { src };
+                out << "#define CAPO_BENCH_TYPES " << n << "\n" << prologue << a.code_ << "\n";
+            }
+            result r = compile(compiler + " -std=c++1y -fsyntax-only -I\"" + include + "\" " + src + " > /dev/null 2>&1");
+            if (r.ok_)
+                 capo::printf("%-10s %6d %12.1f %12ld\n", a.name_, n, r.ms_, r.kb_);
+            else capo::printf("%-10s %6d %12s %12s\n"    , a.name_, n, "failed", "-");
+        }
+    }
+    std::remove(src.c_str());
+    return 0;
+#endif/*!CAPO_OS_WIN_*/
+}